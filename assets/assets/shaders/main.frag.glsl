@@ -1,12 +1,11 @@
 #version 460
 
-layout(set = 2, binding = 0) uniform sampler2D u_texture;
-
-layout(set = 3, binding = 0) uniform Uni
-{
-    vec2 u_tex_size;
-};
+// The build also compiles this with `VARIANT_color_only` and `VARIANT_texture_only` defined, see `Renderer::MainVariant`.
+// Those are the cases where `v_factors.xy` are both 0 or both 1, and they skip what doesn't contribute to the result.
 
+#ifndef VARIANT_color_only
+layout(set = 2, binding = 0) uniform sampler2D u_texture;
+#endif
 
 layout(location = 0) in vec4 v_color;
 layout(location = 1) in vec2 v_texcoord;
@@ -16,9 +15,18 @@ layout(location = 0) out vec4 out_color;
 
 void main()
 {
-    vec4 tex_color = texture(u_texture, v_texcoord / u_tex_size);
+#if defined(VARIANT_color_only)
+    out_color = v_color;
+#else
+    // Querying the size instead of passing it as a uniform, since different batches use different textures.
+    vec4 tex_color = texture(u_texture, v_texcoord / vec2(textureSize(u_texture, 0)));
+#if defined(VARIANT_texture_only)
+    out_color = tex_color;
+#else
     out_color = vec4(mix(v_color.rgb, tex_color.rgb, v_factors.x),
                      mix(v_color.a  , tex_color.a  , v_factors.y));
+#endif
+#endif
 
     out_color.rgb *= out_color.a;
     out_color.a *= v_factors.z;
@@ -5,19 +5,35 @@ layout(set = 1, binding = 0) uniform Uni
     vec2 u_scr_size;
 };
 
-layout(location = 0) in vec2 a_pos;
-layout(location = 1) in vec4 a_color;
-layout(location = 2) in vec2 a_texcoord;
-layout(location = 3) in vec3 a_factors;
+// Those are per instance. Each instance is one rect. See `RectInstance`: the coordinates are 16-bit integers, the rest are normalized bytes.
+layout(location = 0) in ivec2 a_pos;
+layout(location = 1) in ivec2 a_size;
+layout(location = 2) in ivec2 a_tex_pos;
+layout(location = 3) in ivec2 a_tex_size;
+layout(location = 4) in vec4 a_color;
+layout(location = 5) in vec4 a_factors;
+layout(location = 6) in uint a_order;
 
 layout(location = 0) out vec4 v_color;
 layout(location = 1) out vec2 v_texcoord;
 layout(location = 2) out vec3 v_factors;
 
+// Two triangles per rect: top-left, top-right, bottom-left, then bottom-left, top-right, bottom-right.
+const vec2 corners[6] = vec2[6](
+    vec2(0, 0), vec2(1, 0), vec2(0, 1),
+    vec2(0, 1), vec2(1, 0), vec2(1, 1)
+);
+
 void main()
 {
-    gl_Position = vec4(a_pos * 2 / u_scr_size, 0, 1);
+    vec2 corner = corners[gl_VertexIndex];
+
+    // The later rects are closer. The depth target is 16-bit, and this value is exactly representable in it. Saturates after 65535 rects.
+    // This only matters for `RenderQueue::DrawWithDepth()`, without a depth target it's ignored.
+    float depth = float(65535u - min(a_order, 65535u)) / 65535.0;
+
+    gl_Position = vec4((vec2(a_pos) + vec2(a_size) * corner) * 2 / u_scr_size, depth, 1);
     v_color = a_color;
-    v_texcoord = a_texcoord;
-    v_factors = a_factors;
+    v_texcoord = vec2(a_tex_pos) + vec2(a_tex_size) * corner;
+    v_factors = a_factors.xyz;
 }
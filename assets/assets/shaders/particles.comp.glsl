@@ -0,0 +1,83 @@
+#version 460
+
+// Simulates `GpuParticles`. One invocation per particle slot, see `ParticlePool::Tick()` for the CPU version of this.
+
+layout(local_size_x = 64) in;
+
+// Must match `GpuParticle` in `particle_pool.h`.
+struct Particle
+{
+    vec2 pos;
+    vec2 vel;
+    vec4 color;
+    float damp;
+    float max_size;
+    float total_life;
+    float remaining_life;
+};
+
+// Must match `GpuParticleSpawn`.
+struct Spawn
+{
+    Particle particle;
+    // How many of the `u_num_ticks` ticks happened before this was spawned.
+    uint tick;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Spawns
+{
+    Spawn spawns[];
+};
+
+layout(std430, set = 1, binding = 0) buffer Particles
+{
+    Particle particles[];
+};
+
+layout(std140, set = 2, binding = 0) uniform Uni
+{
+    uint u_capacity;
+    uint u_num_spawns;
+    // The new particles go to consecutive slots starting from this one, wrapping around.
+    uint u_spawn_cursor;
+    // How many ticks to simulate.
+    uint u_num_ticks;
+    // If non-zero, kill all existing particles first.
+    uint u_clear;
+};
+
+void main()
+{
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= u_capacity)
+        return;
+
+    Particle p;
+    uint num_steps = u_num_ticks;
+
+    uint spawn_index = (i + u_capacity - u_spawn_cursor) % u_capacity;
+    if (spawn_index < u_num_spawns)
+    {
+        p = spawns[spawn_index].particle;
+        // Only simulate the ticks that happened after this was spawned.
+        num_steps = u_num_ticks - spawns[spawn_index].tick;
+    }
+    else if (u_clear != 0)
+    {
+        // Zero everything, not only the life, because this is also how the buffer is initialized.
+        p = Particle(vec2(0), vec2(0), vec4(0), 0, 0, 0, 0);
+    }
+    else
+    {
+        p = particles[i];
+    }
+
+    for (uint s = 0; s < num_steps && p.remaining_life > 0; s++)
+    {
+        p.pos += p.vel;
+        p.vel *= 1 - p.damp;
+        p.remaining_life--;
+    }
+
+    particles[i] = p;
+}
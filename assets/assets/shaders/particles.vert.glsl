@@ -0,0 +1,51 @@
+#version 460
+
+// Draws `GpuParticles` straight from the buffer, one instance (rect) per particle slot. Dead particles get zero size.
+
+layout(set = 1, binding = 0) uniform Uni
+{
+    vec2 u_scr_size;
+};
+
+// Must match `GpuParticle` in `particle_pool.h`.
+struct Particle
+{
+    vec2 pos;
+    vec2 vel;
+    vec4 color;
+    float damp;
+    float max_size;
+    float total_life;
+    float remaining_life;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Particles
+{
+    Particle particles[];
+};
+
+layout(location = 0) out vec4 v_color;
+
+// Same as in `main.vert`.
+const vec2 corners[6] = vec2[6](
+    vec2(0, 0), vec2(1, 0), vec2(0, 1),
+    vec2(0, 1), vec2(1, 0), vec2(1, 1)
+);
+
+// Like `std::round()`, rounds halves away from zero.
+vec2 RoundAway(vec2 x)
+{
+    return sign(x) * floor(abs(x) + 0.5);
+}
+
+void main()
+{
+    Particle p = particles[gl_InstanceIndex];
+
+    // Same as `ParticlePool::Render()`.
+    float size = p.remaining_life > 0 ? RoundAway(vec2(p.max_size * p.remaining_life / p.total_life)).x : 0;
+    vec2 corner = RoundAway(p.pos - floor(size / 2)); // This is an integer division on the CPU.
+
+    gl_Position = vec4((corner + size * corners[gl_VertexIndex]) * 2 / u_scr_size, 0, 1);
+    v_color = p.color;
+}
@@ -2,11 +2,30 @@
 
 layout(set = 2, binding = 0) uniform sampler2D u_tex;
 
+layout(set = 3, binding = 0) uniform Uni
+{
+    // Output pixels per texel. Doesn't have to be integral.
+    vec2 u_scale;
+};
+
 layout(location = 0) in vec2 v_texcoord;
 
 layout(location = 0) out vec4 out_fragcolor;
 
+// Sharp bilinear: each texel is a flat square, and only the output pixels on the borders between the texels are blended.
+// The sampler must use linear filtering. This looks the same as a nearest upscale by an integer factor followed by a linear rescale,
+//   but without the intermediate texture.
 void main()
 {
-    out_fragcolor = texture(u_tex, v_texcoord);
+    vec2 tex_size = vec2(textureSize(u_tex, 0));
+    vec2 scale = max(u_scale, vec2(1)); // Don't let the flat region become negative when downscaling.
+
+    vec2 texel = v_texcoord * tex_size;
+    vec2 center_dist = fract(texel) - 0.5;
+    // The half-size of the flat region in the middle of each texel, measured in texels.
+    vec2 flat_half_size = 0.5 - 0.5 / scale;
+    // Squeeze the transition between the texels into a single output pixel.
+    vec2 offset = (center_dist - clamp(center_dist, -flat_half_size, flat_half_size)) * scale + 0.5;
+
+    out_fragcolor = texture(u_tex, (floor(texel) + offset) / tex_size);
 }
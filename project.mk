@@ -20,6 +20,8 @@ $(Mode)_win_subsystem := -mwindows
 $(call NewMode,profile)
 $(Mode)GLOBAL_COMMON_FLAGS := -O3 -pg
 $(Mode)GLOBAL_CXXFLAGS := -DNDEBUG
+# Compiles in the profiling zones, see `src/utils/trace.h`.
+$(Mode)PROJ_CXXFLAGS += -DEM_TRACE
 $(Mode)_win_subsystem := -mwindows
 
 $(call NewMode,sanitize_address_ub)
@@ -60,6 +62,36 @@ ifeq ($(TARGET_OS),windows)
 $(call ProjectSetting,bad_lib_flags,-Wl$(comma)--enable-new-dtags)
 endif
 
+# Headless rendering benchmark: renders every level offscreen without vsync and prints the timings. Run with `make run-frames_bench`.
+# Same sources as the game, the macro makes `em::Main()` start the benchmark instead.
+$(call Project,exe,frames_bench)
+$(call ProjectSetting,source_dirs,src)
+$(call ProjectSetting,libs,*)
+$(call ProjectSetting,cxxflags,-DFRAMES_BENCH)
+ifeq ($(TARGET_OS),windows)
+$(call ProjectSetting,bad_lib_flags,-Wl$(comma)--enable-new-dtags)
+endif
+
+# Microbenchmarks of the hot functions, one JSON object per line on stdout, to compare between commits. Run with `make run-frames_microbench`.
+# Same sources as the game, the macro makes `em::Main()` start the microbenchmarks instead. See `src/game/microbench.h` for the options.
+$(call Project,exe,frames_microbench)
+$(call ProjectSetting,source_dirs,src)
+$(call ProjectSetting,libs,*)
+$(call ProjectSetting,cxxflags,-DFRAMES_MICROBENCH -DEM_COUNT_ALLOCATIONS)
+ifeq ($(TARGET_OS),windows)
+$(call ProjectSetting,bad_lib_flags,-Wl$(comma)--enable-new-dtags)
+endif
+
+# Converts the PNGs to our pre-baked image format at build time, see `src/game/baked_image.h`.
+# This runs on the build machine, so when cross-compiling, make sure the host can run it (e.g. via Wine).
+$(call Project,exe,bake_image)
+$(call ProjectSetting,source_dirs,tools/bake_image)
+$(call ProjectSetting,libs,stb)
+
+# Packs the assets into one file, see `src/utils/asset_pack_format.h`. Runs on the build machine, same as `bake_image`.
+$(call Project,exe,pack_assets)
+$(call ProjectSetting,source_dirs,tools/pack_assets)
+
 
 # Shader compilation:
 ASSETS_IGNORED_PATTERNS += *.glsl
@@ -70,6 +102,36 @@ assets/%.vert.spv: assets/%.vert.glsl
 assets/%.frag.spv: assets/%.frag.glsl
 	$(call log_now,[GLSL Fragment] $<)
 	@glslc -fshader-stage=frag $< -o $@ -O
+assets/%.comp.spv: assets/%.comp.glsl
+	$(call log_now,[GLSL Compute] $<)
+	@glslc -fshader-stage=comp $< -o $@ -O
+
+# The fragment shader variants, see `ShaderPair`. `<name>.<variant>.frag.spv` is compiled from `<name>.frag.glsl` with `VARIANT_<variant>` defined.
+SHADER_VARIANTS := main.color_only main.texture_only
+ASSETS_GENERATED += $(patsubst %,assets/assets/shaders/%.frag.spv,$(SHADER_VARIANTS))
+override define shader_variant_rule =
+assets/assets/shaders/$1.frag.spv: assets/assets/shaders/$(basename $1).frag.glsl
+	$$(call log_now,[GLSL Fragment] $$< ($(patsubst .%,%,$(suffix $1))))
+	@glslc -fshader-stage=frag -DVARIANT_$(patsubst .%,%,$(suffix $1)) $$< -o $$@ -O
+endef
+$(foreach x,$(SHADER_VARIANTS),$(eval $(call shader_variant_rule,$x)))
+
+# Image baking:
+# Secondary expansion is needed because the path of the baking tool isn't known yet at this point.
+.SECONDEXPANSION:
+ASSETS_IGNORED_PATTERNS += *.png
+ASSETS_GENERATED += $(patsubst %.png,%.image,$(wildcard assets/assets/images/*.png))
+assets/%.image: assets/%.png $$(call proj_output_filename,bake_image)
+	$(call log_now,[Bake image] $<)
+	@$(call proj_output_filename,bake_image) $< $@
+
+# The asset pack: everything above, plus the files that are used as is. This must be last, to see all generated files.
+# The game reads from it if it exists, see `Filesystem::MountAssetPack()`. The loose files are still copied, as a fallback.
+_asset_pack_inputs := $(sort $(call rwildcard,assets/assets,*.wav *.ogg) $(ASSETS_GENERATED))
+ASSETS_GENERATED += assets/assets.pack
+assets/assets.pack: $(_asset_pack_inputs) $$(call proj_output_filename,pack_assets)
+	$(call log_now,[Pack assets] $@)
+	@$(call proj_output_filename,pack_assets) $@ assets $(_asset_pack_inputs)
 
 
 # --- Dependencies ---
@@ -174,7 +236,8 @@ $(call Library,stb,https://github.com/nothings/stb/archive/f0569113c93ad095470c5
   $(call LibrarySetting,build_system,dummy)
   # Out of those, `rectpack` is used both by us and ImGui.
   # There's also `textedit`, which ImGui uses and we don't but we let ImGui keep its version, since it's slightly patched.
-  $(call LibrarySetting,install_files,*.h->include)
+  # `stb_vorbis` is a `.c` file, see `src/audio/stb_vorbis.cpp`.
+  $(call LibrarySetting,install_files,*.h->include stb_vorbis.c->include)
 
 
 
@@ -0,0 +1,117 @@
+#include "audio_thread.h"
+
+#include "audio/errors.h"
+#include "utils/trace.h"
+
+#include <chrono>
+#include <utility>
+
+namespace em::Audio
+{
+    void AudioThread::Start(std::size_t num_voices, Task new_on_tick)
+    {
+        Stop();
+
+        on_tick = std::move(new_on_tick);
+        manager.SetOnVoiceFinished([this](ALuint buffer)
+        {
+            if (!finished.TryPush({.buffer = buffer}))
+                num_dropped.fetch_add(1, std::memory_order_relaxed);
+        });
+        manager.CreateVoices(num_voices);
+
+        failed.store(false, std::memory_order_relaxed);
+        error = nullptr;
+        running.store(true, std::memory_order_relaxed);
+        thread = std::jthread([this](std::stop_token stop){ThreadFunc(std::move(stop));});
+    }
+
+    void AudioThread::Stop()
+    {
+        if (!thread.joinable())
+            return;
+
+        thread = {}; // Requests the stop and joins.
+        running.store(false, std::memory_order_relaxed);
+
+        // The thread is gone, so now we're the consumer. The requests can refer to the buffers that are about to be destroyed.
+        while (requests.TryPop()) {}
+        while (tasks.TryPop()) {}
+        manager.Reset();
+        on_tick = nullptr;
+    }
+
+    void AudioThread::ThreadFunc(std::stop_token stop)
+    {
+        try
+        {
+            while (!stop.stop_requested())
+            {
+                {
+                    EM_TRACE_ZONE("Audio::AudioThread::Tick");
+
+                    while (std::optional<Task> task = tasks.TryPop())
+                        (*task)(manager);
+
+                    if (on_tick)
+                        on_tick(manager);
+
+                    // `SourceManager` merges the identical requests, so the sounds from the same game tick still play once.
+                    while (std::optional<Request> request = requests.TryPop())
+                    {
+                        if (request->pos)
+                            manager.Request(*request->buffer, *request->pos, request->volume, request->pitch);
+                        else
+                            manager.Request(*request->buffer, request->volume, request->pitch);
+                    }
+                    manager.Tick();
+
+                    num_active_sources.store(manager.ActiveSources(), std::memory_order_relaxed);
+
+                    CheckErrors();
+                }
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(tick_interval_ms));
+            }
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+            failed.store(true, std::memory_order_release);
+        }
+    }
+
+    void AudioThread::Push(const Buffer &buffer, std::optional<fvec3> pos, float volume, float pitch)
+    {
+        if (!IsRunning())
+            return;
+        if (!requests.TryPush({.buffer = &buffer, .pos = pos, .volume = volume, .pitch = pitch}))
+            num_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void AudioThread::RunOnThread(Task task)
+    {
+        if (!IsRunning())
+        {
+            task(manager);
+            return;
+        }
+
+        // This is rare (e.g. reloading a sound), so spinning is fine.
+        while (!tasks.TryPush(task))
+        {
+            if (failed.load(std::memory_order_acquire))
+                return; // Nobody would run it. `PollFinished()` reports the error.
+            std::this_thread::sleep_for(std::chrono::milliseconds(tick_interval_ms));
+        }
+    }
+
+    void AudioThread::PollFinished(const std::function<void(const VoiceFinished &voice)> &func)
+    {
+        if (failed.load(std::memory_order_acquire))
+            std::rethrow_exception(error);
+
+        while (std::optional<VoiceFinished> voice = finished.TryPop())
+            func(*voice);
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "audio/buffer.h"
+#include "audio/openal.h"
+#include "audio/source_manager.h"
+#include "em/math/vector.h"
+#include "utils/spsc_queue.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <stop_token>
+#include <thread>
+
+namespace em::Audio
+{
+    // Owns a `SourceManager` and ticks it on a thread of its own, so that the slow OpenAL calls (and the driver hitches) never stall a frame.
+    // The sound requests go in through a lock-free queue (see `SpscQueue`), and the finished voices come back the same way.
+    // The context itself is created by the caller: OpenAL contexts are process-wide, and the sound buffers must not outlive it.
+    // `Request()` is for the thread that plays the gameplay sounds (only one at a time), everything else is for the thread that called `Start()`.
+    class AudioThread
+    {
+      public:
+        struct VoiceFinished
+        {
+            // The buffer that the voice was playing.
+            ALuint buffer = 0;
+        };
+
+        // Runs on the audio thread, with the sources.
+        using Task = std::function<void(SourceManager &manager)>;
+
+      private:
+        struct Request
+        {
+            const Buffer *buffer = nullptr;
+            std::optional<fvec3> pos; // Null for the listener-relative sounds.
+            float volume = 1;
+            float pitch = 0;
+        };
+
+        // How long the thread sleeps between the iterations. This bounds the added latency.
+        static constexpr int tick_interval_ms = 4;
+
+        // Only touched by the thread while it runs.
+        SourceManager manager;
+        Task on_tick;
+
+        SpscQueue<Request> requests = SpscQueue<Request>(256);
+        SpscQueue<Task> tasks = SpscQueue<Task>(64);
+        SpscQueue<VoiceFinished> finished = SpscQueue<VoiceFinished>(256);
+
+        std::atomic<bool> running = false;
+        std::atomic<std::size_t> num_active_sources = 0;
+        // The requests and the notifications lost because their queue was full.
+        std::atomic<std::uint64_t> num_dropped = 0;
+
+        // Set by the thread if it stops because of an error. `error` is written before this.
+        std::atomic<bool> failed = false;
+        std::exception_ptr error;
+
+        // This must be last, to be destroyed (joined) first, while the rest is still alive.
+        std::jthread thread;
+
+        void ThreadFunc(std::stop_token stop);
+        void Push(const Buffer &buffer, std::optional<fvec3> pos, float volume, float pitch);
+
+      public:
+        AudioThread() {}
+
+        // Not movable, the thread refers to `this`.
+        AudioThread(const AudioThread &) = delete;
+        AudioThread &operator=(const AudioThread &) = delete;
+
+        ~AudioThread() {Stop();}
+
+        // Creates the voices and starts the thread. Call this after creating the context.
+        // If `on_tick` isn't null, the thread calls it on every iteration, e.g. to upload the sounds that finished loading.
+        void Start(std::size_t num_voices, Task new_on_tick = nullptr);
+        // Stops the thread and destroys the sources. Call this before destroying the context. Does nothing if not running.
+        // The thread that calls `Request()` must be stopped first.
+        void Stop();
+
+        [[nodiscard]] bool IsRunning() const {return running.load(std::memory_order_relaxed);}
+
+        // Same as `SourceManager::Request()`, but from any one thread. Does nothing if not running.
+        // The buffer must stay alive until the thread is stopped, since the request can be delayed by a few milliseconds.
+        void Request(const Buffer &buffer, fvec3 pos, float volume = 1, float pitch = 0) {Push(buffer, pos, volume, pitch);}
+        void Request(const Buffer &buffer, fvec2 pos, float volume = 1, float pitch = 0) {Push(buffer, pos.to_vec3(), volume, pitch);}
+        void Request(const Buffer &buffer, float volume = 1, float pitch = 0) {Push(buffer, std::nullopt, volume, pitch);}
+
+        // Runs `task` on the audio thread before its next tick. If not running, runs it right away.
+        // If the queue is full, waits until there's space.
+        void RunOnThread(Task task);
+
+        // Calls `func` for each voice that finished since the last call. Call this once per frame.
+        // Rethrows the error if the thread has stopped because of it.
+        void PollFinished(const std::function<void(const VoiceFinished &voice)> &func);
+
+        // The sources that are playing, as of the last tick of the thread.
+        [[nodiscard]] std::size_t NumActiveSources() const {return num_active_sources.load(std::memory_order_relaxed);}
+        // The requests and notifications dropped because the queues were full.
+        [[nodiscard]] std::uint64_t NumDropped() const {return num_dropped.load(std::memory_order_relaxed);}
+    };
+}
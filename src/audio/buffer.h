@@ -13,6 +13,8 @@ namespace em::Audio
         struct Data
         {
             ALuint handle = 0;
+            // If false, this is an alias of another buffer (see `Alias()`), and the handle isn't deleted with this object.
+            bool owns_handle = false;
         };
         Data data;
 
@@ -24,6 +26,7 @@ namespace em::Audio
             alGenBuffers(1, &data.handle);
             if (!data.handle)
                 throw std::runtime_error("Unable to create an audio buffer.");
+            data.owns_handle = true;
             // Not needed because there is no code below this point:
             // FINALLY_ON_THROW{alDeleteBuffers(1, &value);};
         }
@@ -42,7 +45,7 @@ namespace em::Audio
         ~Buffer()
         {
             // Not sure if `alDeleteBuffers` is a no-op if you pass 0 to it. Better be safe.
-            if (data.handle)
+            if (data.handle && data.owns_handle)
                 alDeleteBuffers(1, &data.handle);
         }
 
@@ -56,6 +59,21 @@ namespace em::Audio
             return data.handle;
         }
 
+        // Returns a buffer with the same handle that doesn't own it. It must not outlive this buffer, and its data can't be changed.
+        // This lets identical sounds share the memory, see `GlobalData`.
+        [[nodiscard]] Buffer Alias() const
+        {
+            Buffer ret;
+            ret.data.handle = data.handle;
+            return ret;
+        }
+
+        // False for the null buffers and for the results of `Alias()`.
+        [[nodiscard]] bool OwnsHandle() const
+        {
+            return data.owns_handle;
+        }
+
         // Sets the data from memory, with the format specified at runtime.
         // Note that the length of the data is measured in blocks. Each block consists of `channel_count` samples, each sample having `resolution` bits in it.
         void SetData(int sampling_rate, Channels channel_count, BitResolution resolution, std::size_t block_count, const std::uint8_t *source = nullptr)
@@ -63,6 +81,7 @@ namespace em::Audio
             assert(*this && "Attempt to use a null audio buffer.");
             if (!*this)
                 return;
+            assert(data.owns_handle && "Attempt to change the data of an aliased audio buffer.");
 
             ALenum format;
             if (channel_count == mono)
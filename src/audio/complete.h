@@ -1,5 +1,6 @@
 #pragma once
 
+#include "audio/audio_thread.h"
 #include "audio/buffer.h"
 #include "audio/context.h"
 #include "audio/errors.h"
@@ -9,3 +10,5 @@
 #include "audio/sound.h"
 #include "audio/source_manager.h"
 #include "audio/source.h"
+#include "audio/streaming_source.h"
+#include "audio/voice_pool.h"
@@ -2,15 +2,27 @@
 
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include "audio/buffer.h"
 #include "audio/sound.h"
 #include "em/meta/packs.h"
 #include "em/meta/const_string.h"
+#include "mainloop/job_system.h"
+
+#include <fmt/format.h>
 
 // Provides singletones to conveniently load sounds.
 
@@ -18,6 +30,7 @@ namespace em::Audio::GlobalData
 {
     template <typename T> concept ChannelsOrNullptr = em::Meta::same_as_any<T, Channels, std::nullptr_t>;
     template <typename T> concept FormatOrNullptr = em::Meta::same_as_any<T, Format, std::nullptr_t>;
+    template <typename T> concept ResolutionOrNullptr = em::Meta::same_as_any<T, BitResolution, std::nullptr_t>;
 
     namespace impl
     {
@@ -27,6 +40,11 @@ namespace em::Audio::GlobalData
             // Those may override the parameters specified when calling `LoadFiles()`.
             std::optional<Channels> channels_override;
             std::optional<Format> format_override;
+            // If set to `bits_8`, the sound is stored with 8 bits per sample, for half the memory. By default it's 16 bits.
+            std::optional<BitResolution> resolution_override;
+
+            // The hash of the file and the parameters it was decoded with. The entries with the same hash share one buffer, see `Upload()`.
+            std::uint64_t content_hash = 0;
         };
 
         // We rely on `std::map` never invalidating the references.
@@ -38,7 +56,7 @@ namespace em::Audio::GlobalData
             return ret;
         }
 
-        template <Meta::ConstString Name, ChannelsOrNullptr auto ChannelCount, FormatOrNullptr auto FileFormat>
+        template <Meta::ConstString Name, ChannelsOrNullptr auto ChannelCount, FormatOrNullptr auto FileFormat, ResolutionOrNullptr auto Resolution>
         struct RegisterBuffer
         {
             inline static const Buffer &ref = []() -> Buffer &
@@ -49,18 +67,108 @@ namespace em::Audio::GlobalData
                     iter->second.channels_override = ChannelCount;
                 if constexpr (!std::is_null_pointer_v<decltype(FileFormat)>)
                     iter->second.format_override = FileFormat;
+                if constexpr (!std::is_null_pointer_v<decltype(Resolution)>)
+                    iter->second.resolution_override = Resolution;
                 return iter->second.buffer; // We rely on `std::map` never invalidating the references.
             }();
         };
+
+        // FNV-1a over the file and the decoding parameters. This is computed on the workers, so the speed doesn't matter much.
+        [[nodiscard]] inline std::uint64_t ContentHash(std::span<const unsigned char> file, std::optional<Channels> channels, Format format, BitResolution resolution)
+        {
+            std::uint64_t hash = 0xcbf29ce484222325;
+            auto Mix = [&](std::uint64_t value)
+            {
+                hash ^= value;
+                hash *= 0x100000001b3;
+            };
+            for (unsigned char byte : file)
+                Mix(byte);
+            Mix(channels ? std::uint64_t(*channels) : 0);
+            Mix(std::uint64_t(format));
+            Mix(std::uint64_t(resolution));
+            Mix(file.size());
+            return hash;
+        }
+
+        // Decodes `file` with the parameters of `target`.
+        [[nodiscard]] inline Audio::Sound Decode(const AutoLoadedBuffer &target, std::optional<Channels> channels, Format format, em::Filesystem::LoadedFile file)
+        {
+            BitResolution resolution = target.resolution_override.value_or(bits_16);
+            Audio::Sound ret(format, channels, std::move(file), resolution);
+            if (resolution == bits_8)
+                ret.ConvertTo8Bit(); // WAV ignores the preferred resolution.
+            return ret;
+        }
+
+        // If `target` shares its AL buffer with other entries, makes it stop doing that, and leaves its buffer null. Otherwise does nothing.
+        // If `target` owns the shared buffer, the ownership goes to one of the others, so the handle stays alive for them and for the playing voices.
+        inline void Unshare(AutoLoadedBuffer &target)
+        {
+            if (!target.buffer)
+                return;
+
+            AutoLoadedBuffer *heir = nullptr;
+            bool shared = false;
+            for (auto &[name, other] : GetAutoLoadedBuffers())
+            {
+                if (&other == &target || other.buffer.Handle() != target.buffer.Handle())
+                    continue;
+                shared = true;
+                if (!heir)
+                    heir = &other;
+            }
+            if (!shared)
+                return;
+
+            if (target.buffer.OwnsHandle())
+                heir->buffer = std::move(target.buffer); // Replaces an alias, which doesn't delete anything.
+            target.buffer = {};
+        }
+
+        // Uploads `sound` to `target`. On the first load, if another entry has the same `content_hash`, this reuses its buffer instead,
+        //   so that the sounds that are used under several names (e.g. file copies) are stored once.
+        // Otherwise if `target` already has a buffer of its own, and `before_replace` isn't null, calls it and replaces the contents in place, keeping the handle.
+        inline void Upload(AutoLoadedBuffer &target, const Audio::Sound &sound, std::uint64_t content_hash, const std::function<void(const Buffer &old_buffer)> &before_replace)
+        {
+            // The reloaded file isn't the same anymore, and the other entries must not change with it.
+            Unshare(target);
+            target.content_hash = content_hash;
+
+            if (target.buffer)
+            {
+                if (before_replace)
+                {
+                    before_replace(target.buffer);
+                    target.buffer.SetData(sound);
+                }
+                else
+                {
+                    target.buffer = Buffer(sound);
+                }
+                return;
+            }
+
+            for (auto &[name, other] : GetAutoLoadedBuffers())
+            {
+                if (&other != &target && other.buffer && other.content_hash == content_hash)
+                {
+                    target.buffer = other.buffer.Alias();
+                    return;
+                }
+            }
+            target.buffer = Buffer(sound);
+        }
     }
 
     // Returns a reference to a buffer, loaded from the filename passed as the parameter.
     // The load doesn't happen at the call point, and is done by `LoadFiles()`, which magically knows all files that it needs to load in this manner.
     // The returned reference is stable across reloads.
-    template <Meta::ConstString Name, ChannelsOrNullptr auto ChannelCount = nullptr, FormatOrNullptr auto FileFormat = nullptr>
+    // Pass `bits_8` as `Resolution` for the rarely played sounds, to store them in half the memory at a lower quality.
+    template <Meta::ConstString Name, ChannelsOrNullptr auto ChannelCount = nullptr, FormatOrNullptr auto FileFormat = nullptr, ResolutionOrNullptr auto Resolution = nullptr>
     [[nodiscard]] const Buffer &Sound()
     {
-        return impl::RegisterBuffer<Name, ChannelCount, FileFormat>::ref;
+        return impl::RegisterBuffer<Name, ChannelCount, FileFormat, Resolution>::ref;
     }
 
     // Same as `Sound()`, but without the optional parameters.
@@ -72,14 +180,44 @@ namespace em::Audio::GlobalData
 
     // Loads (or reloads) all files requested with `Audio::GlobalData::Sound()`. Consider using the simplified overload, defined below.
     // The number of channels and the file format can be overridden by the `Sound()` calls.
-    // `get_stream` is called repeatedly for all needed files.
+    // `get_stream` is called repeatedly for all needed files. The identical files share one buffer.
     inline void Load(std::optional<Channels> channels, Format format, std::function<em::Filesystem::LoadedFile(const std::string &name, std::optional<Channels> channels, Format format)> get_stream)
     {
         for (auto &[name, data] : impl::GetAutoLoadedBuffers())
         {
             std::optional<Channels> file_channels = data.channels_override ? data.channels_override : channels;
             Format file_format = data.format_override.value_or(format);
-            data.buffer = Audio::Sound(file_format, file_channels, get_stream(name, file_channels, file_format));
+            em::Filesystem::LoadedFile file = get_stream(name, file_channels, file_format);
+            std::uint64_t hash = impl::ContentHash(file, file_channels, file_format, data.resolution_override.value_or(bits_16));
+            impl::Upload(data, impl::Decode(data, file_channels, file_format, std::move(file)), hash, nullptr);
+        }
+    }
+
+    // `.wav` or `.ogg`.
+    [[nodiscard]] inline const char *FileExtension(Format format)
+    {
+        switch (format)
+        {
+            case wav: return ".wav";
+            case ogg: return ".ogg";
+        }
+        return "";
+    }
+
+    // Calls `func(name, format)` for every sound requested with `Sound()`. `format` is `default_format` unless the `Sound()` call overrides it.
+    template <typename F>
+    void ForEachSound(Format default_format, F &&func)
+    {
+        for (const auto &[name, data] : impl::GetAutoLoadedBuffers())
+            func(std::as_const(name), data.format_override.value_or(default_format));
+    }
+
+    namespace impl
+    {
+        // Opens `prefix + name + ext`, see the `Load()` overload below.
+        [[nodiscard]] inline em::Filesystem::LoadedFile LoadFileWithPrefix(const std::string &prefix, const std::string &name, Format format)
+        {
+            return em::Filesystem::LoadedFile(prefix + name + FileExtension(format), em::Filesystem::LoadMode::map);
         }
     }
 
@@ -90,15 +228,144 @@ namespace em::Audio::GlobalData
         Load(channels, format, [&prefix](const std::string &name, std::optional<Channels> channels, Format format) -> em::Filesystem::LoadedFile
         {
             (void)channels;
-            const char *ext = "";
-            switch (format)
-            {
-                case wav: ext = ".wav"; break;
-                case ogg: ext = ".ogg"; break;
-            }
-            return em::Filesystem::LoadedFile(prefix + name + ext);
+            return impl::LoadFileWithPrefix(prefix, name, format);
         });
     }
+
+    // Same as `Load()`, but reads and decodes the files on the workers of a `JobSystem`. Only the AL buffers are created on this thread, in `Poll()`.
+    // This lets the app show frames while the sounds are loading. Until a sound is loaded, its buffer stays as is (null on the first load),
+    //   and playing a null buffer does nothing.
+    // The decoded data is dropped as soon as it's uploaded, so only the AL copy stays in memory.
+    class AsyncLoader
+    {
+        struct Decoded
+        {
+            impl::AutoLoadedBuffer *target = nullptr;
+            Audio::Sound sound;
+            std::uint64_t content_hash = 0;
+        };
+
+        struct Shared
+        {
+            std::mutex mutex;
+            // Decoded, waiting for `Poll()`.
+            std::vector<Decoded> decoded;
+            std::exception_ptr error;
+        };
+        std::shared_ptr<Shared> shared;
+        std::size_t num_remaining = 0;
+        std::function<void()> on_done;
+        // If set, `Poll()` calls this on the existing buffers right before replacing their contents.
+        std::function<void(const Buffer &old_buffer)> before_replace;
+
+      public:
+        using get_stream_t = std::function<em::Filesystem::LoadedFile(const std::string &name, std::optional<Channels> channels, Format format)>;
+
+      private:
+        void AddTask(App::JobSystem &jobs, std::optional<Channels> channels, Format format, const std::shared_ptr<const get_stream_t> &get_stream, impl::AutoLoadedBuffersMap::value_type &entry)
+        {
+            std::optional<Channels> file_channels = entry.second.channels_override ? entry.second.channels_override : channels;
+            Format file_format = entry.second.format_override.value_or(format);
+
+            num_remaining++;
+            jobs.Add([shared = shared, get_stream = get_stream, &name = entry.first, target = &entry.second, file_channels, file_format]
+            {
+                try
+                {
+                    em::Filesystem::LoadedFile file = (*get_stream)(name, file_channels, file_format);
+                    std::uint64_t hash = impl::ContentHash(file, file_channels, file_format, target->resolution_override.value_or(bits_16));
+                    Audio::Sound sound = impl::Decode(*target, file_channels, file_format, std::move(file));
+                    std::scoped_lock lock(shared->mutex);
+                    shared->decoded.push_back({.target = target, .sound = std::move(sound), .content_hash = hash});
+                }
+                catch (...)
+                {
+                    std::scoped_lock lock(shared->mutex);
+                    if (!shared->error)
+                        shared->error = std::current_exception();
+                }
+            });
+        }
+
+        [[nodiscard]] static get_stream_t PrefixStream(std::string prefix)
+        {
+            return [prefix = std::move(prefix)](const std::string &name, std::optional<Channels> channels, Format format)
+            {
+                (void)channels;
+                return impl::LoadFileWithPrefix(prefix, name, format);
+            };
+        }
+
+      public:
+        AsyncLoader() {}
+
+        // Starts loading all files requested with `Audio::GlobalData::Sound()`, see `Load()` for the parameters.
+        // `get_stream` is called on the workers, possibly concurrently. `on_done` is called by `Poll()` once all sounds are uploaded.
+        // The job system must outlive the loading, but this object doesn't have to.
+        AsyncLoader(App::JobSystem &jobs, std::optional<Channels> channels, Format format, get_stream_t get_stream, std::function<void()> on_done = nullptr)
+            : shared(std::make_shared<Shared>()), on_done(std::move(on_done))
+        {
+            auto shared_get_stream = std::make_shared<const get_stream_t>(std::move(get_stream));
+
+            for (auto &entry : impl::GetAutoLoadedBuffers())
+                AddTask(jobs, channels, format, shared_get_stream, entry);
+
+            // Nothing to load?
+            Poll();
+        }
+
+        // Same, but the sounds are loaded from files named `prefix + name + ext`, like in the `Load()` overload.
+        AsyncLoader(App::JobSystem &jobs, std::optional<Channels> channels, Format format, std::string prefix, std::function<void()> on_done = nullptr)
+            : AsyncLoader(jobs, channels, format, PrefixStream(std::move(prefix)), std::move(on_done))
+        {}
+
+        // Reloads only the sound `name` (as passed to `Sound()`), e.g. when its file changes. Throws if no such sound was requested.
+        // The buffer keeps its AL handle, only the contents are replaced. Since AL can't do that while the buffer is attached to sources,
+        //   `before_replace` is called by `Poll()` right before that, to detach it. See `SourceManager::DetachBuffer()`.
+        // If the buffer was shared with other identical sounds, it gets a new handle instead, and the others keep the old one.
+        AsyncLoader(App::JobSystem &jobs, std::string_view name, std::optional<Channels> channels, Format format, std::string prefix, std::function<void(const Buffer &old_buffer)> before_replace)
+            : shared(std::make_shared<Shared>()), before_replace(std::move(before_replace))
+        {
+            auto &map = impl::GetAutoLoadedBuffers();
+            auto it = map.find(name);
+            if (it == map.end())
+                throw std::runtime_error(fmt::format("No sound named `{}` was requested, can't reload it.", name));
+            AddTask(jobs, channels, format, std::make_shared<const get_stream_t>(PrefixStream(std::move(prefix))), *it);
+        }
+
+        // Returns true when all sounds are loaded.
+        [[nodiscard]] bool IsDone() const
+        {
+            return num_remaining == 0;
+        }
+
+        // Call this periodically (e.g. once per frame) on the thread that owns the audio context.
+        // Uploads the sounds decoded so far, and calls `on_done` when the last one is uploaded.
+        // If any file failed to load, rethrows the first error.
+        void Poll()
+        {
+            if (!shared)
+                return;
+
+            decltype(Shared::decoded) decoded;
+            std::exception_ptr error;
+            {
+                std::scoped_lock lock(shared->mutex);
+                std::swap(decoded, shared->decoded);
+                error = shared->error;
+            }
+
+            for (const Decoded &elem : decoded)
+                impl::Upload(*elem.target, elem.sound, elem.content_hash, before_replace);
+            num_remaining -= decoded.size();
+
+            if (error)
+                std::rethrow_exception(error);
+
+            if (num_remaining == 0 && on_done)
+                std::exchange(on_done, nullptr)();
+        }
+    };
 }
 
 namespace em::inline Common
@@ -4,14 +4,100 @@
 
 #include <SDL3/SDL_audio.h>
 
+#define STB_VORBIS_HEADER_ONLY
+#include <stb_vorbis.c>
+
 #include <fmt/format.h>
 
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+
 namespace em::Audio
 {
-    Sound::Sound(Format format, std::optional<Channels> expected_channel_count, em::Filesystem::LoadedFile input, BitResolution preferred_resolution)
+    namespace
     {
-        (void)preferred_resolution;
+        struct WavPcm
+        {
+            int sampling_rate = 0;
+            Channels channel_count = mono;
+            BitResolution resolution = bits_8;
+            std::span<const std::uint8_t> data;
+        };
+
+        [[nodiscard]] std::uint32_t ReadLe(const std::uint8_t *ptr, int num_bytes)
+        {
+            std::uint32_t ret = 0;
+            for (int i = num_bytes - 1; i >= 0; i--)
+                ret = ret << 8 | ptr[i];
+            return ret;
+        }
+
+        // Parses a WAV file in place, if it's plain 8-bit or 16-bit PCM, mono or stereo, that can be passed to AL as is. Otherwise returns null.
+        [[nodiscard]] std::optional<WavPcm> ParseWavPcm(std::span<const std::uint8_t> file)
+        {
+            // The 16-bit samples are little-endian.
+            if constexpr (std::endian::native != std::endian::little)
+                return {};
+
+            if (file.size() < 12 || std::memcmp(file.data(), "RIFF", 4) != 0 || std::memcmp(file.data() + 8, "WAVE", 4) != 0)
+                return {};
+
+            WavPcm ret;
+            bool have_format = false;
+
+            std::size_t pos = 12;
+            while (pos <= file.size() && file.size() - pos >= 8)
+            {
+                const std::uint8_t *chunk = file.data() + pos;
+                std::size_t chunk_size = ReadLe(chunk + 4, 4);
+                pos += 8;
+                if (chunk_size > file.size() - pos)
+                    return {};
+
+                if (std::memcmp(chunk, "fmt ", 4) == 0)
+                {
+                    if (chunk_size < 16)
+                        return {};
+                    const std::uint8_t *format_chunk = file.data() + pos;
+                    std::uint32_t tag = ReadLe(format_chunk, 2);
+                    // `WAVE_FORMAT_EXTENSIBLE`, the actual tag is at the start of the subformat GUID.
+                    if (tag == 0xfffe && chunk_size >= 40)
+                        tag = ReadLe(format_chunk + 24, 2);
+                    std::uint32_t channels = ReadLe(format_chunk + 2, 2);
+                    std::uint32_t bits = ReadLe(format_chunk + 14, 2);
+                    if (tag != 1 || (channels != 1 && channels != 2) || (bits != 8 && bits != 16))
+                        return {};
+                    ret.sampling_rate = int(ReadLe(format_chunk + 4, 4));
+                    ret.channel_count = Channels(channels);
+                    ret.resolution = BitResolution(bits);
+                    have_format = true;
+                }
+                else if (std::memcmp(chunk, "data", 4) == 0)
+                {
+                    if (!have_format)
+                        return {};
+                    // Trim a partial block, if any.
+                    std::size_t block = std::size_t(GetBytesPerBlock(ret.resolution, ret.channel_count));
+                    ret.data = file.subspan(pos, chunk_size / block * block);
+                    // The 16-bit samples must be aligned, since `Sound::Data()` hands them out as `int16_t`.
+                    if (ret.resolution == bits_16 && reinterpret_cast<std::uintptr_t>(ret.data.data()) % alignof(std::int16_t) != 0)
+                        return {};
+                    return ret;
+                }
 
+                // The chunks are padded to even sizes. If this goes past the end, the loop stops.
+                pos += chunk_size + chunk_size % 2;
+            }
+
+            return {};
+        }
+    }
+
+    Sound::Sound(Format format, std::optional<Channels> expected_channel_count, em::Filesystem::LoadedFile input, BitResolution preferred_resolution)
+    {
         auto CheckChannelCount = [&]
         {
             if (expected_channel_count && *expected_channel_count != channel_count)
@@ -25,11 +111,24 @@ namespace em::Audio
         {
           case wav:
             {
+                if (std::optional<WavPcm> pcm = ParseWavPcm(input))
+                {
+                    sampling_rate = pcm->sampling_rate;
+                    channel_count = pcm->channel_count;
+                    resolution = pcm->resolution;
+                    borrowed = pcm->data;
+                    file = std::move(input);
+                    CheckChannelCount();
+                    break;
+                }
+
+                // Something more exotic, let SDL convert it.
                 SDL_AudioSpec spec{};
                 std::uint8_t *bytes = nullptr;
                 std::uint32_t len = 0;
                 if (!SDL_LoadWAV_IO(SDL_IOFromConstMem(input.data(), input.size()), true, &spec, &bytes, &len))
                     throw std::runtime_error(fmt::format("Failed to parse wav file: `{}`.", input.GetName()));
+                EM_FINALLY{SDL_free(bytes);};
                 sampling_rate = spec.freq;
                 channel_count = Channels(spec.channels);
                 if (spec.format == SDL_AUDIO_U8)
@@ -45,6 +144,35 @@ namespace em::Audio
             }
             break;
           case ogg:
+            {
+                // This decodes the whole file. For long tracks, prefer `StreamingSource`.
+                int channels = 0;
+                short *samples = nullptr;
+                int num_blocks = stb_vorbis_decode_memory(input.data(), int(input.size()), &channels, &sampling_rate, &samples);
+                if (num_blocks < 0 || !samples)
+                    throw std::runtime_error(fmt::format("Failed to parse ogg file: `{}`.", input.GetName()));
+                EM_FINALLY{std::free(samples);};
+
+                if (channels != 1 && channels != 2)
+                    throw std::runtime_error(fmt::format("Failed to parse ogg file: `{}`. Expected a mono or stereo sound, but it has {} channels.", input.GetName(), channels));
+                channel_count = Channels(channels);
+
+                std::size_t num_samples = std::size_t(num_blocks) * std::size_t(channels);
+                resolution = preferred_resolution;
+                if (resolution == bits_16)
+                {
+                    const std::uint8_t *bytes = reinterpret_cast<const std::uint8_t *>(samples);
+                    data.assign(bytes, bytes + num_samples * sizeof(short));
+                }
+                else
+                {
+                    data.resize(num_samples);
+                    for (std::size_t i = 0; i < num_samples; i++)
+                        data[i] = std::uint8_t((samples[i] >> 8) + 128);
+                }
+
+                CheckChannelCount();
+            }
             break;
         }
     }
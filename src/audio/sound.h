@@ -4,10 +4,11 @@
 #include <cstddef>
 #include <cstdint>
 #include <optional>
+#include <span>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
-#include "em/macros/utils/cvref.h"
 #include "utils/filesystem.h"
 
 namespace em::Audio
@@ -46,7 +47,10 @@ namespace em::Audio
 
     class Sound
     {
+        // Either we own the data, or it points into `file` (see `borrowed`), to avoid copying the PCM of uncompressed files.
         std::vector<std::uint8_t> data;
+        Filesystem::LoadedFile file;
+        std::span<const std::uint8_t> borrowed;
 
         int sampling_rate = 0; // 0 indicates a null sound.
         Channels channel_count = mono;
@@ -80,6 +84,7 @@ namespace em::Audio
         {}
 
         // Loads a sound from a stream, according to the specified `format.
+        // Plain PCM WAV files aren't copied: the sound keeps the file alive and points into it, see `IsBorrowed()`.
         // If `expected_channel_count` is not null, will throw if the received data doesn't have the specified amount of channels.
         // `preferred_resolution` specifies the desired resolution; its effect depends on the format. (Currently it's ignored for WAV, and is used unconditionally for OGG.)
         Sound(Format format, std::optional<Channels> expected_channel_count, em::Filesystem::LoadedFile input, BitResolution preferred_resolution = bits_16);
@@ -87,7 +92,42 @@ namespace em::Audio
         // Returns true if the object holds any data.
         [[nodiscard]] explicit operator bool() const
         {
-            return !data.empty();
+            return ByteSize() != 0;
+        }
+
+        // Returns true if the data points into the loaded file, rather than owned by this object.
+        // The first non-const access to the data makes a copy.
+        [[nodiscard]] bool IsBorrowed() const
+        {
+            return !borrowed.empty();
+        }
+
+        // If the data is borrowed from the file, copies it, and releases the file.
+        void MakeOwned()
+        {
+            if (borrowed.empty())
+                return;
+            data.assign(borrowed.begin(), borrowed.end());
+            borrowed = {};
+            file = {};
+        }
+
+        // Converts the 16-bit data to 8 bits, halving the size. Does nothing if it's already 8-bit.
+        // This is audibly noisier, so it's meant for the sounds that are rarely played, or for low-memory devices.
+        void ConvertTo8Bit()
+        {
+            if (resolution == bits_8)
+                return;
+
+            const std::int16_t *samples = std::as_const(*this).Data<std::int16_t>(); // Const, to not copy the borrowed data first.
+            std::vector<std::uint8_t> new_data(BlockCount() * std::size_t(channel_count));
+            for (std::size_t i = 0; i < new_data.size(); i++)
+                new_data[i] = std::uint8_t((samples[i] >> 8) + 128); // Same as what the OGG decoder does for `bits_8`.
+
+            data = std::move(new_data);
+            borrowed = {};
+            file = {};
+            resolution = bits_8;
         }
 
         // Getters/setters for the state:
@@ -106,20 +146,25 @@ namespace em::Audio
         // No setter is provided, reassign the class to change the value.
         [[nodiscard]] BitResolution Resolution() const {return resolution;}
 
-        EM_MAYBE_CONST
-        (
-            // Get an untyped pointer to the sound data.
-            [[nodiscard]] EM_QUAL std::uint8_t *RawUntypedData() EM_QUAL {return data.data();}
+        // Get an untyped pointer to the sound data.
+        [[nodiscard]] const std::uint8_t *RawUntypedData() const {return borrowed.empty() ? data.data() : borrowed.data();}
+        // The non-const version calls `MakeOwned()` first.
+        [[nodiscard]] std::uint8_t *RawUntypedData() {MakeOwned(); return data.data();}
 
-            // Get a pointer to the sound data, converted to a specific pointer type.
-            // Triggers an assertion if the type doesn't match the `Resolution()`.
-            template <typename T> requires std::is_same_v<T, std::uint8_t> || std::is_same_v<T, std::int16_t>
-            [[nodiscard]] EM_QUAL T *Data() EM_QUAL
-            {
-                assert(sizeof(T) == BytesPerSample() && "Type mismatch.");
-                return reinterpret_cast<EM_QUAL T *>(RawUntypedData());
-            }
-        )
+        // Get a pointer to the sound data, converted to a specific pointer type.
+        // Triggers an assertion if the type doesn't match the `Resolution()`.
+        template <typename T> requires std::is_same_v<T, std::uint8_t> || std::is_same_v<T, std::int16_t>
+        [[nodiscard]] const T *Data() const
+        {
+            assert(sizeof(T) == BytesPerSample() && "Type mismatch.");
+            return reinterpret_cast<const T *>(RawUntypedData());
+        }
+        template <typename T> requires std::is_same_v<T, std::uint8_t> || std::is_same_v<T, std::int16_t>
+        [[nodiscard]] T *Data()
+        {
+            assert(sizeof(T) == BytesPerSample() && "Type mismatch.");
+            return reinterpret_cast<T *>(RawUntypedData());
+        }
 
 
         // Various information that can be computed based on the state:
@@ -138,7 +183,7 @@ namespace em::Audio
         // The data size in bytes.
         [[nodiscard]] std::size_t ByteSize() const
         {
-            return data.size();
+            return borrowed.empty() ? data.size() : borrowed.size();
         }
 
         // The amount of samples. (Corresponding samples from different channels count as one).
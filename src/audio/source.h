@@ -39,23 +39,28 @@ namespace em::Audio
         // Create a null source.
         Source() {}
 
-        Source(const Audio::Buffer &buffer)
+        // Create a source without a buffer. Attach one later with `buffer()`. This is used by `VoicePool`.
+        Source(decltype(nullptr))
         {
-            assert(buffer && "Attempt to use a null audio buffer.");
-
             // We don't throw if the handle is null. Instead, we make sure that any operation on a null handle has no effect.
             alGenSources(1, &data.handle);
 
             if (data.handle)
             {
-                alSourcei(data.handle, AL_BUFFER, ALint(buffer.Handle()));
-
                 alSourcef(data.handle, AL_REFERENCE_DISTANCE, default_ref_dist);
                 alSourcef(data.handle, AL_ROLLOFF_FACTOR,     default_rolloff_fac);
                 alSourcef(data.handle, AL_MAX_DISTANCE,       default_max_dist);
             }
         }
 
+        Source(const Audio::Buffer &buffer) : Source(nullptr)
+        {
+            assert(buffer && "Attempt to use a null audio buffer.");
+
+            if (data.handle)
+                alSourcei(data.handle, AL_BUFFER, ALint(buffer.Handle()));
+        }
+
         Source(Source &&other) noexcept : data(std::exchange(other.data, {})) {}
         Source &operator=(Source other) noexcept
         {
@@ -183,6 +188,57 @@ namespace em::Audio
         }
 
 
+        // Replace the buffer. The source must not be playing or paused, `stop()` it first.
+        Source &buffer(const Audio::Buffer &new_buffer)
+        {
+            assert(new_buffer && "Attempt to use a null audio buffer.");
+            if (data.handle)
+                alSourcei(data.handle, AL_BUFFER, ALint(new_buffer.Handle()));
+            return *this;
+        }
+
+        // Stop, and detach the buffer. AL doesn't let you change the contents of a buffer while it's attached to a source, even a stopped one.
+        Source &detach_buffer()
+        {
+            if (data.handle)
+            {
+                stop();
+                alSourcei(data.handle, AL_BUFFER, 0);
+            }
+            return *this;
+        }
+
+        // The handle of the attached buffer, or 0 if none.
+        [[nodiscard]] ALuint buffer_handle() const
+        {
+            if (!data.handle)
+                return 0;
+            ALint ret = 0;
+            alGetSourcei(data.handle, AL_BUFFER, &ret);
+            return ALuint(ret);
+        }
+
+        // Stop, and restore all parameters except the buffer to the defaults, as if the source was just created.
+        // Note that the defaults for the sound model parameters are the current ones, not the ones at the creation time.
+        Source &reset()
+        {
+            if (data.handle)
+            {
+                stop();
+                volume(1);
+                raw_pitch(1);
+                loop(false);
+                relative(false);
+                pos(fvec3());
+                vel(fvec3());
+                ref_distance(default_ref_dist);
+                rolloff_factor(default_rolloff_fac);
+                max_distance(default_max_dist);
+            }
+            return *this;
+        }
+
+
         // State control.
 
         // Start playing.
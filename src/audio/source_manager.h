@@ -1,23 +1,126 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include "audio/buffer.h"
+#include "audio/openal.h"
 #include "audio/source.h"
+#include "audio/voice_pool.h"
+#include "utils/trace.h"
 
 namespace em::Audio
 {
-    // Keeps a list of `std::shared_ptr`s to sources.
-    // Automatically releases them when they stop playing.
+    // Plays fire-and-forget sounds on a `VoicePool`, and keeps a list of `std::shared_ptr`s to other sources.
+    // Automatically releases the latter when they stop playing.
     class SourceManager
     {
+      public:
+        // Applied to `Request()`s, per buffer.
+        struct Limits
+        {
+            // At most this many voices play the same buffer at a time. More requests are dropped.
+            std::size_t max_concurrent = 4;
+            // After a buffer is played, drop the requests for it for this many `Tick()`s. Zero means that it can play again on the next `Tick()`.
+            int cooldown_ticks = 0;
+        };
+
+      private:
+        struct PendingRequest
+        {
+            const Buffer *buffer = nullptr;
+            std::optional<fvec3> pos; // Null for the listener-relative sounds.
+            float volume = 1;
+            float pitch = 0;
+        };
+
+        struct BufferState
+        {
+            ALuint buffer = 0;
+            Limits limits;
+            // The `tick_counter` when this was last played by `Tick()`.
+            std::uint64_t last_played_tick = 0;
+            bool played_at_least_once = false;
+        };
+
+        VoicePool voices;
         std::vector<std::shared_ptr<Source>> sources;
 
+        std::vector<PendingRequest> pending;
+        // Small enough for a linear search.
+        std::vector<BufferState> buffer_states;
+        Limits default_limits;
+        std::uint64_t tick_counter = 0;
+
+        // See `SetOnVoiceFinished()`.
+        std::function<void(ALuint buffer)> on_voice_finished;
+
+        [[nodiscard]] BufferState &GetBufferState(const Buffer &buffer)
+        {
+            for (BufferState &state : buffer_states)
+            {
+                if (state.buffer == buffer.Handle())
+                    return state;
+            }
+            return buffer_states.emplace_back(BufferState{.buffer = buffer.Handle(), .limits = default_limits});
+        }
+
+        void QueueRequest(const Buffer &buffer, std::optional<fvec3> pos, float volume, float pitch)
+        {
+            // Coalesce the identical requests, keeping the loudest one.
+            for (PendingRequest &request : pending)
+            {
+                if (request.buffer->Handle() == buffer.Handle() && request.pos == pos)
+                {
+                    request.volume = std::max(request.volume, volume);
+                    return;
+                }
+            }
+            pending.push_back({.buffer = &buffer, .pos = pos, .volume = volume, .pitch = pitch});
+        }
+
       public:
         SourceManager() {}
 
+        // Creates the voices for `Play()`. Call this after creating the context. Until then, `Play()` does nothing.
+        void CreateVoices(std::size_t num_voices)
+        {
+            voices = VoicePool(num_voices);
+            voices.SetOnFinished(on_voice_finished);
+        }
+
+        // Destroys all sources. Call this before destroying the context.
+        void Reset()
+        {
+            voices = {};
+            sources.clear();
+            pending.clear();
+            buffer_states.clear();
+        }
+
+        // Called with the buffer of each pooled voice that stops playing, see `VoicePool::SetOnFinished()`. `Tick()` checks for that.
+        void SetOnVoiceFinished(std::function<void(ALuint buffer)> func)
+        {
+            on_voice_finished = std::move(func);
+            voices.SetOnFinished(on_voice_finished);
+        }
+
+        // The limits for the buffers that don't have their own `SetLimits()`. Only affects the buffers that weren't requested yet.
+        void SetDefaultLimits(Limits limits)
+        {
+            default_limits = limits;
+        }
+        // The limits for a specific buffer.
+        void SetLimits(const Buffer &buffer, Limits limits)
+        {
+            GetBufferState(buffer).limits = limits;
+        }
+
         // Add a new source to the manager.
         // It should be `play()`ed immediately, otherwise it will be removed at the next `Tick()`.
         void Add(std::shared_ptr<Source> source)
@@ -33,36 +136,88 @@ namespace em::Audio
             return sources.emplace_back(std::make_shared<Source>(buffer));
         }
 
-        // Add a new source and play it immediately.
-        std::shared_ptr<Source> Play(const Buffer &buffer, fvec3 pos, float volume = 1, float pitch = 0)
+        // Play a sound on a pooled voice. This doesn't allocate. If all voices are busy, the quietest one is stolen, see `VoicePool::Acquire()`.
+        // The returned source can be reused by any later `Play()`, so only change it immediately if at all.
+        Source &Play(const Buffer &buffer, fvec3 pos, float volume = 1, float pitch = 0)
+        {
+            return voices.Acquire(buffer, volume).pos(pos).volume(volume).pitch(pitch).play();
+        }
+        Source &Play(const Buffer &buffer, fvec2 pos, float volume = 1, float pitch = 0)
+        {
+            return voices.Acquire(buffer, volume).pos(pos).volume(volume).pitch(pitch).play();
+        }
+        Source &Play(const Buffer &buffer, float volume = 1, float pitch = 0)
+        {
+            return voices.Acquire(buffer, volume).relative().volume(volume).pitch(pitch).play();
+        }
+
+        // Like `Play()`, but the sound is queued until the next `Tick()`. The identical requests (same buffer and position) until then are merged into one,
+        //   and the requests are dropped if they exceed the `Limits` of the buffer. Prefer this for the sounds triggered by the gameplay events.
+        // The buffer must stay alive until the next `Tick()`.
+        void Request(const Buffer &buffer, fvec3 pos, float volume = 1, float pitch = 0)
         {
-            std::shared_ptr<Source> ret = Add(buffer);
-            ret->pos(pos).volume(volume).pitch(pitch).play();
-            return ret;
+            QueueRequest(buffer, pos, volume, pitch);
         }
-        std::shared_ptr<Source> Play(const Buffer &buffer, fvec2 pos, float volume = 1, float pitch = 0)
+        void Request(const Buffer &buffer, fvec2 pos, float volume = 1, float pitch = 0)
         {
-            std::shared_ptr<Source> ret = Add(buffer);
-            ret->pos(pos).volume(volume).pitch(pitch).play();
-            return ret;
+            QueueRequest(buffer, pos.to_vec3(), volume, pitch);
         }
-        std::shared_ptr<Source> Play(const Buffer &buffer, float volume = 1, float pitch = 0)
+        void Request(const Buffer &buffer, float volume = 1, float pitch = 0)
         {
-            std::shared_ptr<Source> ret = Add(buffer);
-            ret->relative().volume(volume).pitch(pitch).play();
-            return ret;
+            QueueRequest(buffer, std::nullopt, volume, pitch);
         }
 
-        // Releases sources that aren't playing (i.e. are stopped, paused, or not played yet).
-        // Call this at the end of every tick.
+        // Plays the queued `Request()`s, and releases sources from `Add()` that aren't playing (i.e. are stopped, paused, or not played yet).
+        // Also reports the finished voices, see `SetOnVoiceFinished()`. Call this once per frame, or once per iteration of `AudioThread`.
         void Tick()
         {
+            EM_TRACE_ZONE("Audio::SourceManager::Tick");
+
+            tick_counter++;
+
+            for (const PendingRequest &request : pending)
+            {
+                if (!*request.buffer)
+                    continue; // Not loaded yet.
+
+                BufferState &state = GetBufferState(*request.buffer);
+                if (state.played_at_least_once && tick_counter - state.last_played_tick <= std::uint64_t(state.limits.cooldown_ticks))
+                    continue;
+                if (voices.NumPlaying(*request.buffer) >= state.limits.max_concurrent)
+                    continue;
+
+                state.last_played_tick = tick_counter;
+                state.played_at_least_once = true;
+                if (request.pos)
+                    Play(*request.buffer, *request.pos, request.volume, request.pitch);
+                else
+                    Play(*request.buffer, request.volume, request.pitch);
+            }
+            pending.clear();
+
+            voices.PollFinished();
+
             std::erase_if(sources, [](const std::shared_ptr<Source> &ptr){return !ptr->IsPlaying();});
         }
 
+        // Stops everything that plays `buffer` (both the voices and the sources from `Add()`), and detaches it, so that its contents can be replaced.
+        // The sources from `Add()` are then released by the next `Tick()`, since they're no longer playing.
+        void DetachBuffer(const Buffer &buffer)
+        {
+            if (!buffer)
+                return;
+            voices.Detach(buffer);
+            for (const std::shared_ptr<Source> &source : sources)
+            {
+                if (source->buffer_handle() == buffer.Handle())
+                    source->detach_buffer();
+            }
+        }
+
+        // The sources from `Add()` plus the busy voices.
         [[nodiscard]] std::size_t ActiveSources() const
         {
-            return sources.size();
+            return sources.size() + voices.NumActiveVoices();
         }
     };
 }
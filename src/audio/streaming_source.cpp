@@ -0,0 +1,193 @@
+#include "streaming_source.h"
+
+#define STB_VORBIS_HEADER_ONLY
+#include <stb_vorbis.c>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace em::Audio
+{
+    StreamingSource::StreamingSource(Filesystem::LoadedFile new_file, std::optional<Channels> expected_channel_count, Params new_params)
+        : params(new_params), file(std::move(new_file))
+    {
+        if (params.num_buffers == 0 || params.chunk_blocks == 0)
+            throw std::runtime_error("Invalid streaming source parameters.");
+
+        int error = 0;
+        decoder = stb_vorbis_open_memory(file.data(), int(file.size()), &error, nullptr);
+        if (!decoder)
+            throw std::runtime_error(fmt::format("Failed to parse ogg file: `{}`.", file.GetName()));
+
+        stb_vorbis_info info = stb_vorbis_get_info(decoder);
+        sampling_rate = int(info.sample_rate);
+        if (info.channels != 1 && info.channels != 2)
+        {
+            stb_vorbis_close(decoder);
+            throw std::runtime_error(fmt::format("Failed to parse ogg file: `{}`. Expected a mono or stereo sound, but it has {} channels.", file.GetName(), info.channels));
+        }
+        channel_count = Channels(info.channels);
+        if (expected_channel_count && *expected_channel_count != channel_count)
+        {
+            stb_vorbis_close(decoder);
+            throw std::runtime_error(fmt::format("Expected a {} sound, but got {}.",
+                (*expected_channel_count == mono ? "mono" : "stereo"), (channel_count == mono ? "mono" : "stereo")));
+        }
+
+        source = Source(nullptr);
+
+        buffers.reserve(params.num_buffers);
+        for (std::size_t i = 0; i < params.num_buffers; i++)
+            free_buffers.push_back(buffers.emplace_back(nullptr).Handle());
+
+        // Twice as many chunks as buffers, so the decoder can run ahead while all buffers are queued.
+        chunks.resize(params.num_buffers * 2);
+        for (Chunk &chunk : chunks)
+            chunk.samples.resize(params.chunk_blocks * std::size_t(channel_count));
+
+        thread = std::jthread([this]{ThreadFunc();});
+    }
+
+    StreamingSource::~StreamingSource()
+    {
+        {
+            std::scoped_lock lock(mutex);
+            stopping = true;
+        }
+        cond.notify_all();
+        thread = {}; // Join before closing the decoder, and before the buffers are destroyed.
+
+        // The buffers must be detached before they can be deleted.
+        source.stop();
+        if (source)
+            alSourcei(source.Handle(), AL_BUFFER, 0);
+
+        stb_vorbis_close(decoder);
+    }
+
+    void StreamingSource::ThreadFunc()
+    {
+        while (true)
+        {
+            std::size_t index = 0;
+            {
+                std::unique_lock lock(mutex);
+                cond.wait(lock, [&]{return stopping || num_ready < chunks.size();});
+                if (stopping)
+                    return;
+                index = (ready_begin + num_ready) % chunks.size();
+            }
+
+            Chunk &chunk = chunks[index];
+            chunk.num_blocks = 0;
+            bool at_end = false;
+            bool just_rewound = false;
+            while (chunk.num_blocks < params.chunk_blocks)
+            {
+                int n = stb_vorbis_get_samples_short_interleaved(decoder, int(channel_count),
+                    chunk.samples.data() + chunk.num_blocks * std::size_t(channel_count), int((params.chunk_blocks - chunk.num_blocks) * std::size_t(channel_count)));
+                if (n > 0)
+                {
+                    chunk.num_blocks += std::size_t(n);
+                    just_rewound = false;
+                    continue;
+                }
+
+                // The end of the file, or a decoding error. If we get nothing right after rewinding, the file is broken, and looping would hang.
+                if (!params.loop || just_rewound || !stb_vorbis_seek_start(decoder))
+                {
+                    at_end = true;
+                    break;
+                }
+                just_rewound = true;
+            }
+
+            std::scoped_lock lock(mutex);
+            if (chunk.num_blocks > 0)
+                num_ready++;
+            if (at_end)
+            {
+                decoder_finished = true;
+                return;
+            }
+        }
+    }
+
+    void StreamingSource::Play()
+    {
+        want_playing = true;
+        Tick();
+    }
+
+    void StreamingSource::Pause()
+    {
+        want_playing = false;
+        source.pause();
+    }
+
+    void StreamingSource::Tick()
+    {
+        if (!source)
+            return;
+
+        { // Recycle the played buffers.
+            ALint num_processed = 0;
+            alGetSourcei(source.Handle(), AL_BUFFERS_PROCESSED, &num_processed);
+            while (num_processed-- > 0)
+            {
+                ALuint handle = 0;
+                alSourceUnqueueBuffers(source.Handle(), 1, &handle);
+                free_buffers.push_back(handle);
+            }
+        }
+
+        { // Queue the decoded chunks.
+            bool consumed_any = false;
+            while (!free_buffers.empty())
+            {
+                std::size_t index = 0;
+                {
+                    std::scoped_lock lock(mutex);
+                    if (num_ready == 0)
+                        break;
+                    index = ready_begin;
+                }
+
+                ALuint handle = free_buffers.back();
+                free_buffers.pop_back();
+
+                Buffer &buffer = *std::find_if(buffers.begin(), buffers.end(), [&](const Buffer &b){return b.Handle() == handle;});
+                const Chunk &chunk = chunks[index];
+                buffer.SetData(sampling_rate, channel_count, bits_16, chunk.num_blocks, reinterpret_cast<const std::uint8_t *>(chunk.samples.data()));
+                alSourceQueueBuffers(source.Handle(), 1, &handle);
+
+                std::scoped_lock lock(mutex);
+                ready_begin = (ready_begin + 1) % chunks.size();
+                num_ready--;
+                consumed_any = true;
+            }
+            if (consumed_any)
+                cond.notify_one();
+        }
+
+        bool queue_empty = free_buffers.size() == buffers.size();
+
+        if (want_playing && !queue_empty && source.GetState() != SourceState::playing)
+        {
+            // Either starting, or the decoder fell behind and the source ran dry.
+            source.play();
+        }
+
+        if (want_playing && queue_empty)
+        {
+            std::scoped_lock lock(mutex);
+            if (decoder_finished && num_ready == 0)
+            {
+                want_playing = false;
+                finished = true;
+            }
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "audio/buffer.h"
+#include "audio/openal.h"
+#include "audio/source.h"
+#include "utils/filesystem.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+struct stb_vorbis;
+
+namespace em::Audio
+{
+    // Plays an OGG/Vorbis file without decoding it fully, for music and ambience.
+    // A background thread decodes it in chunks into a small ring, and `Tick()` feeds those to a few AL buffers queued on one source.
+    // The resident memory is the compressed file, plus `num_buffers * 2` chunks of PCM.
+    class StreamingSource
+    {
+      public:
+        struct Params
+        {
+            // Restart from the beginning at the end of the file.
+            bool loop = false;
+            // The chunk length, in blocks (samples per channel). The default is ~0.2 seconds at 44.1 kHz.
+            std::size_t chunk_blocks = 8192;
+            // How many AL buffers to queue. The decoder runs ahead by the same amount of chunks.
+            std::size_t num_buffers = 4;
+        };
+
+      private:
+        struct Chunk
+        {
+            std::vector<std::int16_t> samples;
+            std::size_t num_blocks = 0;
+        };
+
+        Params params;
+        Filesystem::LoadedFile file;
+        stb_vorbis *decoder = nullptr;
+        int sampling_rate = 0;
+        Channels channel_count = mono;
+
+        Source source;
+        std::vector<Buffer> buffers;
+        // The handles of `buffers` that aren't queued. Only touched by `Tick()`.
+        std::vector<ALuint> free_buffers;
+        bool want_playing = false;
+        bool finished = false;
+
+        // The ring of decoded chunks. The decoder thread appends at `ready_begin + num_ready`, `Tick()` consumes from `ready_begin`.
+        // They never touch the same chunk, so only the indices need the mutex.
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::vector<Chunk> chunks;
+        std::size_t ready_begin = 0;
+        std::size_t num_ready = 0;
+        bool decoder_finished = false;
+        bool stopping = false;
+
+        // This must be last, to be destroyed (joined) first, while the rest is still alive.
+        std::jthread thread;
+
+        void ThreadFunc();
+
+      public:
+        // Throws if the file isn't a valid OGG/Vorbis file. If `expected_channel_count` isn't null, also throws if it doesn't match.
+        StreamingSource(Filesystem::LoadedFile file, std::optional<Channels> expected_channel_count = {}, Params params = {});
+
+        // Not movable, the thread refers to `this`.
+        StreamingSource(const StreamingSource &) = delete;
+        StreamingSource &operator=(const StreamingSource &) = delete;
+        ~StreamingSource();
+
+        // Use this to set the volume, the position and such. Don't change the buffer and the looping, and don't start or stop it directly.
+        [[nodiscard]] Source &GetSource() {return source;}
+
+        [[nodiscard]] int SamplingRate() const {return sampling_rate;}
+        [[nodiscard]] Channels ChannelCount() const {return channel_count;}
+
+        // Starts or resumes the playback. It actually starts at the next `Tick()` that has a decoded chunk.
+        void Play();
+        // Pauses the playback. `Play()` resumes from the same position.
+        void Pause();
+
+        // Call this regularly (e.g. once per frame) on the thread that owns the audio context.
+        // Recycles the played buffers, and restarts the source if it ran dry because the decoder fell behind.
+        void Tick();
+
+        // True when a non-looping stream played to the end.
+        [[nodiscard]] bool IsFinished() const {return finished;}
+    };
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "audio/buffer.h"
+#include "audio/openal.h"
+#include "audio/source.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace em::Audio
+{
+    // A fixed set of sources, reused for the fire-and-forget sounds. See `SourceManager::Play()`.
+    // Creating and deleting AL sources for every sound is slow on some OpenAL builds, and can cause audible hitches.
+    // Create this after the context, and destroy it before the context.
+    class VoicePool
+    {
+        struct Voice
+        {
+            Source source;
+            // The buffer passed to `Acquire()`.
+            ALuint buffer = 0;
+            // The volume passed to `Acquire()`. Quieter voices are stolen first.
+            float volume = 0;
+            // When `Acquire()` returned this voice, for stealing the oldest one among the equally quiet ones.
+            std::uint64_t start_counter = 0;
+            // Set by `Acquire()`, and cleared when `on_finished` is called for this voice.
+            bool started = false;
+        };
+        std::vector<Voice> voices;
+        std::uint64_t counter = 0;
+
+        // See `SetOnFinished()`.
+        std::function<void(ALuint buffer)> on_finished;
+
+        void Finish(Voice &voice)
+        {
+            if (!voice.started)
+                return;
+            voice.started = false;
+            if (on_finished)
+                on_finished(voice.buffer);
+        }
+
+        // Returned when there are no voices.
+        Source null_source;
+
+      public:
+        VoicePool() {}
+
+        // Creates `num_voices` sources. If the implementation can't create that many, we silently get fewer.
+        VoicePool(std::size_t num_voices)
+        {
+            voices.reserve(num_voices);
+            for (std::size_t i = 0; i < num_voices; i++)
+            {
+                if (Source source(nullptr); source)
+                    voices.push_back({.source = std::move(source)});
+            }
+        }
+
+        // Called with the buffer of each voice that stops playing: when `PollFinished()` notices it, or when the voice is stolen or detached.
+        void SetOnFinished(std::function<void(ALuint buffer)> func)
+        {
+            on_finished = std::move(func);
+        }
+
+        [[nodiscard]] std::size_t NumVoices() const
+        {
+            return voices.size();
+        }
+
+        [[nodiscard]] std::size_t NumActiveVoices() const
+        {
+            std::size_t ret = 0;
+            for (const Voice &voice : voices)
+            {
+                SourceState state = voice.source.GetState();
+                ret += state == SourceState::playing || state == SourceState::paused;
+            }
+            return ret;
+        }
+
+        // Returns a stopped source with default parameters and the specified buffer. Play it immediately, otherwise it can be reused at any point.
+        // If all voices are busy, steals the quietest one (and the oldest among those). `volume` is what you're going to play this at, to rank it for stealing.
+        // The reference stays valid as long as the pool exists, but the voice can be reused by the next call.
+        // This doesn't allocate. If there are no voices, or the buffer is null (e.g. not loaded yet, see `GlobalData::AsyncLoader`), returns a null source.
+        [[nodiscard]] Source &Acquire(const Buffer &buffer, float volume)
+        {
+            if (voices.empty() || !buffer)
+                return null_source;
+
+            Voice *target = nullptr;
+            for (Voice &voice : voices)
+            {
+                SourceState state = voice.source.GetState();
+                if (state == SourceState::initial || state == SourceState::stopped)
+                {
+                    target = &voice;
+                    break;
+                }
+
+                if (!target || voice.volume < target->volume || (voice.volume == target->volume && voice.start_counter < target->start_counter))
+                    target = &voice;
+            }
+
+            Finish(*target); // If it's stolen.
+            target->buffer = buffer.Handle();
+            target->volume = volume;
+            target->start_counter = counter++;
+            target->started = true;
+            target->source.reset().buffer(buffer);
+            return target->source;
+        }
+
+        // How many voices are playing `buffer`.
+        [[nodiscard]] std::size_t NumPlaying(const Buffer &buffer) const
+        {
+            std::size_t ret = 0;
+            for (const Voice &voice : voices)
+                ret += voice.buffer == buffer.Handle() && voice.source.IsPlaying();
+            return ret;
+        }
+
+        // Stops the voices playing `buffer`, and detaches it from them. See `Source::detach_buffer()`.
+        void Detach(const Buffer &buffer)
+        {
+            for (Voice &voice : voices)
+            {
+                if (voice.buffer == buffer.Handle())
+                {
+                    Finish(voice);
+                    voice.source.detach_buffer();
+                    voice.buffer = 0;
+                }
+            }
+        }
+
+        // Calls `on_finished` for the voices that stopped playing on their own since the last call. Paused voices don't count as stopped.
+        void PollFinished()
+        {
+            for (Voice &voice : voices)
+            {
+                if (!voice.started)
+                    continue;
+                SourceState state = voice.source.GetState();
+                if (state != SourceState::playing && state != SourceState::paused)
+                    Finish(voice);
+            }
+        }
+
+        // Stops all voices.
+        void StopAll()
+        {
+            for (Voice &voice : voices)
+                voice.source.stop();
+        }
+    };
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+// The pre-baked image format that `LoadImage()` reads. The build converts `assets/images/*.png` to it using `tools/bake_image`.
+// A file is this header followed by `width * height` tightly packed RGBA8 pixels, top to bottom, in the same layout as the GPU texture.
+// This way we can memory-map the file and copy the pixels straight into a transfer buffer, without decoding anything.
+// All integers are little-endian, since that's what every platform we target uses.
+// This is deliberately free of dependencies, because the baking tool uses it too.
+struct BakedImageHeader
+{
+    // Bump `current_version` when changing the layout.
+    static constexpr char expected_magic[4] = {'F', 'I', 'M', 'G'};
+    static constexpr std::uint32_t current_version = 1;
+
+    char magic[4]{};
+    std::uint32_t version = 0;
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+
+    [[nodiscard]] bool IsValid() const
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            if (magic[i] != expected_magic[i])
+                return false;
+        }
+        return version == current_version;
+    }
+
+    // The size of the pixel data following the header.
+    [[nodiscard]] std::uint64_t PixelDataSize() const
+    {
+        return std::uint64_t(width) * height * 4;
+    }
+};
+static_assert(sizeof(BakedImageHeader) == 16);
@@ -0,0 +1,117 @@
+#include "batch_sim.h"
+
+#include "game/clock.h"
+#include "game/main.h"
+#include "mainloop/job_system.h"
+#include "utils/fast_rng.h"
+
+#include <fmt/format.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+
+void BatchSim::Add(World world, InputSource input)
+{
+    world.sounds = false;
+    entries.push_back({.world = std::move(world), .input = std::move(input)});
+}
+
+void BatchSim::Run(App::JobSystem &jobs, std::uint64_t num_ticks)
+{
+    jobs.ParallelFor(entries.size(), [&](std::size_t i)
+    {
+        Entry &entry = entries[i];
+        for (std::uint64_t t = 0; t < num_ticks; t++)
+        {
+            entry.world.Tick(entry.input(entry.world, entry.num_ticks));
+            entry.num_ticks++;
+        }
+    });
+}
+
+BatchSim::InputSource RandomInputSource(std::uint64_t seed)
+{
+    // The state is captured by the lambda, so each source is independent. `FastRng` gives the same inputs on every platform.
+    return [rng = FastRng(seed), input = World::Input{}, ticks_left = 0](const World &world, std::uint64_t tick) mutable
+    {
+        (void)world;
+        (void)tick;
+
+        if (ticks_left-- <= 0)
+        {
+            // Hold this for up to a second.
+            ticks_left = rng.Int(1, 60);
+
+            // Those probabilities are arbitrary, tuned so that the frames get dragged around and the player gets to move.
+            input.mouse_down = rng.Chance(0.4f);
+            input.left = rng.Chance(0.3f);
+            input.right = !input.left && rng.Chance(0.4f);
+            input.jump = rng.Chance(0.3f);
+            input.reset = rng.Chance(0.01f);
+        }
+
+        // The mouse wanders around the screen.
+        input.mouse_pos = ivec2(
+            std::clamp(input.mouse_pos.x + rng.Int(-4, 4), -screen_size.x / 2, screen_size.x / 2 - 1),
+            std::clamp(input.mouse_pos.y + rng.Int(-4, 4), -screen_size.y / 2, screen_size.y / 2 - 1)
+        );
+
+        return input;
+    };
+}
+
+namespace
+{
+    struct BatchApp : App::Module
+    {
+        std::size_t num_worlds = 0;
+
+        App::JobSystem jobs = App::JobSystem(App::JobSystem::Params{});
+
+        BatchApp(std::size_t num_worlds) : num_worlds(num_worlds) {}
+
+        [[nodiscard]] static std::uint64_t NumTicks()
+        {
+            if (const char *env = SDL_getenv("FRAMES_BATCH_TICKS"))
+                return std::uint64_t(std::max(1ll, std::atoll(env)));
+            return 60 * 60 * 10; // Ten minutes of gameplay.
+        }
+
+        App::Action Tick() override
+        {
+            const std::uint64_t num_ticks = NumTicks();
+
+            BatchSim sim;
+            for (std::size_t i = 0; i < num_worlds; i++)
+            {
+                World world;
+                world.SeedRandom(i);
+                world.LoadLevel(i % World::NumLevels());
+                sim.Add(std::move(world), RandomInputSource(i));
+            }
+
+            // `ParallelFor()` also uses the calling thread.
+            const std::size_t num_threads = jobs.NumThreads() + 1;
+
+            fmt::print("Simulating {} worlds for {} ticks each, on {} threads.\n", num_worlds, num_ticks, num_threads);
+
+            std::uint64_t start = Clock::Time();
+            sim.Run(jobs, num_ticks);
+            double secs = Clock::TicksToSeconds(Clock::Time() - start);
+
+            double total_ticks = double(num_ticks) * double(num_worlds);
+            fmt::print("Simulated {:.0f} ticks in {:.3f} s: {:.0f} ticks per second, {:.0f} per thread.\n", total_ticks, secs, total_ticks / secs, total_ticks / secs / double(num_threads));
+
+            std::fflush(stdout);
+            return App::Action::exit_success;
+        }
+    };
+}
+
+std::unique_ptr<App::Module> MakeBatchApp(std::size_t num_worlds)
+{
+    return std::make_unique<BatchApp>(num_worlds);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "game/world.h"
+#include "mainloop/module.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace em::App
+{
+    class JobSystem;
+}
+
+using namespace em;
+
+// Steps many independent worlds in parallel, without rendering or sounds. This is for fuzzing the levels and for automated playtesting.
+// The worlds don't share any mutable state, so each one is simply stepped by one thread at a time.
+class BatchSim
+{
+  public:
+    // Produces the input for the next tick of a world. This is only called from the thread that is stepping that world,
+    //   so it can keep its own state without locking.
+    using InputSource = std::function<World::Input(const World &world, std::uint64_t tick)>;
+
+    struct Entry
+    {
+        World world;
+        InputSource input;
+        // How many ticks this world has simulated so far.
+        std::uint64_t num_ticks = 0;
+    };
+    std::vector<Entry> entries;
+
+    BatchSim() {}
+
+    // Adds a world. This disables its sounds.
+    void Add(World world, InputSource input);
+
+    // Steps every world by `num_ticks` ticks, and waits for that to finish.
+    void Run(App::JobSystem &jobs, std::uint64_t num_ticks);
+};
+
+// An input source that holds random buttons for random durations and drags the mouse around, for fuzzing.
+[[nodiscard]] BatchSim::InputSource RandomInputSource(std::uint64_t seed);
+
+// Creates an app that runs `num_worlds` worlds with random inputs, prints the throughput, and exits.
+// The number of ticks per world can be set with the `FRAMES_BATCH_TICKS` environment variable.
+[[nodiscard]] std::unique_ptr<App::Module> MakeBatchApp(std::size_t num_worlds);
@@ -0,0 +1,107 @@
+#include "bench.h"
+
+#include "em/macros/utils/finally.h"
+#include "em/refl/macros/structs.h"
+#include "game/clock.h"
+#include "game/main.h"
+#include "game/renderer.h"
+#include "game/timings.h"
+#include "game/world.h"
+#include "gpu/command_buffer.h"
+#include "gpu/device.h"
+#include "gpu/fence_pool.h"
+#include "mainloop/job_system.h"
+#include "mainloop/reflected_app.h"
+#include "window/sdl.h"
+
+#include <fmt/format.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+using namespace em;
+
+namespace
+{
+    struct BenchApp : App::Module
+    {
+        EM_REFL(
+            (Sdl)(sdl, AppMetadata{
+                .name = "Frames benchmark",
+            })
+            // For compiling the pipelines, see `Renderer`.
+            (App::JobSystem)(jobs, App::JobSystem::Params{})
+            (Gpu::Device)(device, Gpu::Device::Params{})
+        )
+
+        // No window, so we pick the format ourselves.
+        Renderer renderer = Renderer(device, jobs, SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM);
+
+        World world;
+
+        // How many frames can be in flight at once. Without a swapchain nothing else limits this,
+        //   and the render queue would keep adding upload buffers if we let the CPU run ahead indefinitely.
+        static constexpr std::size_t max_frames_in_flight = 3;
+
+        [[nodiscard]] static int NumFramesPerLevel()
+        {
+            if (const char *env = SDL_getenv("FRAMES_BENCH_FRAMES"))
+                return std::max(1, std::atoi(env));
+            return 1000;
+        }
+
+        App::Action Tick() override
+        {
+            const int num_frames = NumFramesPerLevel();
+
+            fmt::print("Rendering {} frames per level at {}x{}.\n", num_frames, screen_size.x, screen_size.y);
+
+            for (std::size_t level = 0; level < World::NumLevels(); level++)
+            {
+                world.LoadLevel(level);
+
+                Timings timings;
+
+                std::uint64_t level_start = Clock::Time();
+
+                for (int i = 0; i < num_frames; i++)
+                {
+                    std::uint64_t frame_start = Clock::Time();
+
+                    {
+                        Gpu::CommandBuffer cmdbuf(device, &renderer.BeginFrame());
+                        EM_FINALLY{ renderer.EndFrame(); };
+                        renderer.Render(cmdbuf, world, timings);
+                    }
+                    renderer.texture_pool.EndFrame();
+                    renderer.upload_arena.EndFrame();
+
+                    // The frame's fence is in the renderer's pool, along with the older frames that weren't retired yet.
+                    while (renderer.frame_fences.NumPending() > max_frames_in_flight)
+                        renderer.frame_fences.WaitAny();
+
+                    timings[TimingZone::cpu_frame].Add(Clock::TicksToSeconds(Clock::Time() - frame_start));
+                }
+
+                renderer.frame_fences.WaitAll();
+
+                double total_secs = Clock::TicksToSeconds(Clock::Time() - level_start);
+
+                fmt::print("\nLevel {}: {:.1f} fps ({:.3f} ms per frame, including the GPU)\n{}", level + 1, num_frames / total_secs, total_secs * 1000 / num_frames, timings.Report());
+            }
+
+            std::fflush(stdout);
+            return App::Action::exit_success;
+        }
+    };
+}
+
+std::unique_ptr<App::Module> MakeBenchApp()
+{
+    return std::make_unique<App::ReflectedApp<BenchApp>>();
+}
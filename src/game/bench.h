@@ -0,0 +1,9 @@
+#pragma once
+
+#include "mainloop/module.h"
+
+#include <memory>
+
+// Creates the headless rendering benchmark. It renders every level offscreen as fast as possible, prints the results, and exits.
+// The number of frames per level can be set with the `FRAMES_BENCH_FRAMES` environment variable.
+[[nodiscard]] std::unique_ptr<em::App::Module> MakeBenchApp();
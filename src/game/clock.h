@@ -1,7 +1,9 @@
 #pragma once
 
+#include <SDL3/SDL_atomic.h>
 #include <SDL3/SDL_timer.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 
@@ -32,6 +34,65 @@ namespace Clock
         SDL_Delay(std::uint32_t(secs * 1000));
     }
 
+    // Paces the frames to a fixed length, more precisely than `WaitSeconds()`.
+    // Sleeps until shortly before the deadline, then spins on `Time()` for the rest. How early to wake up is calibrated from how much the sleeps overshoot.
+    // The deadlines follow a fixed schedule, so the rounding errors don't accumulate. If we fall behind by more than a frame, the schedule restarts from now.
+    class FramePacer
+    {
+        // Zero before the first `Wait()`.
+        std::uint64_t deadline = 0;
+        std::uint64_t last_wakeup = 0;
+
+        // How early to stop sleeping, in clock ticks. Grows immediately when a sleep overshoots more than this, and shrinks slowly back otherwise.
+        std::uint64_t sleep_margin = 0;
+
+      public:
+        FramePacer() {} // Don't call `Wait()` before SDL initialization.
+
+        // Call this at the end of each frame. Waits until `frame_len` seconds have passed since the previous deadline.
+        // Returns the achieved frame length in seconds (the time since the previous call returned), or zero on the first call.
+        double Wait(double frame_len)
+        {
+            const std::uint64_t len = SecondsToTicks(frame_len);
+            const std::uint64_t min_margin = SecondsToTicks(0.0002), max_margin = SecondsToTicks(0.004);
+            if (sleep_margin == 0)
+                sleep_margin = SecondsToTicks(0.001);
+
+            std::uint64_t now = Time();
+            if (deadline == 0 || now > deadline + len)
+                deadline = now;
+            deadline += len;
+
+            if (now + sleep_margin < deadline)
+            {
+                std::uint64_t wanted_wakeup = deadline - sleep_margin;
+                SDL_DelayNS(std::uint64_t(TicksToSeconds(wanted_wakeup - now) * 1e9));
+
+                now = Time();
+                std::uint64_t oversleep = now > wanted_wakeup ? now - wanted_wakeup : 0;
+                if (oversleep > sleep_margin)
+                    sleep_margin = oversleep;
+                else
+                    sleep_margin -= (sleep_margin - oversleep) / 64;
+                sleep_margin = std::clamp(sleep_margin, min_margin, max_margin);
+            }
+
+            while (Time() < deadline)
+                SDL_CPUPauseInstruction();
+
+            now = Time();
+            double ret = last_wakeup == 0 ? 0 : TicksToSeconds(now - last_wakeup);
+            last_wakeup = now;
+            return ret;
+        }
+
+        // The current sleep margin, in seconds.
+        [[nodiscard]] double SleepMargin() const
+        {
+            return TicksToSeconds(sleep_margin);
+        }
+    };
+
     class DeltaTimer
     {
         std::uint64_t time = 0;
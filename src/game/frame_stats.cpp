@@ -0,0 +1,101 @@
+#include "frame_stats.h"
+
+#include "game/main.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <string>
+
+float FrameStats::Percentile(double fraction) const
+{
+    if (samples.empty())
+        return 0;
+    scratch.clear();
+    for (const Sample &sample : samples)
+        scratch.push_back(sample.frame_ms);
+    auto it = scratch.begin() + std::ptrdiff_t(std::clamp(fraction, 0., 1.) * double(scratch.size() - 1) + 0.5);
+    std::nth_element(scratch.begin(), it, scratch.end());
+    return *it;
+}
+
+std::size_t FrameStats::NumLagFrames() const
+{
+    return std::size_t(std::count_if(samples.begin(), samples.end(), [](const Sample &sample){return sample.lag;}));
+}
+
+void FrameStats::Draw(ivec2 pos, float budget_ms, std::uint64_t gpu_live_bytes) const
+{
+    static constexpr int width = 160;
+    static constexpr int graph_height = 32; // One pixel per millisecond.
+    static constexpr int histogram_height = 24;
+    static constexpr int num_buckets = 40; // One per millisecond, the last one also has everything longer.
+    static constexpr int bucket_width = width / num_buckets;
+    static constexpr ivec2 glyph_size(8, 16); // The digits in the main atlas.
+
+    DrawRect(pos - 2, ivec2(width, graph_height + 2 + histogram_height) + 4, fvec4(0, 0, 0, 0.6f));
+
+    auto BarHeight = [](float ms){return std::clamp(int(std::round(ms)), 0, graph_height);};
+
+    // The timeline, the newest frame on the right.
+    std::size_t num_shown = std::min(samples.size(), std::size_t(width));
+    for (std::size_t i = 0; i < num_shown; i++)
+    {
+        const Sample &sample = (*this)[samples.size() - num_shown + i];
+        ivec2 bar_pos(pos.x + width - int(num_shown) + int(i), pos.y + graph_height);
+
+        fvec4 color = sample.lag ? fvec4(1, 0.2f, 0.2f, 1) : sample.num_ticks > 1 ? fvec4(1, 0.9f, 0.2f, 1) : fvec4(0.3f, 0.9f, 0.4f, 1);
+        int h = BarHeight(sample.frame_ms);
+        int wait_h = std::min(h, BarHeight(sample.swapchain_wait_ms));
+        DrawRect(bar_pos - ivec2(0, h), ivec2(1, h - wait_h), color);
+        DrawRect(bar_pos - ivec2(0, wait_h), ivec2(1, wait_h), color * fvec4(0.4f, 0.4f, 0.4f, 1));
+
+        if (sample.num_gpu_resources_created > 0)
+            DrawRect(ivec2(bar_pos.x, pos.y - 2), ivec2(1), fvec4(1, 0.3f, 1, 1));
+    }
+    DrawRect(ivec2(pos.x, pos.y + graph_height - BarHeight(budget_ms)), ivec2(width, 1), fvec4(1, 1, 1, 0.5f));
+
+    // The histogram, normalized to the tallest bucket.
+    std::array<int, num_buckets> buckets{};
+    for (const Sample &sample : samples)
+        buckets[std::size_t(std::clamp(int(sample.frame_ms), 0, num_buckets - 1))]++;
+    int max_count = std::max(1, *std::max_element(buckets.begin(), buckets.end()));
+
+    ivec2 histogram_pos(pos.x, pos.y + graph_height + 2 + histogram_height);
+    for (int i = 0; i < num_buckets; i++)
+    {
+        if (buckets[std::size_t(i)] == 0)
+            continue;
+        // At least one pixel, so that the rare outliers stay visible.
+        int h = std::max(1, buckets[std::size_t(i)] * histogram_height / max_count);
+        DrawRect(histogram_pos + ivec2(i * bucket_width, -h), ivec2(bucket_width - 1, h), fvec4(0.6f, 0.7f, 1, 1));
+    }
+
+    auto DrawMarker = [&](float ms, fvec4 color)
+    {
+        int x = std::clamp(int(ms * bucket_width), 0, width - 1);
+        DrawRect(histogram_pos + ivec2(x, -histogram_height), ivec2(1, histogram_height), color);
+    };
+    DrawMarker(Percentile(0.5), fvec4(1, 1, 1, 1));
+    DrawMarker(Percentile(0.95), fvec4(1, 0.9f, 0.2f, 1));
+    float p99 = Percentile(0.99);
+    DrawMarker(p99, fvec4(1, 0.2f, 0.2f, 1));
+
+    // The atlas only has digits.
+    auto DrawNumber = [&](ivec2 cursor, std::uint64_t value)
+    {
+        std::string str = fmt::format("{}", value);
+        for (char ch : str)
+        {
+            DrawRect(cursor, glyph_size, ivec2(glyph_size.x * (ch - '0'), 400));
+            cursor.x += glyph_size.x;
+        }
+    };
+    // The p99 in whole milliseconds, to the right of the histogram.
+    DrawNumber(ivec2(pos.x + width + 4, histogram_pos.y - glyph_size.y), std::uint64_t(std::max(0.f, std::round(p99))));
+    // The GPU memory in MiB, rounded up, to the right of the timeline. There's little space, so KiB wouldn't fit.
+    DrawNumber(ivec2(pos.x + width + 4, pos.y), (gpu_live_bytes + (1 << 20) - 1) >> 20);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "em/math/vector.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace em;
+
+// Records every frame into a ring buffer, to spot the hitches that the average FPS hides. See `Draw()` for the overlay.
+// Unlike `Timings`, this keeps the frames in order, so the individual spikes can be seen.
+class FrameStats
+{
+  public:
+    struct Sample
+    {
+        // The wall time since the start of the previous frame.
+        float frame_ms = 0;
+        // How long acquiring the swapchain texture took, including the ticks that ran meanwhile. This is a part of `frame_ms`.
+        float swapchain_wait_ms = 0;
+        // How many fixed ticks this frame ran.
+        int num_ticks = 0;
+        // If `Metronome::Lag()` fired, i.e. the ticks were capped and the simulation fell behind the real time.
+        bool lag = false;
+        // The GPU resources created during the previous frame, see `Gpu::ResourceStats`. This should be zero in the steady state.
+        int num_gpu_resources_created = 0;
+    };
+
+  private:
+    // A ring buffer, `next_sample` is the oldest sample once it's full.
+    std::vector<Sample> samples;
+    std::size_t next_sample = 0;
+    std::size_t max_samples = 0;
+
+    // For `Percentile()`, to avoid allocating every frame.
+    mutable std::vector<float> scratch;
+
+  public:
+    FrameStats(std::size_t max_samples = 600) : max_samples(max_samples)
+    {
+        samples.reserve(max_samples);
+        scratch.reserve(max_samples);
+    }
+
+    void Add(const Sample &sample)
+    {
+        if (samples.size() < max_samples)
+        {
+            samples.push_back(sample);
+        }
+        else
+        {
+            samples[next_sample] = sample;
+            next_sample = (next_sample + 1) % max_samples;
+        }
+    }
+
+    [[nodiscard]] std::size_t NumSamples() const {return samples.size();}
+
+    // Zero is the oldest sample.
+    [[nodiscard]] const Sample &operator[](std::size_t i) const
+    {
+        return samples[(next_sample + i) % samples.size()];
+    }
+
+    // Of `frame_ms`. `fraction` is in 0..1, e.g. `0.99` for the 99th percentile. Returns zero if there are no samples.
+    [[nodiscard]] float Percentile(double fraction) const;
+
+    // How many of the recorded frames had `lag` set.
+    [[nodiscard]] std::size_t NumLagFrames() const;
+
+    // Draws the overlay with `DrawRect()`, with the top-left corner at `pos`. Call this while filling the render queue.
+    // The top half is the timeline of the recent frames, one pixel per frame. The swapchain wait is the darker part of each bar,
+    //   the red bars are the lag frames, and the yellow ones ran several ticks. The horizontal line is `budget_ms`.
+    // The bottom half is the histogram of `frame_ms`, 1 ms per bucket, with the p50/p95/p99 markers (white, yellow, red) and the p99 value in ms.
+    // The magenta dots above the timeline are the frames that created GPU resources. `gpu_live_bytes` is shown in MiB to the right of the timeline.
+    void Draw(ivec2 pos, float budget_ms, std::uint64_t gpu_live_bytes) const;
+};
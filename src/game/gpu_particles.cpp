@@ -0,0 +1,143 @@
+#include "gpu_particles.h"
+
+#include "gpu/command_buffer.h"
+#include "gpu/compute_pass.h"
+#include "gpu/copy_pass.h"
+#include "gpu/device.h"
+#include "gpu/render_pass.h"
+#include "gpu/shader.h"
+#include "utils/filesystem.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace
+{
+    // Must match `particles.comp.glsl`. This is std140, but all members are scalars, so it's the same as the C++ layout.
+    struct SimUniforms
+    {
+        std::uint32_t capacity = 0;
+        std::uint32_t num_spawns = 0;
+        std::uint32_t spawn_cursor = 0;
+        std::uint32_t num_ticks = 0;
+        std::uint32_t clear = 0;
+    };
+
+    // Must match `local_size_x` in `particles.comp.glsl`.
+    constexpr std::uint32_t workgroup_size = 64;
+
+    // The initial size of the spawn buffer, measured in spawns.
+    constexpr std::uint32_t initial_spawn_capacity = 256;
+}
+
+GpuParticles::GpuParticles(Gpu::Device &device, SDL_GPUTextureFormat target_format, std::uint32_t capacity)
+    : device(&device),
+    capacity(capacity),
+    particle_buffer(device, capacity * std::uint32_t(sizeof(GpuParticle)), Gpu::Buffer::Usage::compute_storage_read | Gpu::Buffer::Usage::compute_storage_write | Gpu::Buffer::Usage::graphics_storage_read),
+    sim_pipeline(device, "particles (compute)", Filesystem::LoadedFile(fmt::format("{}assets/shaders/particles.comp.spv", Filesystem::GetResourceDir()), Filesystem::LoadMode::map))
+{
+    // This is small, no point in doing it asynchronously.
+    draw_pipeline.shaders = ShaderPair(device, "particles");
+    draw_pipeline.pipeline = Gpu::Pipeline(device, Gpu::Pipeline::Params{
+        .shaders = draw_pipeline.shaders,
+        // The vertex shader reads the particles from the storage buffer.
+        .vertex_buffers = {},
+        .targets = {
+            .color = {
+                Gpu::Pipeline::ColorTarget{
+                    .texture_format = target_format,
+                    .blending = Gpu::Pipeline::Blending::Premultiplied(),
+                },
+            },
+        },
+    });
+}
+
+void GpuParticles::Queue(std::span<const GpuParticleSpawn> new_spawns, std::uint32_t new_num_ticks, bool new_clear)
+{
+    if (new_clear)
+    {
+        spawns.clear();
+        clear = true;
+    }
+
+    spawns.insert(spawns.end(), new_spawns.begin(), new_spawns.end());
+    num_ticks += new_num_ticks;
+    queued = true;
+}
+
+void GpuParticles::Upload(Gpu::CopyPass &pass)
+{
+    // Only the newest particles would survive anyway.
+    if (spawns.size() > capacity)
+        spawns.erase(spawns.begin(), spawns.end() - capacity);
+
+    std::uint32_t num_spawns = std::uint32_t(spawns.size());
+
+    // Even with no spawns, the compute shader needs something bound there.
+    if (num_spawns > spawn_capacity || !spawn_buffer)
+    {
+        spawn_capacity = std::max(initial_spawn_capacity, std::bit_ceil(num_spawns));
+        std::uint32_t byte_size = spawn_capacity * std::uint32_t(sizeof(GpuParticleSpawn));
+        spawn_buffer = Gpu::Buffer(*device, byte_size, Gpu::Buffer::Usage::compute_storage_read);
+        spawn_transfer_buffer = Gpu::TransferBuffer(*device, byte_size);
+    }
+
+    if (num_spawns == 0)
+        return;
+
+    std::uint32_t byte_size = num_spawns * std::uint32_t(sizeof(GpuParticleSpawn));
+    { // `Map()` cycles the transfer buffer, so this doesn't wait for the previous frame.
+        Gpu::TransferBuffer::Mapping mapping = spawn_transfer_buffer.Map();
+        std::memcpy(mapping.Span().data(), spawns.data(), byte_size);
+    }
+    spawn_transfer_buffer.ApplyToBuffer(pass, 0, spawn_buffer, 0, byte_size);
+}
+
+void GpuParticles::Simulate(Gpu::CommandBuffer &cmdbuf)
+{
+    // Nothing would change.
+    if (spawns.empty() && num_ticks == 0 && !clear)
+        return;
+
+    Gpu::Shader::SetUniform(cmdbuf, Gpu::Shader::Stage::compute, 0, SimUniforms{
+        .capacity = capacity,
+        .num_spawns = std::uint32_t(spawns.size()),
+        .spawn_cursor = spawn_cursor,
+        .num_ticks = num_ticks,
+        .clear = clear,
+    });
+
+    { // Not cycling the particle buffer, since the shader reads the previous contents.
+        const Gpu::ComputePass::ReadWriteBuffer rw_buffers[] = {{.buffer = &particle_buffer}};
+        Gpu::ComputePass pass(cmdbuf, rw_buffers);
+        pass.BindPipeline(sim_pipeline);
+        Gpu::Buffer *const ro_buffers[] = {&spawn_buffer};
+        pass.BindStorageBuffers(ro_buffers);
+        pass.Dispatch(uvec3((capacity + workgroup_size - 1) / workgroup_size, 1, 1));
+    }
+
+    spawn_cursor = std::uint32_t((spawn_cursor + spawns.size()) % capacity);
+}
+
+void GpuParticles::Draw(Gpu::RenderPass &pass)
+{
+    if (!queued)
+        return;
+
+    pass.BindPipeline(draw_pipeline.pipeline);
+    Gpu::Buffer *const buffers[] = {&particle_buffer};
+    pass.BindStorageBuffers(buffers);
+    pass.DrawPrimitivesInstanced(6, capacity); // 6 vertices per rect, the vertex shader generates the corners.
+}
+
+void GpuParticles::EndFrame()
+{
+    spawns.clear();
+    num_ticks = 0;
+    clear = false;
+    queued = false;
+}
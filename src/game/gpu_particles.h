@@ -0,0 +1,75 @@
+#pragma once
+
+#include "game/particle_pool.h"
+#include "game/renderer.h"
+#include "gpu/buffer.h"
+#include "gpu/compute_pipeline.h"
+#include "gpu/transfer_buffer.h"
+
+#include <SDL3/SDL_gpu.h>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace em::Gpu
+{
+    class CommandBuffer;
+    class CopyPass;
+    class Device;
+    class RenderPass;
+}
+
+using namespace em;
+
+// The GPU backend of `ParticlePool`. The particles live in a storage buffer that's never read back to the CPU.
+// Each frame the new particles are uploaded, then a compute shader adds them and simulates all particles for the ticks of this frame,
+//   then the vertex shader draws them straight from the same buffer, one instance per slot (the dead ones become empty rects).
+// The buffer is a ring: the new particles overwrite the oldest slots, whether or not those are still alive.
+class GpuParticles
+{
+    Gpu::Device *device = nullptr;
+
+    std::uint32_t capacity = 0;
+
+    // `capacity` elements of `GpuParticle`.
+    Gpu::Buffer particle_buffer;
+
+    // The spawns for the current frame. Those grow as needed.
+    Gpu::Buffer spawn_buffer;
+    Gpu::TransferBuffer spawn_transfer_buffer;
+    // Measured in spawns.
+    std::uint32_t spawn_capacity = 0;
+
+    Gpu::ComputePipeline sim_pipeline;
+    ShaderPipeline draw_pipeline;
+
+    // The next slot to put a new particle into.
+    std::uint32_t spawn_cursor = 0;
+
+    // What was queued for the current frame.
+    std::vector<GpuParticleSpawn> spawns;
+    std::uint32_t num_ticks = 0;
+    // This starts true to zero the buffer on the first frame.
+    bool clear = true;
+    // Whether `Queue()` was called in this frame, i.e. whether to draw anything.
+    bool queued = false;
+
+  public:
+    GpuParticles() {}
+
+    // `target_format` is the format of the texture we draw to.
+    GpuParticles(Gpu::Device &device, SDL_GPUTextureFormat target_format, std::uint32_t capacity = 1 << 16);
+
+    // Adds particles and ticks for the current frame. See `DrawGpuParticles()` in `main.h`.
+    void Queue(std::span<const GpuParticleSpawn> new_spawns, std::uint32_t new_num_ticks, bool new_clear);
+
+    // Call those once per frame, in this order. `Upload()` and `Simulate()` must be outside of any passes.
+    void Upload(Gpu::CopyPass &pass);
+    void Simulate(Gpu::CommandBuffer &cmdbuf);
+    // Only draws if `Queue()` was called in this frame. Expects the screen size to be in the vertex uniform slot 0, like `main.vert`.
+    void Draw(Gpu::RenderPass &pass);
+
+    // Call this at the end of each frame.
+    void EndFrame();
+};
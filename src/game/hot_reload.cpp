@@ -0,0 +1,75 @@
+#include "hot_reload.h"
+
+#include "game/clock.h"
+#include "utils/filesystem.h"
+
+#include <fmt/format.h>
+
+#include <cstdio>
+#include <exception>
+#include <utility>
+
+HotReloader::~HotReloader()
+{
+    for (const PendingPipeline &pending : pending_pipelines)
+        pending.job.Wait();
+}
+
+void HotReloader::WatchPipeline(App::JobSystem &jobs, Gpu::Device &device, ShaderPipeline &target, std::string name, Gpu::Pipeline::Params params, std::string frag_variant)
+{
+    std::string vert_path = ShaderPath(name, {}, "vert");
+    std::string frag_path = ShaderPath(name, frag_variant, "frag");
+    auto reload = [this, &jobs, &device, &target, name, params = std::move(params), frag_variant = std::move(frag_variant)]
+    {
+        fmt::print(stderr, "Rebuilding the pipeline `{}`{}.\n", name, frag_variant.empty() ? "" : fmt::format(" ({})", frag_variant));
+        PendingPipeline pending{.target = &target, .name = name};
+        pending.job = CreatePipelineAsync(jobs, device, pending.result, name, params, frag_variant);
+        pending_pipelines.push_back(std::move(pending));
+    };
+    watcher.Watch(std::move(vert_path), reload);
+    watcher.Watch(std::move(frag_path), std::move(reload));
+}
+
+void HotReloader::WatchFile(std::string path, std::function<void()> reload)
+{
+    watcher.Watch(path, [path, reload = std::move(reload)]
+    {
+        fmt::print(stderr, "Reloading `{}`.\n", path);
+        try
+        {
+            reload();
+        }
+        catch (std::exception &e)
+        {
+            fmt::print(stderr, "Unable to reload `{}`: {}\n", path, e.what());
+        }
+    });
+}
+
+void HotReloader::Poll()
+{
+    // Install the finished pipelines, in the order they were requested.
+    while (!pending_pipelines.empty() && pending_pipelines.front().job.IsDone())
+    {
+        PendingPipeline pending = std::move(pending_pipelines.front());
+        pending_pipelines.erase(pending_pipelines.begin());
+        try
+        {
+            // SDL keeps the old pipeline alive until the frames in flight are done with it.
+            pending.job.Get();
+            *pending.target = std::move(*pending.result);
+        }
+        catch (std::exception &e)
+        {
+            fmt::print(stderr, "Unable to rebuild the pipeline `{}`, keeping the old one: {}\n", pending.name, e.what());
+        }
+    }
+
+    // Stat-ing the files is cheap, but not cheap enough to do every frame.
+    std::uint64_t now = Clock::Time();
+    if (now - last_poll_time < Clock::SecondsToTicks(0.25))
+        return;
+    last_poll_time = now;
+
+    watcher.Poll();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "game/renderer.h"
+#include "gpu/pipeline.h"
+#include "mainloop/job_system.h"
+#include "utils/file_watcher.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace em::Gpu
+{
+    class Device;
+}
+
+using namespace em;
+
+// Reloads the individual assets when their files change, so you don't have to restart the game after editing them. See `FRAMES_HOT_RELOAD` in `main.cpp`.
+// Rebuild the assets while the game is running (e.g. with `make sync-libs-and-assets`), and this picks up the ones that changed.
+// The loose files are watched, so the asset pack must not be mounted when this is used.
+class HotReloader
+{
+    Filesystem::FileWatcher watcher;
+    std::uint64_t last_poll_time = 0;
+
+    struct PendingPipeline
+    {
+        ShaderPipeline *target = nullptr;
+        std::string name;
+        std::shared_ptr<ShaderPipeline> result;
+        App::JobSystem::Handle job;
+    };
+    std::vector<PendingPipeline> pending_pipelines;
+
+  public:
+    HotReloader() {}
+    HotReloader(const HotReloader &) = delete;
+    HotReloader &operator=(const HotReloader &) = delete;
+    // Waits for the pipelines that are still being rebuilt, since they use the device.
+    ~HotReloader();
+
+    // Watches `assets/shaders/<name>.{vert,frag}.spv` (see `ShaderPair` for `frag_variant`). When either changes, rebuilds the pipeline as a job on `jobs`
+    //   (see `CreatePipelineAsync()`), and replaces `target` once that's done. `jobs`, `device` and `target` must outlive this object.
+    void WatchPipeline(App::JobSystem &jobs, Gpu::Device &device, ShaderPipeline &target, std::string name, Gpu::Pipeline::Params params, std::string frag_variant = {});
+
+    // Calls `reload` when the file at `path` changes. If that throws, the error is printed, and the old asset should stay in use.
+    void WatchFile(std::string path, std::function<void()> reload);
+
+    // Call this once per frame. Checks the files a few times per second, and installs the rebuilt pipelines as soon as they're ready.
+    // This never waits for anything.
+    void Poll();
+};
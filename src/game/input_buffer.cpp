@@ -0,0 +1,79 @@
+#include "input_buffer.h"
+
+#include "game/clock.h"
+
+#include <SDL3/SDL_mouse.h>
+#include <SDL3/SDL_timer.h>
+
+#include <algorithm>
+
+void InputBuffer::HandleEvent(const SDL_Event &e)
+{
+    Edge edge;
+
+    switch (e.type)
+    {
+      case SDL_EVENT_KEY_DOWN:
+      case SDL_EVENT_KEY_UP:
+        if (e.key.repeat || std::size_t(e.key.scancode) >= mouse_index)
+            return;
+        edge.button = std::size_t(e.key.scancode);
+        edge.down = e.type == SDL_EVENT_KEY_DOWN;
+        break;
+
+      case SDL_EVENT_MOUSE_BUTTON_DOWN:
+      case SDL_EVENT_MOUSE_BUTTON_UP:
+        if (e.button.button != SDL_BUTTON_LEFT)
+            return;
+        edge.button = mouse_index;
+        edge.down = e.type == SDL_EVENT_MOUSE_BUTTON_DOWN;
+        break;
+
+      case SDL_EVENT_WINDOW_FOCUS_LOST:
+        // We might not get the releases while unfocused.
+        Clear();
+        return;
+
+      default:
+        return;
+    }
+
+    // The timestamps are in `SDL_GetTicksNS()` nanoseconds. Convert them to our clock by measuring how long ago the event happened.
+    std::uint64_t now_ns = SDL_GetTicksNS();
+    std::uint64_t now = Clock::Time();
+    std::uint64_t age = Clock::SecondsToTicks(double(now_ns - std::min(e.common.timestamp, now_ns)) / 1e9);
+    edge.time = now - std::min(age, now);
+    // Just in case the conversion isn't monotonic, keep the edges sorted.
+    if (!edges.empty())
+        edge.time = std::max(edge.time, edges.back().time);
+
+    edges.push_back(edge);
+}
+
+World::Input InputBuffer::TickInput(std::uint64_t time, ivec2 mouse_pos)
+{
+    pressed_this_tick.fill(false);
+
+    std::size_t i = 0;
+    for (; i < edges.size() && edges[i].time <= time; i++)
+    {
+        const Edge &edge = edges[i];
+        // The release waits for the next tick, so that the press is seen by at least one tick.
+        // This also delays the edges after it, but such short presses are rare.
+        if (!edge.down && pressed_this_tick[edge.button])
+            break;
+
+        held[edge.button] = edge.down;
+        if (edge.down)
+            pressed_this_tick[edge.button] = true;
+    }
+    edges.erase(edges.begin(), edges.begin() + std::ptrdiff_t(i));
+
+    return World::Input::FromKeys(mouse_pos, held[mouse_index], held.data());
+}
+
+void InputBuffer::Clear()
+{
+    edges.clear();
+    held.fill(false);
+}
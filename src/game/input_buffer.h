@@ -0,0 +1,52 @@
+#pragma once
+
+#include "em/math/vector.h"
+#include "game/world.h"
+
+#include <SDL3/SDL_events.h>
+#include <SDL3/SDL_scancode.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace em;
+
+// Collects the key and mouse button events with their timestamps, and gives each fixed tick the input as of the time that tick stands for.
+// Polling the state once per frame instead makes all ticks of a frame see the same input, and loses the presses shorter than a frame.
+// A press that is released before any tick sees it is still held for one tick, so the short taps always register.
+// The mouse position isn't buffered, it's passed to `TickInput()` by the caller.
+class InputBuffer
+{
+    // The scancodes, then the left mouse button.
+    static constexpr std::size_t mouse_index = SDL_SCANCODE_COUNT;
+    static constexpr std::size_t num_buttons = mouse_index + 1;
+
+    struct Edge
+    {
+        // In `Clock::Time()` ticks.
+        std::uint64_t time = 0;
+        std::size_t button = 0;
+        bool down = false;
+    };
+    // In the order of the events, which is also the order of the timestamps.
+    std::vector<Edge> edges;
+
+    std::array<bool, num_buttons> held{};
+    // The buttons pressed during the current `TickInput()`, to not release them in the same tick.
+    std::array<bool, num_buttons> pressed_this_tick{};
+
+  public:
+    InputBuffer() {}
+
+    // Call this for every event. Ignores the irrelevant ones.
+    void HandleEvent(const SDL_Event &e);
+
+    // Returns the input of the tick that ends at `time` (in `Clock::Time()` ticks), and consumes the events up to it.
+    // Call this once per tick, with non-decreasing times.
+    [[nodiscard]] World::Input TickInput(std::uint64_t time, ivec2 mouse_pos);
+
+    // Releases everything and drops the pending events.
+    void Clear();
+};
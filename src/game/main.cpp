@@ -4,7 +4,20 @@
 #include "em/macros/utils/finally.h"
 #include "em/macros/utils/lift.h"
 #include "em/refl/macros/structs.h"
+#include "game/batch_sim.h"
+#include "game/bench.h"
+#include "game/frame_stats.h"
+#include "game/hot_reload.h"
+#include "game/input_buffer.h"
 #include "game/metronome.h"
+#include "game/microbench.h"
+#include "game/readback.h"
+#include "game/renderer.h"
+#include "game/replay.h"
+#include "game/sim_thread.h"
+#include "game/snapshot_ring.h"
+#include "game/solver.h"
+#include "game/timings.h"
 #include "game/world.h"
 #include "gpu/buffer.h"
 #include "gpu/command_buffer.h"
@@ -12,82 +25,69 @@
 #include "gpu/device.h"
 #include "gpu/pipeline.h"
 #include "gpu/render_pass.h"
+#include "gpu/resource_stats.h"
 #include "gpu/sampler.h"
 #include "gpu/shader.h"
-#include "gpu/transfer_buffer.h"
+#include "mainloop/job_system.h"
 #include "mainloop/main.h"
+#include "mainloop/module_timings.h"
 #include "mainloop/reflected_app.h"
+#include "mainloop/startup_trace.h"
+#include "utils/asset_pack.h"
 #include "utils/filesystem.h"
+#include "utils/trace.h"
 #include "window/sdl.h"
 #include "window/window.h"
 
-#include "stb_image.h"
-
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_time.h>
 #include <SDL3/SDL_timer.h>
+#include <SDL3/SDL_video.h>
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
 
 using namespace em;
 
-Audio::SourceManager audio;
-
-Gpu::Texture LoadImage(em::Gpu::Device &device, em::Gpu::CopyPass &pass, std::string_view filename)
-{
-    std::string path = fmt::format("{}assets/images/{}.png", Filesystem::GetResourceDir(), filename);
-    Filesystem::File file(path, "rb");
-    ivec2 pixel_size;
-    int num_channels = 4;
-    unsigned char *stb_data = stbi_load_from_file(file.Handle(), &pixel_size.x, &pixel_size.y, nullptr, num_channels);
-    if (!stb_data)
-        throw std::runtime_error(fmt::format("Unable to load image `{}`.", path));
-    EM_FINALLY{ stbi_image_free(stb_data); };
-
-    std::size_t byte_size = std::size_t(pixel_size.prod() * num_channels);
-
-    Gpu::TransferBuffer tb(device, {stb_data, byte_size});
-
-    Gpu::Texture tex(device, Gpu::Texture::Params{
-        .size = pixel_size.to_vec3(1),
-    });
-    tb.ApplyToTexture(pass, tex);
-    return tex;
-}
+Audio::AudioThread audio;
 
-struct ShaderPair
+// Set `FRAMES_PRESENT_MODE` to `vsync`, `mailbox` or `immediate`. F6 cycles them at runtime.
+static Window::PresentMode PresentModeFromEnv()
 {
-    Gpu::Shader vert;
-    Gpu::Shader frag;
-
-    ShaderPair() {}
-
-    ShaderPair(Gpu::Device &device, std::string_view name)
-        : vert(device, fmt::format("{} (vertex)", name), Gpu::Shader::Stage::vertex, Filesystem::LoadedFile(fmt::format("{}assets/shaders/{}.vert.spv", Filesystem::GetResourceDir(), name))),
-        frag(device, fmt::format("{} (fragment)", name), Gpu::Shader::Stage::fragment, Filesystem::LoadedFile(fmt::format("{}assets/shaders/{}.frag.spv", Filesystem::GetResourceDir(), name)))
-    {}
-
-    operator Gpu::Pipeline::Shaders()
+    const char *str = SDL_getenv("FRAMES_PRESENT_MODE");
+    if (!str)
+        return Window::PresentMode::vsync;
+    for (Window::PresentMode mode : {Window::PresentMode::vsync, Window::PresentMode::mailbox, Window::PresentMode::immediate})
     {
-        return {
-            .vert = &vert,
-            .frag = &frag,
-        };
+        if (std::string_view(str) == PresentModeName(mode))
+            return mode;
     }
-};
-
+    throw std::runtime_error(fmt::format("`FRAMES_PRESENT_MODE` must be `vsync`, `mailbox` or `immediate`, but got `{}`.", str));
+}
 
-struct VertexAttr
+// Set `FRAMES_FRAMES_IN_FLIGHT` to 1..3. 1 has the least latency, e.g. combined with `FRAMES_PRESENT_MODE=mailbox`.
+static std::uint32_t FramesInFlightFromEnv()
 {
-    fvec2 pos;
-    fvec4 color;
-    fvec2 texcoord;
-    fvec3 factors;
-};
-
-
-struct GameApp;
-GameApp *global_app = nullptr;
-
+    const char *str = SDL_getenv("FRAMES_FRAMES_IN_FLIGHT");
+    if (!str)
+        return 2;
+    int n = std::atoi(str);
+    if (n < 1 || n > 3)
+        throw std::runtime_error(fmt::format("`FRAMES_FRAMES_IN_FLIGHT` must be 1, 2 or 3, but got `{}`.", str));
+    return std::uint32_t(n);
+}
 
 struct GameApp : App::Module
 {
@@ -100,58 +100,43 @@ struct GameApp : App::Module
             // .copyright = "",
             // .url = "",
         })
+        (App::StartupMark)(startup_mark_sdl, "sdl")
+        // The background work: loading, rendering, anything else. First, so it outlives everything that adds jobs to it.
+        (App::JobSystem)(jobs, App::JobSystem::Params{})
+        (App::StartupMark)(startup_mark_jobs, "job system")
         (Gpu::Device)(device, Gpu::Device::Params{})
+        (App::StartupMark)(startup_mark_device, "gpu device")
         (Window)(window, Window::Params{
             .gpu_device = &device,
             .size = screen_size * 2,
             .min_size = screen_size,
+            .present_mode = PresentModeFromEnv(),
+            .max_frames_in_flight = FramesInFlightFromEnv(),
         })
+        (App::StartupMark)(startup_mark_window, "window")
     )
 
-    Audio::Context audio_context = nullptr;
-
-    ShaderPair sh_main = ShaderPair(device, "main");
-    ShaderPair sh_upscale = ShaderPair(device, "upscale");
+    // Set `FRAMES_STARTUP_TRACE` to print where the startup time goes, on the first frame. See `StartupTrace`.
+    // The `startup_mark_...` members end the phases of it.
+    bool startup_trace_done = false;
+
+    // Set `FRAMES_TRACE` to a file path to record the profiling zones, and write them there on exit in the Chrome trace format. See `utils/trace.h`.
+    // The zones are only compiled in the builds with `EM_TRACE` defined, e.g. `MODE=profile`.
+    std::string trace_path = []{
+        const char *path = SDL_getenv("FRAMES_TRACE");
+        if (!path)
+            return std::string();
+        #ifndef EM_TRACE
+        fmt::print(stderr, "`FRAMES_TRACE` is set, but this build has no profiling zones. Define `EM_TRACE` or use `MODE=profile`.\n");
+        #endif
+        Trace::SetEnabled(true);
+        return std::string(path);
+    }();
 
-    Gpu::Pipeline pipeline_main = Gpu::Pipeline(device, Gpu::Pipeline::Params{
-        .shaders = sh_main,
-        .vertex_buffers = {
-            {
-                Gpu::Pipeline::VertexBuffer{
-                    .pitch = sizeof(VertexAttr),
-                    .attributes = {
-                        Gpu::Pipeline::VertexAttribute{
-                            .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2,
-                            .byte_offset_in_elem = offsetof(VertexAttr, pos),
-                        },
-                        Gpu::Pipeline::VertexAttribute{
-                            .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4,
-                            .byte_offset_in_elem = offsetof(VertexAttr, color),
-                        },
-                        Gpu::Pipeline::VertexAttribute{
-                            .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2,
-                            .byte_offset_in_elem = offsetof(VertexAttr, texcoord),
-                        },
-                        Gpu::Pipeline::VertexAttribute{
-                            .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3,
-                            .byte_offset_in_elem = offsetof(VertexAttr, factors),
-                        },
-                    }
-                }
-            }
-        },
-        .targets = {
-            .color = {
-                Gpu::Pipeline::ColorTarget{
-                    .texture_format = window.GetSwapchainTextureFormat(),
-                    .blending = Gpu::Pipeline::Blending::Premultiplied(),
-                },
-            },
-        },
-    });
+    Audio::Context audio_context = nullptr;
+    App::StartupMark startup_mark_audio_context = "audio context";
 
-    Gpu::Pipeline pipeline_upscale = Gpu::Pipeline(device, Gpu::Pipeline::Params{
-        .shaders = sh_upscale,
+    Gpu::Pipeline::Params upscale_pipeline_params = {
         .vertex_buffers = {
             {
                 Gpu::Pipeline::VertexBuffer{
@@ -172,24 +157,23 @@ struct GameApp : App::Module
                 },
             },
         },
-    });
+    };
+    // This compiles as a job while we load everything else. We wait for it at the end of the constructor.
+    std::shared_ptr<ShaderPipeline> upscale_pipeline_result;
+    App::JobSystem::Handle upscale_pipeline_job = CreatePipelineAsync(jobs, device, upscale_pipeline_result, "upscale", upscale_pipeline_params);
+    ShaderPipeline upscale_pipeline;
 
     Gpu::Buffer upscale_triangle_buffer;
-    Gpu::Texture upscale_triangle_texture = Gpu::Texture(device, Gpu::Texture::Params{
-        .format = window.GetSwapchainTextureFormat(),
-        .usage = Gpu::Texture::UsageFlags::sampler | Gpu::Texture::UsageFlags::color_target,
-        .size = screen_size.to_vec3(1),
-    });
-    Gpu::Texture upscale_triangle_texture_large; // This is created in `Tick()` with the correct size.
 
-    Gpu::Sampler sampler_nearest = Gpu::Sampler(device, Gpu::Sampler::Params{
-        .filter_min = Gpu::Sampler::Filter::nearest,
-        .filter_mag = Gpu::Sampler::Filter::nearest,
-    });
     Gpu::Sampler sampler_linear = Gpu::Sampler(device, Gpu::Sampler::Params{
         .filter_min = Gpu::Sampler::Filter::linear,
         .filter_mag = Gpu::Sampler::Filter::linear,
     });
+    App::StartupMark startup_mark_upscale_setup = "upscale setup";
+
+    // The software rendering fallback can't afford everything, see `World::low_detail`. This also makes the upscale use nearest filtering.
+    // Set `FRAMES_LOW_DETAIL` to try this with a GPU.
+    bool low_detail = device.IsSoftwareRenderer() || SDL_getenv("FRAMES_LOW_DETAIL");
 
     // FPS counter: [
     std::uint64_t frame_counter = 0;
@@ -202,47 +186,245 @@ struct GameApp : App::Module
     // ]
 
     World world;
-
-    Gpu::Texture main_texture;
+    App::StartupMark startup_mark_world = "world";
+    // The mouse position in world coordinates, updated once per frame.
+    ivec2 mouse_pos;
+    // The buttons, from the events. Each fixed tick gets the state as of its own time, see `InputBuffer`.
+    InputBuffer input_buffer;
+
+    // Set the `FRAMES_RECORD` environment variable to a file path to record a replay of this session. See `replay.h`.
+    // This must be initialized after the world, since it reseeds its random number generator.
+    ReplayWriter replay_writer = [this]{
+        const char *path = SDL_getenv("FRAMES_RECORD");
+        if (!path)
+            return ReplayWriter();
+
+        std::random_device rd;
+        std::uint64_t seed = std::uint64_t(rd()) << 32 | rd();
+        world.SeedRandom(seed);
+        return ReplayWriter(path, seed);
+    }();
+
+    // Hold Backspace to rewind, one tick per tick. Press Ctrl+Z to undo the last drag.
+    // Both are disabled while recording a replay, since the replays only store the inputs.
+    SnapshotRing rewind_history = SnapshotRing(60 * 10);
+    SnapshotRing drag_undo_history = SnapshotRing(64);
+
+    // The sounds are decoded on `jobs`, and uploaded by the audio thread (see `PollSoundLoaders()`), so the first frames don't wait for them.
+    Audio::GlobalData::AsyncLoader sound_loader = Audio::GlobalData::AsyncLoader(jobs, Audio::mono, Audio::wav, fmt::format("{}assets/sounds/", Filesystem::GetResourceDir()));
+    App::StartupMark startup_mark_sound_loader = "thread pool, sound loader";
+
+    // Renders the world into a low-resolution texture, which we then upscale to the window.
+    Renderer renderer = Renderer(device, jobs, window.GetSwapchainTextureFormat());
+    App::StartupMark startup_mark_renderer = "renderer";
+
+    // Set the `FRAMES_HOT_RELOAD` environment variable to reload the changed assets while the game runs. See `hot_reload.h`.
+    std::unique_ptr<HotReloader> hot_reloader;
+    // One per sound being reloaded. Only touched by the audio thread, same as `sound_loader` after `audio.Start()`.
+    std::vector<Audio::GlobalData::AsyncLoader> sound_reloaders;
+    // Counted from `audio.PollFinished()`, for the F3 report.
+    std::uint64_t num_sounds_finished = 0;
+
+    // Set the `FRAMES_SIM_THREAD` environment variable to tick the world on its own thread, see `sim_thread.h`.
+    // Then `world` is only the starting state, and rewinding and undoing are disabled. The ticks then send the sounds to `audio` from that thread.
+    std::unique_ptr<SimThread> sim_thread;
+    // The `SimThread::Snapshot::num_ticks` of the last frame, to count the ticks per frame.
+    std::uint64_t sim_ticks_seen = 0;
 
     GameApp()
     {
-        Gpu::CommandBuffer cmdbuf(device);
-        Gpu::CopyPass pass(cmdbuf);
+        // The job uses `device`, so let it finish if we throw before waiting for it below.
+        EM_FINALLY_ON_THROW{ upscale_pipeline_job.Wait(); };
 
-        main_texture = LoadImage(device, pass, "texture");
-
-        fvec2 upscale_triangle_verts[3] = {
-            fvec2(-1, -1),
-            fvec2(3, -1),
-            fvec2(-1, 3),
-        };
-        upscale_triangle_buffer = Gpu::Buffer(device, pass, {reinterpret_cast<const unsigned char *>(upscale_triangle_verts), sizeof(upscale_triangle_verts)});
+        {
+            Gpu::CommandBuffer cmdbuf(device);
+            Gpu::CopyPass pass(cmdbuf);
 
-        Audio::GlobalData::Load(Audio::mono, Audio::wav, fmt::format("{}assets/sounds/", Filesystem::GetResourceDir()));
+            fvec2 upscale_triangle_verts[3] = {
+                fvec2(-1, -1),
+                fvec2(3, -1),
+                fvec2(-1, 3),
+            };
+            upscale_triangle_buffer = Gpu::Buffer(device, pass, renderer.upload_arena, {reinterpret_cast<const unsigned char *>(upscale_triangle_verts), sizeof(upscale_triangle_verts)});
+        }
+        App::StartupTrace::Mark("vertex buffer upload");
 
         float audio_distance = screen_size.x * 3;
         Audio::ListenerPosition(fvec3(0, 0, -audio_distance));
         Audio::ListenerOrientation(fvec3(0,0,1), fvec3(0,-1,0));
         Audio::Source::DefaultRefDistance(audio_distance);
 
+        // From now on, all sources live on the audio thread.
+        audio.Start(32, [this](Audio::SourceManager &){PollSoundLoaders();});
+        // The destructor doesn't run if we throw below, and the thread must not outlive the loaders it polls.
+        EM_FINALLY_ON_THROW{ audio.Stop(); };
+        App::StartupTrace::Mark("audio setup");
+
         if (is_fullscreen)
             SDL_SetWindowFullscreen(window.Handle(), true);
+        App::StartupTrace::Mark("fullscreen");
+
+        upscale_pipeline_job.Get();
+        upscale_pipeline = std::move(*upscale_pipeline_result);
+        upscale_pipeline_result = nullptr;
+        App::StartupTrace::Mark("upscale pipeline wait");
+
+        if (SDL_getenv("FRAMES_HOT_RELOAD"))
+            StartHotReload();
+
+        // Skip the main pass when nothing on screen changes, see `Renderer::reuse_unchanged_frames`. Set `FRAMES_NO_FRAME_REUSE` to compare.
+        // Not when hot-reloading, since that replaces the pipelines without the renderer noticing.
+        renderer.reuse_unchanged_frames = !hot_reloader && !SDL_getenv("FRAMES_NO_FRAME_REUSE");
+
+        // Before `sim_thread` copies the world.
+        world.low_detail = low_detail;
+
+        if (SDL_getenv("FRAMES_SIM_THREAD"))
+        {
+            if (replay_writer)
+            {
+                fmt::print(stderr, "Ignoring `FRAMES_SIM_THREAD`, since recording a replay needs the ticks on the main thread.\n");
+            }
+            else
+            {
+                sim_thread = std::make_unique<SimThread>(world, metronome.Frequency(), [](World &sim_world, const World::Input &input)
+                {
+                    sim_world.Tick(input);
+                });
+            }
+        }
     }
 
-    Metronome metronome = Metronome(60);
-    std::uint64_t frame_start = std::size_t(-1);
+    ~GameApp()
+    {
+        // The ticks can play sounds, so stop them first.
+        sim_thread.reset();
+
+        // Don't lose the last screenshots. The jobs that encode them outlive us.
+        try
+        {
+            readback.Flush();
+        }
+        catch (std::exception &e)
+        {
+            fmt::print(stderr, "{}\n", e.what());
+        }
+
+        // The sources must be destroyed before the audio context. This also stops polling the sound loaders, before they are destroyed.
+        audio.Stop();
+
+        if (!trace_path.empty())
+        {
+            // Can't throw from a destructor.
+            try
+            {
+                Trace::SetEnabled(false);
+                Trace::WriteChromeJson(trace_path);
+                if (std::size_t dropped = Trace::NumDroppedEvents())
+                    fmt::print(stderr, "The trace buffers overflowed, {} events were dropped.\n", dropped);
+            }
+            catch (std::exception &e)
+            {
+                fmt::print(stderr, "{}\n", e.what());
+            }
+        }
+    }
+
+    // Runs on the audio thread, see `audio.Start()`.
+    void PollSoundLoaders()
+    {
+        sound_loader.Poll();
+        for (Audio::GlobalData::AsyncLoader &loader : sound_reloaders)
+        {
+            try
+            {
+                loader.Poll();
+            }
+            catch (std::exception &e)
+            {
+                fmt::print(stderr, "Unable to reload a sound, keeping the old one: {}\n", e.what());
+                loader = {}; // Stop polling it.
+            }
+        }
+        std::erase_if(sound_reloaders, [](const Audio::GlobalData::AsyncLoader &loader){return loader.IsDone();});
+    }
+
+    void StartHotReload()
+    {
+        hot_reloader = std::make_unique<HotReloader>();
 
+        for (std::size_t i = 0; i < Renderer::num_main_variants; i++)
+        {
+            std::string variant(Renderer::MainVariantName(Renderer::MainVariant(i)));
+            Renderer::MainPipelines &pipelines = renderer.main_pipelines[i];
+            hot_reloader->WatchPipeline(jobs, device, pipelines.normal, "main", renderer.main_pipeline_params, variant);
+            hot_reloader->WatchPipeline(jobs, device, pipelines.opaque, "main", renderer.opaque_pipeline_params, variant);
+            hot_reloader->WatchPipeline(jobs, device, pipelines.translucent, "main", renderer.translucent_pipeline_params, variant);
+        }
+        hot_reloader->WatchPipeline(jobs, device, upscale_pipeline, "upscale", upscale_pipeline_params);
 
-    // Render queue.
-    static constexpr int render_queue_max_verts = 3 * 1000; // Must be a multiple of three.
-    Gpu::Buffer render_queue_buffer = Gpu::Buffer(device, render_queue_max_verts * sizeof(VertexAttr));
-    Gpu::TransferBuffer render_queue_transfer_buffer = Gpu::TransferBuffer(device, render_queue_max_verts * sizeof(VertexAttr));
-    Gpu::TransferBuffer::Mapping render_queue_mapping;
-    std::size_t render_queue_num_verts = 0;
+        hot_reloader->WatchFile(fmt::format("{}assets/images/texture.image", Filesystem::GetResourceDir()), [this]{renderer.RequestMainTextureReload();});
+
+        std::string sound_prefix = fmt::format("{}assets/sounds/", Filesystem::GetResourceDir());
+        Audio::GlobalData::ForEachSound(Audio::wav, [&](const std::string &name, Audio::Format format)
+        {
+            hot_reloader->WatchFile(sound_prefix + name + Audio::GlobalData::FileExtension(format), [this, name, sound_prefix]
+            {
+                // Decoded on `jobs`, uploaded by `PollSoundLoaders()` on the audio thread. That's also where the sources are, which must let go of the old buffer first.
+                audio.RunOnThread([this, name, sound_prefix](Audio::SourceManager &manager)
+                {
+                    sound_reloaders.emplace_back(jobs, name, Audio::mono, Audio::wav, sound_prefix, [&manager](const Audio::Buffer &buffer){manager.DetachBuffer(buffer);});
+                });
+            });
+        });
+    }
 
-    Gpu::RenderPass *main_pass = nullptr;
-    Gpu::CopyPass *queue_copy_pass = nullptr;
+    Metronome metronome = Metronome(60);
+    std::uint64_t frame_start = std::size_t(-1);
+    // When `RunDueTicks()` last passed the time to `metronome`. This is separate from `frame_start`, since the ticks can also run while waiting for the swapchain.
+    std::uint64_t last_tick_time = std::uint64_t(-1);
+
+    // Normally, while no swapchain texture is available, we run the due ticks and poll again, see `AcquireSwapchainTexture()`.
+    // Set the `FRAMES_BLOCKING_SWAPCHAIN` environment variable to block in the driver instead, to compare.
+    bool blocking_swapchain = SDL_getenv("FRAMES_BLOCKING_SWAPCHAIN");
+    // How long to poll before giving up and blocking, in case the driver keeps saying no for some other reason.
+    static constexpr double max_swapchain_poll_seconds = 0.1;
+    // How long to sleep between the polls. This adds at most this much latency to the frame.
+    static constexpr double swapchain_poll_interval_seconds = 0.0002;
+
+
+    // Set when the last level is finished, then we quit.
+    bool game_finished = false;
+
+    // Performance statistics. Press F3 to print them.
+    Timings timings;
+    GpuFrameTimer gpu_frame_timer;
+
+    // The GPU resources that were alive and created as of the last frame. Also in the F2 overlay and the F3 report.
+    Gpu::ResourceStats::FrameCounter gpu_resources;
+
+    // Every frame, in order. Press F2 to show the overlay, see `FrameStats::Draw()`.
+    FrameStats frame_stats;
+    bool show_frame_stats = false;
+
+    // Press F12 to save a screenshot to the current directory. It's the low-resolution image before the upscale, so it's pixel-exact.
+    // Set the `FRAMES_CAPTURE` environment variable to a directory to save every frame there, e.g. for the bug reports.
+    // The frames are downloaded without stalling and encoded on `jobs`, so the capture drops frames rather than slowing the game down. See `FrameReadback`.
+    FrameReadback readback;
+    bool screenshot_requested = false;
+    std::string capture_dir = []{
+        const char *dir = SDL_getenv("FRAMES_CAPTURE");
+        if (!dir)
+            return std::string();
+        if (!SDL_CreateDirectory(dir))
+            throw std::runtime_error(fmt::format("Unable to create the capture directory `{}`: {}", dir, SDL_GetError()));
+        return std::string(dir);
+    }();
+    // Names the captured frames. Counts only the ones that weren't dropped, so the file names have no gaps.
+    std::uint64_t num_captured_frames = 0;
+
+    // Used when `device.MustManuallyLimitFps()`.
+    Clock::FramePacer frame_pacer;
 
     // For alt+enter.
     bool enter_held_prev = false;
@@ -252,47 +434,136 @@ struct GameApp : App::Module
     bool is_fullscreen = false;
     #endif
 
-    void FixedTick()
+    // Alt+Enter.
+    void HandleFullscreenToggle()
+    {
+        const bool *held_keys = SDL_GetKeyboardState(nullptr);
+        bool alt_held = held_keys[SDL_SCANCODE_LALT] || held_keys[SDL_SCANCODE_RALT];
+        bool enter_held = held_keys[SDL_SCANCODE_RETURN];
+
+        if (alt_held && enter_held && !enter_held_prev)
+        {
+            is_fullscreen = !is_fullscreen;
+            SDL_SetWindowFullscreen(window.Handle(), is_fullscreen);
+        }
+
+        enter_held_prev = enter_held;
+    }
+
+    // `tick_time` is the `Clock::Time()` this tick stands for, for `input_buffer`.
+    void FixedTick(std::uint64_t tick_time)
     {
-        { // Alt+Enter?
-            const bool *held_keys = SDL_GetKeyboardState(nullptr);
-            bool alt_held = held_keys[SDL_SCANCODE_LALT] || held_keys[SDL_SCANCODE_RALT];
-            bool enter_held = held_keys[SDL_SCANCODE_RETURN];
+        HandleFullscreenToggle();
 
-            if (alt_held && enter_held && !enter_held_prev)
+        if (!replay_writer && SDL_GetKeyboardState(nullptr)[SDL_SCANCODE_BACKSPACE])
+        {
+            if (const World::Snapshot *snapshot = rewind_history.Back())
             {
-                is_fullscreen = !is_fullscreen;
-                SDL_SetWindowFullscreen(window.Handle(), is_fullscreen);
+                world.LoadSnapshot(*snapshot);
+                rewind_history.PopBack();
             }
+            tick_counter++;
+            return;
+        }
 
-            enter_held_prev = enter_held;
+        World::Snapshot snapshot_before;
+        bool dragging_before = false;
+        if (!replay_writer)
+        {
+            snapshot_before = world.SaveSnapshot();
+            dragging_before = world.GetStatus().dragging;
         }
 
-        world.Tick();
+        World::Input input = input_buffer.TickInput(tick_time, mouse_pos);
+        world.Tick(input);
+        if (replay_writer)
+        {
+            replay_writer.AddTick(input, world);
+        }
+        else
+        {
+            rewind_history.Push(snapshot_before);
+            if (!dragging_before && world.GetStatus().dragging)
+                drag_undo_history.Push(snapshot_before);
+        }
         tick_counter++;
     }
 
 
-    App::Action Tick() override
+    // Runs the fixed ticks that became due since the last call, catching up with the real time. Returns how many ran.
+    // Not with `sim_thread`, which runs its own ticks.
+    // With `from_poll`, does nothing until a whole tick is due, and then passes all the time since the last call at once, without the compensation.
+    //   The metronome is meant for the frame deltas, see `Metronome::Tick()`.
+    int RunDueTicks(bool from_poll = false)
     {
-        std::uint64_t frame_start_ticks = 0;
-        if (device.MustManuallyLimitFps())
-            frame_start_ticks = Clock::Time();
+        std::uint64_t now = Clock::Time();
+        std::uint64_t delta = last_tick_time == std::uint64_t(-1) ? 0 : now - last_tick_time;
+        if (from_poll && metronome.Remainder() + delta < metronome.ClockTicksPerTick())
+            return 0;
+        last_tick_time = now;
+
+        int num_ticks = 0;
+        while (metronome.Tick(delta, /*compensate=*/!from_poll))
+        {
+            Timings::Scope scope(timings, TimingZone::fixed_tick);
+            // The ticks catch up with the real time, the last one ends `Remainder()` before now.
+            FixedTick(now - std::min(metronome.Remainder(), now));
+            num_ticks++;
+        }
+        return num_ticks;
+    }
 
+    // Acquires the swapchain texture for `cmdbuf`. While none is available (too many frames in flight), runs the ticks that become due
+    //   and handles the finished sounds, then polls again, instead of sleeping in the driver. This way the ticks (and the sounds they play) keep their times.
+    // After `max_swapchain_poll_seconds` falls back to blocking, which returns null right away if the window is minimized.
+    // When minimized, blocks right after the first try, so that nothing ticks in the background.
+    // Adds the ticks it ran to `num_ticks`. Stops running them once there's `metronome.MaxTicksPerFrame()`, the rest waits for the frame.
+    [[nodiscard]] Gpu::Texture AcquireSwapchainTexture(Gpu::CommandBuffer &cmdbuf, int &num_ticks)
+    {
+        if (blocking_swapchain)
+            return cmdbuf.WaitAndAcquireSwapchainTexture(window);
+
+        EM_TRACE_ZONE("GameApp::AcquireSwapchainTexture");
+
+        std::uint64_t start = Clock::Time();
+        while (Clock::Time() - start < Clock::SecondsToTicks(max_swapchain_poll_seconds))
+        {
+            if (Gpu::Texture tex = cmdbuf.TryAcquireSwapchainTexture(window))
+                return tex;
+
+            if (SDL_GetWindowFlags(window.Handle()) & SDL_WINDOW_MINIMIZED)
+                break;
+
+            if (!sim_thread && (metronome.MaxTicksPerFrame() == 0 || num_ticks < metronome.MaxTicksPerFrame()))
+                num_ticks += RunDueTicks(/*from_poll=*/true);
+            audio.PollFinished([this](const Audio::AudioThread::VoiceFinished &){num_sounds_finished++;});
+
+            SDL_DelayNS(std::uint64_t(swapchain_poll_interval_seconds * 1e9));
+        }
+
+        return cmdbuf.WaitAndAcquireSwapchainTexture(window);
+    }
+
+    // Returns false if nothing was submitted to the GPU.
+    [[nodiscard]] bool TickAndRender()
+    {
+        // This one only has the upscale pass. The world goes into a separate command buffer on a job, which is submitted before this one.
+        // SDL presents the swapchain texture with the buffer that acquired it, so this has to stay on the main thread.
         Gpu::CommandBuffer cmdbuf(device);
-        Gpu::Texture swapchain_tex = cmdbuf.WaitAndAcquireSwapchainTexture(window);
+
+        // The ticks that ran this frame, including those while waiting for the swapchain.
+        int num_ticks = 0;
+
+        std::uint64_t swapchain_wait_start = Clock::Time();
+        Gpu::Texture swapchain_tex = AcquireSwapchainTexture(cmdbuf, num_ticks);
+        double swapchain_wait = Clock::TicksToSeconds(Clock::Time() - swapchain_wait_start);
 
         if (!swapchain_tex)
         {
             cmdbuf.CancelWhenDestroyed();
-            return App::Action::cont; // No draw target.
+            return false; // No draw target.
         }
 
-        Gpu::CommandBuffer cmdbuf_queue_upload(device);
-        Gpu::CopyPass copypass_queue_upload(cmdbuf_queue_upload);
-        queue_copy_pass = &copypass_queue_upload;
-        EM_FINALLY{ queue_copy_pass = nullptr; };
-
         // Calculate scale.
         fvec2 skew_scale_vec2 = swapchain_tex.GetSize().to_vec2().to<float>() / screen_size;
         float scale = skew_scale_vec2.reduce(EM_FUNC(std::min));
@@ -304,10 +575,14 @@ struct GameApp : App::Module
             ivec2 window_size{};
             SDL_GetWindowSize(window.Handle(), &window_size.x, &window_size.y);
 
-            ivec2 mouse_pos = ((mouse_pos_f / window_size - 0.5) * skew_scale_vec2 * screen_size).map(EM_FUNC(std::round)).to<int>();
-            world.mouse_pos = mouse_pos;
+            mouse_pos = ((mouse_pos_f / window_size - 0.5) * skew_scale_vec2 * screen_size).map(EM_FUNC(std::round)).to<int>();
         }
 
+        // Either `world`, or the latest state from `sim_thread`.
+        World *world_to_render = &world;
+        // See `World::Render()`.
+        float alpha = 1;
+
         { // Fixed tick.
             // Compute timings if needed.
             std::uint64_t delta = 0;
@@ -318,15 +593,58 @@ struct GameApp : App::Module
 
             frame_start = new_frame_start;
 
-            while (metronome.Tick(delta))
-                FixedTick();
+            if (sim_thread)
+            {
+                // The ticks run on their own thread. We only pass the input there, and pick up the latest state.
+                HandleFullscreenToggle();
+                // The ticks there don't line up with ours, so this is the input as of now.
+                sim_thread->SetInput(input_buffer.TickInput(new_frame_start, mouse_pos));
+
+                SimThread::Snapshot &snapshot = sim_thread->Latest();
+                num_ticks += int(snapshot.num_ticks - sim_ticks_seen);
+                sim_ticks_seen = snapshot.num_ticks;
+                tick_counter += std::uint64_t(num_ticks);
+
+                world_to_render = &snapshot.world;
+                alpha = sim_thread->Alpha(snapshot);
+            }
+            else
+            {
+                num_ticks += RunDueTicks();
+                alpha = float(metronome.Time());
+            }
+
+            // Not on the first frame, it has no delta.
+            if (delta != 0)
+            {
+                frame_stats.Add({
+                    .frame_ms = float(Clock::TicksToSeconds(delta) * 1000),
+                    .swapchain_wait_ms = float(swapchain_wait * 1000),
+                    .num_ticks = num_ticks,
+                    .lag = !sim_thread && metronome.Lag(),
+                    .num_gpu_resources_created = int(gpu_resources.CreatedLastFrame()),
+                });
+            }
         }
 
-        { // Audio.
-            audio.Tick();
+        // `Tick()` quits after this frame.
+        if (world_to_render->GetStatus().all_levels_finished)
+            game_finished = true;
 
-            Audio::CheckErrors();
-        }
+        // Before rendering, since this can swap the pipelines and request a texture reload.
+        if (hot_reloader)
+            hot_reloader->Poll();
+
+        // Interpolating between the last two ticks, so the motion stays smooth on displays faster than the tickrate.
+        // This runs on a worker until `scene.Get()` below, so don't touch the world or the timings until then.
+        App::JobSystem::Handle scene = renderer.RenderAsync(jobs, *world_to_render, timings, alpha, show_frame_stats ? [this]{
+            frame_stats.Draw(screen_size / 2 - ivec2(184, 64), float(1000 / metronome.Frequency()), Gpu::ResourceStats::TotalLiveBytes(gpu_resources.Current()));
+        } : std::function<void()>());
+        // If something below throws, the render thread must be done with the world before we unwind.
+        EM_FINALLY{ scene.Wait(); };
+
+        // The audio thread does the rest. This rethrows its errors.
+        audio.PollFinished([this](const Audio::AudioThread::VoiceFinished &){num_sounds_finished++;});
 
         { // Update frame counter and FPS.
             frame_counter++;
@@ -347,64 +665,39 @@ struct GameApp : App::Module
             }
         }
 
-        { // Recreate upscale texture (the larger one).
-            int scale_int = std::max(1, (swapchain_tex.GetSize().to_vec2() / screen_size).reduce(EM_FUNC(std::min)));
-            ivec2 size = screen_size * scale_int;
-            if (!upscale_triangle_texture_large || upscale_triangle_texture_large.GetSize().to_vec2() != size)
+        // Rethrows the errors from the job. After this, the scene command buffer is submitted, so the upscale pass sees `renderer.target`.
+        // Not `jobs.Wait()`, since that could pick up a long job (e.g. a sound to decode) and delay the frame.
+        scene.Get();
+
+        { // Screenshots and frame capture, on their own command buffers, after the scene one.
+            if (screenshot_requested)
             {
-                upscale_triangle_texture_large = Gpu::Texture(device, Gpu::Texture::Params{
-                    .format = window.GetSwapchainTextureFormat(),
-                    .usage = Gpu::Texture::UsageFlags::sampler | Gpu::Texture::UsageFlags::color_target,
-                    .size = size.to_vec3(1),
-                });
+                screenshot_requested = false;
+
+                SDL_Time now = 0;
+                SDL_DateTime date{};
+                if (!SDL_GetCurrentTime(&now) || !SDL_TimeToDateTime(now, &date, true))
+                    throw std::runtime_error(fmt::format("Unable to get the current time: {}", SDL_GetError()));
+                // The frame number is there in case of several screenshots per second.
+                std::string path = fmt::format("screenshot_{:04}-{:02}-{:02}_{:02}-{:02}-{:02}_{}.png", date.year, date.month, date.day, date.hour, date.minute, date.second, frame_counter);
+
+                if (readback.Capture(device, renderer.target, renderer.target_format, [this, path](FrameReadback::Image image){SavePngAsync(jobs, std::move(image), path);}))
+                    fmt::print(stderr, "Saving a screenshot to `{}`.\n", path);
+                else
+                    fmt::print(stderr, "Unable to take a screenshot, the GPU is too far behind.\n");
             }
-        }
-
-        { // Primary render pass.
-            Gpu::RenderPass rp_first(cmdbuf, Gpu::RenderPass::Params{
-                .color_targets = {
-                    Gpu::RenderPass::ColorTarget{
-                        .texture = {
-                            .texture = &upscale_triangle_texture,
-                        },
-                    },
-                },
-            });
-            main_pass = &rp_first;
-            EM_FINALLY{ main_pass = nullptr; };
-
-            rp_first.BindPipeline(pipeline_main);
-
-            rp_first.BindTextures({{{.texture = &main_texture, .sampler = &sampler_nearest}}});
-            Gpu::Shader::SetUniform(cmdbuf, Gpu::Shader::Stage::vertex, 0, (screen_size * ivec2(1,-1)).to<float>());
-            Gpu::Shader::SetUniform(cmdbuf, Gpu::Shader::Stage::fragment, 0, main_texture.GetSize().to_vec2().to<float>());
-
-            RestartRendering();
-
-            world.Render();
 
-            FinishRendering();
+            if (!capture_dir.empty())
+            {
+                std::string path = fmt::format("{}/{:06}.png", capture_dir, num_captured_frames);
+                if (readback.Capture(device, renderer.target, renderer.target_format, [this, path](FrameReadback::Image image){SavePngAsync(jobs, std::move(image), path);}))
+                    num_captured_frames++;
+            }
         }
 
-        { // Upscale.
+        { // Upscale. This is a single pass, the shader does the sharp bilinear filtering.
+            Timings::Scope scope(timings, TimingZone::upscale_pass);
             Gpu::RenderPass rp_upscale(cmdbuf, Gpu::RenderPass::Params{
-                .color_targets = {
-                    Gpu::RenderPass::ColorTarget{
-                        .texture = {
-                            .texture = &upscale_triangle_texture_large,
-                        },
-                        .initial_contents = Gpu::RenderPass::ColorDontCare{},
-                    },
-                },
-            });
-
-            rp_upscale.BindPipeline(pipeline_upscale);
-            rp_upscale.BindVertexBuffers({{{.buffer = &upscale_triangle_buffer}}});
-            rp_upscale.BindTextures({{{.texture = &upscale_triangle_texture, .sampler = &sampler_nearest}}});
-            rp_upscale.DrawPrimitives(3);
-        }
-        { // Upscale, second pass.
-            Gpu::RenderPass rp_upscale2(cmdbuf, Gpu::RenderPass::Params{
                 .color_targets = {
                     Gpu::RenderPass::ColorTarget{
                         .texture = {
@@ -415,96 +708,157 @@ struct GameApp : App::Module
                 },
             });
 
-            rp_upscale2.BindPipeline(pipeline_upscale);
-            rp_upscale2.BindVertexBuffers({{{.buffer = &upscale_triangle_buffer}}});
-            rp_upscale2.BindTextures({{{.texture = &upscale_triangle_texture_large, .sampler = &sampler_linear}}});
+            rp_upscale.BindPipeline(upscale_pipeline.pipeline);
+            rp_upscale.BindVertexBuffers({{{.buffer = &upscale_triangle_buffer}}});
+            // With the nearest filtering the shader degrades to a plain nearest upscale, which is one texel fetch per pixel instead of four.
+            rp_upscale.BindTextures({{{.texture = &renderer.target, .sampler = low_detail ? &renderer.sampler_nearest : &sampler_linear}}});
             Gpu::RenderPass::Viewport vp{
                 .pos = (swapchain_tex.GetSize().to_vec2() / 2 - screen_size / 2 * scale).map(EM_FUNC(std::round)),
                 .size = (screen_size * scale).map(EM_FUNC(std::round)),
             };
+            // Before clamping the viewport, since the clamped parts are still a part of the image.
+            Gpu::Shader::SetUniform(cmdbuf, Gpu::Shader::Stage::fragment, 0, vp.size / screen_size);
             vp.pos.x = std::max(0.f, vp.pos.x);
             vp.pos.y = std::max(0.f, vp.pos.y);
             vp.size.x = std::min(float(swapchain_tex.GetSize().x), vp.pos.x + vp.size.x) - vp.pos.x;
             vp.size.y = std::min(float(swapchain_tex.GetSize().y), vp.pos.y + vp.size.y) - vp.pos.y;
-            rp_upscale2.SetViewport(vp);
-            rp_upscale2.DrawPrimitives(3);
+            rp_upscale.SetViewport(vp);
+            rp_upscale.DrawPrimitives(3);
+        }
+
+        return true;
+    }
+
+    App::Action Tick() override
+    {
+        EM_TRACE_ZONE("GameApp::Tick");
+
+        gpu_frame_timer.Poll(timings[TimingZone::gpu_frame]);
+        // Between the frames, so that the counts cover a whole frame, including the render job.
+        gpu_resources.Update();
+        readback.Poll();
+
+        {
+            std::uint64_t cpu_frame_start = Clock::Time();
+            bool submitted = TickAndRender();
+            timings[TimingZone::cpu_frame].Add(Clock::TicksToSeconds(Clock::Time() - cpu_frame_start));
+
+            // After the frame's command buffer is submitted, which happens at the end of `TickAndRender()`.
+            if (submitted)
+                gpu_frame_timer.Mark(device);
         }
 
+        if (!startup_trace_done && frame_counter > 0)
+        {
+            startup_trace_done = true;
+            App::StartupTrace::Mark("first frame");
+            if (SDL_getenv("FRAMES_STARTUP_TRACE"))
+                fmt::print(stderr, "{}", App::StartupTrace::Report());
+        }
 
         if (device.MustManuallyLimitFps())
         {
             static const double wanted_len = 1.f / SDL_GetDesktopDisplayMode(SDL_GetPrimaryDisplay())->refresh_rate;
 
-            double cur_len = Clock::TicksToSeconds(Clock::Time() - frame_start_ticks) + 0.005f;
-
-            if (cur_len < wanted_len)
-                Clock::WaitSeconds(wanted_len - cur_len);
+            if (double achieved_len = frame_pacer.Wait(wanted_len); achieved_len > 0)
+                timings[TimingZone::paced_frame].Add(achieved_len);
         }
 
-        return App::Action::cont;
+        return game_finished ? App::Action::exit_success : App::Action::cont;
     }
 
     App::Action HandleEvent(SDL_Event &e) override
     {
         if (e.type == SDL_EVENT_QUIT)
             return App::Action::exit_success;
-        return App::Action::cont;
-    }
 
+        input_buffer.HandleEvent(e);
 
-    // Render queue.
+        // Toggle the frame statistics overlay.
+        if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F2 && !e.key.repeat)
+            show_frame_stats = !show_frame_stats;
 
-    void FinishRendering()
-    {
-        render_queue_mapping = {};
-        render_queue_transfer_buffer.ApplyToBuffer(*queue_copy_pass, render_queue_buffer);
-        main_pass->BindVertexBuffers({{{.buffer = &render_queue_buffer}}});
-        main_pass->DrawPrimitives(std::uint32_t(render_queue_num_verts));
-        render_queue_num_verts = 0;
-    }
+        // Dump the timings, ours and then the per-module ones from `ReflectedApp`, then what the last frame drew, then the GPU resources.
+        if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F3 && !e.key.repeat)
+        {
+            const RenderQueue::Stats &stats = renderer.render_queue.LastFrameStats();
+            fmt::print(stderr, "{}{}rects: {} drawn ({} opaque), {} off-screen, {} transparent, {} batches\nsounds: {} playing, {} finished, {} dropped\n{}",
+                timings.Report(), App::ModuleTimings::Report(),
+                stats.num_rects, stats.num_opaque, stats.num_offscreen, stats.num_transparent, stats.num_batches,
+                audio.NumActiveSources(), num_sounds_finished, audio.NumDropped(),
+                gpu_resources.Report());
+        }
 
-    void RestartRendering()
-    {
-        render_queue_mapping = render_queue_transfer_buffer.Map();
-    }
+        // Save a screenshot on the next frame, see `readback`.
+        if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F12 && !e.key.repeat)
+            screenshot_requested = true;
 
-    void InsertVertex(const VertexAttr &v)
-    {
-        if (render_queue_num_verts >= render_queue_max_verts)
+        // Cycle the present modes, skipping the unsupported ones. Vsync is always supported, so this terminates.
+        // This is between the frames, so no swapchain texture is acquired right now.
+        if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F6 && !e.key.repeat)
+        {
+            Window::PresentMode mode = window.GetPresentMode();
+            do
+                mode = Window::PresentMode((int(mode) + 1) % 3);
+            while (!window.SupportsPresentMode(mode));
+            window.SetPresentMode(mode);
+            fmt::print(stderr, "Present mode: {}\n", PresentModeName(mode));
+        }
+
+        // Toggle the GPU particles. Not with `sim_thread`, since the world belongs to it.
+        if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F4 && !e.key.repeat && !sim_thread)
+        {
+            world.gpu_particles = !world.gpu_particles;
+            fmt::print(stderr, "GPU particles: {}\n", world.gpu_particles ? "on" : "off");
+        }
+
+        // Undo the last drag.
+        if (e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_Z && (e.key.mod & SDL_KMOD_CTRL) && !replay_writer)
         {
-            FinishRendering();
-            RestartRendering();
+            if (const World::Snapshot *snapshot = drag_undo_history.Back())
+            {
+                world.LoadSnapshot(*snapshot);
+                drag_undo_history.PopBack();
+                // Don't rewind past the undo, that would be confusing.
+                rewind_history.Clear();
+            }
         }
 
-        reinterpret_cast<VertexAttr *>(render_queue_mapping.Span().data())[render_queue_num_verts++] = v;
+        return App::Action::cont;
     }
 };
 
-void DrawRect(ivec2 pos, ivec2 size, const DrawSettings &settings)
+std::unique_ptr<App::Module> em::Main()
 {
-    VertexAttr v1{.pos = pos,                          .color = settings.color, .texcoord = settings.tex_pos,                                       .factors = settings.factors};
-    VertexAttr v2{.pos = ivec2(pos.x + size.x, pos.y), .color = settings.color, .texcoord = fvec2(settings.tex_pos.x + size.x, settings.tex_pos.y), .factors = settings.factors};
-    VertexAttr v3{.pos = pos + size,                   .color = settings.color, .texcoord = settings.tex_pos + size,                                .factors = settings.factors};
-    VertexAttr v4{.pos = ivec2(pos.x, pos.y + size.y), .color = settings.color, .texcoord = fvec2(settings.tex_pos.x, settings.tex_pos.y + size.y), .factors = settings.factors};
+    // Read the assets from the pack if the build made one, since that's one file open instead of one per asset.
+    // Except when hot-reloading, which watches the loose files, and the pack would shadow them.
+    if (!SDL_getenv("FRAMES_HOT_RELOAD"))
+        Filesystem::MountAssetPackIfExists(fmt::format("{}assets.pack", Filesystem::GetResourceDir()));
+
+    #if defined(FRAMES_BENCH)
+    // The benchmark target, see `project.mk`.
+    return MakeBenchApp();
+    #elif defined(FRAMES_MICROBENCH)
+    // The microbenchmark target, see `project.mk`.
+    return MakeMicrobenchApp();
+    #else
+    // Replays a recording headlessly, see `replay.h`.
+    if (const char *replay_path = SDL_getenv("FRAMES_REPLAY"))
+        return MakeReplayApp(replay_path);
 
-    if (settings.flip_x)
+    // Simulates this many worlds with random inputs on all cores, see `batch_sim.h`.
+    if (const char *num_worlds = SDL_getenv("FRAMES_BATCH"))
+        return MakeBatchApp(std::size_t(std::max(1, std::atoi(num_worlds))));
+
+    // Solves the levels and prints the solutions, see `solver.h`. Either `all` or a level number starting from 1.
+    // E.g. `FRAMES_SOLVE=all make run-frames` in the build pipeline, the exit status tells if all levels were solved.
+    if (const char *level = SDL_getenv("FRAMES_SOLVE"))
     {
-        std::swap(v1.texcoord, v2.texcoord);
-        std::swap(v3.texcoord, v4.texcoord);
+        if (std::string_view(level) == "all")
+            return MakeSolverApp(std::nullopt);
+        return MakeSolverApp(std::size_t(std::max(1, std::atoi(level)) - 1));
     }
 
-    global_app->InsertVertex(v1);
-    global_app->InsertVertex(v2);
-    global_app->InsertVertex(v4);
-
-    global_app->InsertVertex(v4);
-    global_app->InsertVertex(v2);
-    global_app->InsertVertex(v3);
-}
-
-std::unique_ptr<App::Module> em::Main()
-{
-    auto ret = std::make_unique<App::ReflectedApp<GameApp>>();
-    global_app = &ret->underlying;
-    return ret;
+    return std::make_unique<App::ReflectedApp<GameApp>>();
+    #endif
 }
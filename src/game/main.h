@@ -1,13 +1,26 @@
 #pragma once
 
 #include "em/math/vector.h"
-#include "audio/source_manager.h"
+#include "audio/audio_thread.h"
+#include "game/tex_region.h"
+
+#include <cstdint>
+#include <span>
+
+namespace em::Gpu
+{
+    class Sampler;
+    class Texture;
+}
+
+struct GpuParticleSpawn;
+struct RectInstance;
 
 using namespace em;
 
 static constexpr ivec2 screen_size = ivec2(1920, 1080) / 4;
 
-extern Audio::SourceManager audio;
+extern Audio::AudioThread audio;
 
 struct DrawSettings
 {
@@ -17,6 +30,11 @@ struct DrawSettings
 
     bool flip_x = false;
 
+    // If null, uses the main atlas.
+    Gpu::Texture *texture = nullptr;
+    // If null, uses nearest filtering.
+    Gpu::Sampler *sampler = nullptr;
+
     // Low level, mixed texture and color.
     DrawSettings(ivec2 tex_pos, fvec4 color, float mix_tex, float mix_tex_alpha, float beta = 1, bool flip_x = false)
         : color(color), tex_pos(tex_pos), factors(mix_tex, mix_tex_alpha, beta), flip_x(flip_x)
@@ -32,9 +50,34 @@ struct DrawSettings
         : DrawSettings(tex_pos, fvec4(0), 1, alpha, beta, flip_x)
     {}
 
+    // Use a different texture instead of the main atlas. `tex_pos` is then measured in the pixels of that texture.
+    DrawSettings &UseTexture(Gpu::Texture &new_texture, Gpu::Sampler *new_sampler = nullptr)
+    {
+        texture = &new_texture;
+        sampler = new_sampler;
+        return *this;
+    }
 };
 
+// Those draw using the current `Renderer` (see `renderer.h`).
+
 void DrawRect(ivec2 pos, ivec2 size, const DrawSettings &settings);
+// Draws many ready-made rects with the main atlas, cheaper than calling `DrawRect()` for each. They end up in the same batch.
+void DrawRects(std::span<const RectInstance> rects);
+// Draws the particles simulated on the GPU (see `gpu_particles.h`), after adding `spawns` and simulating `num_ticks` ticks.
+// If `clear` is true, kills all existing particles first. This should be called once per frame, since the GPU state is shared.
+void DrawGpuParticles(std::span<const GpuParticleSpawn> spawns, std::uint32_t num_ticks, bool clear);
+
+// Draws `image` (a region of the main atlas) at `pos`, with a 1px black border around it. `alpha` applies to both.
+// The result is one rect, since the combinations come pre-composited from `World::FramedImages()`.
+void DrawFramedImage(ivec2 pos, const TexRegion &image, float alpha = 1);
+// Same, but only the border, without the image itself.
+void DrawImageFrame(ivec2 pos, const TexRegion &image, float alpha = 1);
+
+// Fills the whole screen with a tile from the main atlas, repeated and scrolled by `offset`.
+// The tile is copied into its own texture when `tile_tex_pos` or `tile_size` changes (i.e. when a level is loaded),
+//   and is then repeated by the sampler, so this is a single rect regardless of the tile size.
+void DrawTiledBackground(ivec2 tile_tex_pos, ivec2 tile_size, ivec2 offset);
 
 inline void DrawRectAbs(ivec2 pos_a, ivec2 pos_b, const DrawSettings &settings)
 {
@@ -94,13 +94,15 @@ class Metronome
 
     // Usage: `while (Tick(...)) {...}` during each frame.
     // The `delta` is the frame delta. It's only used on the first iteration.
-    bool Tick(std::uint64_t delta)
+    // Pass `compensate == false` when feeding the time in steps much smaller than a tick (e.g. while polling for something), and only once a tick is due.
+    //   Then the accumulator always lands near `tick_len`, and the compensation would shift the phase by half a tick every time.
+    bool Tick(std::uint64_t delta, bool compensate = true)
     {
         if (new_frame)
             accumulator += delta;
 
         // Compensate.
-        if (std::abs(std::int64_t(accumulator - tick_len)) < tick_len * comp_th)
+        if (compensate && std::abs(std::int64_t(accumulator - tick_len)) < tick_len * comp_th)
         {
             int dir;
             if (comp_dir)
@@ -139,4 +141,11 @@ class Metronome
     {
         return accumulator / double(tick_len);
     }
+
+    // The accumulated time that wasn't spent on the ticks yet, in clock ticks. Updated by `Tick()`.
+    // Inside of `while (Tick(...))`, this is how long before the frame start the current tick ends.
+    [[nodiscard]] std::uint64_t Remainder() const
+    {
+        return accumulator;
+    }
 };
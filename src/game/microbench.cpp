@@ -0,0 +1,361 @@
+#include "microbench.h"
+
+#include "audio/complete.h"
+#include "em/refl/macros/structs.h"
+#include "game/clock.h"
+#include "game/main.h"
+#include "game/metronome.h"
+#include "game/particle_pool.h"
+#include "game/render_queue.h"
+#include "game/renderer.h"
+#include "game/timings.h"
+#include "game/world.h"
+#include "gpu/device.h"
+#include "gpu/upload_queue.h"
+#include "mainloop/job_system.h"
+#include "mainloop/reflected_app.h"
+#include "utils/alloc_counter.h"
+#include "utils/asset_pack.h"
+#include "utils/filesystem.h"
+#include "window/sdl.h"
+
+#include <fmt/format.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace em;
+
+namespace
+{
+    // The benchmarks pass their results to this, so that the compiler can't optimize the work away.
+    volatile std::uint64_t sink = 0;
+    void Consume(std::uint64_t value)
+    {
+        sink = sink + value;
+    }
+
+    class Runner
+    {
+        std::string filter;
+        std::size_t num_samples = 0;
+
+      public:
+        Runner(std::string filter, std::size_t num_samples) : filter(std::move(filter)), num_samples(num_samples) {}
+
+        // Times `func`, which must perform `ops_per_call` operations per call, and prints the time per operation as one line of JSON.
+        template <typename F>
+        void Run(std::string_view name, std::size_t ops_per_call, F &&func)
+        {
+            if (!filter.empty() && name.find(filter) == std::string_view::npos)
+                return;
+
+            // Double the number of calls per sample until a sample takes at least a millisecond, so the clock resolution doesn't matter.
+            // This doubles as the warmup, so the caches are hot and the scratch buffers have grown by the time we measure.
+            const std::uint64_t min_sample_len = Clock::SecondsToTicks(0.001);
+            std::size_t calls_per_sample = 1;
+            while (true)
+            {
+                std::uint64_t start = Clock::Time();
+                for (std::size_t i = 0; i < calls_per_sample; i++)
+                    func();
+                if (Clock::Time() - start >= min_sample_len || calls_per_sample >= std::size_t(1) << 30)
+                    break;
+                calls_per_sample *= 2;
+            }
+
+            TimingStat stat(num_samples);
+            std::uint64_t allocs_before = AllocCounter::NumAllocations();
+            for (std::size_t s = 0; s < num_samples; s++)
+            {
+                std::uint64_t start = Clock::Time();
+                for (std::size_t i = 0; i < calls_per_sample; i++)
+                    func();
+                stat.Add(Clock::TicksToSeconds(Clock::Time() - start) / double(calls_per_sample * ops_per_call));
+            }
+
+            // After the warmup, this should be zero for the per-tick and per-frame work. `stat` has reserved its samples, so it doesn't count.
+            double allocs_per_op = double(AllocCounter::NumAllocations() - allocs_before) / double(num_samples * calls_per_sample * ops_per_call);
+
+            // The median is the number to compare, the rest tells how noisy it is.
+            fmt::print(
+                "{{\"name\":\"{}\",\"ops_per_call\":{},\"calls_per_sample\":{},\"samples\":{},\"median_ns\":{:.3f},\"min_ns\":{:.3f},\"p90_ns\":{:.3f},\"stddev_ns\":{:.3f}{}}}\n",
+                name, ops_per_call, calls_per_sample, num_samples,
+                stat.Percentile(0.5) * 1e9, stat.Min() * 1e9, stat.Percentile(0.9) * 1e9, stat.StdDev() * 1e9,
+                AllocCounter::IsEnabled() ? fmt::format(",\"allocs_per_op\":{:.3f}", allocs_per_op) : ""
+            );
+            std::fflush(stdout);
+        }
+    };
+
+    struct MicrobenchApp : App::Module
+    {
+        EM_REFL(
+            (Sdl)(sdl, AppMetadata{
+                .name = "Frames microbenchmarks",
+            })
+            // For compiling the pipelines, see `Renderer`.
+            (App::JobSystem)(jobs, App::JobSystem::Params{})
+            (Gpu::Device)(device, Gpu::Device::Params{})
+        )
+
+        // Needed for `DrawRect()`. Nothing is submitted, we only fill the render queue and then drop it.
+        Renderer renderer = Renderer(device, jobs, SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM);
+
+        [[nodiscard]] static Runner MakeRunner()
+        {
+            const char *filter = SDL_getenv("FRAMES_MICROBENCH_FILTER");
+            std::size_t num_samples = 50;
+            if (const char *env = SDL_getenv("FRAMES_MICROBENCH_SAMPLES"))
+                num_samples = std::size_t(std::max(1, std::atoi(env)));
+            return Runner(filter ? filter : "", num_samples);
+        }
+
+        void BenchDrawing(Runner &runner)
+        {
+            constexpr int num_rects = 1000;
+
+            // Everything lands in one batch, this is the cost of `DrawRect()` plus the cheapest path through `RenderQueue::Insert()`.
+            runner.Run("draw_rect/same_state", num_rects, [&]
+            {
+                (void)renderer.BeginFrame();
+                for (int i = 0; i < num_rects; i++)
+                    DrawRect(ivec2(i * 7 % screen_size.x, i * 13 % screen_size.y), ivec2(16), DrawSettings(ivec2(0), fvec4(1, 0, 0, 1), 0.5f, 1));
+                renderer.EndFrame();
+            });
+
+            // Overlapping rects with two alternating textures, so each one starts a new batch after searching the lookback window.
+            runner.Run("draw_rect/alternating_states", num_rects, [&]
+            {
+                (void)renderer.BeginFrame();
+                for (int i = 0; i < num_rects; i++)
+                {
+                    DrawSettings settings(ivec2(0));
+                    if (i % 2)
+                        settings.UseTexture(renderer.framed_images_texture);
+                    DrawRect(ivec2(i % 8), ivec2(32), settings);
+                }
+                renderer.EndFrame();
+            });
+
+            std::vector<RectInstance> rects(num_rects);
+            for (int i = 0; i < num_rects; i++)
+                rects[std::size_t(i)] = {.pos = PackRectCoords(ivec2(i % 100, i / 100)), .size = PackRectCoords(ivec2(2)), .color = PackUnorm8(fvec4(1)), .factors = PackUnorm8(fvec4(0, 0, 1, 0))};
+
+            runner.Run("draw_rects/span", num_rects, [&]
+            {
+                (void)renderer.BeginFrame();
+                DrawRects(rects);
+                renderer.EndFrame();
+            });
+        }
+
+        void BenchUploads(Runner &runner)
+        {
+            Gpu::UploadQueue queue(device);
+
+            // The whole round trip of streaming in an image: loading, staging, submitting the batch and waiting for the GPU copy.
+            runner.Run("gpu/upload_queue/load_image", 1, [&]
+            {
+                Gpu::Texture texture = LoadImage(device, queue, "texture");
+                queue.Submit();
+                queue.WaitAll();
+            });
+        }
+
+        void BenchWorld(Runner &runner)
+        {
+            for (std::size_t level = 0; level < World::NumLevels(); level++)
+            {
+                World world;
+                world.sounds = false;
+                world.SeedRandom(1);
+                world.LoadLevel(level);
+
+                { // Every pixel on the screen, which covers all frames and the empty space between them.
+                    std::vector<ivec2> pixels;
+                    for (int y = -screen_size.y / 2; y < screen_size.y / 2; y++)
+                    for (int x = -screen_size.x / 2; x < screen_size.x / 2; x++)
+                        pixels.push_back(ivec2(x, y));
+
+                    runner.Run(fmt::format("world/query_pixel/level_{}", level + 1), pixels.size(), [&]
+                    {
+                        std::uint64_t solid = 0;
+                        for (ivec2 pixel : pixels)
+                            solid += world.QueryWorldPixel(pixel) == 1;
+                        Consume(solid);
+                    });
+                }
+
+                runner.Run(fmt::format("world/render/level_{}", level + 1), 1, [&]
+                {
+                    (void)renderer.BeginFrame();
+                    world.Render();
+                    renderer.EndFrame();
+                });
+
+                // The collision sweep (`SolidAtOffset()` and the movement around it) is local to `World::State::Tick()`,
+                //   so we measure it through whole ticks of the player running and jumping. Restarting from a snapshot keeps the work the same in every sample.
+                world.effects = false;
+                World::Snapshot start = world.SaveSnapshot();
+                int tick = 0;
+                runner.Run(fmt::format("world/tick_walking/level_{}", level + 1), 1, [&]
+                {
+                    if (tick % 120 == 0)
+                        world.LoadSnapshot(start);
+                    world.Tick({.right = true, .jump = tick % 40 < 10});
+                    tick++;
+                });
+            }
+
+            { // Going through the levels. After the first round this shouldn't allocate, see `allocs_per_op`.
+                World world;
+                world.sounds = false;
+                std::size_t level = 0;
+                runner.Run("world/load_level", 1, [&]
+                {
+                    world.LoadLevel(level);
+                    level = (level + 1) % World::NumLevels();
+                });
+            }
+        }
+
+        void BenchParticles(Runner &runner)
+        {
+            ParticlePool pool(4096);
+            std::uint32_t n = 0;
+
+            // Both the removal of the dead particles and the update, with the pool kept full. The lifetimes are staggered, so some die every tick.
+            runner.Run("particles/refill_tick", pool.Capacity(), [&]
+            {
+                while (pool.Size() < pool.Capacity())
+                {
+                    pool.Add(fvec2(0), fvec2(float(n % 7) - 3, float(n % 5) - 2) * 0.1f, 0.05f, fvec4(1), 2, 1 + int(n % 60));
+                    n++;
+                }
+                pool.Tick();
+            });
+
+            // A death burst, the largest one in the game.
+            std::uint64_t seed = 0;
+            runner.Run("particles/burst", 64, [&]
+            {
+                pool.Clear();
+                pool.AddBurst({
+                    .count = 64,
+                    .max_radius = 6,
+                    .max_speed = 2,
+                    .speed_exponent = 1.5f,
+                    .random_velocity_dir = true,
+                    .min_color = fvec4(0.5f),
+                    .max_color = fvec4(1),
+                    .damp = 0.01f,
+                    .size = 4,
+                    .life = 90,
+                }, seed++);
+            });
+        }
+
+        void BenchMetronome(Runner &runner)
+        {
+            Metronome metronome(60);
+
+            // Frame lengths jittering around the tick length, to exercise the compensation.
+            std::vector<std::uint64_t> deltas;
+            for (int i = 0; i < 64; i++)
+                deltas.push_back(std::uint64_t(double(metronome.ClockTicksPerTick()) * (0.97 + 0.06 * (i * 37 % 64) / 64.)));
+
+            std::size_t frame = 0;
+            runner.Run("metronome/frame", 1, [&]
+            {
+                std::uint64_t delta = deltas[frame++ % deltas.size()];
+                std::uint64_t ticks = 0;
+                while (metronome.Tick(delta))
+                    ticks++;
+                Consume(ticks);
+            });
+        }
+
+        void BenchAudio(Runner &runner)
+        {
+            std::optional<Audio::Context> context;
+            try
+            {
+                context.emplace(nullptr);
+            }
+            catch (std::exception &e)
+            {
+                fmt::print(stderr, "Skipping the audio benchmarks: {}\n", e.what());
+                return;
+            }
+
+            // Destroyed in reverse, the voices first, then the buffer, then the context.
+            std::vector<std::int16_t> silence(4410);
+            Audio::Buffer buffer = Audio::Sound(44100, Audio::mono, silence.size(), silence.data());
+            Audio::SourceManager manager;
+            manager.CreateVoices(32);
+            manager.SetDefaultLimits({.max_concurrent = 8});
+
+            int n = 0;
+            runner.Run("audio/play", 1, [&]
+            {
+                manager.Play(buffer, fvec2(float(n++ % 100), 0));
+            });
+
+            constexpr int num_requests = 8;
+            runner.Run("audio/request_tick", num_requests, [&]
+            {
+                for (int i = 0; i < num_requests; i++)
+                    manager.Request(buffer, fvec2(float(i % 4 * 10), 0));
+                manager.Tick();
+            });
+        }
+
+        void BenchFiles(Runner &runner)
+        {
+            std::string path = fmt::format("{}assets/images/texture.image", Filesystem::GetResourceDir());
+
+            // With a mounted pack, `LoadedFile` never touches the loose files, so only that path is measured.
+            if (Filesystem::GetMountedAssetPack())
+            {
+                runner.Run("file/load_pack", 1, [&]{Consume(Filesystem::LoadedFile(path).size());});
+            }
+            else
+            {
+                runner.Run("file/load_read", 1, [&]{Consume(Filesystem::LoadedFile(path, Filesystem::LoadMode::read).size());});
+                runner.Run("file/load_map", 1, [&]{Consume(Filesystem::LoadedFile(path, Filesystem::LoadMode::map).size());});
+            }
+        }
+
+        App::Action Tick() override
+        {
+            Runner runner = MakeRunner();
+
+            BenchDrawing(runner);
+            BenchUploads(runner);
+            BenchWorld(runner);
+            BenchParticles(runner);
+            BenchMetronome(runner);
+            BenchAudio(runner);
+            BenchFiles(runner);
+
+            return App::Action::exit_success;
+        }
+    };
+}
+
+std::unique_ptr<App::Module> MakeMicrobenchApp()
+{
+    return std::make_unique<App::ReflectedApp<MicrobenchApp>>();
+}
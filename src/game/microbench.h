@@ -0,0 +1,13 @@
+#pragma once
+
+#include "mainloop/module.h"
+
+#include <memory>
+
+// Creates the microbenchmark suite. It times the hot functions one by one (drawing rects, streaming images in, collision queries, world ticks, particles,
+//   the metronome, the audio manager, file loading), prints one JSON object per line to stdout, and exits.
+// The results are the time per operation in nanoseconds, so they can be compared between commits with any script.
+// This target counts the heap allocations too (see `utils/alloc_counter.h`), and reports them per operation.
+// `FRAMES_MICROBENCH_FILTER` runs only the benchmarks with this substring in their names.
+// `FRAMES_MICROBENCH_SAMPLES` sets the number of timed samples per benchmark.
+[[nodiscard]] std::unique_ptr<em::App::Module> MakeMicrobenchApp();
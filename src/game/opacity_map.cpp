@@ -0,0 +1,39 @@
+#include "opacity_map.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
+OpacityMap::OpacityMap(std::span<const unsigned char> pixels, ivec2 size)
+    : size(size)
+{
+    if (size.x < 0 || size.y < 0 || pixels.size() != std::size_t(size.prod()) * 4)
+        throw std::runtime_error(fmt::format("The opacity map size [{},{}] doesn't match the {} bytes of pixels.", size.x, size.y, pixels.size()));
+
+    std::size_t pitch = std::size_t(size.x) + 1;
+    sums.resize(pitch * (std::size_t(size.y) + 1));
+
+    for (std::size_t y = 0; y < std::size_t(size.y); y++)
+    {
+        std::uint32_t row_sum = 0;
+        for (std::size_t x = 0; x < std::size_t(size.x); x++)
+        {
+            row_sum += pixels[(y * std::size_t(size.x) + x) * 4 + 3] != 255;
+            sums[(y + 1) * pitch + x + 1] = sums[y * pitch + x + 1] + row_sum;
+        }
+    }
+}
+
+bool OpacityMap::IsOpaque(ivec2 pos, ivec2 region_size) const
+{
+    ivec2 a(std::min(pos.x, pos.x + region_size.x), std::min(pos.y, pos.y + region_size.y));
+    ivec2 b(std::max(pos.x, pos.x + region_size.x), std::max(pos.y, pos.y + region_size.y));
+    if (a.x < 0 || a.y < 0 || b.x > size.x || b.y > size.y || a.x == b.x || a.y == b.y)
+        return false;
+
+    std::size_t pitch = std::size_t(size.x) + 1;
+    auto At = [&](ivec2 p){return sums[std::size_t(p.y) * pitch + std::size_t(p.x)];};
+    return At(b) - At(ivec2(a.x, b.y)) - At(ivec2(b.x, a.y)) + At(a) == 0;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "em/math/vector.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+using namespace em;
+
+// Answers whether a region of an RGBA8 image is fully opaque, in constant time. `Renderer` uses this to find the rects that can go to the opaque pass.
+// This is a summed-area table of the texels with alpha below 255.
+class OpacityMap
+{
+    ivec2 size;
+    // `(size.x + 1) * (size.y + 1)` entries. The entry at `[y][x]` counts the non-opaque texels above and to the left of it.
+    std::vector<std::uint32_t> sums;
+
+  public:
+    // An empty map, where nothing is opaque.
+    OpacityMap() {}
+
+    // `pixels` are tightly packed RGBA8, top to bottom, `size.prod() * 4` bytes.
+    OpacityMap(std::span<const unsigned char> pixels, ivec2 size);
+
+    [[nodiscard]] ivec2 GetSize() const {return size;}
+
+    // The size can be negative, then the region extends to the left and/or up from `pos`.
+    // Returns false if the region isn't entirely inside of the image, or is empty.
+    [[nodiscard]] bool IsOpaque(ivec2 pos, ivec2 size) const;
+};
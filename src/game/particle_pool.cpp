@@ -0,0 +1,269 @@
+#include "particle_pool.h"
+
+#include "em/macros/utils/lift.h"
+#include "game/main.h"
+#include "utils/fast_rng.h"
+#include "utils/fast_sincos.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+ParticlePool::ParticlePool(std::size_t capacity)
+    : capacity(capacity)
+{}
+
+void ParticlePool::Allocate()
+{
+    pos_x.resize(capacity);
+    pos_y.resize(capacity);
+    prev_pos_x.resize(capacity);
+    prev_pos_y.resize(capacity);
+    vel_x.resize(capacity);
+    vel_y.resize(capacity);
+    damp.resize(capacity);
+    max_size.resize(capacity);
+    total_life.resize(capacity);
+    remaining_life.resize(capacity);
+    color.resize(capacity);
+    detail_key.resize(capacity);
+    rects.reserve(capacity);
+}
+
+void ParticlePool::SwapRemove(std::size_t i)
+{
+    std::size_t last = --count;
+    pos_x[i] = pos_x[last];
+    pos_y[i] = pos_y[last];
+    prev_pos_x[i] = prev_pos_x[last];
+    prev_pos_y[i] = prev_pos_y[last];
+    vel_x[i] = vel_x[last];
+    vel_y[i] = vel_y[last];
+    damp[i] = damp[last];
+    max_size[i] = max_size[last];
+    total_life[i] = total_life[last];
+    remaining_life[i] = remaining_life[last];
+    color[i] = color[last];
+    detail_key[i] = detail_key[last];
+}
+
+void ParticlePool::SetBackend(Backend new_backend)
+{
+    if (new_backend == backend)
+        return;
+
+    // Clear with the old backend first, to kill the particles on the GPU when switching away from it.
+    Clear();
+    backend = new_backend;
+}
+
+void ParticlePool::Add(fvec2 pos, fvec2 vel, float new_damp, fvec4 new_color, float size, int life)
+{
+    if (backend == Backend::gpu)
+    {
+        gpu_spawns.push_back({
+            .particle = {
+                .pos = pos,
+                .vel = vel,
+                .color = new_color,
+                .damp = new_damp,
+                .max_size = size,
+                .total_life = float(life),
+                .remaining_life = float(life),
+            },
+            .tick = gpu_pending_ticks,
+        });
+        return;
+    }
+
+    if (count == capacity)
+        return;
+
+    if (pos_x.empty())
+        Allocate();
+
+    std::size_t i = count++;
+    pos_x[i] = pos.x;
+    pos_y[i] = pos.y;
+    prev_pos_x[i] = pos.x;
+    prev_pos_y[i] = pos.y;
+    vel_x[i] = vel.x;
+    vel_y[i] = vel.y;
+    damp[i] = new_damp;
+    max_size[i] = size;
+    total_life[i] = life;
+    remaining_life[i] = life;
+    color[i] = new_color;
+    detail_key[i] = next_detail_key;
+    // The golden ratio times 2^32, this gives a Weyl sequence.
+    next_detail_key += 0x9e3779b9;
+}
+
+void ParticlePool::AddBurst(const Burst &burst, std::uint64_t seed)
+{
+    FastRng rng(seed);
+
+    static constexpr std::size_t chunk_size = 64;
+    std::array<float, chunk_size> pos_angle, pos_sin, pos_cos, vel_angle, vel_sin, vel_cos, radius, speed, color_t, alpha_t;
+
+    for (std::size_t base = 0; base < std::size_t(std::max(0, burst.count)); base += chunk_size)
+    {
+        std::size_t n = std::min(chunk_size, std::size_t(burst.count) - base);
+
+        // The generator is serial, so this part doesn't vectorize. It's only a multiplication and a few shifts per number though.
+        for (std::size_t i = 0; i < n; i++)
+        {
+            pos_angle[i] = rng.Angle();
+            if (burst.random_velocity_dir)
+                vel_angle[i] = rng.Angle();
+            radius[i] = rng.Float01();
+            speed[i] = rng.Float01();
+            color_t[i] = rng.Float01();
+            alpha_t[i] = rng.Float01();
+        }
+
+        // The rest vectorizes.
+        FastSinCos(std::span(pos_angle).first(n), std::span(pos_sin).first(n), std::span(pos_cos).first(n));
+        if (burst.random_velocity_dir)
+            FastSinCos(std::span(vel_angle).first(n), std::span(vel_sin).first(n), std::span(vel_cos).first(n));
+        else
+        {
+            vel_sin = pos_sin;
+            vel_cos = pos_cos;
+        }
+
+        for (std::size_t i = 0; i < n; i++)
+            radius[i] = burst.min_radius + (burst.max_radius - burst.min_radius) * radius[i];
+
+        // Choosing the exponent outside of the loops, so that each of them vectorizes.
+        if (burst.speed_exponent == 0)
+        {
+            std::fill_n(speed.begin(), n, 1.f);
+        }
+        else if (burst.speed_exponent == 1.5f)
+        {
+            for (std::size_t i = 0; i < n; i++)
+                speed[i] *= std::sqrt(speed[i]);
+        }
+        else if (burst.speed_exponent == 2)
+        {
+            for (std::size_t i = 0; i < n; i++)
+                speed[i] *= speed[i];
+        }
+        else if (burst.speed_exponent == 3)
+        {
+            for (std::size_t i = 0; i < n; i++)
+                speed[i] *= speed[i] * speed[i];
+        }
+        else if (burst.speed_exponent != 1)
+        {
+            for (std::size_t i = 0; i < n; i++)
+                speed[i] = std::pow(speed[i], burst.speed_exponent);
+        }
+
+        for (std::size_t i = 0; i < n; i++)
+        {
+            fvec4 new_color = burst.min_color + (burst.max_color - burst.min_color) * fvec4(color_t[i], color_t[i], color_t[i], alpha_t[i]);
+            Add(
+                burst.center + fvec2(pos_cos[i], pos_sin[i]) * radius[i],
+                fvec2(vel_cos[i], vel_sin[i]) * (burst.max_speed * speed[i]),
+                burst.damp,
+                new_color,
+                burst.size,
+                burst.life
+            );
+        }
+    }
+}
+
+void ParticlePool::Clear()
+{
+    count = 0;
+
+    if (backend == Backend::gpu)
+    {
+        gpu_spawns.clear();
+        gpu_pending_clear = true;
+    }
+}
+
+void ParticlePool::Tick()
+{
+    if (backend == Backend::gpu)
+    {
+        // The GPU catches up on those in `Render()`.
+        gpu_pending_ticks++;
+        return;
+    }
+
+    // Remove the dead particles before updating, so that the ones that just ran out are still rendered once, as before.
+    for (std::size_t i = 0; i < count;)
+    {
+        if (remaining_life[i] <= 0)
+            SwapRemove(i);
+        else
+            i++;
+    }
+
+    // Separate pointers, so the compiler knows they don't alias and can vectorize this.
+    float *__restrict px = pos_x.data();
+    float *__restrict py = pos_y.data();
+    float *__restrict ppx = prev_pos_x.data();
+    float *__restrict ppy = prev_pos_y.data();
+    float *__restrict vx = vel_x.data();
+    float *__restrict vy = vel_y.data();
+    const float *__restrict d = damp.data();
+    int *__restrict life = remaining_life.data();
+    std::size_t n = count;
+
+    for (std::size_t i = 0; i < n; i++)
+    {
+        ppx[i] = px[i];
+        ppy[i] = py[i];
+        px[i] += vx[i];
+        py[i] += vy[i];
+        float k = 1.f - d[i];
+        vx[i] *= k;
+        vy[i] *= k;
+        life[i]--;
+    }
+}
+
+void ParticlePool::Render(float alpha, std::size_t max_drawn)
+{
+    if (backend == Backend::gpu)
+    {
+        DrawGpuParticles(gpu_spawns, gpu_pending_ticks, gpu_pending_clear);
+        gpu_spawns.clear();
+        gpu_pending_ticks = 0;
+        gpu_pending_clear = false;
+        return;
+    }
+
+    rects.clear();
+
+    // Drawing the particles whose keys are below the fraction that fits. When the count changes, only the particles near the threshold
+    //   appear or disappear, unlike with skipping by the slot position, since the dead particles get swapped around.
+    std::uint64_t key_threshold = count > max_drawn ? (std::uint64_t(max_drawn) << 32) / count : std::uint64_t(1) << 32;
+    for (std::size_t i = 0; i < count && rects.size() < max_drawn; i++)
+    {
+        if (detail_key[i] >= key_threshold)
+            continue;
+
+        int size = (int)std::round(max_size[i] * remaining_life[i] / total_life[i]);
+
+        fvec2 pos(prev_pos_x[i] + (pos_x[i] - prev_pos_x[i]) * alpha, prev_pos_y[i] + (pos_y[i] - prev_pos_y[i]) * alpha);
+        ivec2 corner = (pos - size / 2).map(EM_FUNC(std::round)).to<int>();
+
+        rects.push_back({
+            .pos = PackRectCoords(corner),
+            .size = PackRectCoords(ivec2(size)),
+            .tex_pos = {},
+            .tex_size = PackRectCoords(ivec2(size)),
+            .color = PackUnorm8(color[i]),
+            .factors = PackUnorm8(fvec4(0, 0, 1, 0)), // Same as `DrawSettings(color)`.
+        });
+    }
+
+    DrawRects(rects);
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "em/math/vector.h"
+#include "game/render_queue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace em;
+
+// One particle in the GPU backend of `ParticlePool`. This is uploaded as is, so the layout must match `particles.{comp,vert}.glsl` (std430).
+struct GpuParticle
+{
+    fvec2 pos;
+    fvec2 vel;
+    fvec4 color;
+    float damp = 0;
+    float max_size = 0;
+    float total_life = 0;
+    float remaining_life = 0;
+};
+static_assert(sizeof(GpuParticle) == 48);
+
+// A particle that was added to the GPU backend of `ParticlePool`, waiting to be uploaded.
+struct GpuParticleSpawn
+{
+    GpuParticle particle;
+    // How many ticks have passed in this frame before this particle was added. It then gets simulated for the remaining ticks.
+    std::uint32_t tick = 0;
+    std::uint32_t _padding[3]{}; // std430 rounds the struct size up to the alignment of `vec4`.
+};
+static_assert(sizeof(GpuParticleSpawn) == 64);
+
+// A fixed-capacity pool of untextured square particles that shrink over their lifetime.
+// It's a structure of arrays, so that `Tick()` vectorizes. Dead particles are swapped with the last one, so the order isn't preserved.
+// Alternatively the particles can be simulated on the GPU, see `Backend::gpu`.
+class ParticlePool
+{
+  public:
+    enum class Backend
+    {
+        // Simulate here, and upload the rects every frame.
+        cpu,
+        // Only record the new particles here, and let `GpuParticles` (see `gpu_particles.h`) simulate and draw them without ever reading them back.
+        // The GPU has its own fixed capacity, and when that is exceeded, the oldest particles are overwritten instead of the new ones being dropped.
+        // The GPU particles are always drawn in one batch, at the place where `Render()` is called.
+        gpu,
+    };
+
+  private:
+    Backend backend = Backend::cpu;
+
+    std::size_t capacity = 0;
+    std::size_t count = 0;
+
+    // All of those have `capacity` elements, the first `count` are used. They are allocated on the first `Add()`,
+    //   so that copying worlds that never spawn particles (e.g. in the solver, see `World::effects`) stays cheap.
+    std::vector<float> pos_x;
+    std::vector<float> pos_y;
+    // The positions as of the previous tick, for the interpolated rendering.
+    std::vector<float> prev_pos_x;
+    std::vector<float> prev_pos_y;
+    std::vector<float> vel_x;
+    std::vector<float> vel_y;
+    std::vector<float> damp;
+    std::vector<float> max_size;
+    std::vector<int> total_life;
+    std::vector<int> remaining_life;
+    std::vector<fvec4> color;
+    // Decides which particles `Render()` keeps when not all of them fit into `max_drawn`. Fixed for the life of the particle.
+    std::vector<std::uint32_t> detail_key;
+    // The key of the next particle. Consecutive keys are spread evenly over the whole range, so any burst gets thinned out evenly.
+    std::uint32_t next_detail_key = 0;
+
+    // Reused by `Render()` to avoid reallocating.
+    std::vector<RectInstance> rects;
+
+    // For `Backend::gpu`: the particles added since the last `Render()`, and the number of ticks since then.
+    std::vector<GpuParticleSpawn> gpu_spawns;
+    std::uint32_t gpu_pending_ticks = 0;
+    // For `Backend::gpu`: whether `Clear()` was called since the last `Render()`.
+    bool gpu_pending_clear = false;
+
+    void Allocate();
+    void SwapRemove(std::size_t i);
+
+  public:
+    ParticlePool(std::size_t capacity = 4096);
+
+    // With `Backend::gpu`, this is always zero, since the live particles only exist on the GPU.
+    [[nodiscard]] std::size_t Size() const {return count;}
+    [[nodiscard]] std::size_t Capacity() const {return capacity;}
+
+    [[nodiscard]] Backend GetBackend() const {return backend;}
+    // Switching the backend removes all existing particles.
+    void SetBackend(Backend new_backend);
+
+    // If the pool is full, the particle is silently dropped.
+    // `damp` is the fraction of the velocity lost per tick. `size` is the initial size in pixels.
+    void Add(fvec2 pos, fvec2 vel, float damp, fvec4 color, float size, int life);
+
+    // A burst of particles flying out of a point in random directions. Each "random" below is a separate number in 0..1.
+    struct Burst
+    {
+        fvec2 center;
+        int count = 0;
+
+        // The particles start at `center + dir * mix(min_radius, max_radius, random)`.
+        float min_radius = 0;
+        float max_radius = 0;
+
+        // The speed is `max_speed * pow(random, speed_exponent)`. The exponents 0, 1, 1.5, 2 and 3 don't call `std::pow()`.
+        float max_speed = 0;
+        float speed_exponent = 1;
+        // If false, the particles fly in the same direction as their offset from `center`. If true, the directions are unrelated.
+        bool random_velocity_dir = false;
+
+        // The color is `mix(min_color, max_color, random)`, with one random shared by RGB, and another one for the alpha.
+        fvec4 min_color;
+        fvec4 max_color;
+
+        // Same as in `Add()`.
+        float damp = 0;
+        float size = 0;
+        int life = 0;
+    };
+    // Adds `burst.count` particles, generating them in batches. This is much cheaper than calling `Add()` in a loop with the random numbers from `std::`.
+    // The random numbers come from a generator seeded with `seed`, so the caller only needs to spend one number of its own, regardless of the count.
+    void AddBurst(const Burst &burst, std::uint64_t seed);
+
+    void Clear();
+
+    void Tick();
+
+    // Draws all particles, as one batch of rects. `alpha` (0..1) interpolates between the previous and the current tick, see `World::Render()`.
+    // The GPU backend ignores it, and draws the state as of the current tick.
+    // If there's more than `max_drawn` particles, only draws a subset that fits into that. The subset only changes gradually as the count changes,
+    //   so the particles don't flicker. The GPU backend ignores this too.
+    void Render(float alpha = 1, std::size_t max_drawn = std::size_t(-1));
+};
@@ -0,0 +1,153 @@
+#include "readback.h"
+
+#include "gpu/command_buffer.h"
+#include "gpu/copy_pass.h"
+#include "gpu/device.h"
+#include "gpu/texture.h"
+#include "utils/filesystem.h"
+#include "utils/trace.h"
+
+#include <fmt/format.h>
+#include <stb_image_write.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+void FrameReadback::Finish(Slot &slot)
+{
+    Image image;
+    image.size = slot.size;
+    image.bgra = slot.bgra;
+    {
+        // Never cycle a download. If SDL still counts the buffer as used, cycling would give us a fresh one without our pixels.
+        Gpu::TransferBuffer::Mapping mapping = slot.buffer.Map(/*cycle=*/false);
+        std::span<unsigned char> span = mapping.Span();
+        image.pixels.assign(span.begin(), span.end());
+    }
+
+    // Free the slot before the callback, in case it captures again.
+    Callback callback = std::move(slot.callback);
+    slot.callback = nullptr;
+    slot.fence = {};
+    slot.busy = false;
+
+    callback(std::move(image));
+}
+
+bool FrameReadback::Capture(Gpu::Device &device, Gpu::Texture &texture, SDL_GPUTextureFormat format, Callback callback)
+{
+    EM_TRACE_ZONE("FrameReadback::Capture");
+
+    bool bgra = false;
+    switch (format)
+    {
+        case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM:
+        case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM_SRGB:
+            break;
+        case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM:
+        case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM_SRGB:
+            bgra = true;
+            break;
+        default:
+            throw std::runtime_error(fmt::format("Can't read back a texture of format {}, only the 8-bit RGBA and BGRA ones are supported.", int(format)));
+    }
+
+    ivec2 size = texture.GetSize().to_vec2();
+    std::uint32_t byte_size = std::uint32_t(size.prod()) * 4;
+
+    // Prefer a free slot that already has a buffer of the right size.
+    Slot *slot = nullptr;
+    for (Slot &s : slots)
+    {
+        if (!s.busy && (!slot || s.buffer.Size() == byte_size))
+            slot = &s;
+    }
+    if (!slot)
+    {
+        if (slots.size() >= max_slots)
+            return false;
+        slot = &slots.emplace_back();
+    }
+
+    if (slot->buffer.Size() != byte_size)
+        slot->buffer = Gpu::TransferBuffer(device, byte_size, Gpu::TransferBuffer::Usage::download);
+
+    {
+        Gpu::CommandBuffer cmdbuf(device, &slot->fence);
+        Gpu::CopyPass pass(cmdbuf);
+        slot->buffer.ApplyToTexture(pass, texture);
+    }
+
+    slot->size = size;
+    slot->bgra = bgra;
+    slot->callback = std::move(callback);
+    slot->busy = true;
+    return true;
+}
+
+void FrameReadback::Poll()
+{
+    for (Slot &slot : slots)
+    {
+        if (slot.busy && (!slot.fence || slot.fence.IsReady()))
+            Finish(slot);
+    }
+}
+
+void FrameReadback::Flush()
+{
+    for (Slot &slot : slots)
+    {
+        if (!slot.busy)
+            continue;
+        if (slot.fence)
+            slot.fence.Wait();
+        Finish(slot);
+    }
+}
+
+std::size_t FrameReadback::NumPending() const
+{
+    return std::size_t(std::count_if(slots.begin(), slots.end(), [](const Slot &slot){return slot.busy;}));
+}
+
+void SavePngAsync(App::JobSystem &jobs, FrameReadback::Image image, std::string path)
+{
+    (void)jobs.Add([image = std::move(image), path = std::move(path)]() mutable
+    {
+        EM_TRACE_ZONE("SavePngAsync");
+
+        try
+        {
+            for (std::size_t i = 0; i < image.pixels.size(); i += 4)
+            {
+                if (image.bgra)
+                    std::swap(image.pixels[i], image.pixels[i + 2]);
+                // The render target isn't meant to be transparent, but its alpha isn't necessarily opaque either.
+                image.pixels[i + 3] = 255;
+            }
+
+            std::vector<unsigned char> png;
+            auto Append = [](void *context, void *data, int size)
+            {
+                auto &out = *static_cast<std::vector<unsigned char> *>(context);
+                out.insert(out.end(), static_cast<unsigned char *>(data), static_cast<unsigned char *>(data) + size);
+            };
+            if (!stbi_write_png_to_func(Append, &png, image.size.x, image.size.y, 4, image.pixels.data(), image.size.x * 4))
+                throw std::runtime_error("Unable to encode the PNG.");
+
+            Filesystem::File file(path, "wb");
+            if (std::fwrite(png.data(), png.size(), 1, file.Handle()) != 1)
+                throw std::runtime_error(fmt::format("Unable to write the image to `{}`.", path));
+        }
+        catch (std::exception &e)
+        {
+            fmt::print(stderr, "Unable to save `{}`: {}\n", path, e.what());
+        }
+    });
+}
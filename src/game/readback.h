@@ -0,0 +1,79 @@
+#pragma once
+
+#include "em/math/vector.h"
+#include "gpu/fence.h"
+#include "gpu/transfer_buffer.h"
+#include "mainloop/job_system.h"
+
+#include <SDL3/SDL_gpu.h>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace em::Gpu
+{
+    class Device;
+    class Texture;
+}
+
+using namespace em;
+
+// Downloads textures from the GPU without stalling, for the screenshots and `FRAMES_CAPTURE` in `main.cpp`.
+// `Capture()` records a copy into a download buffer, and `Poll()` on the later frames picks up the ones whose fence has signalled.
+// The download buffers are pooled, and reused while the captured size stays the same.
+class FrameReadback
+{
+  public:
+    struct Image
+    {
+        ivec2 size;
+        // 4 bytes per pixel, rows from top to bottom, exactly as downloaded. See `bgra` for the channel order.
+        std::vector<unsigned char> pixels;
+        // If true, the channels are BGRA, otherwise RGBA. `SavePngAsync()` swaps them as needed.
+        bool bgra = false;
+    };
+
+    // Called by `Poll()` on the main thread. Hand the image to a job if it takes long to process, e.g. via `SavePngAsync()`.
+    using Callback = std::function<void(Image image)>;
+
+  private:
+    struct Slot
+    {
+        Gpu::TransferBuffer buffer;
+        Gpu::Fence fence;
+        ivec2 size;
+        bool bgra = false;
+        Callback callback;
+        // Waiting for the fence.
+        bool busy = false;
+    };
+    std::vector<Slot> slots;
+    std::size_t max_slots = 0;
+
+    // Copies the pixels out of the slot, frees it, then runs the callback.
+    void Finish(Slot &slot);
+
+  public:
+    // The GPU normally finishes a frame or two behind us, so a few slots are enough for a capture every frame.
+    FrameReadback(std::size_t max_slots = 4) : max_slots(max_slots) {}
+
+    // Records a copy of `texture` on its own command buffer, and submits it. `format` is the format of `texture`, only the 8-bit RGBA and BGRA ones are supported.
+    // Call this after submitting the command buffers that render into `texture`, they execute in the submission order.
+    // Returns false (and drops the capture) if all slots are busy, so that the GPU falling behind doesn't make us wait.
+    bool Capture(Gpu::Device &device, Gpu::Texture &texture, SDL_GPUTextureFormat format, Callback callback);
+
+    // Call this once per frame. Runs the callbacks of the finished downloads.
+    void Poll();
+
+    // Waits for all downloads, and runs their callbacks. Call this before exiting, to not lose the last captures.
+    void Flush();
+
+    // How many captures are waiting for the GPU.
+    [[nodiscard]] std::size_t NumPending() const;
+};
+
+// Converts `image` to RGBA, encodes it as a PNG, and writes it to `path`, all on `jobs`.
+// The errors are printed to stderr, since nobody waits for this job.
+void SavePngAsync(App::JobSystem &jobs, FrameReadback::Image image, std::string path);
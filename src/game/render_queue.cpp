@@ -0,0 +1,356 @@
+#include "render_queue.h"
+
+#include "gpu/copy_pass.h"
+#include "gpu/device.h"
+#include "gpu/pipeline.h"
+#include "gpu/render_pass.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+RenderQueue::RenderQueue(Gpu::Device &device, Gpu::FencePool &fences, std::uint32_t initial_capacity)
+    : device(&device), fences(&fences), initial_capacity(initial_capacity)
+{}
+
+void RenderQueue::EnsureCapacity(Slot &slot, std::uint32_t num_rects)
+{
+    if (slot.capacity >= num_rects)
+        return;
+
+    // Rounding up to a power of two to avoid reallocating repeatedly when the rect count grows slowly.
+    std::uint32_t new_capacity = std::max(initial_capacity, std::bit_ceil(num_rects));
+    std::uint32_t byte_size = new_capacity * std::uint32_t(sizeof(RectInstance));
+
+    // The old buffers are released lazily by SDL, after the GPU stops using them. Though we only get here when the slot is free anyway.
+    slot.buffer = Gpu::Buffer(*device, byte_size);
+    slot.transfer_buffer = Gpu::TransferBuffer(*device, byte_size);
+    slot.capacity = new_capacity;
+}
+
+Gpu::Fence &RenderQueue::BeginFrame()
+{
+    assert(!cur_slot && "Forgot to call `RenderQueue::EndFrame()`.");
+
+    // Look for a free slot, starting from the one after the last used slot.
+    for (std::size_t i = 0; i < slots.size(); i++)
+    {
+        std::size_t index = (cur_slot_index + 1 + i) % slots.size();
+        Slot &slot = slots[index];
+        if (slot.last_command_buffer == 0 || fences->IsDone(slot.last_command_buffer))
+        {
+            cur_slot_index = index;
+            cur_slot = &slot;
+            break;
+        }
+    }
+
+    // All slots are in flight, add a new one.
+    if (!cur_slot)
+    {
+        cur_slot_index = slots.size();
+        cur_slot = &slots.emplace_back();
+        EnsureCapacity(*cur_slot, initial_capacity);
+    }
+
+    Gpu::FencePool::Added added = fences->Add();
+    cur_slot->last_command_buffer = added.id;
+    return *added.fence;
+}
+
+std::size_t RenderQueue::FindBatch(fvec2 rect_min, fvec2 rect_max, const RenderState &state, bool opaque)
+{
+    // Walk the batches backwards, looking for one with the same state. Stop at the first batch that overlaps this rect,
+    //   since we can't draw the rect before it.
+    std::size_t batch_index = batches.size();
+    for (std::size_t i = 0; i < std::min(batches.size(), max_batch_lookback); i++)
+    {
+        const Batch &batch = batches[batches.size() - 1 - i];
+        if (batch.custom_draw)
+            break;
+
+        if (batch.state == state && batch.opaque == opaque)
+        {
+            batch_index = batches.size() - 1 - i;
+            break;
+        }
+
+        bool overlaps =
+            rect_min.x < batch.bounds_max.x && batch.bounds_min.x < rect_max.x &&
+            rect_min.y < batch.bounds_max.y && batch.bounds_min.y < rect_max.y;
+        if (overlaps)
+            break;
+    }
+
+    if (batch_index == batches.size())
+    {
+        batches.push_back({
+            .state = state,
+            .bounds_min = rect_min,
+            .bounds_max = rect_max,
+            .opaque = opaque,
+        });
+    }
+    else
+    {
+        Batch &batch = batches[batch_index];
+        batch.bounds_min = fvec2(std::min(batch.bounds_min.x, rect_min.x), std::min(batch.bounds_min.y, rect_min.y));
+        batch.bounds_max = fvec2(std::max(batch.bounds_max.x, rect_max.x), std::max(batch.bounds_max.y, rect_max.y));
+    }
+
+    return batch_index;
+}
+
+void RenderQueue::Insert(const RectInstance &rect, const RenderState &state)
+{
+    Insert(std::span(&rect, 1), state);
+}
+
+void RenderQueue::Insert(std::span<const RectInstance> new_rects, const RenderState &state)
+{
+    assert(state.pipeline && state.texture && state.sampler && "Incomplete render state.");
+
+    // The bounds of the rects that survive the culling.
+    fvec2 rect_min(std::numeric_limits<float>::infinity());
+    fvec2 rect_max(-std::numeric_limits<float>::infinity());
+    std::size_t num_kept = 0;
+    // The whole span is opaque only if every kept rect is.
+    bool opaque = bool(opacity_test);
+    for (const RectInstance &rect : new_rects)
+    {
+        // See `main.frag`: the output is zero if the mixed alpha is zero, which we know without the texture only if neither the color nor the texture contribute to it.
+        if (rect.color.w == 0 && rect.factors.y == 0)
+        {
+            cur_stats.num_transparent++;
+            continue;
+        }
+
+        // The size can be negative, so we can't just add it to the position.
+        fvec2 pos = rect.pos.to<float>();
+        fvec2 end = pos + rect.size.to<float>();
+        fvec2 this_min(std::min(pos.x, end.x), std::min(pos.y, end.y));
+        fvec2 this_max(std::max(pos.x, end.x), std::max(pos.y, end.y));
+
+        if (this_max.x <= cull_min.x || this_max.y <= cull_min.y || this_min.x >= cull_max.x || this_min.y >= cull_max.y)
+        {
+            cur_stats.num_offscreen++;
+            continue;
+        }
+
+        rect_min = fvec2(std::min(rect_min.x, this_min.x), std::min(rect_min.y, this_min.y));
+        rect_max = fvec2(std::max(rect_max.x, this_max.x), std::max(rect_max.y, this_max.y));
+        if (opaque && !opacity_test(rect, state))
+            opaque = false;
+
+        rects.push_back(rect);
+        num_kept++;
+    }
+
+    if (num_kept == 0)
+        return;
+
+    std::size_t batch_index = FindBatch(rect_min, rect_max, state, opaque);
+
+    batches[batch_index].count += std::uint32_t(num_kept);
+    rect_batches.insert(rect_batches.end(), num_kept, std::uint32_t(batch_index));
+    cur_stats.num_rects += std::uint32_t(num_kept);
+    if (opaque)
+        cur_stats.num_opaque += std::uint32_t(num_kept);
+}
+
+void RenderQueue::InsertCustom(std::function<void(Gpu::RenderPass &pass)> draw)
+{
+    assert(draw && "The custom draw function is null.");
+    batches.push_back({.custom_draw = std::move(draw)});
+}
+
+void RenderQueue::Upload(Gpu::CopyPass &pass)
+{
+    assert(cur_slot && "Must call `RenderQueue::BeginFrame()` first.");
+
+    num_uploaded_rects = std::uint32_t(rects.size());
+    if (num_uploaded_rects == 0)
+        return;
+
+    EnsureCapacity(*cur_slot, num_uploaded_rects);
+
+    std::uint32_t byte_size = num_uploaded_rects * std::uint32_t(sizeof(RectInstance));
+
+    // Assign consecutive ranges to the batches.
+    std::uint32_t offset = 0;
+    for (Batch &batch : batches)
+    {
+        batch.offset = offset;
+        offset += batch.count;
+    }
+
+    { // Copy to the transfer buffer, sorting by batch. This is a stable counting sort, so each batch keeps the insertion order,
+        //   except that the opaque batches are reversed, so that `DrawWithDepth()` draws them front to back.
+        Gpu::TransferBuffer::Mapping mapping = cur_slot->transfer_buffer.Map();
+        RectInstance *dest = reinterpret_cast<RectInstance *>(mapping.Span().data());
+
+        // Reusing the offsets as the insertion positions (one past the position for the opaque batches), then restoring them below.
+        for (Batch &batch : batches)
+        {
+            if (batch.opaque)
+                batch.offset += batch.count;
+        }
+        for (std::size_t i = 0; i < rects.size(); i++)
+        {
+            Batch &batch = batches[rect_batches[i]];
+            RectInstance *target = batch.opaque ? dest + --batch.offset : dest + batch.offset++;
+            std::memcpy(target, &rects[i], sizeof(RectInstance));
+            // The later rects are closer. Counting from 1, since 0 is the far plane that the depth target is cleared to.
+            target->order = std::uint32_t(i + 1);
+        }
+        for (Batch &batch : batches)
+        {
+            if (!batch.opaque)
+                batch.offset -= batch.count;
+        }
+    }
+
+    cur_slot->transfer_buffer.ApplyToBuffer(pass, 0, cur_slot->buffer, 0, byte_size);
+}
+
+void RenderQueue::Draw(Gpu::RenderPass &pass)
+{
+    assert(cur_slot && "Must call `RenderQueue::BeginFrame()` first.");
+
+    // Only rebinding what has changed since the previous batch.
+    const RenderState *prev_state = nullptr;
+    for (const Batch &batch : batches)
+    {
+        if (batch.custom_draw)
+        {
+            batch.custom_draw(pass);
+            // It could've bound anything, so rebind everything for the next batch.
+            prev_state = nullptr;
+            continue;
+        }
+
+        // After a custom draw or at the beginning.
+        if (!prev_state)
+            pass.BindVertexBuffers({{{.buffer = &cur_slot->buffer}}});
+
+        if (!prev_state || prev_state->pipeline != batch.state.pipeline)
+            pass.BindPipeline(*batch.state.pipeline);
+        if (!prev_state || prev_state->texture != batch.state.texture || prev_state->sampler != batch.state.sampler)
+            pass.BindTextures({{{.texture = batch.state.texture, .sampler = batch.state.sampler}}});
+        prev_state = &batch.state;
+
+        pass.DrawPrimitivesInstanced(6, batch.count, 0, batch.offset); // 6 vertices per rect, the vertex shader generates the corners.
+    }
+}
+
+bool RenderQueue::CanDrawWithDepth(std::span<const DepthPipelines> pipelines) const
+{
+    return std::all_of(batches.begin(), batches.end(), [&](const Batch &batch)
+    {
+        return !batch.custom_draw && std::any_of(pipelines.begin(), pipelines.end(), [&](const DepthPipelines &p){return p.normal == batch.state.pipeline;});
+    });
+}
+
+void RenderQueue::DrawWithDepth(Gpu::RenderPass &pass, std::span<const DepthPipelines> pipelines)
+{
+    assert(cur_slot && "Must call `RenderQueue::BeginFrame()` first.");
+
+    if (batches.empty())
+        return;
+
+    pass.BindVertexBuffers({{{.buffer = &cur_slot->buffer}}});
+
+    // Only rebinding what has changed since the previous batch.
+    const Batch *prev_batch = nullptr;
+    Gpu::Pipeline *prev_pipeline = nullptr;
+    auto DrawBatch = [&](const Batch &batch)
+    {
+        assert(!batch.custom_draw && "Must check `RenderQueue::CanDrawWithDepth()` first.");
+
+        // There are only a few of those, a linear search is fine.
+        auto it = std::find_if(pipelines.begin(), pipelines.end(), [&](const DepthPipelines &p){return p.normal == batch.state.pipeline;});
+        assert(it != pipelines.end() && "Must check `RenderQueue::CanDrawWithDepth()` first.");
+        Gpu::Pipeline *pipeline = batch.opaque ? it->opaque : it->translucent;
+
+        if (pipeline != prev_pipeline)
+            pass.BindPipeline(*pipeline);
+        prev_pipeline = pipeline;
+        if (!prev_batch || prev_batch->state.texture != batch.state.texture || prev_batch->state.sampler != batch.state.sampler)
+            pass.BindTextures({{{.texture = batch.state.texture, .sampler = batch.state.sampler}}});
+        prev_batch = &batch;
+
+        pass.DrawPrimitivesInstanced(6, batch.count, 0, batch.offset);
+    };
+
+    // The opaque batches front to back. The order between them only matters for how much the depth test rejects.
+    for (auto it = batches.rbegin(); it != batches.rend(); ++it)
+    {
+        if (it->opaque)
+            DrawBatch(*it);
+    }
+    // Then the rest in the painter's order. The depth test hides the parts that are behind the opaque rects.
+    for (const Batch &batch : batches)
+    {
+        if (!batch.opaque)
+            DrawBatch(batch);
+    }
+}
+
+std::optional<std::uint64_t> RenderQueue::ContentHash() const
+{
+    // One multiplication per 8 bytes, since this runs every frame over all rects. This doesn't need to be good, a rare collision only shows a stale frame.
+    std::uint64_t hash = 0xcbf29ce484222325;
+    auto Mix = [&](std::uint64_t value)
+    {
+        hash = (hash ^ value) * 0x9e3779b97f4a7c15;
+        hash ^= hash >> 32;
+    };
+
+    for (const Batch &batch : batches)
+    {
+        if (batch.custom_draw)
+            return std::nullopt;
+        Mix(std::uint64_t(std::uintptr_t(batch.state.pipeline)));
+        Mix(std::uint64_t(std::uintptr_t(batch.state.texture)));
+        Mix(std::uint64_t(std::uintptr_t(batch.state.sampler)));
+        Mix(batch.count);
+        Mix(batch.opaque);
+    }
+
+    for (std::uint32_t batch_index : rect_batches)
+        Mix(batch_index);
+
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(rects.data());
+    std::size_t num_bytes = rects.size() * sizeof(RectInstance);
+    std::size_t i = 0;
+    for (; i + 8 <= num_bytes; i += 8)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, bytes + i, 8);
+        Mix(word);
+    }
+    if (i < num_bytes)
+    {
+        std::uint64_t word = 0;
+        std::memcpy(&word, bytes + i, num_bytes - i);
+        Mix(word);
+    }
+
+    return hash;
+}
+
+void RenderQueue::EndFrame()
+{
+    cur_stats.num_batches = std::uint32_t(batches.size());
+    last_frame_stats = std::exchange(cur_stats, {});
+
+    // This keeps the capacity, so we don't reallocate every frame.
+    rects.clear();
+    rect_batches.clear();
+    batches.clear();
+    num_uploaded_rects = 0;
+    cur_slot = nullptr;
+}
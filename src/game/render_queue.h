@@ -0,0 +1,232 @@
+#pragma once
+
+#include "em/math/vector.h"
+#include "gpu/buffer.h"
+#include "gpu/fence_pool.h"
+#include "gpu/transfer_buffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace em::Gpu
+{
+    class CopyPass;
+    class Device;
+    class Pipeline;
+    class RenderPass;
+    class Sampler;
+    class Texture;
+}
+
+using namespace em;
+
+// One rectangle to draw. One of those is uploaded per rect, and the vertex shader expands it into a quad (as an instance of 6 vertices).
+// Everything we draw is in whole pixels and the colors are 8-bit, so this is packed into 28 bytes. Use the `Pack...()` functions below to fill it.
+struct RectInstance
+{
+    vec2<std::int16_t> pos;
+    vec2<std::int16_t> size;
+    vec2<std::int16_t> tex_pos;
+    vec2<std::int16_t> tex_size; // Normally same as `size`. The X component is negative when flipped horizontally.
+    vec4<std::uint8_t> color; // Normalized, 255 is 1.
+    vec4<std::uint8_t> factors; // Same. See `DrawSettings`. The last component is unused.
+    // Leave this at zero. `RenderQueue::Upload()` writes the insertion order here, which the vertex shader turns into the depth.
+    std::uint32_t order = 0;
+};
+static_assert(sizeof(RectInstance) == 28, "The vertex attributes in `Renderer` assume there's no padding.");
+
+// For the coordinates in `RectInstance`. Clamps to the range of `int16_t`, which is far outside of the screen anyway.
+[[nodiscard]] inline vec2<std::int16_t> PackRectCoords(ivec2 value)
+{
+    return value.map([](int x){return std::int16_t(std::clamp(x, -32768, 32767));});
+}
+
+// For the colors and factors in `RectInstance`. Clamps to 0..1.
+[[nodiscard]] inline vec4<std::uint8_t> PackUnorm8(fvec4 value)
+{
+    return value.map([](float x){return std::uint8_t(std::round(std::clamp(x, 0.f, 1.f) * 255));});
+}
+
+// What a rect needs bound to be drawn. Rects with equal states can be drawn with one draw call.
+struct RenderState
+{
+    // Must use the `RectInstance` vertex layout.
+    Gpu::Pipeline *pipeline = nullptr;
+    // The texture for fragment slot 0.
+    Gpu::Texture *texture = nullptr;
+    Gpu::Sampler *sampler = nullptr;
+
+    [[nodiscard]] friend bool operator==(const RenderState &, const RenderState &) = default;
+};
+
+// Collects rects for a frame, then uploads them all at once and draws them.
+// The rects are accumulated on the CPU, so the queue never needs to be flushed in the middle of a frame.
+// The rects are grouped into batches by their `RenderState`, one draw call per batch. A rect can join an earlier batch with the same state
+//   (i.e. be drawn earlier than it was inserted) only if it doesn't overlap any of the batches between them, so the painter's order is preserved
+//   wherever it's visible.
+// The rects entirely outside of the cull bounds (normally the screen), and the fully transparent rects, are dropped right away.
+// The rects that the opacity test (see `SetOpacityTest()`) marks as opaque go to separate batches. `DrawWithDepth()` draws those front to back
+//   with the depth writes, and then the rest back to front with the depth test only, so the hidden parts of the opaque rects are never shaded.
+// The GPU side is a ring of buffers, normally one per frame in flight. A slot is reused only after the command buffer that used it
+//   has finished executing (we track this with a fence from a `FencePool`). If all slots are busy, we add a new one. If a frame needs more space than the slot has,
+//   the slot is reallocated with a larger size.
+class RenderQueue
+{
+  public:
+    // The counts for one frame.
+    struct Stats
+    {
+        // The rects that will be drawn.
+        std::uint32_t num_rects = 0;
+        // Out of those, the ones in the opaque batches.
+        std::uint32_t num_opaque = 0;
+        // The rects that were dropped.
+        std::uint32_t num_offscreen = 0;
+        std::uint32_t num_transparent = 0;
+        // The draw calls, including the custom ones.
+        std::uint32_t num_batches = 0;
+    };
+
+    // For `DrawWithDepth()`: the batches that use `normal` are drawn with `opaque` or `translucent` instead.
+    // Both must have the `RectInstance` layout and the depth test, `opaque` with the depth writes and without blending,
+    //   `translucent` with `LESS_OR_EQUAL` and without the depth writes.
+    struct DepthPipelines
+    {
+        const Gpu::Pipeline *normal = nullptr;
+        Gpu::Pipeline *opaque = nullptr;
+        Gpu::Pipeline *translucent = nullptr;
+    };
+
+  private:
+    struct Slot
+    {
+        Gpu::Buffer buffer;
+        Gpu::TransferBuffer transfer_buffer;
+        // Measured in rects.
+        std::uint32_t capacity = 0;
+
+        // The command buffer that used this slot last, or zero if never used.
+        Gpu::FencePool::Id last_command_buffer = 0;
+    };
+
+    Gpu::Device *device = nullptr;
+    Gpu::FencePool *fences = nullptr;
+
+    // A deque, so that adding a slot doesn't move `*cur_slot`.
+    std::deque<Slot> slots;
+    // The last used slot, to cycle through them in order.
+    std::size_t cur_slot_index = 0;
+    // The slot for the current frame, or null if `BeginFrame()` wasn't called yet.
+    Slot *cur_slot = nullptr;
+
+    // The new slots start with this capacity, measured in rects.
+    std::uint32_t initial_capacity = 0;
+
+    struct Batch
+    {
+        RenderState state;
+        // The bounding box of all rects in this batch, in screen coordinates.
+        fvec2 bounds_min;
+        fvec2 bounds_max;
+        // The number of rects.
+        std::uint32_t count = 0;
+        // The index of the first rect in the uploaded buffer. This is computed by `Upload()`.
+        std::uint32_t offset = 0;
+        // Whether all rects here passed the opacity test. Those batches are uploaded in the reverse order, to be drawn front to back.
+        bool opaque = false;
+
+        // If not null, this is a custom batch from `InsertCustom()`, and everything above is ignored.
+        std::function<void(Gpu::RenderPass &pass)> custom_draw;
+    };
+
+    // How many batches back we look for a matching one, before giving up and starting a new batch.
+    // A larger value means less draw calls in exchange for more CPU work per rect.
+    static constexpr std::size_t max_batch_lookback = 16;
+
+    // The rects for the current frame, in the insertion order.
+    std::vector<RectInstance> rects;
+    // For each rect, the index of its batch.
+    std::vector<std::uint32_t> rect_batches;
+    // The batches for the current frame, in the drawing order.
+    std::vector<Batch> batches;
+
+    // The number of rects uploaded in the current frame.
+    std::uint32_t num_uploaded_rects = 0;
+
+    // The rects entirely outside of this are dropped. No culling by default.
+    fvec2 cull_min = fvec2(-std::numeric_limits<float>::infinity());
+    fvec2 cull_max = fvec2(std::numeric_limits<float>::infinity());
+
+    // See `SetOpacityTest()`.
+    std::function<bool(const RectInstance &rect, const RenderState &state)> opacity_test;
+
+    Stats cur_stats;
+    Stats last_frame_stats;
+
+    void EnsureCapacity(Slot &slot, std::uint32_t num_rects);
+
+    // Finds or adds a batch for rects with `state` and `opaque`, and the bounding box from `rect_min` to `rect_max`, and extends its bounds.
+    [[nodiscard]] std::size_t FindBatch(fvec2 rect_min, fvec2 rect_max, const RenderState &state, bool opaque);
+
+  public:
+    RenderQueue() {}
+
+    // The frame fences come from `fences`, which must outlive this.
+    RenderQueue(Gpu::Device &device, Gpu::FencePool &fences, std::uint32_t initial_capacity);
+
+    // The rects that don't overlap this rectangle are dropped by `Insert()`. The custom draws are never culled.
+    void SetCullBounds(fvec2 min, fvec2 max) {cull_min = min; cull_max = max;}
+
+    // Should return true if `rect` completely covers its area with alpha 1, so that nothing behind it is visible.
+    // Those rects are drawn in the opaque pass of `DrawWithDepth()`. If this isn't set, nothing is opaque.
+    void SetOpacityTest(std::function<bool(const RectInstance &rect, const RenderState &state)> test) {opacity_test = std::move(test);}
+
+    // Call this once at the beginning of each frame.
+    // This picks a free slot, and adds a fence to `fences`. The returned fence must be passed to the command buffer that will draw this frame.
+    // If the command buffer is cancelled instead, that's fine too.
+    [[nodiscard]] Gpu::Fence &BeginFrame();
+
+    // Adds a rect to the current frame.
+    void Insert(const RectInstance &rect, const RenderState &state);
+    // Adds several rects with the same state. They all go to the same batch, which is chosen using their common bounding box.
+    // This is cheaper than inserting them one by one, but can give more batches if the rects are spread out.
+    void Insert(std::span<const RectInstance> new_rects, const RenderState &state);
+    // Adds a custom draw, which is called by `Draw()` at this point in the painter's order. It can bind anything it wants.
+    // The rects inserted after this are never moved before it, since we don't know what it covers.
+    void InsertCustom(std::function<void(Gpu::RenderPass &pass)> draw);
+
+    // Uploads all rects inserted so far. Call this once per frame, after inserting all rects.
+    void Upload(Gpu::CopyPass &pass);
+
+    // Draws the uploaded rects. This binds the pipelines and the textures itself, but the uniforms must already be set.
+    void Draw(Gpu::RenderPass &pass);
+
+    // Whether `DrawWithDepth()` can be used for the current frame: every batch must use one of the `DepthPipelines::normal`, and there must be no custom draws.
+    [[nodiscard]] bool CanDrawWithDepth(std::span<const DepthPipelines> pipelines) const;
+    // Same as `Draw()`, but for a pass with a depth target cleared to 1. Check `CanDrawWithDepth()` first.
+    // The pipelines of the batches are replaced according to `pipelines`.
+    void DrawWithDepth(Gpu::RenderPass &pass, std::span<const DepthPipelines> pipelines);
+
+    // A hash of everything inserted in the current frame, or null if there was an `InsertCustom()`, since we can't know what that draws.
+    // If two frames have the same hash, they draw the same image, as long as the textures and the pipelines didn't change in between.
+    [[nodiscard]] std::optional<std::uint64_t> ContentHash() const;
+
+    // Forgets the rects of the current frame. Call this at the end of each frame, even if nothing was drawn.
+    void EndFrame();
+
+    // The number of slots in the ring. This is normally the number of frames in flight.
+    [[nodiscard]] std::size_t NumSlots() const {return slots.size();}
+    // The number of draw calls in the current frame.
+    [[nodiscard]] std::size_t NumBatches() const {return batches.size();}
+    // The counts as of the last `EndFrame()`.
+    [[nodiscard]] const Stats &LastFrameStats() const {return last_frame_stats;}
+};
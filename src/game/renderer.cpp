@@ -0,0 +1,629 @@
+#include "renderer.h"
+
+#include "em/macros/utils/finally.h"
+#include "game/baked_image.h"
+#include "game/gpu_particles.h"
+#include "game/main.h"
+#include "game/timings.h"
+#include "game/world.h"
+#include "gpu/command_buffer.h"
+#include "gpu/copy_pass.h"
+#include "gpu/device.h"
+#include "gpu/render_pass.h"
+#include "utils/filesystem.h"
+#include "utils/trace.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+static Renderer *global_renderer = nullptr;
+
+// Loads and validates `assets/images/<filename>.image` into `file`, and returns its pixels. Writes the image size to `size`.
+static std::span<const unsigned char> LoadImagePixels(std::string_view filename, Filesystem::LoadedFile &file, ivec2 &size)
+{
+    std::string path = fmt::format("{}assets/images/{}.image", Filesystem::GetResourceDir(), filename);
+    // Mapped, or from the asset pack if it's mounted.
+    file = Filesystem::LoadedFile(path, Filesystem::LoadMode::map);
+
+    BakedImageHeader header;
+    if (file.size() < sizeof header)
+        throw std::runtime_error(fmt::format("The image `{}` is too small to be valid.", path));
+    std::memcpy(&header, file.data(), sizeof header);
+    if (!header.IsValid())
+        throw std::runtime_error(fmt::format("The image `{}` has an invalid header or an outdated version. Rebuild the assets.", path));
+    if (file.size() - sizeof header != header.PixelDataSize())
+        throw std::runtime_error(fmt::format("The image `{}` has the wrong size for its header.", path));
+
+    size = ivec2(int(header.width), int(header.height));
+    return std::span<const unsigned char>(file).subspan(sizeof header);
+}
+
+Gpu::Texture LoadImage(Gpu::Device &device, Gpu::CopyPass &pass, Gpu::UploadArena &arena, std::string_view filename, OpacityMap *opacity)
+{
+    Filesystem::LoadedFile file;
+    ivec2 size;
+    std::span<const unsigned char> pixels = LoadImagePixels(filename, file, size);
+
+    Gpu::Texture tex(device, Gpu::Texture::Params{
+        .size = size.to_vec3(1),
+    });
+    // This is the only copy we make, from the mapped file into the transfer buffer.
+    arena.UploadToTexture(pass, pixels, tex);
+    if (opacity)
+        *opacity = OpacityMap(pixels, size);
+    return tex;
+}
+
+Gpu::Texture LoadImage(Gpu::Device &device, Gpu::UploadQueue &queue, std::string_view filename, Gpu::UploadQueue::Id *id, OpacityMap *opacity)
+{
+    Filesystem::LoadedFile file;
+    ivec2 size;
+    std::span<const unsigned char> pixels = LoadImagePixels(filename, file, size);
+
+    Gpu::Texture tex(device, Gpu::Texture::Params{
+        .size = size.to_vec3(1),
+    });
+    // Staged right away, so the file can be unmapped when we return.
+    Gpu::UploadQueue::Id upload_id = queue.UploadToTexture(pixels, tex);
+    if (id)
+        *id = upload_id;
+    if (opacity)
+        *opacity = OpacityMap(pixels, size);
+    return tex;
+}
+
+std::string ShaderPath(std::string_view name, std::string_view variant, std::string_view stage)
+{
+    if (variant.empty())
+        return fmt::format("{}assets/shaders/{}.{}.spv", Filesystem::GetResourceDir(), name, stage);
+    else
+        return fmt::format("{}assets/shaders/{}.{}.{}.spv", Filesystem::GetResourceDir(), name, variant, stage);
+}
+
+ShaderPair::ShaderPair(Gpu::Device &device, std::string_view name, std::string_view frag_variant)
+    : vert(device, fmt::format("{} (vertex)", name), Gpu::Shader::Stage::vertex, Filesystem::LoadedFile(ShaderPath(name, {}, "vert"), Filesystem::LoadMode::map)),
+    frag(device, frag_variant.empty() ? fmt::format("{} (fragment)", name) : fmt::format("{} (fragment, {})", name, frag_variant), Gpu::Shader::Stage::fragment, Filesystem::LoadedFile(ShaderPath(name, frag_variant, "frag"), Filesystem::LoadMode::map))
+{}
+
+App::JobSystem::Handle CreatePipelineAsync(App::JobSystem &jobs, Gpu::Device &device, std::shared_ptr<ShaderPipeline> &result, std::string name, Gpu::Pipeline::Params params, std::string frag_variant)
+{
+    result = std::make_shared<ShaderPipeline>();
+    return jobs.Add([&device, result, name = std::move(name), params = std::move(params), frag_variant = std::move(frag_variant)]() mutable
+    {
+        EM_TRACE_ZONE("CreatePipelineAsync");
+
+        result->shaders = ShaderPair(device, name, frag_variant);
+        params.shaders = result->shaders;
+        result->pipeline = Gpu::Pipeline(device, params);
+    });
+}
+
+Renderer::Renderer(Gpu::Device &device, App::JobSystem &jobs, SDL_GPUTextureFormat target_format)
+    : device(&device),
+    target_format(target_format),
+    sampler_nearest(device, Gpu::Sampler::Params{
+        .filter_min = Gpu::Sampler::Filter::nearest,
+        .filter_mag = Gpu::Sampler::Filter::nearest,
+    }),
+    target(device, Gpu::Texture::Params{
+        .format = target_format,
+        .usage = Gpu::Texture::UsageFlags::sampler | Gpu::Texture::UsageFlags::color_target,
+        .size = screen_size.to_vec3(1),
+    }),
+    depth_target(device, Gpu::Texture::Params{
+        .format = depth_target_format,
+        .usage = Gpu::Texture::UsageFlags::depth_stencil_target,
+        .size = screen_size.to_vec3(1),
+    }),
+    texture_pool(device, frame_fences),
+    upload_arena(device, frame_fences),
+    render_queue(device, frame_fences, 1024)
+{
+    assert(!global_renderer && "Only one renderer can exist at a time.");
+
+    // The screen coordinates have the origin in the middle. Most of what this culls are the particles that flew away.
+    render_queue.SetCullBounds((-screen_size / 2).to<float>(), (screen_size / 2).to<float>());
+    render_queue.SetOpacityTest([this](const RectInstance &rect, const RenderState &state){return IsOpaque(rect, state);});
+
+    main_pipeline_params = Gpu::Pipeline::Params{
+        .vertex_buffers = {
+            {
+                Gpu::Pipeline::VertexBuffer{
+                    .pitch = sizeof(RectInstance),
+                    .per_instance = true,
+                    .attributes = {
+                        Gpu::Pipeline::VertexAttribute{
+                            .format = SDL_GPU_VERTEXELEMENTFORMAT_SHORT2,
+                            .byte_offset_in_elem = offsetof(RectInstance, pos),
+                        },
+                        Gpu::Pipeline::VertexAttribute{
+                            .format = SDL_GPU_VERTEXELEMENTFORMAT_SHORT2,
+                            .byte_offset_in_elem = offsetof(RectInstance, size),
+                        },
+                        Gpu::Pipeline::VertexAttribute{
+                            .format = SDL_GPU_VERTEXELEMENTFORMAT_SHORT2,
+                            .byte_offset_in_elem = offsetof(RectInstance, tex_pos),
+                        },
+                        Gpu::Pipeline::VertexAttribute{
+                            .format = SDL_GPU_VERTEXELEMENTFORMAT_SHORT2,
+                            .byte_offset_in_elem = offsetof(RectInstance, tex_size),
+                        },
+                        Gpu::Pipeline::VertexAttribute{
+                            .format = SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM,
+                            .byte_offset_in_elem = offsetof(RectInstance, color),
+                        },
+                        Gpu::Pipeline::VertexAttribute{
+                            .format = SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM,
+                            .byte_offset_in_elem = offsetof(RectInstance, factors),
+                        },
+                        Gpu::Pipeline::VertexAttribute{
+                            .format = SDL_GPU_VERTEXELEMENTFORMAT_UINT,
+                            .byte_offset_in_elem = offsetof(RectInstance, order),
+                        },
+                    }
+                }
+            }
+        },
+        .targets = {
+            .color = {
+                Gpu::Pipeline::ColorTarget{
+                    .texture_format = target_format,
+                    .blending = Gpu::Pipeline::Blending::Premultiplied(),
+                },
+            },
+        },
+    };
+
+    // The opaque rects overwrite everything behind them, so they don't need blending.
+    opaque_pipeline_params = main_pipeline_params;
+    opaque_pipeline_params.targets.color.front().blending = std::nullopt;
+    opaque_pipeline_params.targets.depth_stencil_format = depth_target_format;
+    opaque_pipeline_params.depth = Gpu::Pipeline::Depth{.depth_pass_condition = SDL_GPU_COMPAREOP_LESS, .write_depth = true};
+
+    // The translucent rects are drawn in the painter's order as usual, only hidden by the opaque ones in front of them.
+    // "Or equal" because the depth saturates on very large frames, see `main.vert`.
+    translucent_pipeline_params = main_pipeline_params;
+    translucent_pipeline_params.targets.depth_stencil_format = depth_target_format;
+    translucent_pipeline_params.depth = Gpu::Pipeline::Depth{.depth_pass_condition = SDL_GPU_COMPAREOP_LESS_OR_EQUAL, .write_depth = false};
+
+    // Compile the pipelines while we're loading the textures.
+    struct PipelineResults
+    {
+        std::shared_ptr<ShaderPipeline> normal, opaque, translucent;
+    };
+    std::array<PipelineResults, num_main_variants> pipeline_results;
+    std::vector<App::JobSystem::Handle> pipeline_jobs;
+    pipeline_jobs.reserve(num_main_variants * 3);
+    // If something throws, let the jobs finish before `device` can go away.
+    EM_FINALLY_ON_THROW{
+        for (const App::JobSystem::Handle &job : pipeline_jobs)
+            job.Wait();
+    };
+    for (std::size_t i = 0; i < num_main_variants; i++)
+    {
+        std::string variant(MainVariantName(MainVariant(i)));
+        pipeline_jobs.push_back(CreatePipelineAsync(jobs, device, pipeline_results[i].normal, "main", main_pipeline_params, variant));
+        pipeline_jobs.push_back(CreatePipelineAsync(jobs, device, pipeline_results[i].opaque, "main", opaque_pipeline_params, variant));
+        pipeline_jobs.push_back(CreatePipelineAsync(jobs, device, pipeline_results[i].translucent, "main", translucent_pipeline_params, variant));
+    }
+
+    {
+        Gpu::CommandBuffer cmdbuf(device);
+
+        {
+            Gpu::CopyPass pass(cmdbuf);
+            main_texture = LoadImage(device, pass, upload_arena, "texture", &main_texture_opacity);
+        }
+
+        // This needs `main_texture` to be uploaded first.
+        CompositeFramedImages(cmdbuf);
+    }
+
+    for (const App::JobSystem::Handle &job : pipeline_jobs)
+        job.Get();
+    for (std::size_t i = 0; i < num_main_variants; i++)
+    {
+        main_pipelines[i] = {
+            .normal = std::move(*pipeline_results[i].normal),
+            .opaque = std::move(*pipeline_results[i].opaque),
+            .translucent = std::move(*pipeline_results[i].translucent),
+        };
+    }
+
+    global_renderer = this;
+}
+
+Renderer::~Renderer()
+{
+    global_renderer = nullptr;
+}
+
+std::string_view Renderer::MainVariantName(MainVariant variant)
+{
+    switch (variant)
+    {
+      case MainVariant::mixed:        return "";
+      case MainVariant::color_only:   return "color_only";
+      case MainVariant::texture_only: return "texture_only";
+      case MainVariant::_count:       break;
+    }
+    return "";
+}
+
+void Renderer::CompositeFramedImages(Gpu::CommandBuffer &cmdbuf)
+{
+    static constexpr int texture_width = 1024;
+
+    // Pack the images into shelves. Each takes two slots side by side, see `FramedImage::pos`.
+    ivec2 cursor(0, 0);
+    int shelf_height = 0;
+    for (const TexRegion &image : World::FramedImages())
+    {
+        ivec2 slot_size = image.size + 2;
+        if (slot_size.x * 2 > texture_width)
+            throw std::runtime_error(fmt::format("The framed image at [{},{}] is too large to pre-composite.", image.pos.x, image.pos.y));
+
+        if (cursor.x + slot_size.x * 2 > texture_width)
+        {
+            cursor = ivec2(0, cursor.y + shelf_height);
+            shelf_height = 0;
+        }
+
+        framed_images.push_back({.source = image, .pos = cursor});
+        cursor.x += slot_size.x * 2;
+        shelf_height = std::max(shelf_height, slot_size.y);
+    }
+
+    ivec2 texture_size(texture_width, std::max(1, cursor.y + shelf_height));
+
+    // Draw the borders on the CPU. Everything else stays transparent for now.
+    std::vector<unsigned char> pixels(std::size_t(texture_size.prod() * 4));
+    auto DrawBorder = [&](ivec2 pos, ivec2 size)
+    {
+        auto SetBlack = [&](ivec2 pixel)
+        {
+            pixels[std::size_t(pixel.y * texture_size.x + pixel.x) * 4 + 3] = 255; // The color is already black.
+        };
+
+        for (int x = 0; x < size.x; x++)
+        {
+            SetBlack(pos + ivec2(x, 0));
+            SetBlack(pos + ivec2(x, size.y - 1));
+        }
+        for (int y = 1; y < size.y - 1; y++)
+        {
+            SetBlack(pos + ivec2(0, y));
+            SetBlack(pos + ivec2(size.x - 1, y));
+        }
+    };
+    for (const FramedImage &image : framed_images)
+    {
+        ivec2 slot_size = image.source.size + 2;
+        DrawBorder(image.pos, slot_size);
+        DrawBorder(image.pos + ivec2(slot_size.x, 0), slot_size);
+    }
+
+    texture_pool.Release(std::move(framed_images_texture));
+    framed_images_texture = texture_pool.Acquire(Gpu::Texture::Params{
+        .size = texture_size.to_vec3(1),
+    });
+
+    {
+        Gpu::CopyPass pass(cmdbuf);
+        upload_arena.UploadToTexture(pass, pixels, framed_images_texture);
+    }
+
+    { // The opacity of the result. The pixels were already copied by the upload, so we can fill the image alphas in place.
+        for (const FramedImage &image : framed_images)
+        {
+            for (int y = 0; y < image.source.size.y; y++)
+            {
+                for (int x = 0; x < image.source.size.x; x++)
+                {
+                    ivec2 pixel = image.pos + 1 + ivec2(x, y);
+                    bool opaque = main_texture_opacity.IsOpaque(image.source.pos + ivec2(x, y), ivec2(1));
+                    pixels[std::size_t(pixel.y * texture_size.x + pixel.x) * 4 + 3] = opaque ? 255 : 0;
+                }
+            }
+        }
+        framed_images_opacity = OpacityMap(pixels, texture_size);
+    }
+
+    { // Copy the images into the borders. This is an exact copy, so drawing the result gives the same pixels as drawing the parts separately.
+        // Using a separate pass to make sure this happens after the upload above.
+        Gpu::CopyPass pass(cmdbuf);
+        for (const FramedImage &image : framed_images)
+        {
+            main_texture.CopyToTexture(pass, framed_images_texture, {
+                .source_pos = image.source.pos.to_vec3(0),
+                .target_pos = (image.pos + 1).to_vec3(0),
+                .size = image.source.size.to_vec3(1),
+            });
+        }
+    }
+}
+
+void Renderer::ReloadMainTexture(Gpu::CommandBuffer &cmdbuf)
+{
+    Gpu::Texture new_texture;
+    OpacityMap new_opacity;
+    {
+        Gpu::CopyPass pass(cmdbuf);
+        new_texture = LoadImage(*device, pass, upload_arena, "texture", &new_opacity);
+    }
+    // SDL keeps the old texture alive until the frames in flight are done with it.
+    main_texture = std::move(new_texture);
+    main_texture_opacity = std::move(new_opacity);
+
+    framed_images.clear();
+    CompositeFramedImages(cmdbuf);
+
+    // Force a copy in `Render()`.
+    background_tile_tex_pos = ivec2(-1);
+}
+
+void Renderer::Render(Gpu::CommandBuffer &cmdbuf, World &world, Timings &timings, float alpha, const std::function<void()> &draw_overlay)
+{
+    // The textures that changed make the old image stale, even if the rects are the same.
+    bool textures_changed = false;
+
+    // Before `World::Render()`, since the framed images can move around in their texture.
+    if (std::exchange(main_texture_reload_requested, false))
+    {
+        textures_changed = true;
+        try
+        {
+            ReloadMainTexture(cmdbuf);
+        }
+        catch (std::exception &e)
+        {
+            fmt::print(stderr, "Unable to reload the texture, keeping the old one: {}\n", e.what());
+        }
+    }
+
+    { // Fill the render queue. This doesn't touch the GPU yet.
+        Timings::Scope scope(timings, TimingZone::world_render);
+        world.Render(alpha);
+        if (draw_overlay)
+            draw_overlay();
+    }
+
+    if (background_tile && wanted_background_tile_tex_pos != background_tile_tex_pos)
+        textures_changed = true;
+
+    { // Skip the GPU work if this frame would draw the same as the previous one.
+        std::optional<std::uint64_t> hash = reuse_unchanged_frames && !gpu_particles ? render_queue.ContentHash() : std::nullopt;
+        last_frame_reused = hash && hash == prev_content_hash && !textures_changed;
+        prev_content_hash = hash;
+        if (last_frame_reused)
+            return;
+    }
+
+    { // Upload the render queue.
+        Timings::Scope scope(timings, TimingZone::upload);
+        Gpu::CopyPass pass(cmdbuf);
+        render_queue.Upload(pass);
+        if (gpu_particles)
+            gpu_particles->Upload(pass);
+
+        // Update the background tile if needed. This happens rarely, normally only when loading a level.
+        if (background_tile && wanted_background_tile_tex_pos != background_tile_tex_pos)
+        {
+            main_texture.CopyToTexture(pass, background_tile, {
+                .source_pos = wanted_background_tile_tex_pos.to_vec3(0),
+                .size = background_tile.GetSize(),
+            });
+            background_tile_tex_pos = wanted_background_tile_tex_pos;
+        }
+    }
+
+    // This can't be in the copy pass or the render pass, it needs its own compute pass.
+    if (gpu_particles)
+        gpu_particles->Simulate(cmdbuf);
+
+    { // The render pass.
+        Timings::Scope scope(timings, TimingZone::main_pass);
+
+        std::array<RenderQueue::DepthPipelines, num_main_variants> depth_pipelines;
+        for (std::size_t i = 0; i < num_main_variants; i++)
+            depth_pipelines[i] = {.normal = &main_pipelines[i].normal.pipeline, .opaque = &main_pipelines[i].opaque.pipeline, .translucent = &main_pipelines[i].translucent.pipeline};
+
+        // The custom draws (the GPU particles) have their own pipelines without a depth target, then we fall back to drawing everything in the painter's order.
+        bool with_depth = render_queue.CanDrawWithDepth(depth_pipelines);
+
+        Gpu::RenderPass pass(cmdbuf, Gpu::RenderPass::Params{
+            .color_targets = {
+                Gpu::RenderPass::ColorTarget{
+                    .texture = {
+                        .texture = &target,
+                    },
+                },
+            },
+            .depth_stencil_target = with_depth ? std::optional(Gpu::RenderPass::DepthStencil{.texture = &depth_target}) : std::nullopt,
+        });
+
+        // The render queue binds the pipelines and the textures itself.
+        Gpu::Shader::SetUniform(cmdbuf, Gpu::Shader::Stage::vertex, 0, (screen_size * ivec2(1,-1)).to<float>());
+
+        if (with_depth)
+            render_queue.DrawWithDepth(pass, depth_pipelines);
+        else
+            render_queue.Draw(pass);
+    }
+
+    if (gpu_particles)
+        gpu_particles->EndFrame();
+}
+
+App::JobSystem::Handle Renderer::RenderAsync(App::JobSystem &jobs, World &world, Timings &timings, float alpha, std::function<void()> draw_overlay)
+{
+    return jobs.Add([this, &world, &timings, alpha, draw_overlay = std::move(draw_overlay)]
+    {
+        EM_TRACE_ZONE("Renderer::RenderAsync");
+
+        { // Submitted when this scope ends, before the job is marked as done.
+            Gpu::CommandBuffer cmdbuf(*device, &BeginFrame());
+            EM_FINALLY{ EndFrame(); };
+            Render(cmdbuf, world, timings, alpha, draw_overlay);
+        }
+        texture_pool.EndFrame();
+        upload_arena.EndFrame();
+    });
+}
+
+bool Renderer::IsOpaque(const RectInstance &rect, const RenderState &state) const
+{
+    // The linear filtering could bleed in the neighboring texels.
+    if (!IsMainPipeline(state.pipeline) || state.sampler != &sampler_nearest)
+        return false;
+
+    // See `main.frag`: the output alpha is `mix(color.a, texture.a, factors.y) * factors.z`.
+    if (rect.factors.z != 255)
+        return false;
+    if (rect.factors.y == 0)
+        return rect.color.w == 255;
+    if (rect.factors.y != 255 && rect.color.w != 255)
+        return false;
+
+    // The texture must be opaque too.
+    if (state.texture == &background_tile)
+        return background_tile_opaque; // It repeats, so any region is the same.
+    const OpacityMap *opacity =
+        state.texture == &main_texture ? &main_texture_opacity :
+        state.texture == &framed_images_texture ? &framed_images_opacity : nullptr;
+    return opacity && opacity->IsOpaque(rect.tex_pos.to<int>(), rect.tex_size.to<int>());
+}
+
+bool Renderer::IsMainPipeline(const Gpu::Pipeline *pipeline) const
+{
+    return std::any_of(main_pipelines.begin(), main_pipelines.end(), [&](const MainPipelines &p){return &p.normal.pipeline == pipeline;});
+}
+
+Renderer::MainVariant Renderer::ChooseMainVariant(const RectInstance &rect)
+{
+    // Exactly 0 or 1 after packing, so `mix()` in the mixed variant would give the same result.
+    if (rect.factors.x == 0 && rect.factors.y == 0)
+        return MainVariant::color_only;
+    if (rect.factors.x == 255 && rect.factors.y == 255)
+        return MainVariant::texture_only;
+    return MainVariant::mixed;
+}
+
+const Renderer::FramedImage &Renderer::FindFramedImage(const TexRegion &source) const
+{
+    auto it = std::find_if(framed_images.begin(), framed_images.end(), [&](const FramedImage &image){return image.source == source;});
+    if (it == framed_images.end())
+        throw std::runtime_error(fmt::format("The image at [{},{}] wasn't pre-composited. Add it to `World::FramedImages()`.", source.pos.x, source.pos.y));
+    return *it;
+}
+
+void DrawRect(ivec2 pos, ivec2 size, const DrawSettings &settings)
+{
+    ivec2 tex_pos = settings.tex_pos;
+    ivec2 tex_size = size;
+    if (settings.flip_x)
+    {
+        tex_pos.x += tex_size.x;
+        tex_size.x = -tex_size.x;
+    }
+
+    RectInstance r{
+        .pos = PackRectCoords(pos),
+        .size = PackRectCoords(size),
+        .tex_pos = PackRectCoords(tex_pos),
+        .tex_size = PackRectCoords(tex_size),
+        .color = PackUnorm8(settings.color),
+        .factors = PackUnorm8(settings.factors.to_vec4(0)),
+    };
+
+    Renderer &renderer = *global_renderer;
+    Renderer::MainVariant variant = Renderer::ChooseMainVariant(r);
+
+    // The color-only rects don't sample anything, so they all get the same texture, to batch together.
+    bool use_texture = variant != Renderer::MainVariant::color_only;
+    renderer.render_queue.Insert(r, RenderState{
+        .pipeline = &renderer.MainPipeline(variant),
+        .texture = use_texture && settings.texture ? settings.texture : &renderer.main_texture,
+        .sampler = use_texture && settings.sampler ? settings.sampler : &renderer.sampler_nearest,
+    });
+}
+
+void DrawRects(std::span<const RectInstance> rects)
+{
+    if (rects.empty())
+        return;
+
+    // They all go into one batch, so they need a variant that works for all of them.
+    Renderer::MainVariant variant = Renderer::ChooseMainVariant(rects.front());
+    for (const RectInstance &rect : rects.subspan(1))
+    {
+        if (Renderer::ChooseMainVariant(rect) != variant)
+        {
+            variant = Renderer::MainVariant::mixed;
+            break;
+        }
+    }
+
+    global_renderer->render_queue.Insert(rects, RenderState{
+        .pipeline = &global_renderer->MainPipeline(variant),
+        .texture = &global_renderer->main_texture,
+        .sampler = &global_renderer->sampler_nearest,
+    });
+}
+
+void DrawGpuParticles(std::span<const GpuParticleSpawn> spawns, std::uint32_t num_ticks, bool clear)
+{
+    Renderer &r = *global_renderer;
+    if (!r.gpu_particles)
+        r.gpu_particles = std::make_unique<GpuParticles>(*r.device, r.target_format);
+
+    r.gpu_particles->Queue(spawns, num_ticks, clear);
+    r.render_queue.InsertCustom([&gpu_particles = *r.gpu_particles](Gpu::RenderPass &pass){gpu_particles.Draw(pass);});
+}
+
+void DrawFramedImage(ivec2 pos, const TexRegion &image, float alpha)
+{
+    const Renderer::FramedImage &framed = global_renderer->FindFramedImage(image);
+    DrawRect(pos - 1, image.size + 2, DrawSettings(framed.pos, alpha).UseTexture(global_renderer->framed_images_texture));
+}
+
+void DrawImageFrame(ivec2 pos, const TexRegion &image, float alpha)
+{
+    const Renderer::FramedImage &framed = global_renderer->FindFramedImage(image);
+    DrawRect(pos - 1, image.size + 2, DrawSettings(framed.pos + ivec2(image.size.x + 2, 0), alpha).UseTexture(global_renderer->framed_images_texture));
+}
+
+void DrawTiledBackground(ivec2 tile_tex_pos, ivec2 tile_size, ivec2 offset)
+{
+    Renderer &r = *global_renderer;
+
+    if (!r.background_tile || r.background_tile.GetSize().to_vec2() != tile_size)
+    {
+        // Through the pool, so that switching back and forth between the tile sizes doesn't create new textures.
+        r.texture_pool.Release(std::move(r.background_tile));
+        r.background_tile = r.texture_pool.Acquire(Gpu::Texture::Params{
+            .usage = Gpu::Texture::UsageFlags::sampler,
+            .size = tile_size.to_vec3(1),
+        });
+        r.background_tile_tex_pos = ivec2(-1); // Force a copy.
+    }
+    r.wanted_background_tile_tex_pos = tile_tex_pos;
+    r.background_tile_opaque = r.main_texture_opacity.IsOpaque(tile_tex_pos, tile_size);
+
+    // The default sampler wraps, so this repeats the tile over the screen. The texture coordinates are allowed to be negative.
+    DrawRect(-screen_size / 2, screen_size, DrawSettings(-offset).UseTexture(r.background_tile));
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "em/math/vector.h"
+#include "game/opacity_map.h"
+#include "game/render_queue.h"
+#include "game/tex_region.h"
+#include "gpu/fence_pool.h"
+#include "gpu/pipeline.h"
+#include "gpu/sampler.h"
+#include "gpu/shader.h"
+#include "gpu/texture.h"
+#include "gpu/texture_pool.h"
+#include "gpu/upload_arena.h"
+#include "gpu/upload_queue.h"
+#include "mainloop/job_system.h"
+
+#include <SDL3/SDL_gpu.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace em::Gpu
+{
+    class CommandBuffer;
+    class CopyPass;
+    class Device;
+    class Fence;
+}
+
+struct World;
+class GpuParticles;
+class Timings;
+
+using namespace em;
+
+// Loads `assets/images/<filename>.image`, which the build bakes from the `.png` with the same name. See `baked_image.h`.
+// The pixels are staged in `arena`. If `opacity` isn't null, it's filled from the same pixels.
+[[nodiscard]] Gpu::Texture LoadImage(Gpu::Device &device, Gpu::CopyPass &pass, Gpu::UploadArena &arena, std::string_view filename, OpacityMap *opacity = nullptr);
+// Same, but queues the upload in `queue` for its next `Submit()`, e.g. to stream the art in without stalling a frame. The texture is usable once that's submitted.
+// If `id` isn't null, it receives the id to pass to `queue.IsDone()`.
+[[nodiscard]] Gpu::Texture LoadImage(Gpu::Device &device, Gpu::UploadQueue &queue, std::string_view filename, Gpu::UploadQueue::Id *id = nullptr, OpacityMap *opacity = nullptr);
+
+// The path to `assets/shaders/<name>.<stage>.spv`, or `<name>.<variant>.<stage>.spv` if `variant` isn't empty.
+// The variants are compiled from the same source with different defines, see `SHADER_VARIANTS` in `project.mk`.
+[[nodiscard]] std::string ShaderPath(std::string_view name, std::string_view variant, std::string_view stage);
+
+// Loads `assets/shaders/<name>.{vert,frag}.spv`. If `frag_variant` isn't empty, the fragment shader is `<name>.<frag_variant>.frag.spv` instead.
+struct ShaderPair
+{
+    Gpu::Shader vert;
+    Gpu::Shader frag;
+
+    ShaderPair() {}
+
+    ShaderPair(Gpu::Device &device, std::string_view name, std::string_view frag_variant = {});
+
+    operator Gpu::Pipeline::Shaders()
+    {
+        return {
+            .vert = &vert,
+            .frag = &frag,
+        };
+    }
+};
+
+// A pipeline, together with the shaders it was created from.
+struct ShaderPipeline
+{
+    ShaderPair shaders;
+    Gpu::Pipeline pipeline;
+};
+
+// Loads the shaders called `name` (see `ShaderPair`) and creates a pipeline from them, as a job on `jobs`. `params.shaders` is ignored and replaced with the loaded shaders.
+// SDL lets us create GPU resources from any thread, so you can load other things on the main thread meanwhile.
+// The pipeline goes to `*result`, which this allocates, and which the job keeps alive. Don't touch it until the returned job is done, see `Handle::Get()`.
+[[nodiscard]] App::JobSystem::Handle CreatePipelineAsync(App::JobSystem &jobs, Gpu::Device &device, std::shared_ptr<ShaderPipeline> &result, std::string name, Gpu::Pipeline::Params params, std::string frag_variant = {});
+
+// Draws the world into a `screen_size` texture. This doesn't know about windows, so it also works headless.
+// `DrawRect()` and other functions from `main.h` draw using the current instance of this class. There can only be one at a time.
+class Renderer
+{
+  public:
+    struct FramedImage
+    {
+        // Where this came from in `main_texture`.
+        TexRegion source;
+        // The top-left corner of the border in `framed_images_texture`.
+        // The image with the border is here, and the border alone is to the right of it.
+        ivec2 pos;
+    };
+
+    // The variants of `main.frag`. `DrawRect()` picks the cheapest one that gives the same pixels, based on the mixing factors.
+    enum class MainVariant
+    {
+        mixed, // Anything.
+        color_only, // Doesn't sample the texture, `DrawSettings::factors` are zero.
+        texture_only, // Ignores the vertex color, the factors are one.
+        _count,
+    };
+    static constexpr std::size_t num_main_variants = std::size_t(MainVariant::_count);
+
+    // The fragment shader variant for `ShaderPair`.
+    [[nodiscard]] static std::string_view MainVariantName(MainVariant variant);
+
+    // One variant of the main shaders, in all the pipelines we need.
+    struct MainPipelines
+    {
+        // The rects refer to this one.
+        ShaderPipeline normal;
+        // For the two phases of `RenderQueue::DrawWithDepth()`, with the same shaders.
+        ShaderPipeline opaque;
+        ShaderPipeline translucent;
+    };
+
+    Gpu::Device *device = nullptr;
+
+    // The format of `target`.
+    SDL_GPUTextureFormat target_format{};
+
+    // Indexed by `MainVariant`.
+    std::array<MainPipelines, num_main_variants> main_pipelines;
+    // What `main_pipelines` were created with, to rebuild them when the shaders change. Those are the same for all variants.
+    Gpu::Pipeline::Params main_pipeline_params;
+    Gpu::Pipeline::Params opaque_pipeline_params;
+    Gpu::Pipeline::Params translucent_pipeline_params;
+
+    Gpu::Sampler sampler_nearest;
+
+    Gpu::Texture main_texture;
+    OpacityMap main_texture_opacity;
+
+    // The fences of our frames. `render_queue`, `texture_pool` and `upload_arena` use those to know when the GPU is done with their resources.
+    // `BeginFrame()` adds one for each frame, and retires the finished ones.
+    Gpu::FencePool frame_fences;
+
+    // The textures that get recreated with different sizes, `background_tile` and `framed_images_texture`, come from here.
+    // `RenderAsync()` ends its frame. If you call `Render()` directly, call `texture_pool.EndFrame()` after submitting the command buffer.
+    Gpu::TexturePool texture_pool;
+
+    // Our uploads are staged here, except for the per-frame rects that `render_queue` uploads from its own buffers.
+    // Same as `texture_pool`, `RenderAsync()` ends its frame, otherwise call `upload_arena.EndFrame()` yourself.
+    Gpu::UploadArena upload_arena;
+
+    // This is what we render to.
+    Gpu::Texture target;
+    // The depth for `RenderQueue::DrawWithDepth()`, same size as `target`. Its contents don't outlive the pass.
+    // SDL guarantees this format to be supported.
+    static constexpr SDL_GPUTextureFormat depth_target_format = SDL_GPU_TEXTUREFORMAT_D16_UNORM;
+    Gpu::Texture depth_target;
+
+    // The tile for `DrawTiledBackground()`, copied out of `main_texture` so that the sampler can repeat it.
+    Gpu::Texture background_tile;
+    // Where `background_tile` was copied from.
+    ivec2 background_tile_tex_pos = ivec2(-1);
+    // What `DrawTiledBackground()` asked for in the current frame. We copy the tile when this differs from the above.
+    ivec2 wanted_background_tile_tex_pos = ivec2(-1);
+    // Whether the tile at `wanted_background_tile_tex_pos` has no transparent pixels.
+    bool background_tile_opaque = false;
+
+    // The images from `World::FramedImages()`, pre-composited with their borders. See `DrawFramedImage()`.
+    Gpu::Texture framed_images_texture;
+    OpacityMap framed_images_opacity;
+    std::vector<FramedImage> framed_images;
+
+    RenderQueue render_queue;
+
+    // This is created on the first call to `DrawGpuParticles()`, so that there's no cost if the GPU particles aren't used.
+    std::unique_ptr<GpuParticles> gpu_particles;
+
+    // If true, `Render()` skips the upload and the main pass when the frame would draw exactly the same as the previous one, and `target` keeps the old image.
+    // The game enables this, since in the planning phase of a level few things move. Keep it off in the benchmarks, and when the pipelines can change under us.
+    bool reuse_unchanged_frames = false;
+    // Whether the last `Render()` did that.
+    bool last_frame_reused = false;
+
+  private:
+    // See `RequestMainTextureReload()`.
+    bool main_texture_reload_requested = false;
+
+    // `RenderQueue::ContentHash()` of the last frame that was drawn, for `reuse_unchanged_frames`.
+    std::optional<std::uint64_t> prev_content_hash;
+
+    void CompositeFramedImages(Gpu::CommandBuffer &cmdbuf);
+
+    // The opacity test for `render_queue`. Only the rects that sample one of our textures with known opacity can pass it.
+    [[nodiscard]] bool IsOpaque(const RectInstance &rect, const RenderState &state) const;
+
+    // Whether `pipeline` is one of `MainPipelines::normal`.
+    [[nodiscard]] bool IsMainPipeline(const Gpu::Pipeline *pipeline) const;
+
+    // Reloads `main_texture` from disk, and re-composites the framed images from it.
+    void ReloadMainTexture(Gpu::CommandBuffer &cmdbuf);
+
+  public:
+    // `target_format` is the format of `target`.
+    // The pipelines are compiled on `jobs`, and the constructor waits for them.
+    Renderer(Gpu::Device &device, App::JobSystem &jobs, SDL_GPUTextureFormat target_format);
+
+    // Not movable, because `DrawRect()` and others refer to the current instance.
+    Renderer(const Renderer &) = delete;
+    Renderer &operator=(const Renderer &) = delete;
+    ~Renderer();
+
+    // Call this at the beginning of each frame, and pass the result to the command buffer of the frame.
+    [[nodiscard]] Gpu::Fence &BeginFrame()
+    {
+        frame_fences.Poll();
+        return render_queue.BeginFrame();
+    }
+
+    // Renders `world` into `target`, using `cmdbuf`. `alpha` is passed to `World::Render()`.
+    // If `draw_overlay` isn't null, it's called after `World::Render()`, so its `DrawRect()`s end up on top of the world.
+    void Render(Gpu::CommandBuffer &cmdbuf, World &world, Timings &timings, float alpha = 1, const std::function<void()> &draw_overlay = nullptr);
+
+    // Same as `BeginFrame()` + `Render()` + `EndFrame()`, but as a job on `jobs`, into a command buffer of its own that is also submitted there.
+    // SDL wants a command buffer to stay on the thread that acquired it, which is why the buffer isn't passed in.
+    // Until the returned job is done, don't touch `world`, `timings` or what `draw_overlay` reads, and don't draw anything else.
+    // Wait for it before submitting the command buffers that read `target`, so that they execute after this one.
+    [[nodiscard]] App::JobSystem::Handle RenderAsync(App::JobSystem &jobs, World &world, Timings &timings, float alpha = 1, std::function<void()> draw_overlay = nullptr);
+
+    // Makes the next `Render()` reload `main_texture` from disk, as a part of its command buffer. If that fails, the error is printed and the old texture stays.
+    void RequestMainTextureReload() {main_texture_reload_requested = true;}
+
+    // Call this at the end of each frame, even if nothing was rendered.
+    void EndFrame() {render_queue.EndFrame();}
+
+    [[nodiscard]] const FramedImage &FindFramedImage(const TexRegion &source) const;
+
+    // The `MainPipelines::normal` for `variant`.
+    [[nodiscard]] Gpu::Pipeline &MainPipeline(MainVariant variant) {return main_pipelines[std::size_t(variant)].normal.pipeline;}
+
+    // The variant that `DrawRect()` uses for `rect`, see `MainVariant`.
+    [[nodiscard]] static MainVariant ChooseMainVariant(const RectInstance &rect);
+};
@@ -0,0 +1,245 @@
+#include "replay.h"
+
+#include "game/clock.h"
+
+#include <fmt/format.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace
+{
+    // Those assume a little-endian platform, like `baked_image.h`.
+
+    template <typename T>
+    void AppendValue(std::vector<unsigned char> &bytes, T value)
+    {
+        unsigned char buffer[sizeof(T)];
+        std::memcpy(buffer, &value, sizeof(T));
+        bytes.insert(bytes.end(), buffer, buffer + sizeof(T));
+    }
+
+    class ByteReader
+    {
+        std::span<const unsigned char> bytes;
+        std::string_view file_name;
+
+      public:
+        ByteReader(std::span<const unsigned char> bytes, std::string_view file_name) : bytes(bytes), file_name(file_name) {}
+
+        [[nodiscard]] bool AtEnd() const {return bytes.empty();}
+
+        template <typename T>
+        [[nodiscard]] T Read()
+        {
+            if (bytes.size() < sizeof(T))
+                throw std::runtime_error(fmt::format("The replay `{}` is truncated.", file_name));
+            T ret;
+            std::memcpy(&ret, bytes.data(), sizeof(T));
+            bytes = bytes.subspan(sizeof(T));
+            return ret;
+        }
+    };
+}
+
+ReplayWriter::ReplayWriter(zstring_view path, std::uint64_t seed)
+    : file(path, "wb")
+{
+    std::vector<unsigned char> bytes(std::begin(ReplayFormat::magic), std::end(ReplayFormat::magic));
+    AppendValue(bytes, ReplayFormat::version);
+    AppendValue(bytes, seed);
+    WriteBytes(bytes);
+}
+
+ReplayWriter::~ReplayWriter()
+{
+    if (!file)
+        return;
+
+    // Can't throw from a destructor. If this fails, we only lose the last few ticks.
+    try
+    {
+        FlushPendingInput();
+    }
+    catch (...) {}
+}
+
+void ReplayWriter::WriteBytes(std::span<const unsigned char> bytes)
+{
+    if (std::fwrite(bytes.data(), bytes.size(), 1, file.Handle()) != 1)
+        throw std::runtime_error("Unable to write to the replay file.");
+}
+
+void ReplayWriter::FlushPendingInput()
+{
+    if (!pending_input)
+        return;
+
+    const World::Input &input = *pending_input;
+
+    std::uint8_t buttons = 0;
+    if (input.mouse_down) buttons |= ReplayFormat::mouse;
+    if (input.left)       buttons |= ReplayFormat::left;
+    if (input.right)      buttons |= ReplayFormat::right;
+    if (input.jump)       buttons |= ReplayFormat::jump;
+    if (input.reset)      buttons |= ReplayFormat::reset;
+
+    std::vector<unsigned char> bytes;
+    AppendValue(bytes, ReplayFormat::RecordKind::input);
+    AppendValue(bytes, buttons);
+    AppendValue(bytes, std::int32_t(input.mouse_pos.x));
+    AppendValue(bytes, std::int32_t(input.mouse_pos.y));
+    AppendValue(bytes, pending_ticks);
+    WriteBytes(bytes);
+
+    pending_input.reset();
+    pending_ticks = 0;
+}
+
+void ReplayWriter::AddTick(const World::Input &input, const World &world)
+{
+    if (pending_input && (*pending_input != input || pending_ticks == std::numeric_limits<std::uint16_t>::max()))
+        FlushPendingInput();
+
+    pending_input = input;
+    pending_ticks++;
+    num_ticks++;
+
+    if (num_ticks % ReplayFormat::checkpoint_interval == 0)
+    {
+        // The checkpoint must come after all inputs before it.
+        FlushPendingInput();
+
+        std::vector<unsigned char> bytes;
+        AppendValue(bytes, ReplayFormat::RecordKind::checkpoint);
+        AppendValue(bytes, num_ticks);
+        AppendValue(bytes, world.StateHash());
+        WriteBytes(bytes);
+    }
+}
+
+Replay Replay::Load(zstring_view path)
+{
+    Filesystem::LoadedFile file(path);
+    ByteReader reader(file, path);
+
+    for (char ch : ReplayFormat::magic)
+    {
+        if (reader.Read<char>() != ch)
+            throw std::runtime_error(fmt::format("`{}` is not a replay file.", path));
+    }
+    if (std::uint32_t version = reader.Read<std::uint32_t>(); version != ReplayFormat::version)
+        throw std::runtime_error(fmt::format("The replay `{}` has version {}, but we need version {}.", path, version, ReplayFormat::version));
+
+    Replay ret;
+    ret.seed = reader.Read<std::uint64_t>();
+
+    while (!reader.AtEnd())
+    {
+        switch (reader.Read<ReplayFormat::RecordKind>())
+        {
+          case ReplayFormat::RecordKind::input:
+            {
+                InputRun &run = ret.inputs.emplace_back();
+                std::uint8_t buttons = reader.Read<std::uint8_t>();
+                run.input.mouse_down = buttons & ReplayFormat::mouse;
+                run.input.left       = buttons & ReplayFormat::left;
+                run.input.right      = buttons & ReplayFormat::right;
+                run.input.jump       = buttons & ReplayFormat::jump;
+                run.input.reset      = buttons & ReplayFormat::reset;
+                run.input.mouse_pos.x = reader.Read<std::int32_t>();
+                run.input.mouse_pos.y = reader.Read<std::int32_t>();
+                run.num_ticks = reader.Read<std::uint16_t>();
+            }
+            break;
+          case ReplayFormat::RecordKind::checkpoint:
+            {
+                Checkpoint &checkpoint = ret.checkpoints.emplace_back();
+                checkpoint.tick = reader.Read<std::uint64_t>();
+                checkpoint.hash = reader.Read<std::uint64_t>();
+            }
+            break;
+          default:
+            throw std::runtime_error(fmt::format("The replay `{}` contains an unknown record kind.", path));
+        }
+    }
+
+    return ret;
+}
+
+std::uint64_t Replay::NumTicks() const
+{
+    std::uint64_t ret = 0;
+    for (const InputRun &run : inputs)
+        ret += run.num_ticks;
+    return ret;
+}
+
+namespace
+{
+    struct ReplayApp : App::Module
+    {
+        std::string path;
+
+        ReplayApp(zstring_view path) : path(path) {}
+
+        App::Action Tick() override
+        {
+            Replay replay = Replay::Load(path);
+
+            World world;
+            world.SeedRandom(replay.seed);
+
+            fmt::print("Replaying `{}`: {} ticks, {} checkpoints.\n", path, replay.NumTicks(), replay.checkpoints.size());
+
+            std::uint64_t tick = 0;
+            std::size_t next_checkpoint = 0;
+            bool failed = false;
+
+            std::uint64_t start = Clock::Time();
+
+            for (const Replay::InputRun &run : replay.inputs)
+            {
+                for (std::uint32_t i = 0; i < run.num_ticks; i++)
+                {
+                    world.Tick(run.input);
+                    tick++;
+
+                    if (next_checkpoint < replay.checkpoints.size() && replay.checkpoints[next_checkpoint].tick == tick)
+                    {
+                        std::uint64_t hash = world.StateHash();
+                        if (hash != replay.checkpoints[next_checkpoint].hash)
+                        {
+                            fmt::print("Diverged at tick {}: expected hash {:016x}, got {:016x}.\n", tick, replay.checkpoints[next_checkpoint].hash, hash);
+                            failed = true;
+                            break;
+                        }
+                        next_checkpoint++;
+                    }
+                }
+
+                if (failed)
+                    break;
+            }
+
+            double secs = Clock::TicksToSeconds(Clock::Time() - start);
+
+            fmt::print("Simulated {} ticks in {:.3f} s: {:.0f} ticks per second ({:.1f}x real time at 60 tps).\n", tick, secs, double(tick) / secs, double(tick) / secs / 60);
+            if (!failed)
+                fmt::print("All {} checkpoints match.\n", next_checkpoint);
+
+            std::fflush(stdout);
+            return failed ? App::Action::exit_failure : App::Action::exit_success;
+        }
+    };
+}
+
+std::unique_ptr<App::Module> MakeReplayApp(zstring_view path)
+{
+    return std::make_unique<ReplayApp>(path);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "em/zstring_view.h"
+#include "game/world.h"
+#include "mainloop/module.h"
+#include "utils/filesystem.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+using namespace em;
+
+// Replays record the per-tick `World::Input`s and the random seed, so the world can be simulated again without a window or a GPU.
+// The file format (all integers are little-endian):
+// * The header: the magic `FRPL`, `u32 version`, `u64 seed`.
+// * Then a sequence of records, each starting with a `u8` kind:
+//   * `input`: `u8 buttons` (see `ReplayFormat::Button`), `i32 mouse_x`, `i32 mouse_y`, `u16 num_ticks`.
+//     The same input repeats for `num_ticks` consecutive ticks, which keeps idle stretches small.
+//   * `checkpoint`: `u64 tick`, `u64 hash`, the result of `World::StateHash()` after that many ticks.
+//     Those are written periodically, so that a diverging replay is caught near the tick where it happened.
+namespace ReplayFormat
+{
+    inline constexpr char magic[4] = {'F', 'R', 'P', 'L'};
+    // Bump this when changing the format or when an update changes the gameplay, since old replays will then diverge.
+    inline constexpr std::uint32_t version = 1;
+
+    enum class RecordKind : std::uint8_t
+    {
+        input = 0,
+        checkpoint = 1,
+    };
+
+    enum Button : std::uint8_t
+    {
+        mouse = 1 << 0,
+        left  = 1 << 1,
+        right = 1 << 2,
+        jump  = 1 << 3,
+        reset = 1 << 4,
+    };
+
+    // How often to write the checkpoints, in ticks.
+    inline constexpr std::uint64_t checkpoint_interval = 600;
+}
+
+// Writes a replay file as the game runs.
+class ReplayWriter
+{
+    Filesystem::File file;
+
+    // The input that's being repeated, not written yet.
+    std::optional<World::Input> pending_input;
+    std::uint16_t pending_ticks = 0;
+
+    std::uint64_t num_ticks = 0;
+
+    void WriteBytes(std::span<const unsigned char> bytes);
+    void FlushPendingInput();
+
+  public:
+    ReplayWriter() {}
+
+    // Creates the file and writes the header. Call `World::SeedRandom(seed)` on the world before the first tick.
+    ReplayWriter(zstring_view path, std::uint64_t seed);
+
+    ReplayWriter(ReplayWriter &&) = default;
+    ReplayWriter &operator=(ReplayWriter &&) = default;
+    // Flushes the last input.
+    ~ReplayWriter();
+
+    [[nodiscard]] explicit operator bool() const {return bool(file);}
+
+    // Call this after each tick, with the input passed to it and the world after it.
+    void AddTick(const World::Input &input, const World &world);
+};
+
+// A parsed replay file.
+struct Replay
+{
+    std::uint64_t seed = 0;
+
+    struct InputRun
+    {
+        World::Input input;
+        std::uint32_t num_ticks = 0;
+    };
+    std::vector<InputRun> inputs;
+
+    struct Checkpoint
+    {
+        std::uint64_t tick = 0;
+        std::uint64_t hash = 0;
+    };
+    std::vector<Checkpoint> checkpoints;
+
+    // Throws on failure.
+    [[nodiscard]] static Replay Load(zstring_view path);
+
+    [[nodiscard]] std::uint64_t NumTicks() const;
+};
+
+// Creates an app that replays `path` as fast as possible, without a window, a GPU or audio, checks it against the checkpoints,
+//   prints the simulation throughput, and exits. The exit status is a failure if the replay diverges.
+[[nodiscard]] std::unique_ptr<App::Module> MakeReplayApp(zstring_view path);
@@ -0,0 +1,84 @@
+#include "sim_thread.h"
+
+#include "game/clock.h"
+#include "game/metronome.h"
+#include "utils/trace.h"
+
+#include <algorithm>
+#include <utility>
+
+SimThread::SimThread(World world, double frequency, TickFunc tick_func)
+    : world(std::move(world)), frequency(frequency), tick_func(std::move(tick_func))
+{
+    // So there's something to render before the first tick. The thread doesn't exist yet, so we can touch the consumer side.
+    snapshots.ReadSlot().world = this->world;
+    snapshots.ReadSlot().time = Clock::Time();
+
+    thread = std::jthread([this](std::stop_token stop){ThreadFunc(std::move(stop));});
+}
+
+void SimThread::ThreadFunc(std::stop_token stop)
+{
+    try
+    {
+        Metronome metronome(frequency);
+        // The metronome decides how many ticks are due, the pacer sleeps between them.
+        // If a tick takes too long, the metronome catches up on the next iteration, up to its limit.
+        Clock::FramePacer pacer;
+        const double tick_len = 1 / frequency;
+
+        World::Input input;
+        std::uint64_t num_ticks = 0;
+        std::uint64_t prev_time = Clock::Time();
+
+        while (!stop.stop_requested())
+        {
+            std::uint64_t time = Clock::Time();
+            std::uint64_t delta = time - prev_time;
+            prev_time = time;
+
+            while (metronome.Tick(delta))
+            {
+                EM_TRACE_ZONE("SimThread::Tick");
+
+                if (inputs.Update())
+                    input = inputs.ReadSlot();
+
+                tick_func(world, input);
+
+                Snapshot &snapshot = snapshots.WriteSlot();
+                snapshot.world = world;
+                snapshot.time = Clock::Time();
+                snapshot.num_ticks = ++num_ticks;
+                snapshots.Publish();
+            }
+
+            (void)pacer.Wait(tick_len);
+        }
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+        failed.store(true, std::memory_order_release);
+    }
+}
+
+void SimThread::SetInput(const World::Input &input)
+{
+    inputs.WriteSlot() = input;
+    inputs.Publish();
+}
+
+SimThread::Snapshot &SimThread::Latest()
+{
+    if (failed.load(std::memory_order_acquire))
+        std::rethrow_exception(error);
+
+    (void)snapshots.Update();
+    return snapshots.ReadSlot();
+}
+
+float SimThread::Alpha(const Snapshot &snapshot) const
+{
+    return float(std::clamp(Clock::TicksToSeconds(Clock::Time() - snapshot.time) * frequency, 0., 1.));
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "game/world.h"
+#include "utils/triple_buffer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <stop_token>
+#include <thread>
+
+using namespace em;
+
+// Ticks a world on its own thread at a fixed rate, so that slow frames and swapchain waits don't delay the ticks, and vice versa. See `FRAMES_SIM_THREAD` in `main.cpp`.
+// The inputs go in, and copies of the world come out, both through `TripleBuffer`s, so neither thread ever waits for the other.
+class SimThread
+{
+  public:
+    // A copy of the world after a tick, for rendering.
+    struct Snapshot
+    {
+        World world;
+        // `Clock::Time()` right after the tick. The renderer interpolates from this, see `Alpha()`.
+        std::uint64_t time = 0;
+        // How many ticks were simulated up to this one, starting from 1. Zero if there were no ticks yet.
+        std::uint64_t num_ticks = 0;
+    };
+
+    // Called on the simulation thread for each tick. Must call `world.Tick(input)`, and can do something around it (e.g. lock the audio).
+    using TickFunc = std::function<void(World &world, const World::Input &input)>;
+
+  private:
+    World world;
+    double frequency = 0;
+    TickFunc tick_func;
+
+    TripleBuffer<World::Input> inputs;
+    TripleBuffer<Snapshot> snapshots;
+
+    // Set by the thread if it stops because `tick_func` threw. `error` is written before this.
+    std::atomic<bool> failed = false;
+    std::exception_ptr error;
+
+    // This must be last, to be destroyed (joined) first, while the rest is still alive.
+    std::jthread thread;
+
+    void ThreadFunc(std::stop_token stop);
+
+  public:
+    // Starts ticking `world` at `frequency` ticks per second. The world then belongs to the thread.
+    SimThread(World world, double frequency, TickFunc tick_func);
+
+    // Not movable, the thread refers to `this`.
+    SimThread(const SimThread &) = delete;
+    SimThread &operator=(const SimThread &) = delete;
+
+    // This and the following functions are for the main thread.
+
+    // The input for the following ticks, until the next call. If the input changes and changes back between two ticks, the ticks don't see it.
+    void SetInput(const World::Input &input);
+
+    // Returns the world as of the latest tick. The reference stays valid and unchanged until the next call, so it can be rendered meanwhile.
+    // Rethrows the error if the thread has stopped because of it.
+    [[nodiscard]] Snapshot &Latest();
+
+    // How far we are from the tick of `snapshot` to the next one, 0..1, to pass to `World::Render()`.
+    [[nodiscard]] float Alpha(const Snapshot &snapshot) const;
+};
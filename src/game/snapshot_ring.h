@@ -0,0 +1,60 @@
+#pragma once
+
+#include "game/world.h"
+
+#include <cstddef>
+#include <vector>
+
+// A fixed-capacity stack of world snapshots, for rewinding and undoing. When full, pushing overwrites the oldest snapshot.
+// All memory is allocated in the constructor.
+class SnapshotRing
+{
+    // `begin` is the oldest snapshot.
+    std::vector<World::Snapshot> snapshots;
+    std::size_t begin = 0;
+    std::size_t count = 0;
+
+  public:
+    SnapshotRing() {}
+    SnapshotRing(std::size_t capacity) : snapshots(capacity) {}
+
+    [[nodiscard]] std::size_t Capacity() const {return snapshots.size();}
+    [[nodiscard]] std::size_t Size() const {return count;}
+    [[nodiscard]] bool IsEmpty() const {return count == 0;}
+
+    void Push(const World::Snapshot &snapshot)
+    {
+        if (snapshots.empty())
+            return;
+
+        if (count < snapshots.size())
+        {
+            snapshots[(begin + count) % snapshots.size()] = snapshot;
+            count++;
+        }
+        else
+        {
+            snapshots[begin] = snapshot;
+            begin = (begin + 1) % snapshots.size();
+        }
+    }
+
+    // Returns the newest snapshot, or null if empty.
+    [[nodiscard]] const World::Snapshot *Back() const
+    {
+        return count == 0 ? nullptr : &snapshots[(begin + count - 1) % snapshots.size()];
+    }
+
+    // Removes the newest snapshot, if any.
+    void PopBack()
+    {
+        if (count > 0)
+            count--;
+    }
+
+    void Clear()
+    {
+        begin = 0;
+        count = 0;
+    }
+};
@@ -0,0 +1,316 @@
+#include "solver.h"
+
+#include "game/clock.h"
+#include "game/world.h"
+#include "mainloop/job_system.h"
+
+#include <fmt/format.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <unordered_set>
+#include <utility>
+
+namespace
+{
+    // The movement actions, in the order of the characters in `LevelSolution::moves`.
+    constexpr char move_chars[] = {'.', '<', '>', '^', '{', '}'};
+    constexpr int num_move_actions = 6;
+
+    [[nodiscard]] World::Input MoveInput(int action, ivec2 mouse_pos)
+    {
+        World::Input ret;
+        ret.mouse_pos = mouse_pos;
+        ret.left = action % 3 == 1;
+        ret.right = action % 3 == 2;
+        ret.jump = action >= 3;
+        return ret;
+    }
+
+    // Lower is better. Collecting a key always beats getting closer to the next one.
+    [[nodiscard]] std::int64_t Score(const World::Status &status)
+    {
+        std::int64_t dist_sq = std::numeric_limits<std::int32_t>::max();
+        if (status.goal)
+        {
+            ivec2 d = *status.goal - status.player_pos;
+            dist_sq = std::int64_t(d.x) * d.x + std::int64_t(d.y) * d.y;
+        }
+        return std::int64_t(status.keys_left) << 40 | dist_sq;
+    }
+
+    // A point of frame `index` that isn't covered by a frame above it, to grab it by. Null if it's fully covered.
+    [[nodiscard]] std::optional<ivec2> FindGrabPoint(const std::vector<World::FrameInfo> &frames, std::size_t index)
+    {
+        const World::FrameInfo &frame = frames[index];
+
+        auto IsCovered = [&](ivec2 point)
+        {
+            for (std::size_t i = index + 1; i < frames.size(); i++)
+            {
+                ivec2 a = frames[i].corner, b = a + frames[i].size;
+                if (point.x >= a.x && point.y >= a.y && point.x < b.x && point.y < b.y)
+                    return true;
+            }
+            return false;
+        };
+
+        // Try the center first, then a coarse grid.
+        ivec2 center = frame.corner + frame.size / 2;
+        if (!IsCovered(center))
+            return center;
+
+        static constexpr int step = 4;
+        for (int y = step / 2; y < frame.size.y; y += step)
+        for (int x = step / 2; x < frame.size.x; x += step)
+        {
+            ivec2 point = frame.corner + ivec2(x, y);
+            if (!IsCovered(point))
+                return point;
+        }
+
+        return {};
+    }
+
+    // Grabs a frame at `grab_point` and moves it by `offset` (before clamping), using the same mouse inputs a player would.
+    // Returns the mouse position at the end.
+    ivec2 Drag(World &world, ivec2 grab_point, ivec2 offset)
+    {
+        World::Input input;
+        input.mouse_pos = grab_point;
+        world.Tick(input); // Hover.
+        input.mouse_down = true;
+        world.Tick(input); // Grab.
+        input.mouse_pos += offset;
+        world.Tick(input); // Move.
+        input.mouse_down = false;
+        world.Tick(input); // Release.
+        return input.mouse_pos;
+    }
+
+    struct Arrangement
+    {
+        World world;
+        std::vector<LevelSolution::Drag> drags;
+        // Where the mouse was left, we keep it there while moving.
+        ivec2 mouse_pos;
+
+        // Filled by `Evaluate()`.
+        std::optional<LevelSolution> solution;
+        std::int64_t best_score = std::numeric_limits<std::int64_t>::max();
+        std::size_t num_move_states = 0;
+    };
+
+    void Evaluate(Arrangement &arr, const SolverParams &params)
+    {
+        struct Node
+        {
+            World world;
+            std::string moves;
+            std::int64_t score = 0;
+        };
+
+        std::vector<Node> layer;
+        layer.push_back({.world = arr.world});
+        std::vector<Node> next_layer;
+        std::unordered_set<std::uint64_t> seen;
+
+        const int max_steps = std::max(1, params.max_move_ticks / params.hold_ticks);
+        for (int step = 0; step < max_steps && !layer.empty(); step++)
+        {
+            next_layer.clear();
+
+            for (const Node &node : layer)
+            {
+                for (int action = 0; action < num_move_actions; action++)
+                {
+                    Node child{.world = node.world, .moves = node.moves + move_chars[action]};
+
+                    World::Input input = MoveInput(action, arr.mouse_pos);
+                    bool dead = false;
+                    for (int t = 0; t < params.hold_ticks; t++)
+                    {
+                        child.world.Tick(input);
+
+                        World::Status status = child.world.GetStatus();
+                        if (status.won)
+                        {
+                            // The layers are in order, so the first win is one of the shortest.
+                            arr.solution = LevelSolution{
+                                .drags = arr.drags,
+                                .moves = std::move(child.moves),
+                                .num_move_ticks = std::uint64_t(step) * std::uint64_t(params.hold_ticks) + std::uint64_t(t) + 1,
+                            };
+                            arr.best_score = std::numeric_limits<std::int64_t>::min();
+                            return;
+                        }
+                        if (!status.player_alive)
+                        {
+                            dead = true;
+                            break;
+                        }
+                    }
+                    if (dead)
+                        continue;
+
+                    if (!seen.insert(child.world.StateHash()).second)
+                        continue;
+
+                    child.score = Score(child.world.GetStatus());
+                    arr.best_score = std::min(arr.best_score, child.score);
+                    arr.num_move_states++;
+                    next_layer.push_back(std::move(child));
+                }
+            }
+
+            if (next_layer.size() > params.move_beam_width)
+            {
+                std::nth_element(next_layer.begin(), next_layer.begin() + std::ptrdiff_t(params.move_beam_width), next_layer.end(), [](const Node &a, const Node &b){return a.score < b.score;});
+                next_layer.erase(next_layer.begin() + std::ptrdiff_t(params.move_beam_width), next_layer.end());
+            }
+
+            std::swap(layer, next_layer);
+        }
+    }
+}
+
+SolveResult SolveLevel(App::JobSystem &jobs, std::size_t level, const SolverParams &params)
+{
+    SolveResult ret;
+
+    std::vector<Arrangement> layer;
+    {
+        Arrangement &root = layer.emplace_back();
+        root.world.sounds = false;
+        root.world.effects = false;
+        root.world.SeedRandom(0);
+        root.world.LoadLevel(level);
+
+        // The player can't move until something was dragged at least once, so click the topmost frame in place.
+        std::vector<World::FrameInfo> frames = root.world.GetFrames();
+        if (std::optional<ivec2> grab = frames.empty() ? std::nullopt : FindGrabPoint(frames, frames.size() - 1))
+            root.mouse_pos = Drag(root.world, *grab, ivec2());
+    }
+
+    std::unordered_set<std::uint64_t> seen_arrangements = {layer.front().world.StateHash()};
+
+    for (int num_drags = 0;; num_drags++)
+    {
+        jobs.ParallelFor(layer.size(), [&](std::size_t i){Evaluate(layer[i], params);});
+
+        ret.num_arrangements += layer.size();
+        for (const Arrangement &arr : layer)
+        {
+            ret.num_move_states += arr.num_move_states;
+            if (arr.solution && (!ret.solution || arr.solution->num_move_ticks < ret.solution->num_move_ticks))
+                ret.solution = arr.solution;
+        }
+
+        if (ret.solution || num_drags == params.max_drags)
+            break;
+
+        // Expand the most promising arrangements.
+        std::sort(layer.begin(), layer.end(), [](const Arrangement &a, const Arrangement &b){return a.best_score < b.best_score;});
+        if (layer.size() > params.drag_beam_width)
+            layer.erase(layer.begin() + std::ptrdiff_t(params.drag_beam_width), layer.end());
+
+        std::vector<std::vector<Arrangement>> children(layer.size());
+        jobs.ParallelFor(layer.size(), [&](std::size_t i)
+        {
+            const Arrangement &parent = layer[i];
+            std::vector<World::FrameInfo> frames = parent.world.GetFrames();
+
+            for (std::size_t f = 0; f < frames.size(); f++)
+            {
+                std::optional<ivec2> grab = FindGrabPoint(frames, f);
+                if (!grab)
+                    continue;
+
+                ivec2 bound = World::MaxFramePos(frames[f].size);
+                for (int y = -bound.y; y <= bound.y; y += params.grid_step)
+                for (int x = -bound.x; x <= bound.x; x += params.grid_step)
+                {
+                    ivec2 target(x, y);
+                    if (target == frames[f].pos)
+                        continue;
+
+                    Arrangement &child = children[i].emplace_back(Arrangement{.world = parent.world, .drags = parent.drags});
+                    child.mouse_pos = Drag(child.world, *grab, target - frames[f].pos);
+                    child.drags.push_back({.from = frames[f].pos, .to = child.world.GetFrames().back().pos});
+                }
+            }
+        });
+
+        layer.clear();
+        for (std::vector<Arrangement> &list : children)
+        {
+            for (Arrangement &child : list)
+            {
+                if (seen_arrangements.insert(child.world.StateHash()).second)
+                    layer.push_back(std::move(child));
+            }
+        }
+
+        if (layer.empty())
+            break;
+    }
+
+    return ret;
+}
+
+namespace
+{
+    struct SolverApp : App::Module
+    {
+        std::optional<std::size_t> level;
+
+        App::JobSystem jobs = App::JobSystem(App::JobSystem::Params{});
+
+        SolverApp(std::optional<std::size_t> level) : level(level) {}
+
+        App::Action Tick() override
+        {
+            SolverParams params;
+            if (const char *env = SDL_getenv("FRAMES_SOLVE_DRAGS"))
+                params.max_drags = std::max(0, std::atoi(env));
+
+            std::size_t first = level.value_or(0);
+            std::size_t last = level ? *level + 1 : World::NumLevels();
+
+            bool all_solved = true;
+
+            for (std::size_t i = first; i < last; i++)
+            {
+                std::uint64_t start = Clock::Time();
+                SolveResult result = SolveLevel(jobs, i, params);
+                double secs = Clock::TicksToSeconds(Clock::Time() - start);
+
+                fmt::print("Level {}: ", i + 1);
+                if (result.solution)
+                {
+                    fmt::print("solved with {} drag(s) and {} ticks of movement.\n", result.solution->drags.size(), result.solution->num_move_ticks);
+                    for (const LevelSolution::Drag &drag : result.solution->drags)
+                        fmt::print("    drag [{},{}] -> [{},{}]\n", drag.from.x, drag.from.y, drag.to.x, drag.to.y);
+                    fmt::print("    moves (x{} ticks): {}\n", params.hold_ticks, result.solution->moves);
+                }
+                else
+                {
+                    fmt::print("NOT SOLVED with up to {} drag(s).\n", params.max_drags);
+                    all_solved = false;
+                }
+                fmt::print("    {} arrangements, {} movement states, {:.2f} s\n", result.num_arrangements, result.num_move_states, secs);
+                std::fflush(stdout);
+            }
+
+            return all_solved ? App::Action::exit_success : App::Action::exit_failure;
+        }
+    };
+}
+
+std::unique_ptr<App::Module> MakeSolverApp(std::optional<std::size_t> level)
+{
+    return std::make_unique<SolverApp>(level);
+}
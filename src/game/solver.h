@@ -0,0 +1,75 @@
+#pragma once
+
+#include "em/math/vector.h"
+#include "mainloop/module.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace em::App
+{
+    class JobSystem;
+}
+
+using namespace em;
+
+// Searches for the solutions of the levels by simulating them: first where to drag the frames, then what keys to press.
+// Both parts are beam searches over copies of `World`, with the duplicate states removed using `World::StateHash()`:
+// * The outer search is over the frame arrangements, one drag per step, trying every frame and every target on a grid.
+//   All arrangements of a step are evaluated in parallel, each by running the inner search on it.
+// * The inner search is over the movement inputs, each held for `hold_ticks`. The states where the player died are dropped,
+//   and when there are too many, the ones closest to the next key (or the exit) are kept.
+// The outer search keeps the arrangements that got the player the closest to the goal.
+// This finds the solution with the fewest drags that it can find, and then the shortest movement for it.
+// Since both searches are pruned, "unsolved" means "not found with these parameters", not "impossible".
+struct SolverParams
+{
+    // The most drags to try.
+    int max_drags = 2;
+    // The drag targets are on a grid with this step in pixels, within the clamp used when dragging (see `World::MaxFramePos()`).
+    int grid_step = 16;
+    // While moving, each input is held for this many ticks.
+    int hold_ticks = 6;
+    // Give up on an arrangement after this many ticks of movement.
+    int max_move_ticks = 60 * 20;
+    // How many states to keep per step of the movement search.
+    std::size_t move_beam_width = 64;
+    // How many arrangements to expand per drag.
+    std::size_t drag_beam_width = 16;
+};
+
+struct LevelSolution
+{
+    struct Drag
+    {
+        // The frame positions.
+        ivec2 from;
+        ivec2 to;
+    };
+    std::vector<Drag> drags;
+
+    // One character per `SolverParams::hold_ticks`: `.` (nothing), `<`, `>`, `^` (jump), `{` (left and jump), `}` (right and jump).
+    std::string moves;
+    // Until the exit is reached. This can be less than `moves.size() * hold_ticks`.
+    std::uint64_t num_move_ticks = 0;
+};
+
+struct SolveResult
+{
+    std::optional<LevelSolution> solution;
+
+    // Statistics.
+    std::size_t num_arrangements = 0;
+    std::size_t num_move_states = 0;
+};
+
+// Searches for a solution of `level` (numbered from zero), using all threads of `jobs`.
+[[nodiscard]] SolveResult SolveLevel(App::JobSystem &jobs, std::size_t level, const SolverParams &params);
+
+// Creates an app that solves the levels, prints the solutions, and exits. The exit status is a failure if any level wasn't solved.
+// `level` is numbered from zero, or null to solve all levels. The maximum number of drags can be set with `FRAMES_SOLVE_DRAGS`.
+[[nodiscard]] std::unique_ptr<App::Module> MakeSolverApp(std::optional<std::size_t> level);
@@ -0,0 +1,15 @@
+// The implementation of `stb_image_write`, for `SavePngAsync()` in `readback.h`.
+// We write the files ourselves, so the stdio functions aren't needed.
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#define STBI_WRITE_NO_STDIO
+
+#ifdef __GNUC__
+#pragma GCC diagnostic ignored "-Wimplicit-fallthrough"
+#pragma GCC diagnostic ignored "-Wimplicit-int-conversion"
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+#endif
+
+#include <stb_image_write.h>
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "em/math/vector.h"
+
+using namespace em;
+
+// A rectangular region of a texture, in pixels.
+struct TexRegion
+{
+    ivec2 pos;
+    ivec2 size;
+
+    [[nodiscard]] friend bool operator==(const TexRegion &a, const TexRegion &b)
+    {
+        return a.pos == b.pos && a.size == b.size;
+    }
+};
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "game/clock.h"
+#include "gpu/command_buffer.h"
+#include "gpu/device.h"
+#include "gpu/fence.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+using namespace em;
+
+// Remembers the last N durations of something, and computes statistics on them.
+class TimingStat
+{
+    // Measured in seconds. This is a ring buffer, `next_sample` is the oldest sample once it's full.
+    std::vector<double> samples;
+    std::size_t next_sample = 0;
+    std::size_t max_samples = 0;
+
+  public:
+    TimingStat(std::size_t max_samples = 240) : max_samples(max_samples)
+    {
+        samples.reserve(max_samples);
+    }
+
+    void Add(double seconds)
+    {
+        if (samples.size() < max_samples)
+        {
+            samples.push_back(seconds);
+        }
+        else
+        {
+            samples[next_sample] = seconds;
+            next_sample = (next_sample + 1) % max_samples;
+        }
+    }
+
+    [[nodiscard]] std::size_t NumSamples() const {return samples.size();}
+
+    // Those return zero if there are no samples.
+    [[nodiscard]] double Average() const
+    {
+        if (samples.empty())
+            return 0;
+        double sum = 0;
+        for (double s : samples)
+            sum += s;
+        return sum / double(samples.size());
+    }
+    [[nodiscard]] double Min() const
+    {
+        return samples.empty() ? 0 : *std::min_element(samples.begin(), samples.end());
+    }
+    [[nodiscard]] double Max() const
+    {
+        return samples.empty() ? 0 : *std::max_element(samples.begin(), samples.end());
+    }
+    // The standard deviation, i.e. how much the durations jitter.
+    [[nodiscard]] double StdDev() const
+    {
+        if (samples.empty())
+            return 0;
+        double avg = Average();
+        double sum = 0;
+        for (double s : samples)
+            sum += (s - avg) * (s - avg);
+        return std::sqrt(sum / double(samples.size()));
+    }
+    // `fraction` is in 0..1, e.g. `0.99` for the 99th percentile.
+    [[nodiscard]] double Percentile(double fraction) const
+    {
+        if (samples.empty())
+            return 0;
+        std::vector<double> copy = samples;
+        auto it = copy.begin() + std::ptrdiff_t(std::clamp(fraction, 0., 1.) * double(copy.size() - 1) + 0.5);
+        std::nth_element(copy.begin(), it, copy.end());
+        return *it;
+    }
+};
+
+// The things we measure every frame.
+enum class TimingZone
+{
+    fixed_tick, // CPU, one sample per tick, not per frame.
+    world_render, // CPU, filling the render queue.
+    upload, // CPU, recording the upload copy pass.
+    main_pass, // CPU, recording the primary render pass.
+    upscale_pass, // CPU, recording the upscale render pass.
+    cpu_frame, // CPU, the whole frame, including the wait for the swapchain texture, but excluding the manual FPS limiter.
+    paced_frame, // CPU, the achieved frame length, including the manual FPS limiter. Only measured when the limiter is active, see `Clock::FramePacer`.
+    gpu_frame, // GPU, see `GpuFrameTimer` for what exactly this measures.
+    _count,
+};
+
+[[nodiscard]] inline const char *TimingZoneName(TimingZone zone)
+{
+    switch (zone)
+    {
+        case TimingZone::fixed_tick:   return "fixed tick";
+        case TimingZone::world_render: return "world render";
+        case TimingZone::upload:       return "upload";
+        case TimingZone::main_pass:    return "main pass";
+        case TimingZone::upscale_pass: return "upscale pass";
+        case TimingZone::cpu_frame:    return "cpu frame";
+        case TimingZone::paced_frame:  return "paced frame";
+        case TimingZone::gpu_frame:    return "gpu frame";
+        case TimingZone::_count:       break;
+    }
+    return "??";
+}
+
+class Timings
+{
+    std::array<TimingStat, std::size_t(TimingZone::_count)> stats;
+
+  public:
+    Timings() {}
+
+    [[nodiscard]]       TimingStat &operator[](TimingZone zone)       {return stats[std::size_t(zone)];}
+    [[nodiscard]] const TimingStat &operator[](TimingZone zone) const {return stats[std::size_t(zone)];}
+
+    // Measures the time until the end of the scope.
+    class Scope
+    {
+        TimingStat *stat = nullptr;
+        std::uint64_t start = 0;
+
+      public:
+        Scope(Timings &timings, TimingZone zone) : stat(&timings[zone]), start(Clock::Time()) {}
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+        ~Scope()
+        {
+            stat->Add(Clock::TicksToSeconds(Clock::Time() - start));
+        }
+    };
+
+    // Returns a human-readable table, one line per zone, in milliseconds.
+    [[nodiscard]] std::string Report() const
+    {
+        std::string ret = fmt::format("{:>14} {:>8} {:>8} {:>8} {:>8} {:>8}\n", "ms", "avg", "min", "max", "p99", "stddev");
+        for (std::size_t i = 0; i < stats.size(); i++)
+        {
+            const TimingStat &stat = stats[i];
+            ret += fmt::format("{:>14} {:8.3f} {:8.3f} {:8.3f} {:8.3f} {:8.3f}\n", TimingZoneName(TimingZone(i)), stat.Average() * 1000, stat.Min() * 1000, stat.Max() * 1000, stat.Percentile(0.99) * 1000, stat.StdDev() * 1000);
+        }
+        return ret;
+    }
+};
+
+// Approximates how long the GPU takes to execute our frames.
+// SDL doesn't expose timestamp queries, so instead, right after submitting a frame, we submit an empty command buffer and remember the time.
+// Command buffers complete in order, so its fence signals once the frame is done. We poll those fences once per frame.
+// This means the measured time is the GPU latency of the frame (including any queued work before it), rounded up to the polling interval.
+// Since we only poll at frame boundaries, this can't measure individual passes, only whole frames.
+class GpuFrameTimer
+{
+    struct Pending
+    {
+        Gpu::Fence fence;
+        std::uint64_t submit_time = 0;
+    };
+    std::deque<Pending> pending;
+
+  public:
+    GpuFrameTimer() {}
+
+    // Call this right after submitting the command buffer of a frame.
+    void Mark(Gpu::Device &device)
+    {
+        Pending &p = pending.emplace_back();
+        p.submit_time = Clock::Time();
+        Gpu::CommandBuffer cmdbuf(device, &p.fence);
+    }
+
+    // Call this once per frame. Adds the finished frames to `stat`.
+    void Poll(TimingStat &stat)
+    {
+        std::uint64_t now = Clock::Time();
+        while (!pending.empty() && (!pending.front().fence || pending.front().fence.IsReady()))
+        {
+            if (pending.front().fence)
+                stat.Add(Clock::TicksToSeconds(now - pending.front().submit_time));
+            pending.pop_front();
+        }
+    }
+};
@@ -3,46 +3,37 @@
 #include "SDL3/SDL_keyboard.h"
 #include "em/macros/utils/lift.h"
 #include "em/macros/utils/named_loops.h"
+#include "audio/context.h"
 #include "audio/global_sound_loader.h"
+#include "game/particle_pool.h"
 #include "main.h"
+#include "utils/fast_rng.h"
+#include "utils/frame_arena.h"
+#include "utils/inline_vector.h"
+#include "utils/trace.h"
 
 #include <fmt/format.h>
 #include <SDL3/SDL_mouse.h>
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
 #include <cmath>
-#include <deque>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <numbers>
+#include <optional>
 #include <random>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 static constexpr int tile_size = 16;
 
-static std::mt19937_64 rng(std::random_device{}());
-
-[[nodiscard]] static int RandSign()
-{
-    return rng() % 2 ? 1 : -1;
-}
-
-[[nodiscard]] static float RandFloat01()
-{
-    static std::uniform_real_distribution<float> dist(0, 1);
-    return dist(rng);
-}
-
-[[nodiscard]] static float RandFloat11()
-{
-    static std::uniform_real_distribution<float> dist(-1, 1);
-    return dist(rng);
-}
-
-[[nodiscard]] static float RandAngle()
-{
-    static std::uniform_real_distribution<float> dist(-std::numbers::pi_v<float>, std::numbers::pi_v<float>);
-    return dist(rng);
-}
-
-
 struct Mouse
 {
     ivec2 pos;
@@ -53,7 +44,6 @@ struct Mouse
     [[nodiscard]] bool IsPressed() const {return is_down && !is_down_prev;}
     [[nodiscard]] bool IsReleased() const {return !is_down && is_down_prev;}
 };
-static Mouse mouse;
 
 struct Key
 {
@@ -70,84 +60,219 @@ struct Keys
     Key jump;
     Key reset;
 };
-static Keys keys;
 
-// This is reset when the level is restarted. And this doesn't tick while we're in edit mode.
-static int global_tick_counter_during_movement = 0;
 
+// One bit per pixel, set for solid pixels. This doesn't own the bits, they're stored in a `FrameLayout`.
+// It's stored twice, by rows and by columns, so that both horizontal and vertical spans of up to 64 pixels can be tested with a couple of shifts.
+class SolidMask
+{
+    ivec2 size;
+    // The number of words per row and per column.
+    int row_stride = 0;
+    int column_stride = 0;
+    const std::uint64_t *rows = nullptr;
+    const std::uint64_t *columns = nullptr;
+
+    // Returns `count` bits of `line`, starting from bit `start`. The first one is in the lowest bit.
+    [[nodiscard]] static std::uint64_t ExtractBits(const std::uint64_t *line, int stride, int start, int count)
+    {
+        assert(count > 0 && count <= 64);
+        int word = start / 64;
+        int shift = start % 64;
+        std::uint64_t ret = line[word] >> shift;
+        if (shift != 0 && word + 1 < stride)
+            ret |= line[word + 1] << (64 - shift);
+        if (count < 64)
+            ret &= (std::uint64_t(1) << count) - 1;
+        return ret;
+    }
+
+  public:
+    constexpr SolidMask() {}
+
+    // `size` is in pixels. `rows` and `columns` are laid out as described in `FrameLayout`.
+    constexpr SolidMask(ivec2 size, const std::uint64_t *rows, const std::uint64_t *columns)
+        : size(size), row_stride((size.x + 63) / 64), column_stride((size.y + 63) / 64), rows(rows), columns(columns)
+    {}
+
+    // `pixel` must be in bounds.
+    [[nodiscard]] bool IsSolid(ivec2 pixel) const
+    {
+        return Row(pixel, 1);
+    }
+
+    // Returns the bits of the `count` pixels going right from `start`, which must be in bounds. The first pixel is in the lowest bit.
+    [[nodiscard]] std::uint64_t Row(ivec2 start, int count) const
+    {
+        assert(start.x >= 0 && start.y >= 0 && start.x + count <= size.x && start.y < size.y);
+        return ExtractBits(rows + start.y * row_stride, row_stride, start.x, count);
+    }
+    // Same, but going down from `start`.
+    [[nodiscard]] std::uint64_t Column(ivec2 start, int count) const
+    {
+        assert(start.x >= 0 && start.y >= 0 && start.x < size.x && start.y + count <= size.y);
+        return ExtractBits(columns + start.x * column_stride, column_stride, start.y, count);
+    }
+};
+
+// How many entities a frame can spawn, see `Frame::spawned_entity_types`. This is also the number of markers, `1`..`4`.
+static constexpr std::size_t max_spawned_entities = 4;
+
+// The tiles of a frame type, one string per row: `-` is empty, `#` is solid, and `1`..`4` are the markers where the entities spawn.
+// This is parsed at compile time, and a malformed layout fails the build. It also stores the bits that `SolidMask` points to.
+// `H` is the height in tiles, and `N - 1` is the width (`N` counts the null terminator). Both are deduced from the constructor arguments.
+template <std::size_t H, std::size_t N>
+struct FrameLayout
+{
+    static constexpr ivec2 tile_count = ivec2(int(N - 1), int(H));
+    static constexpr ivec2 pixel_size = tile_count * tile_size;
+    // The number of words per row and per column of pixels.
+    static constexpr int row_stride = (pixel_size.x + 63) / 64;
+    static constexpr int column_stride = (pixel_size.y + 63) / 64;
+
+    std::array<std::uint64_t, std::size_t(row_stride * pixel_size.y)> rows{};
+    std::array<std::uint64_t, std::size_t(column_stride * pixel_size.x)> columns{};
+
+    // The tile of each marker, if any.
+    std::array<std::optional<ivec2>, max_spawned_entities> markers{};
+
+    // One string per row.
+    template <std::size_t ...M>
+    consteval FrameLayout(const char (&...row_strings)[M])
+    {
+        static_assert(sizeof...(M) == H && ((M == N) && ...), "All rows of a frame must have the same length.");
+        static_assert(H > 0 && N > 1, "A frame can't be empty.");
+
+        const char *const tiles[] = {row_strings...};
+        for (std::size_t y = 0; y < H; y++)
+        {
+            for (std::size_t x = 0; x < N - 1; x++)
+            {
+                char ch = tiles[y][x];
+                if (ch == '#')
+                {
+                    for (int py = int(y) * tile_size; py < int(y + 1) * tile_size; py++)
+                    for (int px = int(x) * tile_size; px < int(x + 1) * tile_size; px++)
+                    {
+                        rows[std::size_t(py * row_stride + px / 64)] |= std::uint64_t(1) << (px % 64);
+                        columns[std::size_t(px * column_stride + py / 64)] |= std::uint64_t(1) << (py % 64);
+                    }
+                }
+                else if (ch >= '1' && ch < '1' + int(max_spawned_entities))
+                {
+                    std::optional<ivec2> &marker = markers[std::size_t(ch - '1')];
+                    if (marker)
+                        throw "Duplicate marker in a frame.";
+                    marker = ivec2(int(x), int(y));
+                }
+                else if (ch != '-')
+                {
+                    throw "Unknown tile in a frame.";
+                }
+            }
+        }
+    }
+};
+
+template <std::size_t ...M>
+FrameLayout(const char (&...row_strings)[M]) -> FrameLayout<sizeof...(M), std::max({M...})>;
 
 struct FrameType
 {
     ivec2 tex_pos; // Measured in tiles.
-    std::vector<std::string> tiles;
+    ivec2 tile_count;
 
-    FrameType(ivec2 tex_pos, std::vector<std::string> tiles)
-        : tex_pos(tex_pos), tiles(std::move(tiles))
-    {}
+    SolidMask solid_mask;
+
+    // For each marker, the offset from the frame center to the center of its tile, in pixels. Null if there's no such marker.
+    std::array<std::optional<ivec2>, max_spawned_entities> marker_offsets{};
+
+    // `layout` must outlive this, normally both are `static constexpr`.
+    template <std::size_t H, std::size_t N>
+    constexpr FrameType(ivec2 tex_pos, const FrameLayout<H, N> &layout)
+        : tex_pos(tex_pos), tile_count(layout.tile_count), solid_mask(layout.pixel_size, layout.rows.data(), layout.columns.data())
+    {
+        for (std::size_t i = 0; i < max_spawned_entities; i++)
+        {
+            if (layout.markers[i])
+                marker_offsets[i] = *layout.markers[i] * tile_size + tile_size / 2 - PixelSize() / 2;
+        }
+    }
 
-    [[nodiscard]] ivec2 TileSize() const
+    [[nodiscard]] constexpr ivec2 TileSize() const
     {
-        if (tiles.empty())
-            return ivec2();
-        return vec2(tiles.front().size(), tiles.size()).to<int>();
+        return tile_count;
     }
 
-    [[nodiscard]] ivec2 PixelSize() const
+    [[nodiscard]] constexpr ivec2 PixelSize() const
     {
         return TileSize() * tile_size;
     }
 
-    [[nodiscard]] ivec2 GetTopLeftCorner(ivec2 pos) const
+    [[nodiscard]] constexpr ivec2 GetTopLeftCorner(ivec2 pos) const
     {
         return pos - PixelSize() / 2;
     }
+
+    // The image in the main atlas.
+    [[nodiscard]] TexRegion ImageRegion() const
+    {
+        return {ivec2(0, 128) + tile_size * tex_pos, PixelSize()};
+    }
 };
 
 namespace Frames
 {
-    static const FrameType
-        flower_island(ivec2(0,0), {
+    namespace Layouts
+    {
+        static constexpr FrameLayout flower_island(
             "-----",
             "-----",
             "-----",
             "--1--",
             "-###-",
-            "-----",
-        }),
-        vortex(ivec2(5,0), {
+            "-----"
+        );
+
+        static constexpr FrameLayout vortex(
             "-----",
             "-----",
             "--1--",
-            "-###-",
-        }),
-        box(ivec2(10,0), {
+            "-###-"
+        );
+
+        static constexpr FrameLayout box(
             "-###-",
             "-#2#-",
             "-#1#-",
-            "#####",
-        }),
-        desert(ivec2(15,0), {
+            "#####"
+        );
+
+        static constexpr FrameLayout desert(
             "---",
             "---",
             "-1-",
-            "###",
-        }),
-        bubbles(ivec2(18,0), {
+            "###"
+        );
+
+        static constexpr FrameLayout bubbles(
             "---------",
             "---------",
             "#-#######",
             "#------1#",
             "#########",
             "---#2#---",
-            "---###---",
-        }),
-        vert_glass_tube(ivec2(15,4), {
+            "---###---"
+        );
+
+        static constexpr FrameLayout vert_glass_tube(
             "---",
             "#-#",
             "#1#",
-            "#-#",
-        }),
-        stone_wall(ivec2(27,0), {
+            "#-#"
+        );
+
+        static constexpr FrameLayout stone_wall(
             "-------",
             "---2---",
             "-------",
@@ -155,54 +280,102 @@ namespace Frames
             "-------",
             "-------",
             "---1---",
-            "#######",
-        }),
-        chimney(ivec2(24,7), {
+            "#######"
+        );
+
+        static constexpr FrameLayout chimney(
             "---",
             "##-",
-            "##-",
-        }),
-        coil(ivec2(21,7), {
+            "##-"
+        );
+
+        static constexpr FrameLayout coil(
             "-1-",
             "###",
-            "#-#",
-        }),
-        snek(ivec2(27,8), {
+            "#-#"
+        );
+
+        static constexpr FrameLayout snek(
             "#1###3#",
-            "###2###",
-        }),
-        staff(ivec2(27,10), {
+            "###2###"
+        );
+
+        static constexpr FrameLayout staff(
             "#####-",
-            "----##",
-        }),
-        stars(ivec2(19,7), {
-            "--",
+            "----##"
+        );
+
+        static constexpr FrameLayout stars(
             "--",
-        }),
-        clamp(ivec2(21,10), {
+            "--"
+        );
+
+        static constexpr FrameLayout clamp(
             "######",
             "----1#",
-            "-#####",
-        }),
-        hole(ivec2(34,0), {
+            "-#####"
+        );
+
+        static constexpr FrameLayout hole(
             "#-#",
             "#-#",
             "#-#",
             "#-#",
             "#1#",
-            "###",
-        }),
-        cat(ivec2(18,9), {
+            "###"
+        );
+
+        static constexpr FrameLayout cat(
             "1--",
             "#--",
-            "##-",
-        }),
-        thanks(ivec2(37,0), {
+            "##-"
+        );
+
+        static constexpr FrameLayout thanks(
             "----------",
             "--------1-",
-            "----------",
-        })
+            "----------"
+        );
+    }
+
+    static constexpr FrameType
+        flower_island(ivec2(0,0), Layouts::flower_island),
+        vortex(ivec2(5,0), Layouts::vortex),
+        box(ivec2(10,0), Layouts::box),
+        desert(ivec2(15,0), Layouts::desert),
+        bubbles(ivec2(18,0), Layouts::bubbles),
+        vert_glass_tube(ivec2(15,4), Layouts::vert_glass_tube),
+        stone_wall(ivec2(27,0), Layouts::stone_wall),
+        chimney(ivec2(24,7), Layouts::chimney),
+        coil(ivec2(21,7), Layouts::coil),
+        snek(ivec2(27,8), Layouts::snek),
+        staff(ivec2(27,10), Layouts::staff),
+        stars(ivec2(19,7), Layouts::stars),
+        clamp(ivec2(21,10), Layouts::clamp),
+        hole(ivec2(34,0), Layouts::hole),
+        cat(ivec2(18,9), Layouts::cat),
+        thanks(ivec2(37,0), Layouts::thanks)
         ;
+
+    // All of the above, to pre-composite their images.
+    static constexpr const FrameType *all[] = {
+        &flower_island,
+        &vortex,
+        &box,
+        &desert,
+        &bubbles,
+        &vert_glass_tube,
+        &stone_wall,
+        &chimney,
+        &coil,
+        &snek,
+        &staff,
+        &stars,
+        &clamp,
+        &hole,
+        &cat,
+        &thanks,
+    };
 }
 
 enum class SpawnedEntity
@@ -214,11 +387,31 @@ enum class SpawnedEntity
     key,
 };
 
+// Which entity to spawn at each marker of a frame, see `FrameLayout`. Unused elements are `none`.
+using SpawnList = std::array<SpawnedEntity, max_spawned_entities>;
+
+// A frame as placed in a level.
+struct LevelFrame
+{
+    const FrameType *type = nullptr;
+    ivec2 pos;
+    SpawnList spawned_entity_types{};
+};
+
+// For the interpolated rendering: the offset from `cur` to draw at, `alpha` (0..1) of the way from `prev` to `cur`.
+// Everything is drawn at whole pixels, so this is rounded. This assumes that `cur` itself is drawn at whole pixels.
+[[nodiscard]] static ivec2 InterpolationOffset(ivec2 prev, ivec2 cur, float alpha)
+{
+    return ((prev - cur) * (1 - alpha)).map(EM_FUNC(std::round)).to<int>();
+}
+
 struct Frame
 {
     const FrameType *type = nullptr;
 
     ivec2 pos;
+    // `pos` as of the previous tick, for the interpolated rendering.
+    ivec2 prev_pos;
 
     bool hovered = false;
 
@@ -228,8 +421,8 @@ struct Frame
     ivec2 drag_offset_relative_to_mouse;
 
 
-    // Which entity this frame can spawn at the `1` marker.
-    std::vector<SpawnedEntity> spawned_entity_types;
+    // Which entity this frame spawns at the `1` marker, then at `2`, and so on.
+    SpawnList spawned_entity_types{};
 
 
     bool aabb_overlaps_player = false;
@@ -242,13 +435,23 @@ struct Frame
     std::optional<ivec2> exit_pos;
 
     // The key positions that haven't been picked up yet. In pixels relative to `pos`.
-    std::vector<ivec2> key_positions;
+    // The keys only come from `spawned_entity_types`, so there can't be more than that. Inline, so that loading a level doesn't allocate.
+    InlineVector<ivec2, max_spawned_entities> key_positions;
+
+    // The index of this frame in `Level::frames`. The frames get reordered when dragged, this lets snapshots find the original.
+    std::size_t index_in_level = 0;
 
 
-    Frame(const FrameType &type, ivec2 pos, std::vector<SpawnedEntity> spawned_entity_types = {})
-        : type(&type), pos(pos), spawned_entity_types(std::move(spawned_entity_types))
+    explicit Frame(const LevelFrame &frame)
+        : type(frame.type), pos(frame.pos), prev_pos(frame.pos), spawned_entity_types(frame.spawned_entity_types)
     {}
 
+    // Restores the state from the level data, like the constructor.
+    void Reset(const LevelFrame &frame)
+    {
+        *this = Frame(frame);
+    }
+
     [[nodiscard]] ivec2 TopLeftCorner() const
     {
         return type->GetTopLeftCorner(pos);
@@ -271,51 +474,86 @@ struct Frame
         if (!WorldPixelIsInRect(pixel))
             return -1;
 
-        ivec2 coord = (pixel - TopLeftCorner()) / tile_size;
-        ivec2 num_tiles = type->TileSize();
+        return type->solid_mask.IsSolid(pixel - TopLeftCorner());
+    }
 
-        if (coord.x < 0 || coord.y < 0 || coord.x >= num_tiles.x || coord.y >= num_tiles.y)
-        {
-            assert(false); // This shouldn't happen, as we already checked `WorldPixelIsInRect()`.
-            return -1;
-        }
+    // A horizontal or vertical line of pixels, for collision checks.
+    struct Span
+    {
+        ivec2 start;
+        bool vert = false;
+        // At most 64.
+        int length = 0;
+    };
+
+    // Returns a mask of pixels in `span` (world coordinates) that are in the AABB. Pixel `i` of the span is bit `i`.
+    // If `solid` isn't null, writes the solid pixels among those to it.
+    [[nodiscard]] std::uint64_t QueryWorldSpan(Span span, std::uint64_t *solid = nullptr) const
+    {
+        ivec2 local_start = span.start - TopLeftCorner();
+        ivec2 size = PixelSize();
+
+        int along = span.vert, across = !span.vert;
+        if (local_start[across] < 0 || local_start[across] >= size[across])
+            return 0;
+
+        int begin = std::max(0, -local_start[along]);
+        int end = std::min(span.length, size[along] - local_start[along]);
+        if (begin >= end)
+            return 0;
+
+        ivec2 first = local_start;
+        first[along] += begin;
+        if (solid)
+            *solid = (span.vert ? type->solid_mask.Column(first, end - begin) : type->solid_mask.Row(first, end - begin)) << begin;
 
-        return type->tiles.at(std::size_t(coord.y)).at(std::size_t(coord.x)) == '#';
+        return end - begin == 64 ? ~std::uint64_t(0) : ((std::uint64_t(1) << (end - begin)) - 1) << begin;
     }
 
-    void Render(int num_remaining_keys) const
+    // Where to draw this frame relative to `pos`, at `alpha` (0..1) between the previous and the current tick.
+    [[nodiscard]] ivec2 RenderOffset(float alpha) const
     {
-        ivec2 corner_pos = TopLeftCorner();
+        return InterpolationOffset(prev_pos, pos, alpha);
+    }
+
+    // `tick_counter` is `World::State::global_tick_counter_during_movement`, for the animations.
+    // `alpha` is the same as in `RenderOffset()`.
+    // `shadow` is false in `World::low_detail`.
+    void Render(int num_remaining_keys, int tick_counter, float alpha, bool shadow) const
+    {
+        ivec2 offset = RenderOffset(alpha);
+        ivec2 render_pos = pos + offset;
+        ivec2 corner_pos = TopLeftCorner() + offset;
         ivec2 pixel_size = PixelSize();
 
         float under_alpha = player_is_under_this_frame ? 0.5f : 1;
 
         // Shadow.
-        DrawRectAbs(
-            corner_pos - ivec2(-1) - (hover_time * ivec2(-1,-1)).map(EM_FUNC(std::round)).to<int>(),
-            corner_pos + pixel_size + ivec2(2,2) + (hover_time * ivec2(1,3)).map(EM_FUNC(std::round)).to<int>(),
-            fvec4(0, 0, 0, 0.5f * under_alpha)
-        );
-
-        // The image.
-        DrawRect(corner_pos, pixel_size, {ivec2(0, 128) + tile_size * type->tex_pos, under_alpha, 1});
+        if (shadow)
+        {
+            DrawRectAbs(
+                corner_pos - ivec2(-1) - (hover_time * ivec2(-1,-1)).map(EM_FUNC(std::round)).to<int>(),
+                corner_pos + pixel_size + ivec2(2,2) + (hover_time * ivec2(1,3)).map(EM_FUNC(std::round)).to<int>(),
+                fvec4(0, 0, 0, 0.5f * under_alpha)
+            );
+        }
 
-        // The frame.
-        DrawRectHollow(corner_pos, pixel_size, 1, fvec4(0,0,0,under_alpha));
+        // The image and the frame around it, as one pre-composited rect.
+        DrawFramedImage(corner_pos, type->ImageRegion(), under_alpha);
 
         { // Entities!
             // Exit.
             if (exit_pos)
             {
                 static constexpr int exit_sprite_size = 32;
-                DrawRect(pos + *exit_pos - exit_sprite_size/2, ivec2(exit_sprite_size), {ivec2((num_remaining_keys == 0 ? global_tick_counter_during_movement / 6 % 4 : 4) * exit_sprite_size, 288), under_alpha});
+                DrawRect(render_pos + *exit_pos - exit_sprite_size/2, ivec2(exit_sprite_size), {ivec2((num_remaining_keys == 0 ? tick_counter / 6 % 4 : 4) * exit_sprite_size, 288), under_alpha});
             }
 
             // Keys.
             for (ivec2 key_pos : key_positions)
             {
                 static constexpr int key_sprite_size = 16;
-                DrawRect(pos + key_pos - key_sprite_size/2, ivec2(key_sprite_size), {ivec2(64 + global_tick_counter_during_movement / 30 % 2 * key_sprite_size, 320), under_alpha});
+                DrawRect(render_pos + key_pos - key_sprite_size/2, ivec2(key_sprite_size), {ivec2(64 + tick_counter / 30 % 2 * key_sprite_size, 320), under_alpha});
             }
         }
 
@@ -325,92 +563,222 @@ struct Frame
     }
 };
 
-struct Particle
+// A uniform grid over the frames, to quickly find the frames at a point or overlapping a rect.
+// Each cell lists the indices of frames whose AABBs touch it, in increasing order, which is also the Z order (the last frame is on top).
+// The grid covers the screen, the edge cells also collect everything beyond it. The results are only candidates, check the AABBs yourself.
+class FrameGrid
 {
-    fvec2 pos;
-    fvec2 vel;
-    fvec2 acc;
+    static constexpr int cell_size = 32;
+    static constexpr ivec2 num_cells = (screen_size + cell_size - 1) / cell_size + 2;
+    static constexpr ivec2 origin = -num_cells * cell_size / 2;
 
-    float damp = 0.01f;
+    // The cells each frame touches, inclusive.
+    struct CellRect
+    {
+        ivec2 a;
+        ivec2 b;
+    };
 
-    fvec4 color;
+    std::vector<std::vector<std::size_t>> cells = std::vector<std::vector<std::size_t>>(std::size_t(num_cells.prod()));
+    std::vector<CellRect> frame_cells;
 
-    float max_size = 0;
+    // Scratch space for `FindOverlapping()`.
+    std::vector<std::size_t> merged;
 
-    int total_life = 10;
-    int remaining_life = 10;
+    [[nodiscard]] static ivec2 PixelToCell(ivec2 pixel)
+    {
+        // Clamping before dividing, since the division rounds towards zero.
+        ivec2 rel = pixel - origin;
+        return ivec2(std::clamp(rel.x, 0, num_cells.x * cell_size - 1), std::clamp(rel.y, 0, num_cells.y * cell_size - 1)) / cell_size;
+    }
 
-    Particle() {}
-    Particle(fvec2 pos, fvec2 vel, fvec2 acc, float damp, fvec4 color, float size, int life)
-        : pos(pos), vel(vel), acc(acc), damp(damp), color(color), max_size(size), total_life(life), remaining_life(life)
-    {}
-};
+    [[nodiscard]] std::vector<std::size_t> &Cell(ivec2 cell)
+    {
+        return cells[std::size_t(cell.y * num_cells.x + cell.x)];
+    }
+    [[nodiscard]] const std::vector<std::size_t> &Cell(ivec2 cell) const
+    {
+        return cells[std::size_t(cell.y * num_cells.x + cell.x)];
+    }
 
+    [[nodiscard]] static CellRect FrameCellRect(const Frame &frame)
+    {
+        ivec2 a = frame.TopLeftCorner();
+        return {PixelToCell(a), PixelToCell(a + frame.PixelSize() - 1)};
+    }
 
+    // Adds `index` to its cells. It must be larger than every index already there.
+    void Insert(std::size_t index)
+    {
+        CellRect rect = frame_cells[index];
+        for (int y = rect.a.y; y <= rect.b.y; y++)
+        for (int x = rect.a.x; x <= rect.b.x; x++)
+        {
+            std::vector<std::size_t> &cell = Cell(ivec2(x, y));
+            assert(cell.empty() || cell.back() < index);
+            cell.push_back(index);
+        }
+    }
 
+    void Remove(std::size_t index)
+    {
+        CellRect rect = frame_cells[index];
+        for (int y = rect.a.y; y <= rect.b.y; y++)
+        for (int x = rect.a.x; x <= rect.b.x; x++)
+            std::erase(Cell(ivec2(x, y)), index);
+    }
 
-struct Level
-{
-    int bg_index = 0;
-    ivec2 bg_movement_dir = ivec2(1, 0);
-    std::vector<Frame> frames;
-};
+  public:
+    FrameGrid() {}
 
-static const std::vector<Level> levels = {
+    void Rebuild(const std::vector<Frame> &frames)
     {
-        0, ivec2(1,0),
+        for (std::vector<std::size_t> &cell : cells)
+            cell.clear();
+
+        frame_cells.clear();
+        for (std::size_t i = 0; i < frames.size(); i++)
         {
-            Frame(Frames::flower_island, ivec2(-50, 20), {SpawnedEntity::player}),
-            Frame(Frames::vortex, ivec2(70, -20), {SpawnedEntity::exit}),
+            frame_cells.push_back(FrameCellRect(frames[i]));
+            Insert(i);
         }
-    },
+    }
+
+    // Call this after moving `frames[index]` to the end with `std::rotate()`.
+    void MoveToTop(std::size_t index)
     {
-        1, ivec2(1,0),
+        std::size_t last = frame_cells.size() - 1;
+        if (index == last)
+            return;
+
+        Remove(index);
+
+        // Shift down the indices of the frames that were above it. This preserves the sort order of all cells.
+        for (std::vector<std::size_t> &cell : cells)
         {
-            Frame(Frames::desert, ivec2(-50, -20), {SpawnedEntity::player}),
-            Frame(Frames::box, ivec2(70, 20), {SpawnedEntity::exit}),
+            for (std::size_t &i : cell)
+            {
+                if (i > index)
+                    i--;
+            }
         }
-    },
+
+        std::rotate(frame_cells.begin() + std::ptrdiff_t(index), frame_cells.begin() + std::ptrdiff_t(index) + 1, frame_cells.end());
+        Insert(last);
+    }
+
+    // Call this after `frames[index]` moves. Only the topmost frame can move, since only it can be dragged.
+    void UpdateTopFrame(const Frame &frame)
     {
-        3, ivec2(0,1),
-        {
-            Frame(Frames::stone_wall, ivec2(50,0), {SpawnedEntity::player, SpawnedEntity::exit}),
-            Frame(Frames::chimney, ivec2(-50, -40)),
-            Frame(Frames::coil, ivec2(-50, 40), {SpawnedEntity::key}),
-        }
-    },
+        std::size_t index = frame_cells.size() - 1;
+        CellRect rect = FrameCellRect(frame);
+        if (rect.a == frame_cells[index].a && rect.b == frame_cells[index].b)
+            return;
+
+        Remove(index);
+        frame_cells[index] = rect;
+        Insert(index);
+    }
+
+    // The candidate frames at `pixel`, in increasing order.
+    [[nodiscard]] const std::vector<std::size_t> &FindAt(ivec2 pixel) const
     {
-        2, ivec2(0,1),
-        {
-            Frame(Frames::bubbles, ivec2(-40,0), {SpawnedEntity::player, SpawnedEntity::exit}),
-            Frame(Frames::vert_glass_tube, ivec2(80, 0)),
-        }
-    },
+        return Cell(PixelToCell(pixel));
+    }
+
+    // The candidate frames overlapping the rect from `a` to `b` inclusive, in increasing order.
+    // The returned reference is invalidated by the next call.
+    [[nodiscard]] const std::vector<std::size_t> &FindOverlapping(ivec2 a, ivec2 b)
     {
-        4, ivec2(0,-1),
+        ivec2 cell_a = PixelToCell(a);
+        ivec2 cell_b = PixelToCell(b);
+        if (cell_a == cell_b)
+            return Cell(cell_a);
+
+        merged.clear();
+        for (int y = cell_a.y; y <= cell_b.y; y++)
+        for (int x = cell_a.x; x <= cell_b.x; x++)
         {
-            Frame(Frames::snek, ivec2(0, 40), {SpawnedEntity::player, SpawnedEntity::key, SpawnedEntity::exit}),
-            Frame(Frames::staff, ivec2(-30, -40)),
-            Frame(Frames::stars, ivec2(60, -40)),
+            const std::vector<std::size_t> &cell = Cell(ivec2(x, y));
+            merged.insert(merged.end(), cell.begin(), cell.end());
         }
-    },
+        std::sort(merged.begin(), merged.end());
+        merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+        return merged;
+    }
+};
+
+// At most this many frames per level. The snapshots store that many, see `SnapshotData`.
+static constexpr std::size_t max_frames_per_level = 8;
+
+struct Level
+{
+    int bg_index = 0;
+    ivec2 bg_movement_dir = ivec2(1, 0);
+    std::array<LevelFrame, max_frames_per_level> frame_storage{};
+    std::size_t num_frames = 0;
+
+    [[nodiscard]] constexpr std::span<const LevelFrame> Frames() const
     {
-        5, ivec2(1,0),
-        {
-            Frame(Frames::box, ivec2(-60, -30), {SpawnedEntity::player, SpawnedEntity::exit}),
-            Frame(Frames::clamp, ivec2(-60, 40), {SpawnedEntity::key}),
-            Frame(Frames::hole, ivec2(40, 0), {SpawnedEntity::key}),
-            Frame(Frames::cat, ivec2(120, 0), {SpawnedEntity::key}),
-        }
-    },
+        return {frame_storage.data(), num_frames};
+    }
+};
+
+// Checks the level at compile time. In particular, every spawned entity must have a marker in its frame.
+template <std::size_t N>
+[[nodiscard]] consteval Level MakeLevel(int bg_index, ivec2 bg_movement_dir, const LevelFrame (&frames)[N])
+{
+    static_assert(N > 0 && N <= max_frames_per_level, "Wrong number of frames in a level.");
+
+    Level ret{.bg_index = bg_index, .bg_movement_dir = bg_movement_dir, .num_frames = N};
+    for (std::size_t i = 0; i < N; i++)
     {
-        6, ivec2(0,-1),
+        if (!frames[i].type)
+            throw "A frame in a level has no type.";
+        for (std::size_t j = 0; j < max_spawned_entities; j++)
         {
-            Frame(Frames::cat, ivec2(-40, 50), {SpawnedEntity::player}),
-            Frame(Frames::vert_glass_tube, ivec2(40, 50), {SpawnedEntity::exit}),
-            Frame(Frames::thanks, ivec2(0, -50), {SpawnedEntity::key}),
+            if (frames[i].spawned_entity_types[j] != SpawnedEntity::none && !frames[i].type->marker_offsets[j])
+                throw "This frame wants to spawn an entity, but has no marker for it.";
         }
-    },
+        ret.frame_storage[i] = frames[i];
+    }
+    return ret;
+}
+
+static constexpr std::array levels = {
+    MakeLevel(0, ivec2(1,0), {
+        {&Frames::flower_island, ivec2(-50, 20), {SpawnedEntity::player}},
+        {&Frames::vortex, ivec2(70, -20), {SpawnedEntity::exit}},
+    }),
+    MakeLevel(1, ivec2(1,0), {
+        {&Frames::desert, ivec2(-50, -20), {SpawnedEntity::player}},
+        {&Frames::box, ivec2(70, 20), {SpawnedEntity::exit}},
+    }),
+    MakeLevel(3, ivec2(0,1), {
+        {&Frames::stone_wall, ivec2(50,0), {SpawnedEntity::player, SpawnedEntity::exit}},
+        {&Frames::chimney, ivec2(-50, -40)},
+        {&Frames::coil, ivec2(-50, 40), {SpawnedEntity::key}},
+    }),
+    MakeLevel(2, ivec2(0,1), {
+        {&Frames::bubbles, ivec2(-40,0), {SpawnedEntity::player, SpawnedEntity::exit}},
+        {&Frames::vert_glass_tube, ivec2(80, 0)},
+    }),
+    MakeLevel(4, ivec2(0,-1), {
+        {&Frames::snek, ivec2(0, 40), {SpawnedEntity::player, SpawnedEntity::key, SpawnedEntity::exit}},
+        {&Frames::staff, ivec2(-30, -40)},
+        {&Frames::stars, ivec2(60, -40)},
+    }),
+    MakeLevel(5, ivec2(1,0), {
+        {&Frames::box, ivec2(-60, -30), {SpawnedEntity::player, SpawnedEntity::exit}},
+        {&Frames::clamp, ivec2(-60, 40), {SpawnedEntity::key}},
+        {&Frames::hole, ivec2(40, 0), {SpawnedEntity::key}},
+        {&Frames::cat, ivec2(120, 0), {SpawnedEntity::key}},
+    }),
+    MakeLevel(6, ivec2(0,-1), {
+        {&Frames::cat, ivec2(-40, 50), {SpawnedEntity::player}},
+        {&Frames::vert_glass_tube, ivec2(40, 50), {SpawnedEntity::exit}},
+        {&Frames::thanks, ivec2(0, -50), {SpawnedEntity::key}},
+    }),
 };
 
 
@@ -426,12 +794,91 @@ struct Tutorial
 
     bool dragged_at_least_once = false;
 };
-static Tutorial tut;
 
 
+// Everything here is per world, so that the worlds can be simulated independently (and on different threads, see `batch_sim.h`).
 struct World::State
 {
+    // Seeded randomly by default, see `World::SeedRandom()`.
+    FastRng rng{std::random_device{}()};
+
+    [[nodiscard]] int RandSign()
+    {
+        return rng.Sign();
+    }
+
+    [[nodiscard]] float RandFloat01()
+    {
+        return rng.Float01();
+    }
+
+    [[nodiscard]] float RandFloat11()
+    {
+        return rng.Float11();
+    }
+
+    // Copied from `World::sounds` every tick.
+    bool sounds_enabled = true;
+
+    // Plays a sound, unless disabled or there's no audio context (e.g. when running a replay headlessly, see `replay.h`).
+    // The arguments are evaluated either way, so this consumes the same random numbers regardless.
+    // This only queues the sound for the audio thread, which merges the identical sounds that arrive together. See `Audio::AudioThread`.
+    void PlayWorldSound(const Audio::Buffer &buffer, fvec2 pos, float volume, float pitch) const
+    {
+        if (sounds_enabled && audio.IsRunning())
+            audio.Request(buffer, pos, volume, pitch);
+    }
+
+    // Copied from `World::effects` every tick.
+    bool effects_enabled = true;
+    // Copied from `World::low_detail` every frame.
+    bool low_detail = false;
+    // How many particles `low_detail` draws at most.
+    static constexpr std::size_t low_detail_max_particles = 256;
+
+    // Adds a particle, unless disabled. Same as with the sounds, the arguments are evaluated either way.
+    void AddParticle(fvec2 pos, fvec2 vel, float damp, fvec4 color, float size, int life)
+    {
+        if (effects_enabled)
+            particles.Add(pos, vel, damp, color, size, life);
+    }
+
+    // Adds many particles at once, unless disabled. This always consumes one random number, see `ParticlePool::AddBurst()`.
+    void AddParticleBurst(const ParticlePool::Burst &burst)
+    {
+        std::uint64_t seed = rng.Next64();
+        if (effects_enabled)
+            particles.AddBurst(burst, seed);
+    }
+
+    // The sparks when the exit is reached or spawns, and when a key is collected.
+    [[nodiscard]] static ParticlePool::Burst SparkBurst(ivec2 center, int count, float max_speed, float speed_exponent, float size, int life)
+    {
+        return {
+            .center = center.to<float>(),
+            .count = count,
+            .max_radius = 6,
+            .max_speed = max_speed,
+            .speed_exponent = speed_exponent,
+            .min_color = fvec4(1, 0.5f, 0, 0),
+            .max_color = fvec4(1, 0.75f, 0, 1),
+            .damp = 0.09f,
+            .size = size,
+            .life = life,
+        };
+    }
+
+    Mouse mouse;
+    Keys keys;
+
+    // This is reset when the level is restarted. And this doesn't tick while we're in edit mode.
+    int global_tick_counter_during_movement = 0;
+
+    Tutorial tut;
+
     std::vector<Frame> frames;
+    // Must be kept in sync with `frames`.
+    FrameGrid frame_grid;
 
     std::size_t current_level_index = 0;
 
@@ -439,6 +886,8 @@ struct World::State
     float fade = 1;
     bool winning_fade_out = false;
     int winning_timer = 0;
+    // The last level was won and faded out. We stay like this, and the app decides what to do, see `Status::all_levels_finished`.
+    bool all_levels_finished = false;
 
 
     struct Player
@@ -447,6 +896,8 @@ struct World::State
         bool exists_prev = false;
 
         ivec2 pos;
+        // `pos` as of the previous tick, for the interpolated rendering.
+        ivec2 prev_pos;
         fvec2 vel;
         fvec2 vel_comp;
         bool on_ground = false;
@@ -463,7 +914,11 @@ struct World::State
     bool movement_started = false;
     int background_movement_timer = 0;
 
-    std::deque<Particle> particles;
+    ParticlePool particles;
+
+    // The temporary data of `Tick()` and `Render()`, reset at the start of each. They never run at the same time for the same world.
+    // Not a part of the state, copying the world doesn't copy this.
+    FrameArena scratch;
 
     ivec2 reset_button_size = ivec2(32);
     ivec2 reset_button_pos = screen_size/2 - reset_button_size;
@@ -481,26 +936,11 @@ struct World::State
     {
         frame.key_positions.clear();
 
-        char ch = '1';
-        for (SpawnedEntity e : frame.spawned_entity_types)
+        for (std::size_t i = 0; i < max_spawned_entities; i++)
         {
-            ivec2 offset_to_spawned_entity;
-
-            bool found = false;
-
-            for (int y = 0; y < frame.type->TileSize().y; y++) EM_NAMED_LOOP(outer)
-            for (int x = 0; x < frame.type->TileSize().x; x++)
-            {
-                if (frame.type->tiles[std::size_t(y)][std::size_t(x)] == ch)
-                {
-                    offset_to_spawned_entity = frame.TopLeftCorner() + ivec2(x, y) * tile_size + tile_size / 2 - frame.pos;
-                    found = true;
-                    EM_BREAK(outer);
-                }
-            }
-
-            if (!found)
-                throw std::runtime_error("This frame wants to spawn an entity, but has no marker for it.");
+            SpawnedEntity e = frame.spawned_entity_types[i];
+            // `MakeLevel()` checks at compile time that the markers exist for everything except `none`.
+            ivec2 offset_to_spawned_entity = frame.type->marker_offsets[i].value_or(ivec2());
 
             switch (e)
             {
@@ -509,6 +949,7 @@ struct World::State
               case SpawnedEntity::player:
                 player.exists = true;
                 player.pos = frame.pos + offset_to_spawned_entity;
+                player.prev_pos = player.pos;
                 break;
               case SpawnedEntity::exit:
                 frame.exit_pos = offset_to_spawned_entity;
@@ -517,8 +958,6 @@ struct World::State
                 frame.key_positions.push_back(offset_to_spawned_entity);
                 break;
             }
-
-            ch++;
         }
     }
 
@@ -530,7 +969,13 @@ struct World::State
 
     void LoadLevelData()
     {
-        frames = levels.at(current_level_index).frames;
+        std::span<const LevelFrame> level_frames = levels.at(current_level_index).Frames();
+        frames.clear();
+        // Once this is done, the level changes and restarts don't allocate. A no-op after the first level, unless this world was copied.
+        frames.reserve(max_frames_per_level);
+        for (std::size_t i = 0; i < level_frames.size(); i++)
+            frames.emplace_back(level_frames[i]).index_in_level = i;
+        frame_grid.Rebuild(frames);
 
         movement_started = false;
         player = {};
@@ -540,7 +985,8 @@ struct World::State
         fade = 1;
         winning_fade_out = false;
         winning_timer = 0;
-        particles.clear();
+        all_levels_finished = false;
+        particles.Clear();
     }
 
     void RestartLevel()
@@ -552,6 +998,10 @@ struct World::State
 
     void Tick()
     {
+        EM_TRACE_ZONE("World::State::Tick");
+
+        scratch.Reset();
+
         static constexpr ivec2 player_hitbox_corners[] = {
             ivec2(-4, -3),
             ivec2( 3, -3),
@@ -559,57 +1009,21 @@ struct World::State
             ivec2( 3, 7),
         };
 
-        static constexpr ivec2 player_hitbox_full[] = {
-            ivec2(-4, -3),
-            ivec2(-3, -3),
-            ivec2(-2, -3),
-            ivec2(-1, -3),
-            ivec2( 0, -3),
-            ivec2( 1, -3),
-            ivec2( 2, -3),
-            ivec2( 3, -3),
-
-            ivec2(-4, 7),
-            ivec2(-3, 7),
-            ivec2(-2, 7),
-            ivec2(-1, 7),
-            ivec2( 0, 7),
-            ivec2( 1, 7),
-            ivec2( 2, 7),
-            ivec2( 3, 7),
-
-            ivec2(-4, -2),
-            ivec2(-4, -1),
-            ivec2(-4,  0),
-            ivec2(-4,  1),
-            ivec2(-4,  2),
-            ivec2(-4,  3),
-            ivec2(-4,  4),
-            ivec2(-4,  5),
-            ivec2(-4,  6),
-
-            ivec2(3, -2),
-            ivec2(3, -1),
-            ivec2(3,  0),
-            ivec2(3,  1),
-            ivec2(3,  2),
-            ivec2(3,  3),
-            ivec2(3,  4),
-            ivec2(3,  5),
-            ivec2(3,  6),
+        // The perimeter of the hitbox, as the corners above but one pixel larger in each direction.
+        // The order matters for `SolidAtOffset()` below, because it can make the player go under a frame mid-check.
+        static constexpr Frame::Span player_hitbox_full[] = {
+            {ivec2(-4, -3), false, 8}, // Top.
+            {ivec2(-4,  7), false, 8}, // Bottom.
+            {ivec2(-4, -2), true,  9}, // Left.
+            {ivec2( 3, -2), true,  9}, // Right.
         };
 
-        { // Particles.
-            // Remove dead particles.
-            std::erase_if(particles, [](const Particle &part){return part.remaining_life <= 0;});
+        // Remember the positions for the interpolated rendering. The particles do this themselves.
+        for (Frame &frame : frames)
+            frame.prev_pos = frame.pos;
+        player.prev_pos = player.pos;
 
-            for (Particle &part : particles)
-            {
-                part.pos += part.vel;
-                part.vel *= 1.f - part.damp;
-                part.remaining_life--;
-            }
-        }
+        particles.Tick();
 
         { // The reset button.
             static constexpr float
@@ -652,9 +1066,9 @@ struct World::State
         { // Clicking a frame during movement kills the player and restarts the level.
             if (movement_started && mouse.IsPressed() && !winning_fade_out)
             {
-                for (const Frame &frame : frames) EM_NAMED_LOOP(outer)
+                for (std::size_t i : frame_grid.FindAt(mouse.pos)) EM_NAMED_LOOP(outer)
                 {
-                    if (frame.WorldPixelIsInRect(mouse.pos))
+                    if (frames[i].WorldPixelIsInRect(mouse.pos))
                     {
                         player.exists = false;
                         tut.explaining_reset_by_drag = false; // Remove the tutorial message as well.
@@ -670,22 +1084,26 @@ struct World::State
         bool any_frame_dragged = std::any_of(frames.begin(), frames.end(), EM_MEMBER(.dragged));
 
         { // Resolve which frame is hovered.
-            std::size_t i = frames.size();
-            bool found = false;
-            while (i-- > 0)
+            // Only the topmost frame can be dragged, and the dragged frame is always hovered.
+            if (!frames.empty() && frames.back().dragged)
             {
-                Frame &frame = frames[i];
-                if (!found && /* !movement_started &&*/ (frame.dragged || (!reset_button_hovered && frame.WorldPixelIsInRect(mouse.pos) && !winning_fade_out)))
-                {
-                    found = true;
-                    frame.hovered = true;
-                    hovered_frame_index = i;
-                }
-                else
+                hovered_frame_index = frames.size() - 1;
+            }
+            else if (/* !movement_started &&*/ !reset_button_hovered && !winning_fade_out)
+            {
+                const std::vector<std::size_t> &candidates = frame_grid.FindAt(mouse.pos);
+                for (std::size_t j = candidates.size(); j-- > 0;)
                 {
-                    frame.hovered = false;
+                    if (frames[candidates[j]].WorldPixelIsInRect(mouse.pos))
+                    {
+                        hovered_frame_index = candidates[j];
+                        break;
+                    }
                 }
             }
+
+            for (std::size_t i = 0; i < frames.size(); i++)
+                frames[i].hovered = i == hovered_frame_index;
         }
 
         { // Update frame hover timers.
@@ -725,6 +1143,7 @@ struct World::State
             {
                 // Move the activated frame to the end.
                 std::rotate(frames.begin() + std::ptrdiff_t(hovered_frame_index), frames.begin() + std::ptrdiff_t(hovered_frame_index) + 1, frames.end());
+                frame_grid.MoveToTop(hovered_frame_index);
                 // And update the index to match too.
                 hovered_frame_index = frames.size() - 1;
 
@@ -737,7 +1156,7 @@ struct World::State
 
                 tut.dragged_at_least_once = true;
 
-                audio.Play("drag"_sound, mouse.pos, 1, RandFloat11() * 0.2f);
+                PlayWorldSound("drag"_sound, mouse.pos, 1, RandFloat11() * 0.2f);
             }
 
             // Finish drag.
@@ -745,7 +1164,7 @@ struct World::State
             {
                 frames.back().dragged = false;
 
-                audio.Play("drag"_sound, mouse.pos, 1, RandFloat11() * 0.2f);
+                PlayWorldSound("drag"_sound, mouse.pos, 1, RandFloat11() * 0.2f);
             }
 
             // Continue drag.
@@ -754,7 +1173,7 @@ struct World::State
                 frames.back().pos = mouse.pos + frames.back().drag_offset_relative_to_mouse;
 
                 // Clamp frame position.
-                ivec2 bound = screen_size / 2 - frames.back().PixelSize() / 2 - 8;
+                ivec2 bound = MaxFramePos(frames.back().PixelSize());
                 if (frames.back().pos.x < -bound.x)
                     frames.back().pos.x = -bound.x;
                 else if (frames.back().pos.x > bound.x)
@@ -764,6 +1183,8 @@ struct World::State
                 else if (frames.back().pos.y > bound.y)
                     frames.back().pos.y = bound.y;
 
+                frame_grid.UpdateTopFrame(frames.back());
+
                 // Drag the entities with the frames.
                 if (!movement_started)
                     InitEntityFromSpecificFrame(frames.back());
@@ -773,6 +1194,9 @@ struct World::State
         std::optional<std::size_t> topmost_touched_frame;
         { // Update AABB overlap flags for frames.
             bool no_movement_and_found_player_frame = false;
+            // Only those can overlap the player. This is sorted, so we walk it in parallel with `frames`.
+            const std::vector<std::size_t> &candidates = frame_grid.FindOverlapping(player.pos + player_hitbox_corners[0], player.pos + player_hitbox_corners[3]);
+            std::size_t next_candidate = 0;
             std::size_t i = 0;
             for (Frame &frame : frames)
             {
@@ -780,18 +1204,23 @@ struct World::State
                 if (!movement_started)
                     frame.player_is_under_this_frame = false;
 
-                for (ivec2 point : player_hitbox_corners)
+                if (next_candidate < candidates.size() && candidates[next_candidate] == i)
                 {
-                    if (frame.WorldPixelIsInRect(player.pos + point))
+                    next_candidate++;
+
+                    for (ivec2 point : player_hitbox_corners)
                     {
-                        frame.aabb_overlaps_player = true;
+                        if (frame.WorldPixelIsInRect(player.pos + point))
+                        {
+                            frame.aabb_overlaps_player = true;
 
-                        if (!frame.player_is_under_this_frame)
-                            topmost_touched_frame = i;
+                            if (!frame.player_is_under_this_frame)
+                                topmost_touched_frame = i;
 
-                        if (no_movement_and_found_player_frame)
-                            frame.player_is_under_this_frame = true;
-                        break;
+                            if (no_movement_and_found_player_frame)
+                                frame.player_is_under_this_frame = true;
+                            break;
+                        }
                     }
                 }
 
@@ -816,9 +1245,10 @@ struct World::State
         { // Player to frame entity interactions. This is before player movement, this looks better.
             if (movement_started && player.exists)
             {
-                for (std::size_t i = frames.size(); i-- > 0;)
+                const std::vector<std::size_t> &candidates = frame_grid.FindAt(player.pos);
+                for (std::size_t j = candidates.size(); j-- > 0;)
                 {
-                    Frame &frame = frames[i];
+                    Frame &frame = frames[candidates[j]];
 
                     if (frame.player_is_under_this_frame)
                         continue; // The frame is above the player, no interaction.
@@ -837,24 +1267,11 @@ struct World::State
                         if (dist.x < exit_hitbox_size.x && dist.y < exit_hitbox_size.y)
                         {
                             frame.exit_pos = {};
-                            audio.Play("win"_sound, exit_world_pos, 1, RandFloat11() * 0.2f);
+                            PlayWorldSound("win"_sound, exit_world_pos, 1, RandFloat11() * 0.2f);
                             player.exists = false;
                             winning_fade_out = true;
 
-                            for (int i = 0; i < 64; i++)
-                            {
-                                float a1 = RandAngle();
-
-                                particles.push_back(Particle(
-                                    exit_world_pos + fvec2(std::cos(a1), std::sin(a1)) * (RandFloat01() * 6),
-                                    fvec2(std::cos(a1), std::sin(a1)) * std::pow(RandFloat01() * 1.5f, 3.f),
-                                    fvec2(),
-                                    0.09f,
-                                    fvec4(1, 0.5f + 0.25f * RandFloat01(), 0, RandFloat01()),
-                                    2,
-                                    90
-                                ));
-                            }
+                            AddParticleBurst(SparkBurst(exit_world_pos, 64, 1.5f * 1.5f * 1.5f, 3, 2, 90));
                         }
                     }
 
@@ -868,23 +1285,10 @@ struct World::State
                         ivec2 dist = (key_world_pos - player.pos).map(EM_FUNC(std::abs));
                         if (dist.x < key_hitbox_size.x && dist.y < key_hitbox_size.y)
                         {
-                            audio.Play("key_collected"_sound, key_world_pos, 1, RandFloat11() * 0.2f);
+                            PlayWorldSound("key_collected"_sound, key_world_pos, 1, RandFloat11() * 0.2f);
 
                             // Particles on key.
-                            for (int i = 0; i < 5; i++)
-                            {
-                                float a1 = RandAngle();
-
-                                particles.push_back(Particle(
-                                    key_world_pos + fvec2(std::cos(a1), std::sin(a1)) * (RandFloat01() * 6),
-                                    fvec2(std::cos(a1), std::sin(a1)) * std::pow(RandFloat01() * 1.5f, 2.f),
-                                    fvec2(),
-                                    0.09f,
-                                    fvec4(1, 0.5f + 0.25f * RandFloat01(), 0, RandFloat01()),
-                                    2,
-                                    60
-                                ));
-                            }
+                            AddParticleBurst(SparkBurst(key_world_pos, 5, 1.5f * 1.5f, 2, 2, 60));
 
                             // Particles on exit if it has just spawned.
                             if (num_remaining_keys == 1)
@@ -900,22 +1304,7 @@ struct World::State
                                 }
 
                                 if (exit_world_pos)
-                                {
-                                    for (int i = 0; i < 20; i++)
-                                    {
-                                        float a1 = RandAngle();
-
-                                        particles.push_back(Particle(
-                                            *exit_world_pos + fvec2(std::cos(a1), std::sin(a1)) * (RandFloat01() * 6),
-                                            fvec2(std::cos(a1), std::sin(a1)) * std::pow(RandFloat01() * 1.5f, 2.f),
-                                            fvec2(),
-                                            0.09f,
-                                            fvec4(1, 0.5f + 0.25f * RandFloat01(), 0, RandFloat01()),
-                                            3,
-                                            90
-                                        ));
-                                    }
-                                }
+                                    AddParticleBurst(SparkBurst(*exit_world_pos, 20, 1.5f * 1.5f, 2, 3, 90));
                             }
 
                             it = frame.key_positions.erase(it);
@@ -960,7 +1349,7 @@ struct World::State
             if (hc)
             {
                 if (!movement_started)
-                    audio.Play("start_moving"_sound, player.pos, 1, RandFloat11() * 0.2f);
+                    PlayWorldSound("start_moving"_sound, player.pos, 1, RandFloat11() * 0.2f);
                 movement_started = true;
 
                 player.facing_left = hc < 0;
@@ -985,17 +1374,73 @@ struct World::State
             }
 
 
+            // Whether the player must go under `frames[i]` instead of colliding with it, if `update_frames` is true.
+            auto ShouldGoUnderFrame = [&](std::size_t i, bool update_frames)
+            {
+                return !frames[i].aabb_overlaps_player && topmost_touched_frame && *topmost_touched_frame < i && update_frames;
+            };
+
             auto SolidAtOffset = [&](ivec2 offset, bool update_frames)
             {
+
+                // The fast path: if the player can't go under any frame during this check, the checks don't affect each other,
+                // so we can test whole spans at once. For each frame from the top, take the pixels that are in its AABB and not claimed by a higher frame.
+                bool can_go_under = false;
+                for (std::size_t i = 0; i < frames.size(); i++)
+                {
+                    if (!frames[i].player_is_under_this_frame && ShouldGoUnderFrame(i, update_frames))
+                    {
+                        can_go_under = true;
+                        break;
+                    }
+                }
+
+                if (!can_go_under)
+                {
+                    for (Frame::Span span : player_hitbox_full)
+                    {
+                        span.start += player.pos + offset;
+                        std::uint64_t unclaimed = span.length == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << span.length) - 1;
+
+                        ivec2 span_end = span.start;
+                        span_end[span.vert] += span.length - 1;
+                        const std::vector<std::size_t> &candidates = frame_grid.FindOverlapping(span.start, span_end);
+
+                        std::size_t j = candidates.size();
+                        while (j-- > 0 && unclaimed)
+                        {
+                            const Frame &frame = frames[candidates[j]];
+                            if (frame.player_is_under_this_frame)
+                                continue;
+
+                            std::uint64_t solid = 0;
+                            std::uint64_t claimed = frame.QueryWorldSpan(span, &solid) & unclaimed;
+                            if (solid & claimed)
+                                return true;
+                            unclaimed &= ~claimed;
+                        }
+                    }
+
+                    return false;
+                }
+
+                // The slow path, pixel by pixel.
                 bool ret = false;
 
-                for (ivec2 point : player_hitbox_full)
+                for (Frame::Span span : player_hitbox_full)
+                for (int j = 0; j < span.length; j++)
                 {
+                    ivec2 point = span.start;
+                    point[span.vert] += j;
+
                     bool found_aabb_overlap = false;
 
-                    std::size_t i = frames.size();
-                    while (i-- > 0)
+                    // Frames not in this list don't contain the point, so we can skip them.
+                    const std::vector<std::size_t> &candidates = frame_grid.FindAt(player.pos + point + offset);
+                    std::size_t k = candidates.size();
+                    while (k-- > 0)
                     {
+                        std::size_t i = candidates[k];
                         Frame &frame = frames[i];
 
                         if (!found_aabb_overlap && !frame.player_is_under_this_frame)
@@ -1007,7 +1452,7 @@ struct World::State
 
                             if (r == 1)
                             {
-                                if (!frame.aabb_overlaps_player && topmost_touched_frame && *topmost_touched_frame < i && update_frames)
+                                if (ShouldGoUnderFrame(i, update_frames))
                                 {
                                     frame.player_is_under_this_frame = true;
                                 }
@@ -1023,24 +1468,97 @@ struct World::State
                 return ret;
             };
 
+            // A snapshot of what `SolidAtOffset(..., true)` sees around the player, used by the movement below.
+            // One row of bits per pixel row, starting from `corner`. `solid` is what we collide with.
+            // `under` is where the player would go under a frame instead, which changes the frames and so needs the slow path.
+            struct CollisionField
+            {
+                ivec2 corner;
+                ArenaVector<std::uint64_t> solid;
+                ArenaVector<std::uint64_t> under;
+            };
+
+            // Fills `field` for the pixels from `corner` to `corner + size - 1`. `size.x` must be at most 64.
+            // This is the same per-span logic as in `SolidAtOffset()`, but instead of stopping at a solid pixel, it remembers all of them.
+            auto FillCollisionField = [&](CollisionField &field, ivec2 corner, ivec2 size)
+            {
+                assert(size.x <= 64);
+                field.corner = corner;
+                field.solid.assign(std::size_t(size.y), 0);
+                field.under.assign(std::size_t(size.y), 0);
+
+                for (int y = 0; y < size.y; y++)
+                {
+                    Frame::Span span{corner + ivec2(0, y), false, size.x};
+                    std::uint64_t unclaimed = size.x == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << size.x) - 1;
+
+                    const std::vector<std::size_t> &candidates = frame_grid.FindOverlapping(span.start, span.start + ivec2(size.x - 1, 0));
+                    std::size_t j = candidates.size();
+                    while (j-- > 0 && unclaimed)
+                    {
+                        const Frame &frame = frames[candidates[j]];
+                        if (frame.player_is_under_this_frame)
+                            continue;
+
+                        std::uint64_t solid = 0;
+                        std::uint64_t claimed = frame.QueryWorldSpan(span, &solid) & unclaimed;
+                        (ShouldGoUnderFrame(candidates[j], true) ? field.under : field.solid)[std::size_t(y)] |= solid & claimed;
+                        unclaimed &= ~claimed;
+                    }
+                }
+            };
+
+            // Tests the hitbox perimeter at `player.pos + offset` against `field`, which must cover it.
+            // Returns 1 if solid, 0 if not, or -1 if the player would go under a frame, then you must call `SolidAtOffset(offset, true)` instead.
+            auto QueryCollisionField = [&](const CollisionField &field, ivec2 offset) -> int
+            {
+                auto AnyBits = [&](const ArenaVector<std::uint64_t> &rows, Frame::Span span)
+                {
+                    if (span.vert)
+                    {
+                        for (int j = 0; j < span.length; j++)
+                        {
+                            if (rows[std::size_t(span.start.y + j)] >> span.start.x & 1)
+                                return true;
+                        }
+                        return false;
+                    }
+                    else
+                    {
+                        std::uint64_t mask = span.length == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << span.length) - 1;
+                        return bool(rows[std::size_t(span.start.y)] >> span.start.x & mask);
+                    }
+                };
+
+                bool ret = false;
+                for (Frame::Span span : player_hitbox_full)
+                {
+                    span.start += player.pos + offset - field.corner;
+                    if (AnyBits(field.under, span))
+                        return -1;
+                    if (AnyBits(field.solid, span))
+                        ret = true;
+                }
+                return ret;
+            };
+
             player.on_ground_prev = player.on_ground;
             player.on_ground = SolidAtOffset(ivec2(0, 1), false);
 
             if (player.on_ground && !player.on_ground_prev && movement_started)
             {
-                audio.Play("landing"_sound, player.pos, 1, RandFloat11() * 0.3f);
+                PlayWorldSound("landing"_sound, player.pos, 1, RandFloat11() * 0.3f);
 
                 for (int i = 0; i < 8; i++)
                 {
-                    particles.push_back(Particle(
+                    AddParticle(
                         player.pos + ivec2(0,8) + fvec2(RandSign() * (2.f + 1.2f * RandFloat01()), RandFloat11()),
                         fvec2(RandFloat11() * 0.7f, RandFloat01() * -0.14f),
-                        fvec2(0,-0.01f),
                         0.01f,
                         fvec3(0.7f + RandFloat01() * 0.2f).to_vec4(0.7f),
                         3,
                         30
-                    ));
+                    );
                 }
             }
 
@@ -1057,19 +1575,18 @@ struct World::State
                     player.vel.y = -3;
                     player.vel_comp.y = 0;
 
-                    audio.Play("jump"_sound, player.pos, 1, RandFloat11() * 0.3f);
+                    PlayWorldSound("jump"_sound, player.pos, 1, RandFloat11() * 0.3f);
 
                     for (int i = 0; i < 4; i++)
                     {
-                        particles.push_back(Particle(
+                        AddParticle(
                             player.pos + ivec2(0,7) + fvec2(RandFloat11() * 4, RandFloat01()),
                             fvec2(RandFloat11() * 0.2f, RandFloat01() * -0.48f),
-                            fvec2(0,-0.01f),
                             0.01f,
                             fvec3(0.7f + RandFloat01() * 0.2f).to_vec4(0.7f),
                             3,
                             30
-                        ));
+                        );
                     }
                 }
                 else
@@ -1106,6 +1623,16 @@ struct World::State
 
                 bool moved_x = false;
 
+                // We still move one pixel at a time, but test the steps against a snapshot of the collision data around the whole path.
+                // That's a few bit operations per step, regardless of the number of frames.
+                // When a step makes the player go under a frame, we fall back to `SolidAtOffset()` for it and refill the snapshot, since the frames change.
+                ivec2 field_corner = player.pos + player_hitbox_corners[0] + int_vel.map([](int x){return std::min(x, 0);});
+                ivec2 field_size = player_hitbox_corners[3] - player_hitbox_corners[0] + 1 + int_vel.map(EM_FUNC(std::abs));
+                bool use_field = field_size.x <= 64;
+                CollisionField field{.solid = ArenaVector<std::uint64_t>(scratch), .under = ArenaVector<std::uint64_t>(scratch)};
+                if (use_field)
+                    FillCollisionField(field, field_corner, field_size);
+
                 while (int_vel != ivec2())
                 {
                     for (bool vert : {false, true})
@@ -1116,7 +1643,22 @@ struct World::State
                         ivec2 offset;
                         offset[vert] = int_vel[vert] > 0 ? 1 : -1;
 
-                        if (SolidAtOffset(offset, true))
+                        bool solid = false;
+                        int field_result = use_field ? QueryCollisionField(field, offset) : -1;
+                        if (field_result < 0)
+                        {
+                            solid = SolidAtOffset(offset, true);
+                            if (use_field)
+                                FillCollisionField(field, field_corner, field_size);
+                        }
+                        else
+                        {
+                            solid = field_result == 1;
+                            // Without frames to go under, this must agree with the non-updating check.
+                            assert(solid == SolidAtOffset(offset, false));
+                        }
+
+                        if (solid)
                         {
                             if (int_vel[vert] * player.vel[vert] > 0)
                             {
@@ -1168,23 +1710,21 @@ struct World::State
         // Player death.
         if (!player.exists && player.exists_prev && !winning_fade_out)
         {
-            audio.Play("death"_sound, player.pos, 1, RandFloat11() * 0.1f);
-
-            for (int i = 0; i < 64; i++)
-            {
-                float a1 = RandAngle();
-                float a2 = RandAngle();
-
-                particles.push_back(Particle(
-                    player.pos + fvec2(std::cos(a1), std::sin(a1)) * (RandFloat01() * 6),
-                    fvec2(std::cos(a2), std::sin(a2)) * std::pow(RandFloat01() * 2.f, 1.5f),
-                    fvec2(),
-                    0.01f,
-                    fvec3(0.6f + RandFloat01() * 0.4f).to_vec4(0.5f + RandFloat01() * 0.5f),
-                    4,
-                    90
-                ));
-            }
+            PlayWorldSound("death"_sound, player.pos, 1, RandFloat11() * 0.1f);
+
+            AddParticleBurst({
+                .center = player.pos.to<float>(),
+                .count = 64,
+                .max_radius = 6,
+                .max_speed = 2 * std::numbers::sqrt2_v<float>, // 2^1.5
+                .speed_exponent = 1.5f,
+                .random_velocity_dir = true,
+                .min_color = fvec4(0.6f, 0.6f, 0.6f, 0.5f),
+                .max_color = fvec4(1),
+                .damp = 0.01f,
+                .size = 4,
+                .life = 90,
+            });
         }
         player.exists_prev = player.exists;
 
@@ -1194,23 +1734,22 @@ struct World::State
                 player.death_timer++;
                 if (player.death_timer > 45)
                 {
-                    audio.Play("respawn"_sound, player.pos, 1, RandFloat11() * 0.2f);
+                    PlayWorldSound("respawn"_sound, player.pos, 1, RandFloat11() * 0.2f);
                     RestartLevel();
 
-                    for (int i = 0; i < 16; i++)
-                    {
-                        float a1 = RandAngle();
-
-                        particles.push_back(Particle(
-                            player.pos + fvec2(std::cos(a1), std::sin(a1)) * (3 + RandFloat01()),
-                            fvec2(std::cos(a1), std::sin(a1)) * (1),
-                            fvec2(),
-                            0.05f,
-                            fvec3(0.7f + RandFloat01() * 0.2f).to_vec4(1),
-                            3,
-                            20
-                        ));
-                    }
+                    AddParticleBurst({
+                        .center = player.pos.to<float>(),
+                        .count = 16,
+                        .min_radius = 3,
+                        .max_radius = 4,
+                        .max_speed = 1,
+                        .speed_exponent = 0,
+                        .min_color = fvec4(0.7f, 0.7f, 0.7f, 1),
+                        .max_color = fvec4(0.9f, 0.9f, 0.9f, 1),
+                        .damp = 0.05f,
+                        .size = 3,
+                        .life = 20,
+                    });
                 }
             }
         }
@@ -1228,11 +1767,16 @@ struct World::State
                     fade += fade_step;
                     if (fade > 1)
                     {
-                        current_level_index++;
-                        if (current_level_index >= levels.size())
-                            std::exit(0); // Oh well.
-
-                        LoadLevelData();
+                        if (current_level_index + 1 < levels.size())
+                        {
+                            current_level_index++;
+                            LoadLevelData();
+                        }
+                        else
+                        {
+                            fade = 1;
+                            all_levels_finished = true;
+                        }
                     }
                 }
             }
@@ -1302,23 +1846,23 @@ struct World::State
         }
     }
 
-    void Render() const
+    // `alpha` is how far we are (0..1) from the previous tick to the current one. See `World::Render()`.
+    void Render(float alpha)
     {
+        EM_TRACE_ZONE("World::State::Render");
+
+        scratch.Reset();
+
         { // Background.
             static constexpr ivec2 bg_size(128);
 
             ivec2 vel = levels[current_level_index].bg_movement_dir;
 
-            ivec2 count = (screen_size + bg_size - 1) / bg_size;
-            for (int y = -(vel.y > 0); y < count.y + (vel.y < 0); y++)
-            for (int x = -(vel.x > 0); x < count.x + (vel.x < 0); x++)
-            {
-                DrawRect(ivec2(x, y) * bg_size - screen_size / 2 + vel * ivec2(background_movement_timer / 2 % bg_size.x), bg_size, ivec2(bg_size.x * levels[current_level_index].bg_index, 0));
-            }
+            DrawTiledBackground(ivec2(bg_size.x * levels[current_level_index].bg_index, 0), bg_size, vel * ivec2(background_movement_timer / 2 % bg_size.x));
         }
 
         { // Level number.
-            std::string str = fmt::format("{}", current_level_index + 1);
+            std::string_view str = FormatToArena(scratch, "{}", current_level_index + 1);
 
             static constexpr ivec2 glyph_size(8, 16);
 
@@ -1331,7 +1875,8 @@ struct World::State
         }
 
         // Vignette.
-        DrawRect(-screen_size / 2, screen_size, {ivec2(544, 754), 0.1f});
+        if (!low_detail)
+            DrawRect(-screen_size / 2, screen_size, {ivec2(544, 754), 0.1f});
 
         // Frames.
         std::size_t frame_index = 0;
@@ -1340,14 +1885,16 @@ struct World::State
             if (frames[frame_index].player_is_under_this_frame)
                 break;
 
-            frames[frame_index].Render(num_remaining_keys);
+            frames[frame_index].Render(num_remaining_keys, global_tick_counter_during_movement, alpha, !low_detail);
         }
 
-        { // Frame borders that are visible through other frames. Only doing this for non-transparent frames.
+        // Frame borders that are visible through other frames. Only doing this for non-transparent frames.
+        if (!low_detail)
+        {
             for (std::size_t i = 0; i < frame_index; i++)
             {
                 const Frame &frame = frames[i];
-                DrawRectHollow(frame.TopLeftCorner(), frame.PixelSize(), 1, fvec4(0,0,0,0.06f));
+                DrawImageFrame(frame.TopLeftCorner() + frame.RenderOffset(alpha), frame.type->ImageRegion(), 0.06f);
             }
         }
 
@@ -1381,25 +1928,17 @@ struct World::State
                     pl_frame = 4;
             }
 
-            DrawRect(player.pos - player_sprite_size / 2 + ivec2(0,2), ivec2(player_sprite_size), {ivec2(0, 240) + ivec2(pl_frame, pl_state) * player_sprite_size, 1, 1, player.facing_left});
+            ivec2 render_pos = player.pos + InterpolationOffset(player.prev_pos, player.pos, alpha);
+            DrawRect(render_pos - player_sprite_size / 2 + ivec2(0,2), ivec2(player_sprite_size), {ivec2(0, 240) + ivec2(pl_frame, pl_state) * player_sprite_size, 1, 1, player.facing_left});
 
         }
 
-        { // Particles.
-            for (const Particle &part : particles)
-            {
-                int size = (int)std::round(part.max_size * part.remaining_life / part.total_life);
-
-                ivec2 corner = (part.pos - size / 2).map(EM_FUNC(std::round)).to<int>();
-
-                DrawRect(corner, ivec2(size), part.color);
-            }
-        }
+        particles.Render(alpha, low_detail ? low_detail_max_particles : std::size_t(-1));
 
         // Frames above the player.
         for (; frame_index < frames.size(); frame_index++)
         {
-            frames[frame_index].Render(num_remaining_keys);
+            frames[frame_index].Render(num_remaining_keys, global_tick_counter_during_movement, alpha, !low_detail);
         }
 
 
@@ -1433,6 +1972,66 @@ struct World::State
 };
 
 
+namespace
+{
+    // The positions fit in 16 bits, the screen is much smaller than that.
+    struct SnapshotVec
+    {
+        std::int16_t x = 0;
+        std::int16_t y = 0;
+
+        SnapshotVec() {}
+        SnapshotVec(ivec2 v) : x(std::int16_t(v.x)), y(std::int16_t(v.y)) {}
+
+        [[nodiscard]] operator ivec2() const {return ivec2(x, y);}
+    };
+
+    struct FrameSnapshot
+    {
+        static constexpr std::size_t max_keys = 4;
+
+        std::uint8_t index_in_level = 0;
+        std::uint8_t num_keys = 0;
+        bool hovered = false;
+        bool dragged = false;
+        bool aabb_overlaps_player = false;
+        bool player_is_under_this_frame = false;
+        bool has_exit = false;
+        float hover_time = 0;
+        SnapshotVec pos;
+        SnapshotVec drag_offset_relative_to_mouse;
+        SnapshotVec exit_pos;
+        SnapshotVec key_positions[max_keys];
+    };
+
+    // Everything in `World::State` that changes during the gameplay, except the random number generator and the particles,
+    //   which only affect the visuals. The rest is restored from `levels`.
+    struct SnapshotData
+    {
+        static constexpr std::size_t max_frames = max_frames_per_level;
+
+        std::uint8_t level_index = 0;
+        std::uint8_t num_frames = 0;
+        bool winning_fade_out = false;
+        bool all_levels_finished = false;
+        bool movement_started = false;
+        bool reset_button_hovered = false;
+        float fade = 0;
+        int winning_timer = 0;
+        int background_movement_timer = 0;
+        float reset_button_vis_timer = 0;
+        int num_remaining_keys = 0;
+        int global_tick_counter_during_movement = 0;
+        World::State::Player player;
+        Mouse mouse;
+        Keys keys;
+        Tutorial tut;
+        FrameSnapshot frames[max_frames];
+    };
+    static_assert(std::is_trivially_copyable_v<SnapshotData>);
+    static_assert(sizeof(SnapshotData) <= World::Snapshot::size, "Increase `World::Snapshot::size`.");
+}
+
 World::World() : state(std::make_unique<State>()) {}
 World::World(const World &) = default;
 World::World(World &&) = default;
@@ -1440,36 +2039,326 @@ World &World::operator=(const World &) = default;
 World &World::operator=(World &&) = default;
 World::~World() = default;
 
-void World::Tick()
+std::size_t World::NumLevels()
+{
+    return levels.size();
+}
+
+void World::LoadLevel(std::size_t index)
+{
+    state->current_level_index = index;
+    state->LoadLevelData();
+}
+
+World::Snapshot World::SaveSnapshot() const
+{
+    const State &s = *state;
+
+    if (s.frames.size() > SnapshotData::max_frames)
+        throw std::runtime_error(fmt::format("Too many frames for a snapshot: {}, the maximum is {}.", s.frames.size(), SnapshotData::max_frames));
+
+    SnapshotData data;
+    data.level_index = std::uint8_t(s.current_level_index);
+    data.num_frames = std::uint8_t(s.frames.size());
+    data.winning_fade_out = s.winning_fade_out;
+    data.all_levels_finished = s.all_levels_finished;
+    data.movement_started = s.movement_started;
+    data.reset_button_hovered = s.reset_button_hovered;
+    data.fade = s.fade;
+    data.winning_timer = s.winning_timer;
+    data.background_movement_timer = s.background_movement_timer;
+    data.reset_button_vis_timer = s.reset_button_vis_timer;
+    data.num_remaining_keys = s.num_remaining_keys;
+    data.global_tick_counter_during_movement = s.global_tick_counter_during_movement;
+    data.player = s.player;
+    data.mouse = s.mouse;
+    data.keys = s.keys;
+    data.tut = s.tut;
+
+    for (std::size_t i = 0; i < s.frames.size(); i++)
+    {
+        const Frame &frame = s.frames[i];
+        FrameSnapshot &f = data.frames[i];
+
+        if (frame.key_positions.size() > FrameSnapshot::max_keys)
+            throw std::runtime_error(fmt::format("Too many keys in a frame for a snapshot: {}, the maximum is {}.", frame.key_positions.size(), FrameSnapshot::max_keys));
+
+        f.index_in_level = std::uint8_t(frame.index_in_level);
+        f.num_keys = std::uint8_t(frame.key_positions.size());
+        f.hovered = frame.hovered;
+        f.dragged = frame.dragged;
+        f.aabb_overlaps_player = frame.aabb_overlaps_player;
+        f.player_is_under_this_frame = frame.player_is_under_this_frame;
+        f.has_exit = bool(frame.exit_pos);
+        f.hover_time = frame.hover_time;
+        f.pos = frame.pos;
+        f.drag_offset_relative_to_mouse = frame.drag_offset_relative_to_mouse;
+        f.exit_pos = frame.exit_pos.value_or(ivec2());
+        std::copy(frame.key_positions.begin(), frame.key_positions.end(), f.key_positions);
+    }
+
+    Snapshot ret;
+    std::memcpy(ret.bytes, &data, sizeof(data));
+    return ret;
+}
+
+void World::LoadSnapshot(const Snapshot &snapshot)
+{
+    SnapshotData data;
+    std::memcpy(&data, snapshot.bytes, sizeof(data));
+
+    State &s = *state;
+    const Level &level = levels.at(data.level_index);
+
+    s.current_level_index = data.level_index;
+    s.winning_fade_out = data.winning_fade_out;
+    s.all_levels_finished = data.all_levels_finished;
+    s.movement_started = data.movement_started;
+    s.reset_button_hovered = data.reset_button_hovered;
+    s.fade = data.fade;
+    s.winning_timer = data.winning_timer;
+    s.background_movement_timer = data.background_movement_timer;
+    s.reset_button_vis_timer = data.reset_button_vis_timer;
+    s.num_remaining_keys = data.num_remaining_keys;
+    s.global_tick_counter_during_movement = data.global_tick_counter_during_movement;
+    s.player = data.player;
+    s.player.prev_pos = s.player.pos;
+    s.mouse = data.mouse;
+    s.keys = data.keys;
+    s.tut = data.tut;
+
+    // Assigning over the existing frames reuses the capacity of their vectors, so once warmed up, this doesn't allocate.
+    if (s.frames.size() > data.num_frames)
+        s.frames.erase(s.frames.begin() + data.num_frames, s.frames.end());
+    for (std::size_t i = 0; i < data.num_frames; i++)
+    {
+        const FrameSnapshot &f = data.frames[i];
+        if (f.index_in_level >= level.num_frames)
+            throw std::runtime_error("Invalid frame index in a snapshot.");
+        const LevelFrame &original = level.Frames()[f.index_in_level];
+
+        if (i < s.frames.size())
+            s.frames[i].Reset(original);
+        else
+            s.frames.emplace_back(original);
+
+        Frame &frame = s.frames[i];
+        frame.index_in_level = f.index_in_level;
+        frame.hovered = f.hovered;
+        frame.dragged = f.dragged;
+        frame.aabb_overlaps_player = f.aabb_overlaps_player;
+        frame.player_is_under_this_frame = f.player_is_under_this_frame;
+        frame.hover_time = f.hover_time;
+        frame.pos = f.pos;
+        frame.prev_pos = frame.pos;
+        frame.drag_offset_relative_to_mouse = f.drag_offset_relative_to_mouse;
+        if (f.has_exit)
+            frame.exit_pos = f.exit_pos;
+        else
+            frame.exit_pos.reset();
+        frame.key_positions.assign(f.key_positions, f.key_positions + f.num_keys);
+    }
+
+    s.frame_grid.Rebuild(s.frames);
+}
+
+std::vector<World::FrameInfo> World::GetFrames() const
+{
+    std::vector<FrameInfo> ret;
+    ret.reserve(state->frames.size());
+    for (const Frame &frame : state->frames)
+        ret.push_back({.pos = frame.pos, .corner = frame.TopLeftCorner(), .size = frame.PixelSize()});
+    return ret;
+}
+
+int World::QueryWorldPixel(ivec2 pixel) const
+{
+    // Same lookup as the collision checks in `State::Tick()`: only the frames in the grid cell of the pixel, from the top.
+    const std::vector<std::size_t> &candidates = state->frame_grid.FindAt(pixel);
+    std::size_t i = candidates.size();
+    while (i-- > 0)
+    {
+        if (int r = state->frames[candidates[i]].QueryWorldPixel(pixel); r >= 0)
+            return r;
+    }
+    return -1;
+}
+
+ivec2 World::MaxFramePos(ivec2 frame_size)
+{
+    return screen_size / 2 - frame_size / 2 - 8;
+}
+
+World::Status World::GetStatus() const
+{
+    const State &s = *state;
+
+    Status ret{
+        .won = s.winning_fade_out,
+        .all_levels_finished = s.all_levels_finished,
+        .player_alive = s.player.exists,
+        .moving = s.movement_started,
+        .dragging = !s.frames.empty() && s.frames.back().dragged,
+        .player_pos = s.player.pos,
+    };
+
+    auto DistSq = [&](ivec2 pos)
+    {
+        ivec2 d = pos - s.player.pos;
+        return d.x * d.x + d.y * d.y;
+    };
+    auto Consider = [&](ivec2 pos)
+    {
+        if (!ret.goal || DistSq(pos) < DistSq(*ret.goal))
+            ret.goal = pos;
+    };
+
+    for (const Frame &frame : s.frames)
+    {
+        ret.keys_left += int(frame.key_positions.size());
+        for (ivec2 key : frame.key_positions)
+            Consider(frame.pos + key);
+    }
+    if (!ret.goal)
+    {
+        for (const Frame &frame : s.frames)
+        {
+            if (frame.exit_pos)
+                Consider(frame.pos + *frame.exit_pos);
+        }
+    }
+
+    return ret;
+}
+
+std::vector<TexRegion> World::FramedImages()
+{
+    std::vector<TexRegion> ret;
+    for (const FrameType *type : Frames::all)
+        ret.push_back(type->ImageRegion());
+    return ret;
+}
+
+World::Input World::Input::FromSdl(ivec2 mouse_pos)
+{
+    SDL_MouseButtonFlags sdl_mouse_flags = SDL_GetMouseState(nullptr, nullptr);
+    return FromKeys(mouse_pos, bool(sdl_mouse_flags & SDL_BUTTON_LEFT), SDL_GetKeyboardState(nullptr));
+}
+
+World::Input World::Input::FromKeys(ivec2 mouse_pos, bool mouse_down, const bool *held_keys)
+{
+    Input ret;
+    ret.mouse_pos = mouse_pos;
+    ret.mouse_down = mouse_down;
+
+    ret.left  = held_keys[SDL_SCANCODE_LEFT ] || held_keys[SDL_SCANCODE_A];
+    ret.right = held_keys[SDL_SCANCODE_RIGHT] || held_keys[SDL_SCANCODE_D];
+    ret.jump  = held_keys[SDL_SCANCODE_UP   ] || held_keys[SDL_SCANCODE_W] || held_keys[SDL_SCANCODE_SPACE] || held_keys[SDL_SCANCODE_Z] || held_keys[SDL_SCANCODE_J];
+    ret.reset = held_keys[SDL_SCANCODE_R] || held_keys[SDL_SCANCODE_ESCAPE];
+
+    return ret;
+}
+
+void World::Tick(const Input &input)
 {
     { // Mouse.
-        mouse.pos = mouse_pos;
+        Mouse &mouse = state->mouse;
+        mouse.pos = input.mouse_pos;
 
         mouse.is_down_prev = mouse.is_down;
-
-        SDL_MouseButtonFlags sdl_mouse_flags = SDL_GetMouseState(nullptr, nullptr);
-        mouse.is_down = bool(sdl_mouse_flags & SDL_BUTTON_LEFT);
+        mouse.is_down = input.mouse_down;
     }
 
     { // Keys.
-        const bool *held_keys = SDL_GetKeyboardState(nullptr);
-
+        Keys &keys = state->keys;
         keys.left .is_down_prev = keys.left .is_down;
         keys.right.is_down_prev = keys.right.is_down;
         keys.jump .is_down_prev = keys.jump .is_down;
         keys.reset.is_down_prev = keys.reset.is_down;
 
-        keys.left .is_down = held_keys[SDL_SCANCODE_LEFT ] || held_keys[SDL_SCANCODE_A];
-        keys.right.is_down = held_keys[SDL_SCANCODE_RIGHT] || held_keys[SDL_SCANCODE_D];
-        keys.jump .is_down = held_keys[SDL_SCANCODE_UP   ] || held_keys[SDL_SCANCODE_W] || held_keys[SDL_SCANCODE_SPACE] || held_keys[SDL_SCANCODE_Z] || held_keys[SDL_SCANCODE_J];
-
-        keys.reset.is_down = held_keys[SDL_SCANCODE_R] || held_keys[SDL_SCANCODE_ESCAPE];
+        keys.left .is_down = input.left;
+        keys.right.is_down = input.right;
+        keys.jump .is_down = input.jump;
+        keys.reset.is_down = input.reset;
     }
 
+    state->particles.SetBackend(gpu_particles ? ParticlePool::Backend::gpu : ParticlePool::Backend::cpu);
+    state->sounds_enabled = sounds;
+    state->effects_enabled = effects;
+
     state->Tick();
 }
 
-void World::Render()
+void World::Render(float alpha)
 {
-    state->Render();
+    state->low_detail = low_detail;
+    state->Render(alpha);
+}
+
+void World::SeedRandom(std::uint64_t seed)
+{
+    state->rng.Seed(seed);
+}
+
+std::uint64_t World::StateHash() const
+{
+    // FNV-1a. This doesn't need to be good, only stable.
+    std::uint64_t hash = 0xcbf29ce484222325;
+    auto Mix = [&](std::uint64_t value)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            hash ^= (value >> (i * 8)) & 0xff;
+            hash *= 0x100000001b3;
+        }
+    };
+    auto MixVec = [&](ivec2 v)
+    {
+        Mix(std::uint64_t(std::uint32_t(v.x)) | std::uint64_t(std::uint32_t(v.y)) << 32);
+    };
+    auto MixFloat = [&](float f)
+    {
+        Mix(std::bit_cast<std::uint32_t>(f));
+    };
+
+    const State &s = *state;
+
+    Mix(s.current_level_index);
+    Mix(s.movement_started);
+    Mix(s.winning_fade_out);
+    Mix(s.all_levels_finished);
+    Mix(std::uint64_t(s.winning_timer));
+    Mix(std::uint64_t(s.num_remaining_keys));
+    Mix(std::uint64_t(s.global_tick_counter_during_movement));
+
+    Mix(s.frames.size());
+    for (const Frame &frame : s.frames)
+    {
+        Mix(std::uint64_t(std::find(std::begin(Frames::all), std::end(Frames::all), frame.type) - std::begin(Frames::all)));
+        MixVec(frame.pos);
+        Mix(frame.dragged);
+        Mix(frame.player_is_under_this_frame);
+        Mix(frame.key_positions.size());
+        for (ivec2 key : frame.key_positions)
+            MixVec(key);
+    }
+
+    Mix(s.player.exists);
+    MixVec(s.player.pos);
+    MixFloat(s.player.vel.x);
+    MixFloat(s.player.vel.y);
+    MixFloat(s.player.vel_comp.x);
+    MixFloat(s.player.vel_comp.y);
+    Mix(s.player.on_ground);
+    Mix(s.player.facing_left);
+    Mix(s.player.holding_jump);
+    Mix(std::uint64_t(s.player.death_timer));
+
+    // The held buttons matter too, since pressing is detected by comparing with the previous tick.
+    Mix(s.mouse.is_down);
+    Mix(s.keys.jump.is_down);
+    Mix(s.keys.reset.is_down);
+    Mix(s.tut.dragged_at_least_once);
+
+    return hash;
 }
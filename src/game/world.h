@@ -2,12 +2,46 @@
 
 #include "em/meta/copyable_unique_ptr.h"
 #include "em/math/vector.h"
+#include "game/tex_region.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
 
 using namespace em;
 
 struct World
 {
-    ivec2 mouse_pos;
+    // What the player does in one tick. `Tick()` doesn't read anything else, so the same inputs (with the same `SeedRandom()`)
+    //   always give the same results. See `replay.h`.
+    struct Input
+    {
+        ivec2 mouse_pos;
+        bool mouse_down = false;
+
+        bool left = false;
+        bool right = false;
+        bool jump = false;
+        bool reset = false;
+
+        // Reads the mouse buttons and the keyboard from SDL. The mouse position is passed by the caller, since it depends on the window scale.
+        [[nodiscard]] static Input FromSdl(ivec2 mouse_pos);
+        // Same, but from the key states that the caller tracks, indexed by `SDL_Scancode`. See `InputBuffer`.
+        [[nodiscard]] static Input FromKeys(ivec2 mouse_pos, bool mouse_down, const bool *held_keys);
+
+        [[nodiscard]] friend bool operator==(const Input &, const Input &) = default;
+    };
+
+    // Simulate the particles on the GPU instead of the CPU, see `ParticlePool::Backend`. Switching this removes the existing particles.
+    bool gpu_particles = false;
+    // Play the sounds through the global `audio` manager. Disable this when simulating worlds off the main thread.
+    bool sounds = true;
+    // Spawn the particles. They don't affect the gameplay, so disabling this is a free speedup when nothing is rendered.
+    bool effects = true;
+    // Draw less, for the software rendering fallback: no vignette, no shadows, no frame borders seen through the other frames, and fewer particles.
+    // This only affects `Render()`, not the gameplay.
+    bool low_detail = false;
 
     struct State;
     em::Meta::CopyableUniquePtr<State> state;
@@ -19,6 +53,74 @@ struct World
     World &operator=(World &&);
     ~World();
 
-    void Tick();
-    void Render();
+    void Tick(const Input &input);
+    // `alpha` (0..1) is how far we are from the previous tick to the current one, e.g. `Metronome::Time()`.
+    // The moving things (the player, the frames and the particles) are drawn interpolated between the two, which smooths the motion
+    //   when the framerate doesn't match the tickrate, at the cost of one tick of visual latency. Pass 1 to draw the current tick as is.
+    void Render(float alpha = 1);
+
+    // Reseeds the random number generator used by the gameplay. Each world has its own, seeded randomly by default.
+    // The generator is `FastRng`, so a seed gives the same sequence on every platform.
+    void SeedRandom(std::uint64_t seed);
+
+    // A hash of the gameplay state (the level, the frames, the player, etc), excluding the purely visual parts.
+    // This is for checking that replaying the same inputs gives the same results.
+    [[nodiscard]] std::uint64_t StateHash() const;
+
+    // The levels are numbered from zero.
+    [[nodiscard]] static std::size_t NumLevels();
+    // Restarts the world at the specified level.
+    void LoadLevel(std::size_t index);
+
+    // A compact copy of the gameplay state, to rewind or undo. This is a fixed-size blob without any heap allocations,
+    //   so it's cheap to keep many of them (see `SnapshotRing`). It doesn't include the random number generator and the particles,
+    //   since those only affect the visuals.
+    struct Snapshot
+    {
+        static constexpr std::size_t size = 512;
+        alignas(8) unsigned char bytes[size]{};
+    };
+    [[nodiscard]] Snapshot SaveSnapshot() const;
+    // Once warmed up (after the first load of each level), this doesn't allocate either.
+    void LoadSnapshot(const Snapshot &snapshot);
+
+    // A read-only view of one frame, for tools like the solver (see `solver.h`).
+    struct FrameInfo
+    {
+        // The position of the frame, which is what gets dragged and clamped (see `MaxFramePos()`).
+        ivec2 pos;
+        // The rect of the frame in world pixels.
+        ivec2 corner;
+        ivec2 size;
+    };
+    // In the drawing order, the last one is on top.
+    [[nodiscard]] std::vector<FrameInfo> GetFrames() const;
+    // Whether the world pixel `pixel` is solid in the topmost frame that covers it: 1 if solid, 0 if not, or -1 if no frame covers it.
+    // This ignores which frames the player is currently under.
+    [[nodiscard]] int QueryWorldPixel(ivec2 pixel) const;
+
+    // Dragging clamps the frame positions to `-MaxFramePos(size)..MaxFramePos(size)`, where `size` is the pixel size of the frame.
+    [[nodiscard]] static ivec2 MaxFramePos(ivec2 frame_size);
+
+    struct Status
+    {
+        // The exit was reached, and we're fading out to the next level.
+        bool won = false;
+        // The last level was won and has faded out. The world then stays as is, it's up to the caller to quit or load another level.
+        bool all_levels_finished = false;
+        bool player_alive = false;
+        // The player has started moving. The frames can no longer be dragged without restarting the level.
+        bool moving = false;
+        // A frame is being dragged. Only the topmost frame can be.
+        bool dragging = false;
+        ivec2 player_pos;
+        int keys_left = 0;
+        // The next thing to reach: the nearest remaining key, or the exit if there are no keys left.
+        std::optional<ivec2> goal;
+    };
+    [[nodiscard]] Status GetStatus() const;
+
+    // The regions of the main atlas that `Render()` draws with `DrawFramedImage()` and `DrawImageFrame()`.
+    // The app pre-composites them at startup.
+    [[nodiscard]] static std::vector<TexRegion> FramedImages();
 };
@@ -1,7 +1,9 @@
 #include "buffer.h"
 
 #include "gpu/device.h"
+#include "gpu/resource_stats.h"
 #include "gpu/transfer_buffer.h"
+#include "gpu/upload_arena.h"
 
 #include <fmt/format.h>
 
@@ -23,6 +25,8 @@ namespace em::Gpu
         state.buffer = SDL_CreateGPUBuffer(device.Handle(), &sdl_params);
         if (!state.buffer)
             throw std::runtime_error(fmt::format("Unable to create GPU buffer: {}", SDL_GetError()));
+        state.size = size;
+        ResourceStats::OnCreated(ResourceStats::Type::buffer, size);
     }
 
     Buffer::Buffer(Device &device, CopyPass &pass, std::span<const unsigned char> data, Usage usage)
@@ -32,6 +36,12 @@ namespace em::Gpu
         tb.ApplyToBuffer(pass, *this);
     }
 
+    Buffer::Buffer(Device &device, CopyPass &pass, UploadArena &arena, std::span<const unsigned char> data, Usage usage)
+        : Buffer(device, std::uint32_t(data.size()), usage)
+    {
+        arena.UploadToBuffer(pass, data, *this);
+    }
+
     Buffer::Buffer(Buffer &&other) noexcept
         : state(std::move(other.state))
     {
@@ -47,6 +57,9 @@ namespace em::Gpu
     Buffer::~Buffer()
     {
         if (state.buffer)
+        {
             SDL_ReleaseGPUBuffer(state.device, state.buffer);
+            ResourceStats::OnDestroyed(ResourceStats::Type::buffer, state.size);
+        }
     }
 }
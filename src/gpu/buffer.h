@@ -11,6 +11,7 @@ namespace em::Gpu
 {
     class CopyPass;
     class Device;
+    class UploadArena;
 
     // A texture.
     class Buffer
@@ -22,6 +23,8 @@ namespace em::Gpu
             SDL_GPUDevice *device = nullptr;
 
             SDL_GPUBuffer *buffer = nullptr;
+            // For `ResourceStats`.
+            std::uint32_t size = 0;
         };
         State state;
 
@@ -57,6 +60,8 @@ namespace em::Gpu
         Buffer(Device &device, std::uint32_t size, Usage usage = Usage::vertex);
         // A helper constructor that creates a buffer and immediately fills it using a temporary transfer buffer.
         Buffer(Device &device, CopyPass &pass, std::span<const unsigned char> data, Usage usage = Usage::vertex);
+        // Same, but stages the data in `arena` instead of a temporary transfer buffer.
+        Buffer(Device &device, CopyPass &pass, UploadArena &arena, std::span<const unsigned char> data, Usage usage = Usage::vertex);
 
         Buffer(Buffer &&other) noexcept;
         Buffer &operator=(Buffer other) noexcept;
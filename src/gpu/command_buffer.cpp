@@ -2,6 +2,7 @@
 
 #include "gpu/device.h"
 #include "gpu/fence.h"
+#include "utils/trace.h"
 #include "window/window.h"
 
 #include <fmt/format.h>
@@ -15,6 +16,7 @@ namespace em::Gpu
     CommandBuffer::CommandBuffer(Device &device, Fence *output_fence)
         : CommandBuffer() // Ensure cleanup on throw.
     {
+        state.device = device.Handle();
         state.output_fence = output_fence;
         state.num_active_exceptions = std::uncaught_exceptions();
 
@@ -46,6 +48,8 @@ namespace em::Gpu
             }
             else
             {
+                EM_TRACE_ZONE("Gpu::CommandBuffer submit");
+
                 if (state.output_fence)
                 {
                     SDL_GPUFence *fence = SDL_SubmitGPUCommandBufferAndAcquireFence(state.buffer);
@@ -70,6 +74,8 @@ namespace em::Gpu
 
     Texture CommandBuffer::WaitAndAcquireSwapchainTexture(Window &window)
     {
+        EM_TRACE_ZONE("Gpu::CommandBuffer::WaitAndAcquireSwapchainTexture");
+
         // Note that this never needs freeing, so we don't really care what the value is on failure.
         SDL_GPUTexture *texture = nullptr;
 
@@ -80,4 +86,17 @@ namespace em::Gpu
 
         return Texture(Texture::ViewExternalHandle{}, state.device, texture, size.to<int>().to_vec3(1));
     }
+
+    Texture CommandBuffer::TryAcquireSwapchainTexture(Window &window)
+    {
+        SDL_GPUTexture *texture = nullptr;
+
+        vec2<Uint32> size;
+
+        // This returns true with a null texture when there's nothing available yet, and false only on actual errors.
+        if (!SDL_AcquireGPUSwapchainTexture(state.buffer, window.Handle(), &texture, &size.x, &size.y))
+            throw std::runtime_error(fmt::format("Unable to acquire a GPU swapchain texture: {}", SDL_GetError()));
+
+        return Texture(Texture::ViewExternalHandle{}, state.device, texture, size.to<int>().to_vec3(1));
+    }
 }
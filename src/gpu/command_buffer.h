@@ -64,11 +64,15 @@ namespace em::Gpu
 
 
         // Get a temporary texture that represents the window.
-        // Blocks if there are too many frames in flight. There's a version that doesn't block and returns null, but we don't expose that at the moment.
+        // Blocks if there are too many frames in flight. See `TryAcquireSwapchainTexture()` for the version that doesn't.
         // CAN RETURN NULL if the window is minimized. Don't render anything in that case.
         // If this return null, you should probably call `CancelWhenDestroyed()` and then do nothing else.
         // The docs say you can't cancel after acquiring the texture, but so far my understanding is that it applies only to SUCCESSFULLY acquiring it.
         // This seems to never return null for me on Linux on XFCE, but it does return null in Wine, and there cancelling works fine.
         [[nodiscard]] Texture WaitAndAcquireSwapchainTexture(Window &window);
+
+        // Same, but never blocks. Returns null if there are too many frames in flight, and also if the window is minimized (there's no way to tell those apart).
+        // After a null result you can call this (or `WaitAndAcquireSwapchainTexture()`) again on the same buffer, e.g. after doing some other work.
+        [[nodiscard]] Texture TryAcquireSwapchainTexture(Window &window);
     };
 }
@@ -0,0 +1,76 @@
+#include "compute_pass.h"
+
+#include "gpu/buffer.h"
+#include "gpu/command_buffer.h"
+#include "gpu/compute_pipeline.h"
+
+#include <fmt/format.h>
+#include <SDL3/SDL_gpu.h>
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace em::Gpu
+{
+    ComputePass::ComputePass(CommandBuffer &command_buffer, std::span<const ReadWriteBuffer> read_write_buffers)
+        : ComputePass() // Ensure cleanup on throw.
+    {
+        std::vector<SDL_GPUStorageBufferReadWriteBinding> sdl_buffers;
+        sdl_buffers.reserve(read_write_buffers.size());
+
+        for (const ReadWriteBuffer &buffer : read_write_buffers)
+        {
+            sdl_buffers.push_back({
+                .buffer = buffer.buffer->Handle(),
+                .cycle = buffer.cycle,
+            });
+        }
+
+        // We don't expose the storage textures for now.
+        state.pass = SDL_BeginGPUComputePass(command_buffer.Handle(), nullptr, 0, sdl_buffers.data(), std::uint32_t(sdl_buffers.size()));
+        if (!state.pass)
+            throw std::runtime_error(fmt::format("Unable to begin a GPU compute pass: {}", SDL_GetError()));
+    }
+
+    ComputePass::ComputePass(ComputePass &&other) noexcept
+        : state(std::move(other.state))
+    {
+        other.state = {};
+    }
+
+    ComputePass &ComputePass::operator=(ComputePass other) noexcept
+    {
+        std::swap(state, other.state);
+        return *this;
+    }
+
+    ComputePass::~ComputePass()
+    {
+        if (state.pass)
+            SDL_EndGPUComputePass(state.pass);
+    }
+
+    void ComputePass::BindPipeline(ComputePipeline &pipeline)
+    {
+        // This can't fail.
+        SDL_BindGPUComputePipeline(state.pass, pipeline.Handle());
+    }
+
+    void ComputePass::BindStorageBuffers(std::span<Buffer *const> buffers, std::uint32_t first_slot)
+    {
+        std::vector<SDL_GPUBuffer *> sdl_buffers;
+        sdl_buffers.reserve(buffers.size());
+        for (Buffer *buffer : buffers)
+            sdl_buffers.push_back(buffer->Handle());
+
+        // This can't fail.
+        SDL_BindGPUComputeStorageBuffers(state.pass, first_slot, sdl_buffers.data(), std::uint32_t(sdl_buffers.size()));
+    }
+
+    void ComputePass::Dispatch(uvec3 num_workgroups)
+    {
+        // This can't fail.
+        SDL_DispatchGPUCompute(state.pass, num_workgroups.x, num_workgroups.y, num_workgroups.z);
+    }
+}
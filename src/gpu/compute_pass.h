@@ -0,0 +1,56 @@
+#pragma once
+
+#include "em/math/vector.h"
+
+#include <cstdint>
+#include <span>
+
+typedef struct SDL_GPUComputePass SDL_GPUComputePass;
+
+namespace em::Gpu
+{
+    class Buffer;
+    class CommandBuffer;
+    class ComputePipeline;
+
+    class ComputePass
+    {
+        struct State
+        {
+            SDL_GPUComputePass *pass = nullptr;
+        };
+        State state;
+
+      public:
+        constexpr ComputePass() {}
+
+        struct ReadWriteBuffer
+        {
+            Buffer *buffer = nullptr;
+
+            // If true and the buffer is still in use by the GPU, SDL gives you a fresh one instead of waiting.
+            // This discards the old contents, so keep this false if the shader reads what it writes.
+            bool cycle = false;
+        };
+
+        // Unlike with read-only buffers, the read-write buffers must be specified when starting the pass.
+        // In the shader, they are in `set = 1`, in this order.
+        ComputePass(CommandBuffer &command_buffer, std::span<const ReadWriteBuffer> read_write_buffers);
+
+        ComputePass(ComputePass &&other) noexcept;
+        ComputePass &operator=(ComputePass other) noexcept;
+        ~ComputePass();
+
+        [[nodiscard]] explicit operator bool() const {return bool(state.pass);}
+        [[nodiscard]] SDL_GPUComputePass *Handle() {return state.pass;}
+
+        // Select the active pipeline.
+        void BindPipeline(ComputePipeline &pipeline);
+
+        // Select the read-only storage buffers. In the shader they are in `set = 0`, after the textures (if any).
+        void BindStorageBuffers(std::span<Buffer *const> buffers, std::uint32_t first_slot = 0);
+
+        // Runs the bound pipeline, with this many workgroups along each axis.
+        void Dispatch(uvec3 num_workgroups);
+    };
+}
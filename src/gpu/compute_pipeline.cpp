@@ -0,0 +1,61 @@
+#include "compute_pipeline.h"
+
+#include "gpu/device.h"
+#include "gpu/resource_stats.h"
+
+#include <fmt/format.h>
+#include <SDL3_shadercross/SDL_shadercross.h>
+#include <SDL3/SDL_gpu.h>
+
+#include <stdexcept>
+#include <utility>
+
+namespace em::Gpu
+{
+    ComputePipeline::ComputePipeline(Device &device, zstring_view name, std::span<const unsigned char> spirv_binary)
+        : ComputePipeline() // Ensure cleanup on throw.
+    {
+        SDL_ShaderCross_SPIRV_Info input{
+            .bytecode = spirv_binary.data(),
+            .bytecode_size = spirv_binary.size(),
+            // See the comment in `Shader::Shader()`.
+            .entrypoint = "main",
+            .shader_stage = SDL_SHADERCROSS_SHADERSTAGE_COMPUTE,
+            .enable_debug = device.DebugModeEnabled(),
+            .name = name.empty() ? nullptr : name.c_str(),
+            .props = 0,
+        };
+
+        // Must set before creating the pipeline to let the destructor do its job if we throw later in this function.
+        state.device = device.Handle();
+
+        // Like for graphics shaders, this output parameter isn't optional. This is where the resource counts and the workgroup size go.
+        SDL_ShaderCross_ComputePipelineMetadata output_metadata{};
+
+        state.pipeline = SDL_ShaderCross_CompileComputePipelineFromSPIRV(device.Handle(), &input, &output_metadata);
+        if (!state.pipeline)
+            throw std::runtime_error(fmt::format("Unable to compile SPIRV compute shader: {}", SDL_GetError()));
+        ResourceStats::OnCreated(ResourceStats::Type::compute_pipeline);
+    }
+
+    ComputePipeline::ComputePipeline(ComputePipeline &&other) noexcept
+        : state(std::move(other.state))
+    {
+        other.state = {};
+    }
+
+    ComputePipeline &ComputePipeline::operator=(ComputePipeline other) noexcept
+    {
+        std::swap(state, other.state);
+        return *this;
+    }
+
+    ComputePipeline::~ComputePipeline()
+    {
+        if (state.pipeline)
+        {
+            SDL_ReleaseGPUComputePipeline(state.device, state.pipeline);
+            ResourceStats::OnDestroyed(ResourceStats::Type::compute_pipeline);
+        }
+    }
+}
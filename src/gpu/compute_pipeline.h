@@ -0,0 +1,43 @@
+#pragma once
+
+#include "em/zstring_view.h"
+
+#include <span>
+
+typedef struct SDL_GPUComputePipeline SDL_GPUComputePipeline;
+typedef struct SDL_GPUDevice SDL_GPUDevice;
+
+namespace em::Gpu
+{
+    class Device;
+
+    // A compute shader, together with its resource layout.
+    // Unlike graphics pipelines, this is created directly from the shader, since SDL has no separate compute shader objects.
+    // The resource counts (storage buffers, uniforms, etc) and the workgroup size are reflected from the SPIR-V.
+    class ComputePipeline
+    {
+        struct State
+        {
+            // This this at least to destroy the pipeline.
+            // Using this instead of `Device *` to keep the address stable.
+            SDL_GPUDevice *device = nullptr;
+            SDL_GPUComputePipeline *pipeline = nullptr;
+        };
+        State state;
+
+      public:
+        constexpr ComputePipeline() {}
+
+        // The name is optional.
+        // In the shader, use `set = 0` for read-only storage buffers, `set = 1` for read-write storage buffers, and `set = 2` for uniforms.
+        // See for more details: https://wiki.libsdl.org/SDL3/SDL_CreateGPUComputePipeline
+        ComputePipeline(Device &device, zstring_view name, std::span<const unsigned char> spirv_binary);
+
+        ComputePipeline(ComputePipeline &&other) noexcept;
+        ComputePipeline &operator=(ComputePipeline other) noexcept;
+        ~ComputePipeline();
+
+        [[nodiscard]] explicit operator bool() const {return bool(state.pipeline);}
+        [[nodiscard]] SDL_GPUComputePipeline *Handle() {return state.pipeline;}
+    };
+}
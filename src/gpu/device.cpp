@@ -53,6 +53,7 @@ namespace em::Gpu
                     state.device = SDL_CreateGPUDevice(SDL_ShaderCross_GetSPIRVShaderFormats(), state.debug_mode_enabled, nullptr);
 
                     state.must_manually_limit_fps = true;
+                    state.is_software_renderer = true;
                 }
             }
             #else
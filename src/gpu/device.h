@@ -18,6 +18,9 @@ namespace em::Gpu
             // We set this to true for backends known to not do Vsync (currently only SwiftShader, the software Vulkan implementation
             //   that we fall back to intentionally).
             bool must_manually_limit_fps = false;
+
+            // True if we fell back to a software implementation. The callers should draw less then, since everything runs on the CPU.
+            bool is_software_renderer = false;
         };
         State state;
 
@@ -41,5 +44,6 @@ namespace em::Gpu
 
         [[nodiscard]] bool DebugModeEnabled() const {return state.debug_mode_enabled;}
         [[nodiscard]] bool MustManuallyLimitFps() const {return state.must_manually_limit_fps;}
+        [[nodiscard]] bool IsSoftwareRenderer() const {return state.is_software_renderer;}
     };
 }
@@ -5,6 +5,7 @@
 
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 namespace em::Gpu
 {
@@ -43,4 +44,24 @@ namespace em::Gpu
         if (!SDL_WaitForGPUFences(state.device, false, &state.fence, 1))
             throw std::runtime_error(fmt::format("Unable to wait for a GPU fence: {}", SDL_GetError()));
     }
+
+    void Fence::WaitForMany(std::span<Fence *const> fences, bool wait_all)
+    {
+        SDL_GPUDevice *device = nullptr;
+        std::vector<SDL_GPUFence *> handles;
+        handles.reserve(fences.size());
+        for (Fence *fence : fences)
+        {
+            if (!fence || !*fence)
+                continue;
+            device = fence->state.device;
+            handles.push_back(fence->state.fence);
+        }
+
+        if (handles.empty())
+            return;
+
+        if (!SDL_WaitForGPUFences(device, wait_all, handles.data(), Uint32(handles.size())))
+            throw std::runtime_error(fmt::format("Unable to wait for {} of {} GPU fences: {}", wait_all ? "all" : "any", handles.size(), SDL_GetError()));
+    }
 }
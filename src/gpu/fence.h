@@ -1,5 +1,7 @@
 #pragma once
 
+#include <span>
+
 typedef struct SDL_GPUDevice SDL_GPUDevice;
 typedef struct SDL_GPUFence SDL_GPUFence;
 
@@ -34,7 +36,14 @@ namespace em::Gpu
         [[nodiscard]] bool IsReady();
 
         // Blocks until the fence is ready. Throws on failure.
-        // SDL also provides a way to wait for more than once fence (any or all of them), but we don't expose that yet.
         void Wait();
+
+        // Block until at least one of the fences is ready, or until all of them are. Throw on failure.
+        // The null pointers and the null fences are skipped, and if nothing is left, those return immediately. All fences must be from the same device.
+        static void WaitAny(std::span<Fence *const> fences) {WaitForMany(fences, false);}
+        static void WaitAll(std::span<Fence *const> fences) {WaitForMany(fences, true);}
+
+      private:
+        static void WaitForMany(std::span<Fence *const> fences, bool wait_all);
     };
 }
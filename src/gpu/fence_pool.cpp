@@ -0,0 +1,55 @@
+#include "fence_pool.h"
+
+#include <algorithm>
+
+namespace em::Gpu
+{
+    FencePool::Added FencePool::Add()
+    {
+        Entry &entry = pending.emplace_back();
+        entry.id = next_id++;
+        return {.id = entry.id, .fence = &entry.fence};
+    }
+
+    bool FencePool::IsDone(Id id)
+    {
+        if (id == 0 || id >= next_id)
+            return false;
+
+        auto it = std::find_if(pending.begin(), pending.end(), [&](const Entry &entry){return entry.id == id;});
+        return it == pending.end() || !it->fence || it->fence.IsReady();
+    }
+
+    void FencePool::Poll(const std::function<void(Id id)> &on_done)
+    {
+        std::erase_if(pending, [&](Entry &entry)
+        {
+            if (entry.fence && !entry.fence.IsReady())
+                return false;
+            if (on_done)
+                on_done(entry.id);
+            return true;
+        });
+    }
+
+    void FencePool::WaitForPending(bool wait_all, const std::function<void(Id id)> &on_done)
+    {
+        // The cancelled ones are done already, so there's no need to wait if one of them is enough.
+        if (!wait_all && std::any_of(pending.begin(), pending.end(), [](const Entry &entry){return !entry.fence;}))
+        {
+            Poll(on_done);
+            return;
+        }
+
+        scratch.clear();
+        for (Entry &entry : pending)
+            scratch.push_back(&entry.fence);
+
+        if (wait_all)
+            Fence::WaitAll(scratch);
+        else
+            Fence::WaitAny(scratch);
+
+        Poll(on_done);
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "gpu/fence.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace em::Gpu
+{
+    // Tracks the fences of several submitted command buffers at once, each under its own id, and waits for any or all of them.
+    // The classes that must know when the GPU is done with something (see `TexturePool` and `UploadArena`) remember the id of the command buffer
+    //   that last used it and check `IsDone()`, instead of submitting fences of their own. The ids grow in the submission order.
+    // SDL fences can't be reset and resubmitted, so this doesn't recycle them. It keeps the pending ones, and releases each one once it's retired.
+    // This isn't thread-safe, use it from one thread at a time.
+    class FencePool
+    {
+      public:
+        // Starts at 1, zero is never used.
+        using Id = std::uint64_t;
+
+      private:
+        struct Entry
+        {
+            Id id = 0;
+            // Null if the command buffer was cancelled. We treat that as done, since nothing is going to signal it.
+            Fence fence;
+        };
+
+        // In the order of the ids. A deque, so that `Add()` doesn't move the fences handed out before.
+        // `Poll()` can move them though, which is why `Added::fence` must be submitted before calling anything else.
+        std::deque<Entry> pending;
+        Id next_id = 1;
+
+        // Reused by `WaitAny()` and `WaitAll()`.
+        std::vector<Fence *> scratch;
+
+        void WaitForPending(bool wait_all, const std::function<void(Id id)> &on_done);
+
+      public:
+        FencePool() {}
+
+        struct Added
+        {
+            Id id = 0;
+            // Pass this to a `CommandBuffer`. Destroy that command buffer (i.e. submit it) before calling anything else here,
+            //   otherwise the fence is still null and looks like a cancelled one.
+            Fence *fence = nullptr;
+        };
+
+        // Starts tracking a new fence.
+        [[nodiscard]] Added Add();
+
+        // The id that the next `Add()` returns.
+        [[nodiscard]] Id NextId() const {return next_id;}
+        // The id that the last `Add()` returned, or zero if none.
+        [[nodiscard]] Id LastId() const {return next_id - 1;}
+
+        // Doesn't block. False if the id wasn't added yet.
+        [[nodiscard]] bool IsDone(Id id);
+
+        // Releases the fences that are ready, calling `on_done` (if not null) for each of them, in the order they were added. Doesn't block.
+        void Poll(const std::function<void(Id id)> &on_done = nullptr);
+
+        // Block until at least one of the pending fences or all of them are ready, then `Poll()`. Throw on failure.
+        void WaitAny(const std::function<void(Id id)> &on_done = nullptr) {WaitForPending(false, on_done);}
+        void WaitAll(const std::function<void(Id id)> &on_done = nullptr) {WaitForPending(true, on_done);}
+
+        [[nodiscard]] std::size_t NumPending() const {return pending.size();}
+    };
+}
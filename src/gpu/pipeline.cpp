@@ -1,6 +1,7 @@
 #include "pipeline.h"
 
 #include "gpu/device.h"
+#include "gpu/resource_stats.h"
 #include "gpu/shader.h"
 
 #include <fmt/format.h>
@@ -194,6 +195,7 @@ namespace em::Gpu
         state.pipeline = SDL_CreateGPUGraphicsPipeline(device.Handle(), &sdl_params);
         if (!state.pipeline)
             throw std::runtime_error(fmt::format("Unable to create a GPU pipeline: {}", SDL_GetError()));
+        ResourceStats::OnCreated(ResourceStats::Type::pipeline);
     }
 
     Pipeline::Pipeline(Pipeline &&other) noexcept
@@ -210,6 +212,9 @@ namespace em::Gpu
     Pipeline::~Pipeline()
     {
         if (state.pipeline)
+        {
             SDL_ReleaseGPUGraphicsPipeline(state.device, state.pipeline);
+            ResourceStats::OnDestroyed(ResourceStats::Type::pipeline);
+        }
     }
 }
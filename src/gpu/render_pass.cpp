@@ -191,6 +191,20 @@ namespace em::Gpu
             SDL_BindGPUFragmentSamplers(state.pass, first_slot, sdl_textures.data(), std::uint32_t(sdl_textures.size()));
     }
 
+    void RenderPass::BindStorageBuffers(std::span<Buffer *const> buffers, ShaderStage shader_stage, std::uint32_t first_slot)
+    {
+        std::vector<SDL_GPUBuffer *> sdl_buffers;
+        sdl_buffers.reserve(buffers.size());
+        for (Buffer *buffer : buffers)
+            sdl_buffers.push_back(buffer->Handle());
+
+        // Those functions can't fail.
+        if (shader_stage == ShaderStage::vertex)
+            SDL_BindGPUVertexStorageBuffers(state.pass, first_slot, sdl_buffers.data(), std::uint32_t(sdl_buffers.size()));
+        else
+            SDL_BindGPUFragmentStorageBuffers(state.pass, first_slot, sdl_buffers.data(), std::uint32_t(sdl_buffers.size()));
+    }
+
     void RenderPass::DrawPrimitivesInstanced(std::uint32_t num_vertices, std::uint32_t num_instances, std::uint32_t first_vertex, std::uint32_t first_instance)
     {
         SDL_DrawGPUPrimitives(state.pass, num_vertices, num_instances, first_vertex, first_instance);
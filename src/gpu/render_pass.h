@@ -203,6 +203,12 @@ namespace em::Gpu
         void BindTextures(std::span<const TextureAndSampler> textures, ShaderStage shader_stage = ShaderStage::fragment, std::uint32_t first_slot = 0);
 
 
+        // Select the read-only storage buffers for a shader stage. The buffers need the `graphics_storage_read` usage.
+        // In vertex shaders use `layout(std430, set = 0, binding = MySlotIndex) readonly buffer`, after the textures, if any.
+        // In fragment shaders use `set = 2` instead.
+        void BindStorageBuffers(std::span<Buffer *const> buffers, ShaderStage shader_stage = ShaderStage::vertex, std::uint32_t first_slot = 0);
+
+
         // Drawing:
 
         void DrawPrimitives(std::uint32_t num_vertices, std::uint32_t first_vertex = 0) {DrawPrimitivesInstanced(num_vertices, 1, first_vertex, 0);}
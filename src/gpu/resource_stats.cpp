@@ -0,0 +1,102 @@
+#include "resource_stats.h"
+
+#include <fmt/format.h>
+
+#include <atomic>
+
+namespace em::Gpu::ResourceStats
+{
+    namespace
+    {
+        struct AtomicCounts
+        {
+            std::atomic<std::uint64_t> num_live = 0;
+            std::atomic<std::uint64_t> live_bytes = 0;
+            std::atomic<std::uint64_t> num_created = 0;
+            std::atomic<std::uint64_t> num_destroyed = 0;
+        };
+
+        // Those are only statistics, so all accesses are relaxed.
+        std::array<AtomicCounts, num_types> counts;
+    }
+
+    const char *TypeName(Type type)
+    {
+        switch (type)
+        {
+            case Type::buffer:           return "buffer";
+            case Type::texture:          return "texture";
+            case Type::transfer_buffer:  return "transfer buffer";
+            case Type::sampler:          return "sampler";
+            case Type::pipeline:         return "pipeline";
+            case Type::compute_pipeline: return "compute pipeline";
+            case Type::_count:           break;
+        }
+        return "??";
+    }
+
+    void OnCreated(Type type, std::uint64_t bytes)
+    {
+        AtomicCounts &c = counts[std::size_t(type)];
+        c.num_live.fetch_add(1, std::memory_order_relaxed);
+        c.live_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        c.num_created.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void OnDestroyed(Type type, std::uint64_t bytes)
+    {
+        AtomicCounts &c = counts[std::size_t(type)];
+        c.num_live.fetch_sub(1, std::memory_order_relaxed);
+        c.live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        c.num_destroyed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Snapshot Get()
+    {
+        Snapshot ret;
+        for (std::size_t i = 0; i < num_types; i++)
+        {
+            ret[i] = {
+                .num_live = counts[i].num_live.load(std::memory_order_relaxed),
+                .live_bytes = counts[i].live_bytes.load(std::memory_order_relaxed),
+                .num_created = counts[i].num_created.load(std::memory_order_relaxed),
+                .num_destroyed = counts[i].num_destroyed.load(std::memory_order_relaxed),
+            };
+        }
+        return ret;
+    }
+
+    std::uint64_t TotalLiveBytes(const Snapshot &snapshot)
+    {
+        std::uint64_t ret = 0;
+        for (const Counts &c : snapshot)
+            ret += c.live_bytes;
+        return ret;
+    }
+
+    void FrameCounter::Update()
+    {
+        prev = cur;
+        cur = Get();
+    }
+
+    std::uint64_t FrameCounter::CreatedLastFrame() const
+    {
+        std::uint64_t ret = 0;
+        for (std::size_t i = 0; i < num_types; i++)
+            ret += CreatedLastFrame(Type(i));
+        return ret;
+    }
+
+    std::string FrameCounter::Report() const
+    {
+        std::string ret = fmt::format("{:>16} {:>8} {:>10} {:>9} {:>9} {:>10} {:>10}\n", "gpu resources", "live", "live KiB", "+/frame", "-/frame", "created", "destroyed");
+        for (std::size_t i = 0; i < num_types; i++)
+        {
+            const Counts &c = cur[i];
+            ret += fmt::format("{:>16} {:8} {:10.1f} {:9} {:9} {:10} {:10}\n", TypeName(Type(i)), c.num_live, double(c.live_bytes) / 1024,
+                CreatedLastFrame(Type(i)), DestroyedLastFrame(Type(i)), c.num_created, c.num_destroyed);
+        }
+        return ret;
+    }
+}
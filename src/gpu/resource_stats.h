@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace em::Gpu::ResourceStats
+{
+    // Counts the live GPU resources and the bytes they use, to catch the leaks and the resources recreated every frame.
+    // The RAII wrappers (`Buffer`, `Texture`, etc) update this from their constructors and destructors, on any thread.
+    // The bytes are what we asked SDL for, the driver can add alignment and padding on top. The views of the external handles (the swapchain) aren't counted.
+
+    enum class Type
+    {
+        buffer,
+        texture,
+        transfer_buffer,
+        sampler,
+        pipeline,
+        compute_pipeline,
+        _count,
+    };
+    inline constexpr std::size_t num_types = std::size_t(Type::_count);
+
+    [[nodiscard]] const char *TypeName(Type type);
+
+    struct Counts
+    {
+        std::uint64_t num_live = 0;
+        std::uint64_t live_bytes = 0;
+        // Since the start of the program.
+        std::uint64_t num_created = 0;
+        std::uint64_t num_destroyed = 0;
+    };
+    // Indexed by `Type`.
+    using Snapshot = std::array<Counts, num_types>;
+
+    // For the wrappers.
+    void OnCreated(Type type, std::uint64_t bytes = 0);
+    void OnDestroyed(Type type, std::uint64_t bytes = 0);
+
+    // The current counts. Each number is read atomically, but not all of them at once, so they can disagree slightly while other threads create resources.
+    [[nodiscard]] Snapshot Get();
+
+    // The live bytes of all types together.
+    [[nodiscard]] std::uint64_t TotalLiveBytes(const Snapshot &snapshot);
+
+    // Turns the totals into the per-frame counts. Call `Update()` once per frame.
+    class FrameCounter
+    {
+        Snapshot prev{};
+        Snapshot cur{};
+
+      public:
+        FrameCounter() {}
+
+        // Takes a new snapshot. After this, the `...LastFrame()` functions return the counts since the previous call.
+        void Update();
+
+        [[nodiscard]] const Snapshot &Current() const {return cur;}
+
+        [[nodiscard]] std::uint64_t CreatedLastFrame(Type type) const {return cur[std::size_t(type)].num_created - prev[std::size_t(type)].num_created;}
+        [[nodiscard]] std::uint64_t DestroyedLastFrame(Type type) const {return cur[std::size_t(type)].num_destroyed - prev[std::size_t(type)].num_destroyed;}
+        // Of all types together.
+        [[nodiscard]] std::uint64_t CreatedLastFrame() const;
+
+        // A table with one row per type, as of the last `Update()`.
+        [[nodiscard]] std::string Report() const;
+    };
+}
@@ -1,6 +1,7 @@
 #include "sampler.h"
 
 #include "gpu/device.h"
+#include "gpu/resource_stats.h"
 
 #include <fmt/format.h>
 #include <SDL3/SDL_gpu.h>
@@ -55,6 +56,7 @@ namespace em::Gpu
         state.sampler = SDL_CreateGPUSampler(device.Handle(), &sdl_params);
         if (!state.sampler)
             throw std::runtime_error(fmt::format("Unable to create a GPU sampler: {}", SDL_GetError()));
+        ResourceStats::OnCreated(ResourceStats::Type::sampler);
     }
 
     Sampler::Sampler(Sampler &&other) noexcept
@@ -72,6 +74,9 @@ namespace em::Gpu
     Sampler::~Sampler()
     {
         if (state.sampler)
+        {
             SDL_ReleaseGPUSampler(state.device, state.sampler);
+            ResourceStats::OnDestroyed(ResourceStats::Type::sampler);
+        }
     }
 }
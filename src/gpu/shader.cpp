@@ -8,6 +8,7 @@
 #include <SDL3/SDL_gpu.h>
 
 #include <stdexcept>
+#include <utility>
 
 namespace em::Gpu
 {
@@ -57,6 +58,18 @@ namespace em::Gpu
             throw std::runtime_error(fmt::format("Unable to compile SPIRV shader: {}", SDL_GetError()));
     }
 
+    Shader::Shader(Shader &&other) noexcept
+        : state(std::move(other.state))
+    {
+        other.state = {};
+    }
+
+    Shader &Shader::operator=(Shader other) noexcept
+    {
+        std::swap(state, other.state);
+        return *this;
+    }
+
     Shader::~Shader()
     {
         if (state.shader)
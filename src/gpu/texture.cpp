@@ -1,13 +1,25 @@
 #include "texture.h"
 
+#include "gpu/copy_pass.h"
 #include "gpu/device.h"
+#include "gpu/resource_stats.h"
 
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace em::Gpu
 {
+    // All mipmap levels times the samples. The 3D textures are counted as if their depth didn't shrink with the levels, this is only an estimate.
+    [[nodiscard]] static std::uint64_t EstimateByteSize(const Texture::Params &params)
+    {
+        std::uint64_t ret = 0;
+        for (int level = 0; level < params.num_mipmap_levels; level++)
+            ret += SDL_CalculateGPUTextureFormatSize(params.format, std::uint32_t(std::max(1, params.size.x >> level)), std::uint32_t(std::max(1, params.size.y >> level)), std::uint32_t(params.size.z));
+        return ret << int(params.multisample_samples); // The enum is the log2 of the sample count.
+    }
+
     Texture::Texture(Device &device, const Params &params)
         : Texture() // Ensure cleanup on throw.
     {
@@ -32,6 +44,8 @@ namespace em::Gpu
             throw std::runtime_error(fmt::format("Unable to create a GPU texture: {}", SDL_GetError()));
         state.size = params.size;
         state.type = params.type;
+        state.byte_size = EstimateByteSize(params);
+        ResourceStats::OnCreated(ResourceStats::Type::texture, state.byte_size);
     }
 
     Texture::Texture(ViewExternalHandle, SDL_GPUDevice *device, SDL_GPUTexture *handle, ivec3 size, Type type)
@@ -65,6 +79,40 @@ namespace em::Gpu
             // This returns `void` and can't fail.
             // This also apparently destroys the texture lazily, when it's no longer needed, so no need to worry about synchronization issues.
             SDL_ReleaseGPUTexture(state.device, state.texture);
+            ResourceStats::OnDestroyed(ResourceStats::Type::texture, state.byte_size);
         }
     }
+
+    void Texture::CopyToTexture(CopyPass &pass, Texture &target, const CopyParams &params)
+    {
+        ivec3 size = params.size;
+        if (size.x == 0) size.x = state.size.x - params.source_pos.x;
+        if (size.y == 0) size.y = state.size.y - params.source_pos.y;
+        if (size.z == 0) size.z = state.size.z - params.source_pos.z;
+
+        // For 3D textures the Z component is the depth, and for arrays it's the layer. SDL has separate fields for those.
+        bool source_is_layered = TypeIsLayered(state.type);
+        bool target_is_layered = TypeIsLayered(target.state.type);
+
+        SDL_GPUTextureLocation sdl_source{
+            .texture   = state.texture,
+            .mip_level = params.source_mipmap_level,
+            .layer     = source_is_layered ? std::uint32_t(params.source_pos.z) : 0,
+            .x         = std::uint32_t(params.source_pos.x),
+            .y         = std::uint32_t(params.source_pos.y),
+            .z         = source_is_layered ? 0 : std::uint32_t(params.source_pos.z),
+        };
+        SDL_GPUTextureLocation sdl_target{
+            .texture   = target.state.texture,
+            .mip_level = params.target_mipmap_level,
+            .layer     = target_is_layered ? std::uint32_t(params.target_pos.z) : 0,
+            .x         = std::uint32_t(params.target_pos.x),
+            .y         = std::uint32_t(params.target_pos.y),
+            .z         = target_is_layered ? 0 : std::uint32_t(params.target_pos.z),
+        };
+
+        // Not cycling, since the user could be copying into a part of the texture.
+        // This returns `void`, so no error checking.
+        SDL_CopyGPUTextureToTexture(pass.Handle(), &sdl_source, &sdl_target, std::uint32_t(size.x), std::uint32_t(size.y), std::uint32_t(size.z), false);
+    }
 }
@@ -6,8 +6,11 @@
 
 #include <SDL3/SDL_gpu.h>
 
+#include <cstdint>
+
 namespace em::Gpu
 {
+    class CopyPass;
     class Device;
 
     // A texture.
@@ -58,6 +61,9 @@ namespace em::Gpu
 
             // Solely for user convenience.
             Type type{};
+
+            // An estimate of the memory use, for `ResourceStats`. Zero for the external handles.
+            std::uint64_t byte_size = 0;
         };
         State state;
 
@@ -106,5 +112,25 @@ namespace em::Gpu
         [[nodiscard]] ivec3 GetSize() const {return state.size;}
 
         [[nodiscard]] Type GetType() const {return state.type;}
+
+
+        struct CopyParams
+        {
+            // The corner of the region in this texture. The Z component is the layer for texture arrays.
+            ivec3 source_pos;
+            // The corner of the region in the target texture.
+            ivec3 target_pos;
+            // The region size. If zero, copies everything from `source_pos` to the end of this texture. The components can be zeroed individually.
+            ivec3 size{};
+
+            std::uint32_t source_mipmap_level = 0;
+            std::uint32_t target_mipmap_level = 0;
+        };
+
+        // Copies a region of this texture into another texture. The formats must match.
+        // Like uploads, you can assume that this finishes immediately.
+        void CopyToTexture(CopyPass &pass, Texture &target) {CopyToTexture(pass, target, {});}
+        // An overload with parameters. Not using the default constructor because of the usual issue with member initializers.
+        void CopyToTexture(CopyPass &pass, Texture &target, const CopyParams &params);
     };
 }
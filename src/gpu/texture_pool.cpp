@@ -0,0 +1,87 @@
+#include "texture_pool.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace em::Gpu
+{
+    [[nodiscard]] static bool ParamsMatch(const Texture::Params &a, const Texture::Params &b)
+    {
+        return a.type == b.type && a.format == b.format && a.usage == b.usage && a.size == b.size && a.num_mipmap_levels == b.num_mipmap_levels &&
+            a.multisample_samples == b.multisample_samples;
+    }
+
+    TexturePool::TexturePool(Device &device, FencePool &fences, std::size_t max_free_textures)
+        : device(&device), fences(&fences), max_free_textures(max_free_textures)
+    {
+        frames.emplace_back();
+    }
+
+    void TexturePool::Poll()
+    {
+        while (frames.size() > 1 && fences->IsDone(frames.front().last_command_buffer))
+        {
+            std::vector<Entry> &textures = frames.front().textures;
+            free_textures.insert(free_textures.end(), std::make_move_iterator(textures.begin()), std::make_move_iterator(textures.end()));
+            frames.pop_front();
+        }
+
+        if (free_textures.size() > max_free_textures)
+            free_textures.erase(free_textures.begin(), free_textures.end() - std::ptrdiff_t(max_free_textures));
+    }
+
+    Texture TexturePool::Acquire(const Texture::Params &params)
+    {
+        Poll();
+
+        Texture ret;
+
+        // The newest matching one, since the old ones are the first to be evicted.
+        auto it = std::find_if(free_textures.rbegin(), free_textures.rend(), [&](const Entry &entry){return ParamsMatch(entry.params, params);});
+        if (it != free_textures.rend())
+        {
+            ret = std::move(it->texture);
+            free_textures.erase(std::next(it).base());
+        }
+        else
+        {
+            ret = Texture(*device, params);
+        }
+
+        acquired_params.emplace_back(ret.Handle(), params);
+        return ret;
+    }
+
+    void TexturePool::Release(Texture &&texture)
+    {
+        if (!texture)
+            return;
+
+        auto it = std::find_if(acquired_params.begin(), acquired_params.end(), [&](const auto &elem){return elem.first == texture.Handle();});
+        if (it == acquired_params.end())
+            throw std::logic_error("This texture didn't come from this texture pool.");
+
+        frames.back().textures.push_back({.params = it->second, .texture = std::move(texture)});
+        acquired_params.erase(it);
+    }
+
+    void TexturePool::EndFrame()
+    {
+        // With no textures, or no command buffer to wait for yet, the current frame goes on.
+        if (frames.back().textures.empty() || fences->LastId() == 0)
+            return;
+
+        frames.back().last_command_buffer = fences->LastId();
+        frames.emplace_back();
+    }
+
+    std::size_t TexturePool::NumPending() const
+    {
+        std::size_t ret = 0;
+        for (const Frame &frame : frames)
+            ret += frame.textures.size();
+        return ret;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "gpu/fence_pool.h"
+#include "gpu/texture.h"
+
+#include <cstddef>
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace em::Gpu
+{
+    class Device;
+
+    // Recycles the textures that are recreated often, such as the render targets and the caches that change size, instead of destroying them.
+    // The textures are matched by all of their `Texture::Params`, so this works best when the same few sizes repeat.
+    // A released texture isn't handed out again until the GPU finishes the frame that released it, so reusing it never waits for the GPU.
+    // The contents of an acquired texture are undefined. This isn't thread-safe, use it from one thread at a time.
+    class TexturePool
+    {
+        struct Entry
+        {
+            Texture::Params params;
+            Texture texture;
+        };
+
+        struct Frame
+        {
+            // The textures released during this frame.
+            std::vector<Entry> textures;
+            // The last command buffer of this frame, set by `EndFrame()`. Zero if the frame is still going.
+            FencePool::Id last_command_buffer = 0;
+        };
+
+        Device *device = nullptr;
+        FencePool *fences = nullptr;
+
+        // The released textures that the GPU is done with.
+        std::vector<Entry> free_textures;
+        // The params of the textures that are currently acquired, so that `Release()` doesn't need them.
+        std::vector<std::pair<SDL_GPUTexture *, Texture::Params>> acquired_params;
+        // The oldest frame first. The last one is the current frame, and is never empty.
+        std::deque<Frame> frames;
+
+        // When there's more than this many free textures, the oldest ones are destroyed.
+        std::size_t max_free_textures = 0;
+
+        // Moves the textures from the finished frames to `free_textures`.
+        void Poll();
+
+      public:
+        TexturePool() {}
+
+        // The command buffers that use our textures must get their fences from `fences`, which must outlive this.
+        TexturePool(Device &device, FencePool &fences, std::size_t max_free_textures = 8);
+
+        // Returns a texture with those params, either a free one or a new one.
+        [[nodiscard]] Texture Acquire(const Texture::Params &params);
+
+        // Returns the texture to the pool. It must have come from `Acquire()`, otherwise this throws. Does nothing if `texture` is null.
+        // You can release a texture that is used by the commands of this frame or the earlier frames.
+        void Release(Texture &&texture);
+
+        // Call this once per frame, after submitting the last command buffer that uses the textures released in this frame.
+        // The released textures are then freed when the last fence added to `fences` signals. Command buffers complete in order, so that covers the frame.
+        void EndFrame();
+
+        // The textures waiting for the GPU, and the ones ready to be reused.
+        [[nodiscard]] std::size_t NumPending() const;
+        [[nodiscard]] std::size_t NumFree() const {return free_textures.size();}
+    };
+}
@@ -3,6 +3,7 @@
 #include "gpu/buffer.h"
 #include "gpu/copy_pass.h"
 #include "gpu/device.h"
+#include "gpu/resource_stats.h"
 #include "gpu/texture.h"
 
 #include <fmt/format.h>
@@ -29,6 +30,7 @@ namespace em::Gpu
         state.buffer = SDL_CreateGPUTransferBuffer(device.Handle(), &sdl_params);
         if (!state.buffer)
             throw std::runtime_error(fmt::format("Unable to create GPU transfer buffer: {}", SDL_GetError()));
+        ResourceStats::OnCreated(ResourceStats::Type::transfer_buffer, size);
     }
 
     TransferBuffer::TransferBuffer(Device &device, std::span<const unsigned char> data)
@@ -52,7 +54,10 @@ namespace em::Gpu
     TransferBuffer::~TransferBuffer()
     {
         if (state.buffer)
+        {
             SDL_ReleaseGPUTransferBuffer(state.device, state.buffer);
+            ResourceStats::OnDestroyed(ResourceStats::Type::transfer_buffer, state.size);
+        }
     }
 
     TransferBuffer::Mapping::Mapping(Mapping &&other) noexcept
@@ -75,14 +80,13 @@ namespace em::Gpu
 
     // Maps the buffer into memory temporarily.
     // It gets unmapped when the returned object dies.
-    TransferBuffer::Mapping TransferBuffer::Map()
+    TransferBuffer::Mapping TransferBuffer::Map(bool cycle)
     {
         Mapping ret;
         ret.state.device = state.device;
         ret.state.buffer = state.buffer;
 
-        // Here we always cycle. Not sure why we wouldn't want to.
-        void *address = SDL_MapGPUTransferBuffer(state.device, state.buffer, /*cycle:*/true);
+        void *address = SDL_MapGPUTransferBuffer(state.device, state.buffer, cycle);
         if (!address)
             throw std::runtime_error(fmt::format("Failed to map a GPU transfer buffer: {}", SDL_GetError()));
 
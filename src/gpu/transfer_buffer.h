@@ -86,7 +86,9 @@ namespace em::Gpu
         // Maps the buffer into memory temporarily. Throws on failure.
         // It gets unmapped when the returned object dies.
         // Call `.Span()` on the result to get the mapped pointer.
-        [[nodiscard]] Mapping Map();
+        // If `cycle` is true and the GPU still uses this buffer, SDL gives us a fresh one behind the same handle, and the commands recorded so far keep the old one.
+        // If false, the old contents stay, and you must only write to the parts that the pending commands don't read.
+        [[nodiscard]] Mapping Map(bool cycle = true);
 
         // A wrapper for `Map()` that fills the buffer from the passed pointer.
         void LoadFromMemory(const unsigned char *source);
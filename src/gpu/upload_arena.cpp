@@ -0,0 +1,112 @@
+#include "upload_arena.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace em::Gpu
+{
+    // SDL doesn't document the alignment requirements of the transfer buffer offsets, this should be enough for any texel block and any vertex.
+    static constexpr std::uint32_t alignment = 16;
+
+    UploadArena::UploadArena(Device &device, FencePool &fences, std::uint32_t block_size)
+        : device(&device), fences(&fences), block_size(block_size)
+    {
+        frames.emplace_back();
+    }
+
+    void UploadArena::Poll()
+    {
+        while (frames.size() > 1 && fences->IsDone(frames.front().last_command_buffer))
+        {
+            for (std::size_t index : frames.front().block_indices)
+                blocks[index].used = 0;
+            frames.pop_front();
+        }
+    }
+
+    UploadArena::Range UploadArena::Write(std::span<const unsigned char> data)
+    {
+        // A block is free when nothing is used in it, so an empty range must not take one, or it could be handed out again while listed in a pending frame.
+        if (data.empty())
+            return {};
+
+        std::uint32_t size = std::uint32_t(data.size());
+
+        Block *block = nullptr;
+        std::uint32_t offset = 0;
+
+        // First try to append to a block of this frame.
+        for (std::size_t index : frames.back().block_indices)
+        {
+            Block &b = blocks[index];
+            std::uint32_t aligned = (b.used + alignment - 1) / alignment * alignment;
+            if (aligned <= b.buffer.Size() && size <= b.buffer.Size() - aligned)
+            {
+                block = &b;
+                offset = aligned;
+                break;
+            }
+        }
+
+        // Then a free block, the smallest one that fits.
+        if (!block)
+        {
+            Poll();
+
+            std::size_t best_index = blocks.size();
+            for (std::size_t i = 0; i < blocks.size(); i++)
+            {
+                const Block &b = blocks[i];
+                if (!b.in_current_frame && b.used == 0 && b.buffer.Size() >= size && (best_index == blocks.size() || b.buffer.Size() < blocks[best_index].buffer.Size()))
+                    best_index = i;
+            }
+
+            // Otherwise make a new one.
+            if (best_index == blocks.size())
+                blocks.push_back({.buffer = TransferBuffer(*device, std::max(block_size, std::bit_ceil(size)))});
+
+            block = &blocks[best_index];
+            block->in_current_frame = true;
+            frames.back().block_indices.push_back(best_index);
+        }
+
+        { // Not cycling, since the earlier uploads of this frame may already be recorded from this block. We never overwrite those.
+            TransferBuffer::Mapping mapping = block->buffer.Map(/*cycle=*/false);
+            std::memcpy(mapping.Span().data() + offset, data.data(), size);
+        }
+        block->used = offset + size;
+
+        return {.buffer = &block->buffer, .offset = offset};
+    }
+
+    void UploadArena::UploadToBuffer(CopyPass &pass, std::span<const unsigned char> data, Buffer &target, std::uint32_t target_offset)
+    {
+        Range range = Write(data);
+        if (!range.buffer)
+            return;
+        range.buffer->ApplyToBuffer(pass, range.offset, target, target_offset, std::uint32_t(data.size()));
+    }
+
+    void UploadArena::UploadToTexture(CopyPass &pass, std::span<const unsigned char> data, Texture &target, TransferBuffer::TextureParams params)
+    {
+        Range range = Write(data);
+        if (!range.buffer)
+            return;
+        params.self_byte_offset = range.offset;
+        range.buffer->ApplyToTexture(pass, target, params);
+    }
+
+    void UploadArena::EndFrame()
+    {
+        // With no blocks, or no command buffer to wait for yet, the current frame goes on.
+        if (frames.back().block_indices.empty() || fences->LastId() == 0)
+            return;
+
+        for (std::size_t index : frames.back().block_indices)
+            blocks[index].in_current_frame = false;
+
+        frames.back().last_command_buffer = fences->LastId();
+        frames.emplace_back();
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "gpu/fence_pool.h"
+#include "gpu/transfer_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <vector>
+
+namespace em::Gpu
+{
+    class Buffer;
+    class CopyPass;
+    class Device;
+    class Texture;
+
+    // Stages the uploads in a few large transfer buffers, instead of creating a temporary transfer buffer for each one.
+    // The uploads are packed one after another into a block, and the block is reused once the GPU finishes the frames that read from it.
+    // An upload larger than a block gets a block of its own, which is then reused like the others.
+    // This isn't thread-safe, use it from one thread at a time.
+    class UploadArena
+    {
+        struct Block
+        {
+            TransferBuffer buffer;
+            // How many bytes are taken, starting from the beginning.
+            std::uint32_t used = 0;
+            // True if this is in `frames.back()`.
+            bool in_current_frame = false;
+        };
+
+        struct Frame
+        {
+            // Indices into `blocks`.
+            std::vector<std::size_t> block_indices;
+            // The last command buffer of this frame, set by `EndFrame()`. Zero if the frame is still going.
+            FencePool::Id last_command_buffer = 0;
+        };
+
+        Device *device = nullptr;
+        FencePool *fences = nullptr;
+
+        // Using a deque for reference stability, since the callers hold on to the ranges until they record the copy.
+        std::deque<Block> blocks;
+        // The oldest frame first. The last one is the current frame.
+        std::deque<Frame> frames;
+
+        std::uint32_t block_size = 0;
+
+        // Marks the blocks of the finished frames as free.
+        void Poll();
+
+      public:
+        UploadArena() {}
+
+        // The command buffers that upload from this must get their fences from `fences`, which must outlive this.
+        UploadArena(Device &device, FencePool &fences, std::uint32_t block_size = 1 << 20);
+
+        struct Range
+        {
+            TransferBuffer *buffer = nullptr;
+            std::uint32_t offset = 0;
+        };
+
+        // Copies `data` into a block, and returns where it ended up. Use this if the helpers below don't fit.
+        // The range stays valid until the end of the frame. Empty data gets a null range, skip the upload then (the helpers below do).
+        [[nodiscard]] Range Write(std::span<const unsigned char> data);
+
+        void UploadToBuffer(CopyPass &pass, std::span<const unsigned char> data, Buffer &target, std::uint32_t target_offset = 0);
+        // `params.self_byte_offset` is ignored and replaced with our offset.
+        void UploadToTexture(CopyPass &pass, std::span<const unsigned char> data, Texture &target) {UploadToTexture(pass, data, target, {});}
+        void UploadToTexture(CopyPass &pass, std::span<const unsigned char> data, Texture &target, TransferBuffer::TextureParams params);
+
+        // Call this once per frame, after submitting the last command buffer that uploads from this arena in this frame.
+        // This doesn't submit anything, the blocks of this frame wait for the newest fence in `fences`, i.e. the one of that command buffer (or a later one).
+        void EndFrame();
+
+        // The number of transfer buffers we've created so far.
+        [[nodiscard]] std::size_t NumBlocks() const {return blocks.size();}
+    };
+}
@@ -0,0 +1,66 @@
+#include "upload_queue.h"
+
+#include "gpu/command_buffer.h"
+#include "gpu/copy_pass.h"
+
+namespace em::Gpu
+{
+    UploadQueue::UploadQueue(Device &device, std::uint32_t block_size)
+        : device(&device), arena(device, fences, block_size)
+    {}
+
+    UploadQueue::Id UploadQueue::UploadToBuffer(std::span<const unsigned char> data, Buffer &target, std::uint32_t target_offset)
+    {
+        UploadArena::Range range = arena.Write(data);
+        if (!range.buffer)
+            return fences.NextId();
+        pending.push_back({
+            .range = range,
+            .size = std::uint32_t(data.size()),
+            .buffer = &target,
+            .buffer_offset = target_offset,
+        });
+        return fences.NextId();
+    }
+
+    UploadQueue::Id UploadQueue::UploadToTexture(std::span<const unsigned char> data, Texture &target, TransferBuffer::TextureParams params)
+    {
+        UploadArena::Range range = arena.Write(data);
+        if (!range.buffer)
+            return fences.NextId();
+        params.self_byte_offset = range.offset;
+        pending.push_back({
+            .range = range,
+            .size = std::uint32_t(data.size()),
+            .texture = &target,
+            .texture_params = params,
+        });
+        return fences.NextId();
+    }
+
+    UploadQueue::Id UploadQueue::Submit()
+    {
+        if (pending.empty())
+            return 0;
+
+        FencePool::Added batch = fences.Add();
+        {
+            CommandBuffer cmdbuf(*device, batch.fence);
+            CopyPass pass(cmdbuf);
+
+            for (PendingUpload &upload : pending)
+            {
+                if (upload.buffer)
+                    upload.range.buffer->ApplyToBuffer(pass, upload.range.offset, *upload.buffer, upload.buffer_offset, upload.size);
+                else
+                    upload.range.buffer->ApplyToTexture(pass, *upload.texture, upload.texture_params);
+            }
+        }
+        pending.clear();
+
+        // This only tags the blocks with the batch fence, which is the newest one in `fences`. They're reused once the batch is done.
+        arena.EndFrame();
+
+        return batch.id;
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "gpu/fence_pool.h"
+#include "gpu/transfer_buffer.h"
+#include "gpu/upload_arena.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace em::Gpu
+{
+    class Buffer;
+    class Device;
+    class Texture;
+
+    // Uploads textures and buffers in the background, in batches. Each batch is a dedicated command buffer with a single copy pass, separate from the frames.
+    // The uploads are staged right away (in an `UploadArena` of our own), so the source memory can be freed after the call. Then `Submit()` records and submits them.
+    // Every upload gets the id of its batch, which tells when the GPU has finished it. The arena reuses its blocks on the same fences, so a batch is one submit and one fence.
+    // The GPU runs the command buffers in order, so the frames submitted after `Submit()` can use the targets already, waiting for the copy if it's still going.
+    //   Check `IsDone()` instead if you'd rather draw something else until then, e.g. when streaming in the art during a transition.
+    // The targets must stay alive until their batch is done. This isn't thread-safe, use it from one thread at a time.
+    class UploadQueue
+    {
+      public:
+        using Id = FencePool::Id;
+
+      private:
+        struct PendingUpload
+        {
+            UploadArena::Range range;
+            std::uint32_t size = 0;
+
+            // Exactly one of those is set.
+            Buffer *buffer = nullptr;
+            std::uint32_t buffer_offset = 0;
+            Texture *texture = nullptr;
+            TransferBuffer::TextureParams texture_params;
+        };
+
+        Device *device = nullptr;
+        // Before `arena`, which points to this.
+        FencePool fences;
+        UploadArena arena;
+
+        std::vector<PendingUpload> pending;
+
+      public:
+        UploadQueue() {}
+
+        UploadQueue(Device &device, std::uint32_t block_size = 1 << 20);
+
+        // Not movable, `arena` points to `fences`.
+        UploadQueue(const UploadQueue &) = delete;
+        UploadQueue &operator=(const UploadQueue &) = delete;
+
+        // Queue an upload for the next `Submit()`, and return the id of that batch.
+        Id UploadToBuffer(std::span<const unsigned char> data, Buffer &target, std::uint32_t target_offset = 0);
+        // `params.self_byte_offset` is ignored and replaced with our offset.
+        Id UploadToTexture(std::span<const unsigned char> data, Texture &target) {return UploadToTexture(data, target, {});}
+        Id UploadToTexture(std::span<const unsigned char> data, Texture &target, TransferBuffer::TextureParams params);
+
+        // Records the queued uploads into one command buffer and submits it. Returns the id of this batch, or zero if nothing was queued.
+        Id Submit();
+
+        // Doesn't block. False for the uploads that aren't submitted yet.
+        [[nodiscard]] bool IsDone(Id id) {return fences.IsDone(id);}
+
+        // Calls `on_done` (if not null) for each batch that finished since the last call. Doesn't block. Call this once per frame or so.
+        void Poll(const std::function<void(Id id)> &on_done = nullptr) {fences.Poll(on_done);}
+
+        // Block until at least one of the submitted batches or all of them are done, then `Poll()`. Throw on failure.
+        // The uploads that aren't submitted yet are not waited for.
+        void WaitAny(const std::function<void(Id id)> &on_done = nullptr) {fences.WaitAny(on_done);}
+        void WaitAll(const std::function<void(Id id)> &on_done = nullptr) {fences.WaitAll(on_done);}
+
+        // The uploads waiting for `Submit()`.
+        [[nodiscard]] std::size_t NumQueued() const {return pending.size();}
+        // The batches submitted but not reported by `Poll()` yet.
+        [[nodiscard]] std::size_t NumInFlight() const {return fences.NumPending();}
+    };
+}
@@ -0,0 +1,334 @@
+#include "job_system.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <utility>
+
+namespace em::App
+{
+    namespace
+    {
+        // Which worker of which system the current thread is, if any.
+        thread_local const JobSystem *current_system = nullptr;
+        thread_local std::size_t current_worker = 0;
+    }
+
+    bool JobSystem::Handle::IsDone() const
+    {
+        std::scoped_lock lock(state->mutex);
+        return state->done;
+    }
+
+    void JobSystem::Handle::Wait() const
+    {
+        std::unique_lock lock(state->mutex);
+        state->cond.wait(lock, [&]{return state->done;});
+    }
+
+    void JobSystem::Handle::Get() const
+    {
+        Wait();
+        std::scoped_lock lock(state->mutex);
+        if (state->error)
+            std::rethrow_exception(state->error);
+    }
+
+    JobSystem::JobSystem(const Params &params)
+        : main_thread_id(std::this_thread::get_id())
+    {
+        std::size_t num_threads = params.num_threads;
+        if (num_threads == 0)
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+        for (std::size_t i = 0; i < num_threads; i++)
+            worker_queues.emplace_back();
+
+        threads.reserve(num_threads);
+        for (std::size_t i = 0; i < num_threads; i++)
+            threads.emplace_back([this, i]{WorkerFunc(i);});
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::scoped_lock lock(sleep_mutex);
+            stopping = true;
+        }
+        sleep_cond.notify_all();
+        // The `std::jthread`s join themselves.
+    }
+
+    void JobSystem::WorkerFunc(std::size_t index)
+    {
+        current_system = this;
+        current_worker = index;
+
+        while (true)
+        {
+            if (std::shared_ptr<JobState> job = FindJob())
+            {
+                Run(job);
+                continue;
+            }
+
+            std::unique_lock lock(sleep_mutex);
+            sleep_cond.wait(lock, [&]{return stopping || num_queued.load(std::memory_order_acquire) > 0;});
+            if (stopping && num_queued.load(std::memory_order_acquire) == 0)
+                return;
+        }
+    }
+
+    JobSystem::Handle JobSystem::AddLow(std::function<void()> func, std::span<const Handle> deps, bool main_thread)
+    {
+        auto job = std::make_shared<JobState>();
+        job->func = std::move(func);
+        job->main_thread = main_thread;
+
+        for (const Handle &dep : deps)
+        {
+            if (!dep)
+                continue;
+
+            std::scoped_lock lock(dep.state->mutex);
+            if (dep.state->done)
+            {
+                if (dep.state->error)
+                {
+                    std::scoped_lock job_lock(job->mutex);
+                    if (!job->error)
+                        job->error = dep.state->error;
+                }
+                continue;
+            }
+            job->num_blockers.fetch_add(1, std::memory_order_relaxed);
+            dep.state->dependents.push_back(job);
+        }
+
+        Handle ret;
+        ret.state = job;
+        // Drop the extra blocker that kept the job from starting while we were adding the dependencies.
+        Release(job);
+        return ret;
+    }
+
+    void JobSystem::Release(const std::shared_ptr<JobState> &job)
+    {
+        if (job->num_blockers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            Schedule(job);
+    }
+
+    void JobSystem::Schedule(std::shared_ptr<JobState> job)
+    {
+        if (job->main_thread)
+        {
+            std::scoped_lock lock(main_queue.mutex);
+            main_queue.jobs.push_back(std::move(job));
+            return;
+        }
+
+        Queue &queue = current_system == this ? worker_queues[current_worker] : outside_queue;
+        {
+            std::scoped_lock lock(queue.mutex);
+            queue.jobs.push_back(std::move(job));
+        }
+
+        num_queued.fetch_add(1, std::memory_order_release);
+        // Locking to make sure a worker isn't between checking `num_queued` and falling asleep, otherwise it would miss the notification.
+        {
+            std::scoped_lock lock(sleep_mutex);
+        }
+        sleep_cond.notify_one();
+    }
+
+    std::shared_ptr<JobSystem::JobState> JobSystem::FindJob()
+    {
+        auto Pop = [&](Queue &queue, bool newest) -> std::shared_ptr<JobState>
+        {
+            std::scoped_lock lock(queue.mutex);
+            if (queue.jobs.empty())
+                return nullptr;
+            std::shared_ptr<JobState> ret;
+            if (newest)
+            {
+                ret = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+            }
+            else
+            {
+                ret = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+            }
+            if (&queue != &main_queue)
+                num_queued.fetch_sub(1, std::memory_order_relaxed);
+            return ret;
+        };
+
+        if (std::this_thread::get_id() == main_thread_id)
+        {
+            if (auto job = Pop(main_queue, false))
+                return job;
+        }
+
+        bool is_worker = current_system == this;
+        if (is_worker)
+        {
+            if (auto job = Pop(worker_queues[current_worker], true))
+                return job;
+        }
+
+        if (auto job = Pop(outside_queue, false))
+            return job;
+
+        // Steal, starting from the next worker, so that the thieves don't all pick the same victim.
+        std::size_t first = is_worker ? current_worker + 1 : 0;
+        for (std::size_t i = 0; i < worker_queues.size(); i++)
+        {
+            if (auto job = Pop(worker_queues[(first + i) % worker_queues.size()], false))
+                return job;
+        }
+
+        return nullptr;
+    }
+
+    void JobSystem::Run(const std::shared_ptr<JobState> &job)
+    {
+        // Only this thread touches `error` now, the dependencies are done with it.
+        if (!job->error)
+        {
+            try
+            {
+                job->func();
+            }
+            catch (...)
+            {
+                job->error = std::current_exception();
+            }
+        }
+        // Release the captures now, instead of when the last handle dies.
+        job->func = nullptr;
+
+        std::vector<std::shared_ptr<JobState>> dependents;
+        {
+            std::scoped_lock lock(job->mutex);
+            job->done = true;
+            dependents = std::move(job->dependents);
+        }
+        job->cond.notify_all();
+
+        for (const std::shared_ptr<JobState> &dependent : dependents)
+        {
+            if (job->error)
+            {
+                std::scoped_lock lock(dependent->mutex);
+                if (!dependent->error)
+                    dependent->error = job->error;
+            }
+            Release(dependent);
+        }
+    }
+
+    JobSystem::Handle JobSystem::Add(std::function<void()> func, std::span<const Handle> deps)
+    {
+        return AddLow(std::move(func), deps, false);
+    }
+
+    JobSystem::Handle JobSystem::AddMainThread(std::function<void()> func, std::span<const Handle> deps)
+    {
+        return AddLow(std::move(func), deps, true);
+    }
+
+    void JobSystem::Wait(const Handle &handle)
+    {
+        while (!handle.IsDone())
+        {
+            if (std::shared_ptr<JobState> job = FindJob())
+            {
+                Run(job);
+                continue;
+            }
+
+            // Nothing to run. Sleep until the job is done, but check the queues now and then, since its dependencies might need our help.
+            std::unique_lock lock(handle.state->mutex);
+            handle.state->cond.wait_for(lock, std::chrono::milliseconds(1), [&]{return handle.state->done;});
+        }
+
+        handle.Get();
+    }
+
+    void JobSystem::ParallelFor(std::size_t n, const std::function<void(std::size_t i)> &func)
+    {
+        if (n == 0)
+            return;
+
+        std::atomic<std::size_t> next_index = 0;
+        std::atomic<bool> failed = false;
+
+        auto Body = [&]
+        {
+            std::size_t i;
+            while (!failed.load(std::memory_order_relaxed) && (i = next_index.fetch_add(1, std::memory_order_relaxed)) < n)
+            {
+                try
+                {
+                    func(i);
+                }
+                catch (...)
+                {
+                    failed.store(true, std::memory_order_relaxed);
+                    throw;
+                }
+            }
+        };
+
+        // The calling thread is one of the participants.
+        std::vector<Handle> helpers;
+        std::size_t num_helpers = std::min(n - 1, threads.size());
+        helpers.reserve(num_helpers);
+        for (std::size_t h = 0; h < num_helpers; h++)
+            helpers.push_back(Add(Body));
+
+        std::exception_ptr error;
+        try
+        {
+            Body();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        // Wait for all of them even if something threw, since they refer to our locals. The first exception wins.
+        for (const Handle &helper : helpers)
+        {
+            try
+            {
+                Wait(helper);
+            }
+            catch (...)
+            {
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    Action JobSystem::Tick()
+    {
+        assert(std::this_thread::get_id() == main_thread_id && "`JobSystem::Tick()` must be called on the main thread.");
+
+        // Only the jobs that are already queued, so that a job that adds another one doesn't keep us here forever.
+        std::deque<std::shared_ptr<JobState>> jobs;
+        {
+            std::scoped_lock lock(main_queue.mutex);
+            jobs.swap(main_queue.jobs);
+        }
+        for (const std::shared_ptr<JobState> &job : jobs)
+            Run(job);
+
+        return Action::cont;
+    }
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "mainloop/module.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace em::App
+{
+    // A work-stealing thread pool, with dependencies between the jobs, and with jobs that must run on the main thread (e.g. the SDL and OpenAL calls).
+    // This is a module, so its lifetime is tied to the app: add it to the app (see `ReflectedApp`), and its `Tick()` runs the main-thread jobs once per frame.
+    // Each worker has its own queue. A worker runs the newest job from its own queue first, which is the one with the hottest cache,
+    //   then the jobs added from outside of the workers, then steals the oldest jobs from the other workers.
+    class JobSystem : public Module
+    {
+        struct JobState;
+
+      public:
+        // Refers to a job. The job runs regardless of whether the handles are kept.
+        class Handle
+        {
+            friend JobSystem;
+            std::shared_ptr<JobState> state;
+
+          public:
+            Handle() {}
+
+            [[nodiscard]] explicit operator bool() const {return bool(state);}
+
+            // Whether the job has finished, or was skipped because one of its dependencies threw.
+            [[nodiscard]] bool IsDone() const;
+            // Blocks until the job is done. This doesn't run other jobs meanwhile, see `JobSystem::Wait()` for that.
+            // Don't call this from the jobs, if all workers end up waiting, nothing runs the jobs they wait for.
+            void Wait() const;
+            // Same, then rethrows the exception from the job (or from its dependency that caused it to be skipped), if any.
+            void Get() const;
+        };
+
+        struct Params
+        {
+            // Zero means one per hardware thread.
+            std::size_t num_threads = 0;
+        };
+
+      private:
+        struct JobState
+        {
+            std::function<void()> func;
+            bool main_thread = false;
+
+            // The number of unfinished dependencies, plus one while `Add()` is still registering them. The job is queued when this reaches zero.
+            std::atomic<std::size_t> num_blockers = 1;
+
+            // Guards everything below.
+            std::mutex mutex;
+            std::condition_variable cond;
+            bool done = false;
+            // Those are released when this finishes.
+            std::vector<std::shared_ptr<JobState>> dependents;
+            // Thrown by `func`, or inherited from a dependency, in which case `func` isn't called.
+            std::exception_ptr error;
+        };
+
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<std::shared_ptr<JobState>> jobs;
+        };
+
+        std::thread::id main_thread_id;
+
+        // One per worker thread. Using a deque for reference stability.
+        std::deque<Queue> worker_queues;
+        // The jobs added from the non-worker threads.
+        Queue outside_queue;
+        // The jobs for `Tick()`.
+        Queue main_queue;
+
+        // The sleeping workers wait on `sleep_cond` for this to become positive. This doesn't count `main_queue`.
+        std::atomic<std::size_t> num_queued = 0;
+        std::mutex sleep_mutex;
+        std::condition_variable sleep_cond;
+        bool stopping = false;
+
+        // This must be last, to be destroyed (joined) first, while the rest is still alive.
+        std::vector<std::jthread> threads;
+
+        void WorkerFunc(std::size_t index);
+
+        [[nodiscard]] Handle AddLow(std::function<void()> func, std::span<const Handle> deps, bool main_thread);
+        // Decrements `num_blockers`, and queues the job if it reaches zero.
+        void Release(const std::shared_ptr<JobState> &job);
+        void Schedule(std::shared_ptr<JobState> job);
+        // Returns null if there's nothing to run. `main_queue` is only checked on the main thread.
+        [[nodiscard]] std::shared_ptr<JobState> FindJob();
+        void Run(const std::shared_ptr<JobState> &job);
+
+      public:
+        // Creates the workers. This must be called on the main thread.
+        JobSystem(const Params &params);
+
+        // Not movable, the threads refer to `this`.
+        JobSystem(const JobSystem &) = delete;
+        JobSystem &operator=(const JobSystem &) = delete;
+        // Finishes the queued jobs, then joins the threads.
+        // The jobs still waiting for their dependencies, and the main-thread jobs not yet run by `Tick()`, are dropped.
+        ~JobSystem();
+
+        [[nodiscard]] std::size_t NumThreads() const {return threads.size();}
+
+        // Queues `func` to run on a worker, after all `deps` finish. The exceptions are stored in the handle, see `Handle::Get()`.
+        // If a dependency throws, `func` is skipped, and the exception is passed on to this job.
+        // This can be called from any thread, including from the jobs.
+        Handle Add(std::function<void()> func, std::span<const Handle> deps = {});
+        // Same, but `func` runs on the main thread, in `Tick()` or in `Wait()`.
+        Handle AddMainThread(std::function<void()> func, std::span<const Handle> deps = {});
+
+        // Waits for the job, running other jobs meanwhile. On the main thread, this also runs the main-thread jobs.
+        // Unlike `Handle::Wait()`, this is fine to call from the jobs. Rethrows like `Handle::Get()`.
+        void Wait(const Handle &handle);
+
+        // Calls `func(i)` for every `i` in `0..n`, on the workers and on the calling thread, and waits for it to finish.
+        // The indices are handed out one by one, so the uneven workloads are balanced automatically.
+        // If any call throws, the remaining indices are skipped, and the first exception is rethrown here. This can be called from the jobs.
+        void ParallelFor(std::size_t n, const std::function<void(std::size_t i)> &func);
+
+        // Runs the main-thread jobs that were queued before this call.
+        Action Tick() override;
+    };
+}
@@ -11,12 +11,35 @@ namespace em::App
         exit_failure = SDL_APP_FAILURE,
     };
 
+    // How often `ReflectedApp` calls `Module::Tick()`. Override `Module::TickSchedule()` to change it.
+    struct Schedule
+    {
+        enum class Policy
+        {
+            every_frame,
+            // At most `rate` times per second, and at most once per frame. The missed ticks aren't made up for.
+            fixed_rate,
+            // Every `every_n_frames`-th frame.
+            every_n_frames,
+            // Only if the frame so far (the modules before this one) took less than `budget` seconds.
+            // But at least every `every_n_frames`-th frame, so that it doesn't starve on slow machines.
+            when_budget_allows,
+        };
+        Policy policy = Policy::every_frame;
+
+        double rate = 60;
+        int every_n_frames = 1;
+        double budget = 0.008;
+    };
+
     // The base class for the whole application and for the individual modules in it.
     struct Module
     {
         virtual ~Module() = default;
 
         virtual Action Tick() {return Action::cont;}
+        // Read by `ReflectedApp` every frame, so this can change over time.
+        virtual Schedule TickSchedule() const {return {};}
         virtual Action HandleEvent(SDL_Event &e) {(void)e; return Action::cont;}
     };
 }
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <fmt/format.h>
+#include <SDL3/SDL_timer.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+namespace em::App
+{
+    // How long the `Tick()` of each module takes, and how often it's skipped by its `Schedule`. `ReflectedApp` records this.
+    // The modules are listed in the order they tick. This is only meant for the main thread.
+    class ModuleTimings
+    {
+      public:
+        struct Entry
+        {
+            const std::type_info *type = nullptr;
+
+            std::uint64_t num_ticks = 0;
+            // The frames where the schedule didn't let it tick.
+            std::uint64_t num_skipped = 0;
+
+            // In `SDL_GetPerformanceCounter()` ticks.
+            std::uint64_t total = 0;
+            std::uint64_t max = 0;
+            std::uint64_t last = 0;
+        };
+
+      private:
+        [[nodiscard]] static std::vector<Entry> &GetEntries()
+        {
+            static std::vector<Entry> ret;
+            return ret;
+        }
+
+        [[nodiscard]] static std::string TypeName(const std::type_info &type)
+        {
+            #if __has_include(<cxxabi.h>)
+            int status = 0;
+            std::unique_ptr<char, decltype(&std::free)> name(abi::__cxa_demangle(type.name(), nullptr, nullptr, &status), &std::free);
+            if (status == 0 && name)
+                return name.get();
+            #endif
+            return type.name();
+        }
+
+      public:
+        ModuleTimings() = delete;
+
+        // The entry for the `index`-th module in the tick order. `ReflectedApp` calls this.
+        [[nodiscard]] static Entry &At(std::size_t index, const std::type_info &type)
+        {
+            std::vector<Entry> &entries = GetEntries();
+            if (index >= entries.size())
+                entries.resize(index + 1);
+            Entry &entry = entries[index];
+            // If a different module ends up in this position, start over.
+            if (entry.type != &type && (!entry.type || *entry.type != type))
+                entry = {.type = &type};
+            return entry;
+        }
+
+        static void Record(Entry &entry, std::uint64_t ticks)
+        {
+            entry.num_ticks++;
+            entry.total += ticks;
+            entry.max = std::max(entry.max, ticks);
+            entry.last = ticks;
+        }
+
+        [[nodiscard]] static const std::vector<Entry> &Entries()
+        {
+            return GetEntries();
+        }
+
+        // Returns a human-readable table, one line per module, in milliseconds.
+        [[nodiscard]] static std::string Report()
+        {
+            double ms_per_tick = 1000. / double(SDL_GetPerformanceFrequency());
+
+            std::string ret = fmt::format("{:>28} {:>8} {:>8} {:>8} {:>8} {:>8}\n", "module", "ticks", "skipped", "avg", "max", "last");
+            for (const Entry &entry : GetEntries())
+            {
+                if (!entry.type)
+                    continue;
+                ret += fmt::format("{:>28} {:8} {:8} {:8.3f} {:8.3f} {:8.3f}\n", TypeName(*entry.type), entry.num_ticks, entry.num_skipped,
+                    entry.num_ticks ? double(entry.total) / double(entry.num_ticks) * ms_per_tick : 0, double(entry.max) * ms_per_tick, double(entry.last) * ms_per_tick);
+            }
+            return ret;
+        }
+    };
+}
@@ -3,6 +3,15 @@
 #include "em/macros/utils/forward.h"
 #include "em/refl/for_each_matching_elem.h"
 #include "mainloop/module.h"
+#include "mainloop/module_timings.h"
+#include "mainloop/startup_trace.h"
+
+#include <SDL3/SDL_timer.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <typeinfo>
+#include <vector>
 
 namespace em::App
 {
@@ -14,9 +23,68 @@ namespace em::App
     // 2. We could check if the function is overridden in `T` via `if constexpr (std::is_same_v<decltype(&T::func), decltype(&Module::func)>)`,
     //   but that breaks down if the user starts adding overloads of `func` (we could also test for inability to take the address,
     //   but then we don't know if that should result in true or false).
+    // This also starts the `StartupTrace` timeline right before constructing `T`.
+    // Each module ticks according to its `Module::TickSchedule()`, and the time each one takes is recorded in `ModuleTimings`.
     template <typename T>
     struct ReflectedApp : Module
     {
+      private:
+        struct BeginStartupTrace
+        {
+            BeginStartupTrace() {StartupTrace::Begin();}
+        };
+        // This must be before `underlying`.
+        [[no_unique_address]] BeginStartupTrace begin_startup_trace;
+
+        // For the `Schedule`s, one per module, in the tick order.
+        struct ModuleState
+        {
+            // For `Schedule::Policy::fixed_rate`, in `SDL_GetPerformanceCounter()` ticks.
+            std::uint64_t next_tick_time = 0;
+            int frames_since_tick = 0;
+            bool ticked_before = false;
+        };
+        std::vector<ModuleState> module_states;
+
+        // For `Schedule::Policy::fixed_rate`.
+        [[nodiscard]] static std::uint64_t TickPeriod(const Schedule &schedule)
+        {
+            return std::uint64_t(double(SDL_GetPerformanceFrequency()) / schedule.rate);
+        }
+
+        // `now` and `frame_start` are in `SDL_GetPerformanceCounter()` ticks.
+        [[nodiscard]] static bool ShouldTick(const Schedule &schedule, ModuleState &state, std::uint64_t now, std::uint64_t frame_start)
+        {
+            // Everything ticks on the first frame.
+            if (!state.ticked_before)
+            {
+                if (schedule.policy == Schedule::Policy::fixed_rate)
+                    state.next_tick_time = now + TickPeriod(schedule);
+                return true;
+            }
+
+            switch (schedule.policy)
+            {
+              case Schedule::Policy::every_frame:
+                return true;
+              case Schedule::Policy::fixed_rate:
+                {
+                    if (now < state.next_tick_time)
+                        return false;
+                    std::uint64_t period = TickPeriod(schedule);
+                    // Keep the average rate, unless we're so far behind that we'd tick on every frame to catch up.
+                    state.next_tick_time = now - state.next_tick_time < period ? state.next_tick_time + period : now + period;
+                    return true;
+                }
+              case Schedule::Policy::every_n_frames:
+                return state.frames_since_tick + 1 >= schedule.every_n_frames;
+              case Schedule::Policy::when_budget_allows:
+                return double(now - frame_start) < schedule.budget * double(SDL_GetPerformanceFrequency()) || state.frames_since_tick + 1 >= schedule.every_n_frames;
+            }
+            return true;
+        }
+
+      public:
         T underlying;
 
         ReflectedApp(auto &&... params) : underlying(EM_FWD(params)...) {}
@@ -26,7 +94,32 @@ namespace em::App
             // `exit_success` is non-zero (zero is `cont`). This causes us to exit if there are no overriders,
             //   to avoid an infinite loop, which apparently is only stoppable by a SIGKILL.
             Action ret = Action::exit_success;
-            Refl::ForEachElemOfTypeCvref<Module, Meta::LoopAnyOf<>>(underlying, [&](Module &m){return bool(ret = m.Tick());});
+            std::uint64_t frame_start = SDL_GetPerformanceCounter();
+            std::size_t index = 0;
+            Refl::ForEachElemOfTypeCvref<Module, Meta::LoopAnyOf<>>(underlying, [&](Module &m)
+            {
+                if (index >= module_states.size())
+                    module_states.resize(index + 1);
+                ModuleState &state = module_states[index];
+                ModuleTimings::Entry &timing = ModuleTimings::At(index, typeid(m));
+                index++;
+
+                std::uint64_t start = SDL_GetPerformanceCounter();
+                if (!ShouldTick(m.TickSchedule(), state, start, frame_start))
+                {
+                    state.frames_since_tick++;
+                    timing.num_skipped++;
+                    // A skipped module still counts as an overrider, so don't exit.
+                    ret = Action::cont;
+                    return false;
+                }
+                state.ticked_before = true;
+                state.frames_since_tick = 0;
+
+                ret = m.Tick();
+                ModuleTimings::Record(timing, SDL_GetPerformanceCounter() - start);
+                return bool(ret);
+            });
             return ret;
         }
 
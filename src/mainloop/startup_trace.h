@@ -0,0 +1,92 @@
+#pragma once
+
+#include <fmt/format.h>
+#include <SDL3/SDL_timer.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace em::App
+{
+    // Shows where the startup time goes, as a sequence of named phases.
+    // `ReflectedApp` starts the timeline right before constructing your app. Then each `Mark()` ends a phase: the time since the previous mark is attributed to it.
+    // Use `StartupMark` members to time the member initializers (including the ones in `EM_REFL()`), and call `Mark()` directly in the constructor body.
+    // This is only meant for the main thread.
+    class StartupTrace
+    {
+      public:
+        struct Phase
+        {
+            std::string_view name;
+            std::uint64_t ticks = 0;
+        };
+
+      private:
+        struct State
+        {
+            std::uint64_t start = 0;
+            std::uint64_t last_mark = 0;
+            std::vector<Phase> phases;
+        };
+
+        [[nodiscard]] static State &GetState()
+        {
+            static State ret;
+            return ret;
+        }
+
+      public:
+        StartupTrace() = delete;
+
+        // Restarts the timeline. `ReflectedApp` calls this.
+        static void Begin()
+        {
+            State &state = GetState();
+            state.start = state.last_mark = SDL_GetPerformanceCounter();
+            state.phases.clear();
+        }
+
+        // Ends the current phase. `name` must outlive the trace, normally it's a string literal.
+        static void Mark(std::string_view name)
+        {
+            State &state = GetState();
+            std::uint64_t now = SDL_GetPerformanceCounter();
+            state.phases.push_back({.name = name, .ticks = now - state.last_mark});
+            state.last_mark = now;
+        }
+
+        [[nodiscard]] static const std::vector<Phase> &Phases()
+        {
+            return GetState().phases;
+        }
+
+        // Returns a human-readable table, one line per phase, in milliseconds, with the total at the end.
+        [[nodiscard]] static std::string Report()
+        {
+            const State &state = GetState();
+            double ms_per_tick = 1000. / double(SDL_GetPerformanceFrequency());
+            double total = double(state.last_mark - state.start) * ms_per_tick;
+
+            std::string ret = fmt::format("{:>28} {:>9} {:>6}\n", "startup phase", "ms", "%");
+            for (const Phase &phase : state.phases)
+            {
+                double ms = double(phase.ticks) * ms_per_tick;
+                ret += fmt::format("{:>28} {:9.2f} {:6.1f}\n", phase.name, ms, total > 0 ? ms / total * 100 : 0);
+            }
+            ret += fmt::format("{:>28} {:9.2f}\n", "total", total);
+            return ret;
+        }
+    };
+
+    // Calls `StartupTrace::Mark()` when constructed. Declare one right after the members you want to time, and it measures them together.
+    // E.g. `App::StartupMark startup_mark_window = "window";`, or `(App::StartupMark)(startup_mark_window, "window")` in `EM_REFL()`.
+    struct StartupMark
+    {
+        StartupMark(const char *name)
+        {
+            StartupTrace::Mark(name);
+        }
+    };
+}
@@ -0,0 +1,41 @@
+#include "alloc_counter.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace em::AllocCounter
+{
+    namespace
+    {
+        // Constant-initialized, so it's usable by the allocations during the static initialization.
+        constinit std::atomic<std::uint64_t> num_allocations = 0;
+    }
+
+    std::uint64_t NumAllocations()
+    {
+        return num_allocations.load(std::memory_order_relaxed);
+    }
+}
+
+#ifdef EM_COUNT_ALLOCATIONS
+// Only the basic forms. The standard library implements the array and `nothrow` forms via those, and the over-aligned ones are rare enough to not bother.
+void *operator new(std::size_t size)
+{
+    em::AllocCounter::num_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *ret = std::malloc(size ? size : 1))
+        return ret;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+#endif
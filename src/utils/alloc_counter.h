@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts the heap allocations, to check that the steady-state gameplay doesn't allocate. The microbenchmarks report it per operation.
+// This replaces the global `operator new`, so it's only compiled in if `EM_COUNT_ALLOCATIONS` is defined (the `frames_microbench` target does that).
+// Otherwise `IsEnabled()` returns false, and the count stays zero.
+namespace em::AllocCounter
+{
+    [[nodiscard]] constexpr bool IsEnabled()
+    {
+        #ifdef EM_COUNT_ALLOCATIONS
+        return true;
+        #else
+        return false;
+        #endif
+    }
+
+    // The number of `operator new` calls so far, from all threads.
+    [[nodiscard]] std::uint64_t NumAllocations();
+}
@@ -0,0 +1,97 @@
+#include "asset_pack.h"
+
+#include <fmt/format.h>
+#include <SDL3/SDL_filesystem.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace em::Filesystem
+{
+    AssetPack::AssetPack(zstring_view path)
+    {
+        auto new_file = std::make_shared<const MappedFile>(path);
+
+        AssetPackHeader header;
+        if (new_file->size() < sizeof header)
+            throw std::runtime_error(fmt::format("The asset pack `{}` is too small to be valid.", path));
+        std::memcpy(&header, new_file->data(), sizeof header);
+        if (!header.IsValid())
+            throw std::runtime_error(fmt::format("The asset pack `{}` has an invalid header or an outdated version. Rebuild the assets.", path));
+
+        if (header.entries_offset % alignof(AssetPackEntry) != 0 || header.entries_offset > new_file->size() ||
+            (new_file->size() - header.entries_offset) / sizeof(AssetPackEntry) < header.num_entries || header.names_offset > new_file->size())
+        {
+            throw std::runtime_error(fmt::format("The asset pack `{}` has a malformed header.", path));
+        }
+
+        // The mapping is page-aligned, and the offset is checked above.
+        const auto *new_entries = reinterpret_cast<const AssetPackEntry *>(new_file->data() + header.entries_offset);
+        for (std::uint32_t i = 0; i < header.num_entries; i++)
+        {
+            const AssetPackEntry &entry = new_entries[i];
+            // `>=` rather than `>`, because each blob must be followed by a null terminator.
+            if (entry.data_offset > new_file->size() || entry.data_size >= new_file->size() - entry.data_offset ||
+                entry.name_size > new_file->size() - header.names_offset || entry.name_offset > new_file->size() - header.names_offset - entry.name_size)
+            {
+                throw std::runtime_error(fmt::format("The asset pack `{}` has a malformed entry #{}.", path, i));
+            }
+        }
+
+        file = std::move(new_file);
+        entries = new_entries;
+        num_entries = header.num_entries;
+        names = reinterpret_cast<const char *>(file->data() + header.names_offset);
+    }
+
+    std::optional<LoadedFile> AssetPack::Find(std::string_view name) const
+    {
+        if (!file)
+            return {};
+
+        std::uint64_t hash = AssetPackHash(name);
+        const AssetPackEntry *it = std::lower_bound(entries, entries + num_entries, hash, [](const AssetPackEntry &entry, std::uint64_t hash){return entry.name_hash < hash;});
+        for (; it != entries + num_entries && it->name_hash == hash; it++)
+        {
+            if (std::string_view(names + it->name_offset, it->name_size) != name)
+                continue; // A hash collision.
+
+            return LoadedFile(
+                std::shared_ptr<const unsigned char[]>(file, file->data() + it->data_offset),
+                std::size_t(it->data_size),
+                fmt::format("{} (in {})", name, file->GetName())
+            );
+        }
+        return {};
+    }
+
+    static AssetPack &MountedPack()
+    {
+        static AssetPack ret;
+        return ret;
+    }
+
+    void MountAssetPack(AssetPack pack)
+    {
+        MountedPack() = std::move(pack);
+    }
+
+    bool MountAssetPackIfExists(zstring_view path)
+    {
+        SDL_PathInfo info{};
+        if (!SDL_GetPathInfo(path.c_str(), &info) || info.type != SDL_PATHTYPE_FILE)
+            return false;
+        MountAssetPack(AssetPack(path));
+        return true;
+    }
+
+    const AssetPack *GetMountedAssetPack()
+    {
+        const AssetPack &pack = MountedPack();
+        return pack ? &pack : nullptr;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "em/zstring_view.h"
+#include "utils/asset_pack_format.h"
+#include "utils/filesystem.h"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace em::Filesystem
+{
+    // A read-only archive of assets, made by `tools/pack_assets`. See `asset_pack_format.h` for the format.
+    // The whole pack is memory-mapped, so opening it is one file open, and the contents are paged in as they're used.
+    class AssetPack
+    {
+        std::shared_ptr<const MappedFile> file;
+        const AssetPackEntry *entries = nullptr;
+        std::size_t num_entries = 0;
+        const char *names = nullptr;
+
+      public:
+        AssetPack() {}
+
+        // Opens a pack, throws on failure, including if it's malformed or has an outdated version.
+        AssetPack(zstring_view path);
+
+        [[nodiscard]] explicit operator bool() const {return bool(file);}
+
+        [[nodiscard]] std::size_t NumFiles() const {return num_entries;}
+
+        // Looks up a file by its name relative to the resource directory (see `asset_pack_format.h`). Returns null if there's no such file.
+        // The result points into the mapping, and keeps it alive.
+        [[nodiscard]] std::optional<LoadedFile> Find(std::string_view name) const;
+    };
+
+    // After this, `LoadedFile` looks up the files under `GetResourceDir()` in `pack` first, and only reads the loose files if they're not there.
+    // Call this at startup, before any other threads start loading files.
+    void MountAssetPack(AssetPack pack);
+    // Mounts the pack at `path` if that file exists. Returns true if it was mounted. Throws if it exists but can't be opened.
+    bool MountAssetPackIfExists(zstring_view path);
+
+    // Returns null if nothing is mounted.
+    [[nodiscard]] const AssetPack *GetMountedAssetPack();
+}
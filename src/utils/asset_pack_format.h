@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// The asset pack format that `Filesystem::AssetPack` reads. The build makes one from all assets using `tools/pack_assets`.
+// A file is `AssetPackHeader`, then `num_entries` of `AssetPackEntry` sorted by `name_hash` (then by name), then the names, then the blobs.
+// Every blob starts at a multiple of `blob_alignment`, and is followed by at least one zero byte, so `LoadedFile` can keep its null terminator guarantee.
+// The names are relative to the resource directory, with `/` as the separator, e.g. `assets/sounds/jump.wav`. They aren't null-terminated.
+// All integers are little-endian, since that's what every platform we target uses.
+// This is deliberately free of dependencies, because the packing tool uses it too.
+struct AssetPackHeader
+{
+    // Bump `current_version` when changing the layout.
+    static constexpr char expected_magic[4] = {'F', 'P', 'A', 'K'};
+    static constexpr std::uint32_t current_version = 1;
+    static constexpr std::uint64_t blob_alignment = 64;
+
+    char magic[4]{};
+    std::uint32_t version = 0;
+    std::uint32_t num_entries = 0;
+    std::uint32_t _padding = 0;
+    std::uint64_t entries_offset = 0;
+    std::uint64_t names_offset = 0;
+
+    [[nodiscard]] bool IsValid() const
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            if (magic[i] != expected_magic[i])
+                return false;
+        }
+        return version == current_version;
+    }
+};
+static_assert(sizeof(AssetPackHeader) == 32);
+
+struct AssetPackEntry
+{
+    // `AssetPackHash()` of the name.
+    std::uint64_t name_hash = 0;
+    // Relative to the beginning of the file.
+    std::uint64_t data_offset = 0;
+    std::uint64_t data_size = 0;
+    // Relative to `AssetPackHeader::names_offset`.
+    std::uint32_t name_offset = 0;
+    std::uint32_t name_size = 0;
+};
+static_assert(sizeof(AssetPackEntry) == 32);
+
+// FNV-1a.
+[[nodiscard]] constexpr std::uint64_t AssetPackHash(std::string_view name)
+{
+    std::uint64_t ret = 0xcbf29ce484222325;
+    for (char ch : name)
+    {
+        ret ^= std::uint8_t(ch);
+        ret *= 0x100000001b3;
+    }
+    return ret;
+}
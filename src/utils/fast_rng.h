@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <numbers>
+
+namespace em
+{
+    // A small and fast random number generator, PCG32 (XSH-RR). The whole state is 16 bytes, so copying the worlds that own one stays cheap.
+    // Unlike `std::mt19937_64` with the standard distributions, the helpers below are our own, so the sequence is the same on every platform
+    //   and every standard library. This matters for the replays and `BatchSim`.
+    // This satisfies UniformRandomBitGenerator, so it also works with `<random>` and `std::shuffle()`.
+    class FastRng
+    {
+        std::uint64_t state = 0;
+        // Must be odd. Different values give independent streams.
+        std::uint64_t increment = 0;
+
+        // SplitMix64, to turn similar seeds (0, 1, 2, ...) into unrelated states.
+        [[nodiscard]] static constexpr std::uint64_t Mix(std::uint64_t &x)
+        {
+            std::uint64_t z = (x += 0x9e3779b97f4a7c15);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            return z ^ (z >> 31);
+        }
+
+      public:
+        using result_type = std::uint32_t;
+
+        constexpr FastRng() : FastRng(0) {}
+        explicit constexpr FastRng(std::uint64_t seed) {Seed(seed);}
+
+        constexpr void Seed(std::uint64_t seed)
+        {
+            state = Mix(seed);
+            increment = Mix(seed) | 1;
+        }
+
+        [[nodiscard]] static constexpr result_type min() {return 0;}
+        [[nodiscard]] static constexpr result_type max() {return std::numeric_limits<result_type>::max();}
+
+        constexpr result_type operator()()
+        {
+            std::uint64_t old = state;
+            state = old * 6364136223846793005 + increment;
+            std::uint32_t xorshifted = std::uint32_t(((old >> 18) ^ old) >> 27);
+            std::uint32_t rot = std::uint32_t(old >> 59);
+            return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+        }
+
+        // Two numbers combined. Good for seeding other generators, see `ParticlePool::AddBurst()`.
+        [[nodiscard]] constexpr std::uint64_t Next64()
+        {
+            std::uint64_t high = (*this)();
+            return high << 32 | (*this)();
+        }
+
+        // 0 <= x < 1. Using the top 24 bits, which is all that a float can represent in this range uniformly.
+        [[nodiscard]] constexpr float Float01()
+        {
+            return float((*this)() >> 8) * 0x1p-24f;
+        }
+
+        // -1 <= x < 1.
+        [[nodiscard]] constexpr float Float11()
+        {
+            return Float01() * 2 - 1;
+        }
+
+        // -pi <= x < pi.
+        [[nodiscard]] constexpr float Angle()
+        {
+            return Float11() * std::numbers::pi_v<float>;
+        }
+
+        [[nodiscard]] constexpr int Sign()
+        {
+            return (*this)() >> 31 ? 1 : -1;
+        }
+
+        // `min <= x <= max`. The bias is at most `(max - min + 1) / 2^32`, which is negligible for the small ranges we use.
+        [[nodiscard]] constexpr int Int(int min, int max)
+        {
+            std::uint64_t range = std::uint64_t(std::int64_t(max) - min + 1);
+            return int(std::int64_t(min) + std::int64_t((std::uint64_t((*this)()) * range) >> 32));
+        }
+
+        // True with the probability `p`.
+        [[nodiscard]] constexpr bool Chance(float p)
+        {
+            return Float01() < p;
+        }
+    };
+}
@@ -0,0 +1,37 @@
+#include "file_watcher.h"
+
+#include "em/zstring_view.h"
+
+#include <SDL3/SDL_filesystem.h>
+
+#include <utility>
+
+namespace em::Filesystem
+{
+    [[nodiscard]] static SDL_Time GetModifyTime(zstring_view path)
+    {
+        SDL_PathInfo info;
+        if (!SDL_GetPathInfo(path.c_str(), &info) || info.type != SDL_PATHTYPE_FILE)
+            return 0;
+        return info.modify_time;
+    }
+
+    void FileWatcher::Watch(std::string path, std::function<void()> on_change)
+    {
+        SDL_Time time = GetModifyTime(path);
+        entries.push_back({.path = std::move(path), .seen_time = time, .reported_time = time, .on_change = std::move(on_change)});
+    }
+
+    void FileWatcher::Poll()
+    {
+        for (Entry &entry : entries)
+        {
+            SDL_Time prev_time = std::exchange(entry.seen_time, GetModifyTime(entry.path));
+            if (entry.seen_time == 0 || entry.seen_time != prev_time || entry.seen_time == entry.reported_time)
+                continue;
+            // Update before calling, so that a throwing callback doesn't make us report the same change forever.
+            entry.reported_time = entry.seen_time;
+            entry.on_change();
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace em::Filesystem
+{
+    // Polls the modification times of a list of files, and calls a callback when one of them changes.
+    // We don't use the OS change notifications, since they differ between platforms, and polling a few dozen files is cheap enough.
+    class FileWatcher
+    {
+        struct Entry
+        {
+            std::string path;
+            // What we saw on the last poll. Zero if the file didn't exist.
+            SDL_Time seen_time = 0;
+            // What we last reported (or saw when starting to watch).
+            SDL_Time reported_time = 0;
+            std::function<void()> on_change;
+        };
+        std::vector<Entry> entries;
+
+      public:
+        FileWatcher() {}
+
+        // Starts watching `path`. The current state of the file counts as unchanged.
+        void Watch(std::string path, std::function<void()> on_change);
+
+        // Checks all files, and calls `on_change` for the ones that were modified, but then stayed the same since the previous call.
+        // That is, the changes are reported one call late, which usually avoids reading a file while it's still being written.
+        // A file that disappears (e.g. while the build is replacing it) isn't reported until it reappears.
+        // If a callback throws, the remaining files are checked on the next call.
+        void Poll();
+
+        [[nodiscard]] std::size_t NumFiles() const {return entries.size();}
+    };
+}
@@ -1,13 +1,26 @@
 #include "filesystem.h"
 
+#include "em/macros/utils/finally.h"
+#include "utils/asset_pack.h"
+
 #include <fmt/format.h>
 #include <SDL3/SDL_filesystem.h>
 #include <SDL3/SDL_iostream.h>
 
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <string_view>
+
 #ifdef _WIN32
 #define MOMINMAX
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 namespace em::Filesystem
@@ -143,8 +156,56 @@ namespace em::Filesystem
     }
     #endif
 
-    LoadedFile::LoadedFile(zstring_view file_path)
+    // The granularity of the memory mappings. The tail of the last page past the end of the file is zero-filled.
+    [[nodiscard]] static std::size_t PageSize()
+    {
+        static const std::size_t ret = []{
+            #ifdef _WIN32
+            SYSTEM_INFO info{};
+            GetSystemInfo(&info);
+            return std::size_t(info.dwPageSize);
+            #else
+            return std::size_t(sysconf(_SC_PAGESIZE));
+            #endif
+        }();
+        return ret;
+    }
+
+    LoadedFile::LoadedFile(zstring_view file_path, LoadMode mode)
     {
+        if (const AssetPack *pack = GetMountedAssetPack())
+        {
+            zstring_view resource_dir = GetResourceDir();
+            if (std::string_view(file_path).starts_with(std::string_view(resource_dir)))
+            {
+                std::string pack_name(std::string_view(file_path).substr(resource_dir.size()));
+                #ifdef _WIN32
+                std::replace(pack_name.begin(), pack_name.end(), '\\', '/');
+                #endif
+                if (std::optional<LoadedFile> packed = pack->Find(pack_name))
+                {
+                    *this = std::move(*packed);
+                    return;
+                }
+            }
+        }
+
+        if (mode == LoadMode::map)
+        {
+            // We promise a null terminator, which exists after the end of a mapping only if the last page isn't full.
+            SDL_PathInfo info{};
+            if (SDL_GetPathInfo(file_path.c_str(), &info) && info.type == SDL_PATHTYPE_FILE && info.size > 0 && info.size % PageSize() != 0)
+            {
+                auto mapping = std::make_shared<const MappedFile>(file_path);
+                data_size.value = mapping->size();
+                // Aliasing the mapping, so the last copy of `ptr` unmaps it.
+                ptr = std::shared_ptr<const unsigned char[]>(mapping, mapping->data());
+
+                name = file_path;
+                return;
+            }
+        }
+
         auto new_ptr = reinterpret_cast<const unsigned char *>(SDL_LoadFile(file_path.c_str(), &data_size.value));
         if (!new_ptr)
             throw std::runtime_error(fmt::format("Unable to load file contents: `{}`.", file_path));
@@ -152,4 +213,64 @@ namespace em::Filesystem
 
         name = file_path;
     }
+
+    MappedFile::MappedFile(zstring_view file_path)
+        : MappedFile() // Ensure cleanup on throw.
+    {
+        name = file_path;
+
+        #ifdef _WIN32
+        HANDLE file = CreateFileW(WindowsUtf8ToWide(file_path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error(fmt::format("Unable to open file for mapping: `{}`.", file_path));
+        // The mapping keeps the file open, so we don't need this handle afterwards.
+        EM_FINALLY{CloseHandle(file);};
+
+        LARGE_INTEGER file_size{};
+        if (!GetFileSizeEx(file, &file_size))
+            throw std::runtime_error(fmt::format("Unable to get the size of file: `{}`.", file_path));
+        if (file_size.QuadPart == 0)
+            throw std::runtime_error(fmt::format("Unable to map an empty file: `{}`.", file_path));
+
+        state.mapping_handle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!state.mapping_handle)
+            throw std::runtime_error(fmt::format("Unable to create a file mapping: `{}`.", file_path));
+
+        state.data = static_cast<const unsigned char *>(MapViewOfFile(state.mapping_handle, FILE_MAP_READ, 0, 0, 0));
+        if (!state.data)
+            throw std::runtime_error(fmt::format("Unable to map file: `{}`.", file_path));
+        state.size = std::size_t(file_size.QuadPart);
+        #else
+        int fd = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+            throw std::runtime_error(fmt::format("Unable to open file for mapping: `{}`.", file_path));
+        // The mapping keeps the file open, so we don't need the descriptor afterwards.
+        EM_FINALLY{close(fd);};
+
+        struct stat file_stat{};
+        if (fstat(fd, &file_stat) != 0)
+            throw std::runtime_error(fmt::format("Unable to get the size of file: `{}`.", file_path));
+        if (file_stat.st_size == 0)
+            throw std::runtime_error(fmt::format("Unable to map an empty file: `{}`.", file_path));
+
+        void *address = mmap(nullptr, std::size_t(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED)
+            throw std::runtime_error(fmt::format("Unable to map file: `{}`.", file_path));
+        state.data = static_cast<const unsigned char *>(address);
+        state.size = std::size_t(file_stat.st_size);
+        #endif
+    }
+
+    MappedFile::~MappedFile()
+    {
+        #ifdef _WIN32
+        if (state.data)
+            UnmapViewOfFile(state.data);
+        if (state.mapping_handle)
+            CloseHandle(state.mapping_handle);
+        #else
+        if (state.data)
+            munmap(const_cast<unsigned char *>(state.data), state.size);
+        #endif
+    }
 }
@@ -8,11 +8,9 @@
 #include <cstdio>
 #include <memory>
 #include <span>
+#include <string>
 #include <string_view>
 #include <utility>
-#ifdef _WIN32
-#include <string>
-#endif
 
 namespace em::Filesystem
 {
@@ -78,6 +76,16 @@ namespace em::Filesystem
     };
 
 
+    // How `LoadedFile` gets the file contents.
+    enum class LoadMode
+    {
+        // Read everything upfront into a heap allocation.
+        read,
+        // Map the file into memory (see `MappedFile`). The OS pages the contents in lazily, and shares them between processes.
+        // If the null terminator can't be guaranteed (the file is empty, or its size is a multiple of the page size), silently falls back to `read`.
+        map,
+    };
+
     // The contents of a file loaded to memory.
     class LoadedFile
     {
@@ -94,8 +102,16 @@ namespace em::Filesystem
       public:
         constexpr LoadedFile() {}
 
-        // Load from a file.
-        LoadedFile(zstring_view file_path);
+        // Load from a file. If an asset pack is mounted and has this file, it's loaded from there instead, see `MountAssetPack()`.
+        LoadedFile(zstring_view file_path, LoadMode mode = LoadMode::read);
+
+        // Wrap existing memory, which must stay alive as long as `new_ptr` does. `new_ptr[new_size]` must be a null terminator.
+        LoadedFile(std::shared_ptr<const unsigned char[]> new_ptr, std::size_t new_size, std::string new_name)
+            : ptr(std::move(new_ptr))
+        {
+            data_size.value = new_size;
+            name.value = std::move(new_name);
+        }
 
         [[nodiscard]] explicit operator bool() const {return bool(ptr);}
 
@@ -112,4 +128,46 @@ namespace em::Filesystem
         // This doesn't work automatically in some cases because the compiler refuses to consider more than one user-defined conversion at the same time.
         [[nodiscard]] operator std::string_view() const {return operator zstring_view();}
     };
+
+
+    // A read-only memory mapping of a whole file.
+    // Unlike `LoadedFile`, this doesn't read anything upfront. The OS pages the contents in when you touch them.
+    class MappedFile
+    {
+        struct State
+        {
+            const unsigned char *data = nullptr;
+            std::size_t size = 0;
+            #ifdef _WIN32
+            void *mapping_handle = nullptr;
+            #endif
+        };
+        State state;
+
+        // A file name for the user.
+        std::string name;
+
+      public:
+        constexpr MappedFile() {}
+
+        // Maps a file, throws on failure. Empty files can't be mapped.
+        MappedFile(zstring_view file_path);
+
+        MappedFile(MappedFile &&other) noexcept : state(std::exchange(other.state, {})), name(std::move(other.name)) {}
+        MappedFile &operator=(MappedFile other) noexcept {std::swap(state, other.state); std::swap(name, other.name); return *this;}
+
+        ~MappedFile();
+
+        [[nodiscard]] explicit operator bool() const {return bool(state.data);}
+
+        [[nodiscard]] const std::string &GetName() const {return name;}
+
+        [[nodiscard]] const unsigned char *data() const {return state.data;}
+        [[nodiscard]] std::size_t size() const {return state.size;}
+
+        [[nodiscard]] const unsigned char *begin() const {return data();}
+        [[nodiscard]] const unsigned char *end() const {return data() + size();}
+
+        [[nodiscard]] operator std::span<const unsigned char>() const {return {state.data, state.size};}
+    };
 }
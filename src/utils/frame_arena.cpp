@@ -0,0 +1,56 @@
+#include "frame_arena.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+namespace em
+{
+    void FrameArena::AddBlock(std::size_t min_size)
+    {
+        // Double the size each time, so a burst needs few blocks.
+        std::size_t size = std::max({min_size, blocks.empty() ? initial_size : blocks.back().size * 2, std::size_t(64)});
+        blocks.push_back({std::make_unique_for_overwrite<unsigned char[]>(size), size});
+        used = 0;
+    }
+
+    void *FrameArena::Allocate(std::size_t size, std::size_t alignment)
+    {
+        assert(alignment != 0 && (alignment & (alignment - 1)) == 0 && "The alignment must be a power of two.");
+
+        if (!blocks.empty())
+        {
+            Block &block = blocks.back();
+            std::uintptr_t base = std::uintptr_t(block.data.get());
+            std::size_t offset = std::size_t((base + used + alignment - 1) & ~std::uintptr_t(alignment - 1)) - std::size_t(base);
+            if (offset <= block.size && block.size - offset >= size)
+            {
+                used = offset + size;
+                return block.data.get() + offset;
+            }
+        }
+
+        // With the extra space for the alignment. The new block starts at an address aligned at least as well as by `new`.
+        AddBlock(size + alignment);
+        return Allocate(size, alignment);
+    }
+
+    void FrameArena::Reset()
+    {
+        used = 0;
+        if (blocks.size() > 1)
+        {
+            std::size_t total = Capacity();
+            blocks.clear();
+            AddBlock(total);
+        }
+    }
+
+    std::size_t FrameArena::Capacity() const
+    {
+        std::size_t ret = 0;
+        for (const Block &block : blocks)
+            ret += block.size;
+        return ret;
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <fmt/format.h>
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <vector>
+
+namespace em
+{
+    // A bump allocator for the scratch data that only lives until the end of a tick or a frame.
+    // `Allocate()` is a pointer increment, and `Reset()` frees everything at once. Nothing is destroyed, so only put into it what is fine to not destroy,
+    //   or use the containers below, which destroy their elements themselves.
+    // When a block runs out, another one is chained. `Reset()` then replaces them with one block of the combined size, so after a warmup this never allocates.
+    class FrameArena
+    {
+        struct Block
+        {
+            std::unique_ptr<unsigned char[]> data;
+            std::size_t size = 0;
+        };
+
+        std::vector<Block> blocks;
+        // How much of the last block is used.
+        std::size_t used = 0;
+        // The size of the first block, if we don't have any yet.
+        std::size_t initial_size = 0;
+
+        void AddBlock(std::size_t min_size);
+
+      public:
+        // Doesn't allocate until the first `Allocate()`.
+        explicit FrameArena(std::size_t initial_size = 4096) : initial_size(initial_size) {}
+
+        // Copying doesn't copy the contents, since they're only valid until the next `Reset()` anyway. This makes the owners (e.g. `World`) copyable.
+        // A copy starts empty, and the assignment keeps the blocks of the target.
+        FrameArena(const FrameArena &other) : initial_size(other.Capacity() ? other.Capacity() : other.initial_size) {}
+        FrameArena &operator=(const FrameArena &) {return *this;}
+
+        // Returns uninitialized memory. `alignment` must be a power of two.
+        [[nodiscard]] void *Allocate(std::size_t size, std::size_t alignment);
+
+        // Invalidates everything allocated so far. Merges the blocks, if there's more than one.
+        void Reset();
+
+        // The total size of the blocks.
+        [[nodiscard]] std::size_t Capacity() const;
+    };
+
+    // Lets the standard containers allocate from a `FrameArena`. The deallocations do nothing, the memory is reclaimed by `FrameArena::Reset()`.
+    // The containers must not outlive the next reset, and their growth wastes the old storage until then, so `reserve()` if you can.
+    template <typename T>
+    class ArenaAllocator
+    {
+        template <typename U>
+        friend class ArenaAllocator;
+
+        FrameArena *arena = nullptr;
+
+      public:
+        using value_type = T;
+
+        ArenaAllocator(FrameArena &arena) : arena(&arena) {}
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+        [[nodiscard]] T *allocate(std::size_t n)
+        {
+            if (n > std::size_t(-1) / sizeof(T))
+                throw std::bad_array_new_length();
+            return static_cast<T *>(arena->Allocate(n * sizeof(T), alignof(T)));
+        }
+        void deallocate(T *, std::size_t) noexcept {}
+
+        template <typename U>
+        [[nodiscard]] bool operator==(const ArenaAllocator<U> &other) const {return arena == other.arena;}
+    };
+
+    template <typename T>
+    using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+    // Formats into `arena` instead of a `std::string`. The result is null-terminated, and is valid until the next `arena.Reset()`.
+    template <typename ...P>
+    [[nodiscard]] std::string_view FormatToArena(FrameArena &arena, fmt::format_string<const P &...> format, const P &... params)
+    {
+        // Measuring first, to allocate the exact size.
+        std::size_t size = fmt::formatted_size(format, params...);
+        char *buffer = static_cast<char *>(arena.Allocate(size + 1, 1));
+        *fmt::format_to(buffer, format, params...) = '\0';
+        return std::string_view(buffer, size);
+    }
+}
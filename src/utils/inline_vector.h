@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+namespace em
+{
+    // A vector with a fixed capacity, stored inline. Never allocates, and copies are as cheap as copying the array.
+    // Exceeding the capacity is a bug, and only asserts. `T` must be default-constructible, all `N` elements always exist.
+    template <typename T, std::size_t N>
+    class InlineVector
+    {
+        std::array<T, N> elems{};
+        std::size_t count = 0;
+
+      public:
+        using value_type = T;
+        using iterator = T *;
+        using const_iterator = const T *;
+
+        constexpr InlineVector() {}
+
+        template <typename I>
+        constexpr InlineVector(I first, I last)
+        {
+            assign(first, last);
+        }
+
+        [[nodiscard]] static constexpr std::size_t capacity() {return N;}
+        [[nodiscard]] constexpr std::size_t size() const {return count;}
+        [[nodiscard]] constexpr bool empty() const {return count == 0;}
+        [[nodiscard]] constexpr bool full() const {return count == N;}
+
+        [[nodiscard]] constexpr T *data() {return elems.data();}
+        [[nodiscard]] constexpr const T *data() const {return elems.data();}
+
+        [[nodiscard]] constexpr iterator begin() {return data();}
+        [[nodiscard]] constexpr iterator end() {return data() + count;}
+        [[nodiscard]] constexpr const_iterator begin() const {return data();}
+        [[nodiscard]] constexpr const_iterator end() const {return data() + count;}
+
+        [[nodiscard]] constexpr T &operator[](std::size_t i) {assert(i < count); return elems[i];}
+        [[nodiscard]] constexpr const T &operator[](std::size_t i) const {assert(i < count); return elems[i];}
+
+        constexpr void clear()
+        {
+            // Resetting the removed elements, so that hashing the whole object stays meaningful.
+            for (std::size_t i = 0; i < count; i++)
+                elems[i] = T{};
+            count = 0;
+        }
+
+        constexpr T &push_back(T value)
+        {
+            assert(count < N && "`InlineVector` capacity exceeded.");
+            elems[count] = std::move(value);
+            return elems[count++];
+        }
+
+        // Removes the element and shifts the rest back. Returns the iterator to the element after it, like `std::vector::erase()`.
+        constexpr iterator erase(const_iterator it)
+        {
+            std::size_t i = std::size_t(it - begin());
+            assert(i < count);
+            std::move(begin() + i + 1, end(), begin() + i);
+            elems[--count] = T{};
+            return begin() + i;
+        }
+
+        template <typename I>
+        constexpr void assign(I first, I last)
+        {
+            clear();
+            for (; first != last; ++first)
+                push_back(T(*first));
+        }
+    };
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace em
+{
+    // A bounded FIFO queue from one producer thread to one consumer thread, without locks. Neither side ever waits, a full queue rejects the push.
+    // The producer and the consumer can change over time, as long as there's a happens-before between the old thread's last call and the new thread's first one
+    //   (e.g. the new thread was started or joined by the old one).
+    template <typename T>
+    class SpscQueue
+    {
+        // Separating the indices, so that the two threads don't fight over the same cache line.
+        static constexpr std::size_t cache_line_size = 64;
+
+        // The size is a power of two, to wrap the indices with a mask.
+        std::vector<T> slots;
+        std::size_t mask = 0;
+
+        // Those only grow, and are wrapped when indexing. Written only by the consumer and the producer respectively.
+        alignas(cache_line_size) std::atomic<std::size_t> read_pos = 0;
+        alignas(cache_line_size) std::atomic<std::size_t> write_pos = 0;
+
+      public:
+        // The capacity is rounded up to a power of two. The slots are allocated once here.
+        explicit SpscQueue(std::size_t capacity)
+            : slots(std::bit_ceil(std::max(capacity, std::size_t(1)))), mask(slots.size() - 1)
+        {}
+
+        // Not movable, the threads refer to the slots.
+        SpscQueue(const SpscQueue &) = delete;
+        SpscQueue &operator=(const SpscQueue &) = delete;
+
+        [[nodiscard]] std::size_t Capacity() const {return slots.size();}
+
+        // For the producer. Returns false and drops `value` if the queue is full.
+        bool TryPush(T value)
+        {
+            std::size_t pos = write_pos.load(std::memory_order_relaxed);
+            if (pos - read_pos.load(std::memory_order_acquire) == slots.size())
+                return false;
+            slots[pos & mask] = std::move(value);
+            write_pos.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        // For the consumer. Returns null if the queue is empty.
+        [[nodiscard]] std::optional<T> TryPop()
+        {
+            std::size_t pos = read_pos.load(std::memory_order_relaxed);
+            if (pos == write_pos.load(std::memory_order_acquire))
+                return std::nullopt;
+            // Resetting the slot, so that it doesn't hold onto the resources of `T` (e.g. a `std::function` capture) until it's overwritten.
+            std::optional<T> ret = std::exchange(slots[pos & mask], T{});
+            read_pos.store(pos + 1, std::memory_order_release);
+            return ret;
+        }
+    };
+}
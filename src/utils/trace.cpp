@@ -0,0 +1,130 @@
+#include "trace.h"
+
+#include "utils/filesystem.h"
+
+#include <fmt/format.h>
+#include <SDL3/SDL_timer.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace em::Trace
+{
+    namespace
+    {
+        struct ThreadBuffer
+        {
+            // 24 bytes each, so this is 1.5 MB per thread.
+            static constexpr std::size_t capacity = 1 << 16;
+
+            std::unique_ptr<impl::Event[]> events = std::make_unique<impl::Event[]>(capacity);
+            // Only the owning thread writes to this. The events below it are complete.
+            std::atomic<std::size_t> size = 0;
+            std::atomic<std::size_t> num_dropped = 0;
+            std::size_t thread_index = 0;
+        };
+
+        // The buffers outlive their threads, so that the events can be exported after the threads exit.
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        };
+
+        [[nodiscard]] Registry &GetRegistry()
+        {
+            static Registry ret;
+            return ret;
+        }
+
+        [[nodiscard]] ThreadBuffer &GetThreadBuffer()
+        {
+            // Locking only once per thread.
+            thread_local ThreadBuffer *buffer = []{
+                Registry &registry = GetRegistry();
+                std::scoped_lock lock(registry.mutex);
+                auto &ret = registry.buffers.emplace_back(std::make_unique<ThreadBuffer>());
+                ret->thread_index = registry.buffers.size() - 1;
+                return ret.get();
+            }();
+            return *buffer;
+        }
+    }
+
+    namespace impl
+    {
+        std::uint64_t Now()
+        {
+            return SDL_GetPerformanceCounter();
+        }
+
+        void Record(const char *name, std::uint64_t begin, std::uint64_t end)
+        {
+            ThreadBuffer &buffer = GetThreadBuffer();
+            std::size_t size = buffer.size.load(std::memory_order_relaxed);
+            if (size >= ThreadBuffer::capacity)
+            {
+                buffer.num_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            buffer.events[size] = {.name = name, .begin = begin, .end = end};
+            // Publishes the event to `ToChromeJson()`.
+            buffer.size.store(size + 1, std::memory_order_release);
+        }
+    }
+
+    std::size_t NumDroppedEvents()
+    {
+        Registry &registry = GetRegistry();
+        std::scoped_lock lock(registry.mutex);
+        std::size_t ret = 0;
+        for (const auto &buffer : registry.buffers)
+            ret += buffer->num_dropped.load(std::memory_order_relaxed);
+        return ret;
+    }
+
+    std::string ToChromeJson()
+    {
+        Registry &registry = GetRegistry();
+        std::scoped_lock lock(registry.mutex);
+
+        // The timestamps are in microseconds, relative to the earliest event.
+        const double us_per_tick = 1e6 / double(SDL_GetPerformanceFrequency());
+        std::uint64_t origin = std::uint64_t(-1);
+        for (const auto &buffer : registry.buffers)
+        {
+            std::size_t size = buffer->size.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < size; i++)
+                origin = std::min(origin, buffer->events[i].begin);
+        }
+
+        std::string ret = "{\"traceEvents\":[\n";
+        bool first = true;
+        for (const auto &buffer : registry.buffers)
+        {
+            std::size_t size = buffer->size.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < size; i++)
+            {
+                const impl::Event &event = buffer->events[i];
+                // The names are string literals, so they don't need escaping.
+                ret += fmt::format("{}{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                    first ? "" : ",\n", event.name, buffer->thread_index, double(event.begin - origin) * us_per_tick, double(event.end - event.begin) * us_per_tick);
+                first = false;
+            }
+        }
+        ret += "\n],\"displayTimeUnit\":\"ms\"}\n";
+        return ret;
+    }
+
+    void WriteChromeJson(zstring_view path)
+    {
+        std::string json = ToChromeJson();
+        Filesystem::File file(path, "wb");
+        if (std::fwrite(json.data(), json.size(), 1, file.Handle()) != 1)
+            throw std::runtime_error(fmt::format("Unable to write the trace to `{}`.", path));
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "em/zstring_view.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Scoped profiling zones, exported in the Chrome trace format. Open the result in https://ui.perfetto.dev or `chrome://tracing`.
+// The zones are only compiled in if `EM_TRACE` is defined (the `profile` build mode does that), otherwise the macros expand to nothing,
+//   so they can stay in the code in all build modes. Even when compiled in, nothing is recorded until `Trace::SetEnabled(true)`.
+// Every thread records into its own buffer, without locking. When a buffer fills up, the rest of the events of that thread are dropped.
+
+// Measures the time until the end of the scope. `name` must be a string literal (or otherwise outlive the trace).
+#ifdef EM_TRACE
+#define EM_TRACE_ZONE(name) ::em::Trace::impl::Zone EM_TRACE_IMPL_CAT(_em_trace_zone_, __LINE__)(name)
+#else
+#define EM_TRACE_ZONE(name) do {} while (false)
+#endif
+
+#define EM_TRACE_IMPL_CAT(a, b) EM_TRACE_IMPL_CAT_(a, b)
+#define EM_TRACE_IMPL_CAT_(a, b) a##b
+
+namespace em::Trace
+{
+    namespace impl
+    {
+        struct Event
+        {
+            const char *name = nullptr;
+            // In `SDL_GetPerformanceCounter()` ticks.
+            std::uint64_t begin = 0;
+            std::uint64_t end = 0;
+        };
+
+        inline std::atomic_bool enabled = false;
+
+        [[nodiscard]] std::uint64_t Now();
+
+        // Appends to the buffer of the current thread, creating it if needed.
+        void Record(const char *name, std::uint64_t begin, std::uint64_t end);
+
+        class Zone
+        {
+            const char *name = nullptr;
+            std::uint64_t begin = 0;
+
+          public:
+            explicit Zone(const char *name)
+            {
+                if (enabled.load(std::memory_order_relaxed))
+                {
+                    this->name = name;
+                    begin = Now();
+                }
+            }
+            Zone(const Zone &) = delete;
+            Zone &operator=(const Zone &) = delete;
+            ~Zone()
+            {
+                if (name)
+                    Record(name, begin, Now());
+            }
+        };
+    }
+
+    // Starts or stops recording.
+    inline void SetEnabled(bool enable)
+    {
+        impl::enabled.store(enable, std::memory_order_relaxed);
+    }
+    [[nodiscard]] inline bool IsEnabled()
+    {
+        return impl::enabled.load(std::memory_order_relaxed);
+    }
+
+    // How many events didn't fit into the buffers.
+    [[nodiscard]] std::size_t NumDroppedEvents();
+
+    // Returns the events recorded so far, from all threads, in the Chrome trace JSON format.
+    // This can be called while the other threads are still recording, it only sees the events that were finished at the time of the call.
+    [[nodiscard]] std::string ToChromeJson();
+    // Writes `ToChromeJson()` to a file. Throws on failure.
+    void WriteChromeJson(zstring_view path);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace em
+{
+    // Passes the latest value of `T` from one producer thread to one consumer thread, without locks and without either side ever waiting.
+    // There are three slots: one the producer writes, one the consumer reads, and one in the middle that they exchange with atomically.
+    // The consumer always gets the most recently published value. The values published in between are skipped.
+    template <typename T>
+    class TripleBuffer
+    {
+        // The index of the middle slot, plus `fresh_bit` if the consumer hasn't picked it up yet.
+        static constexpr std::uint8_t index_mask = 3, fresh_bit = 4;
+
+        std::array<T, 3> slots{};
+        std::atomic<std::uint8_t> middle = 1;
+        // Those are only touched by their own threads.
+        std::uint8_t write_index = 0;
+        std::uint8_t read_index = 2;
+
+      public:
+        TripleBuffer() {}
+
+        // Not movable, the threads refer to the slots.
+        TripleBuffer(const TripleBuffer &) = delete;
+        TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+        // The producer's slot. It holds an older value that the consumer is done with, overwrite it completely, then call `Publish()`.
+        [[nodiscard]] T &WriteSlot() {return slots[write_index];}
+
+        // Hands the write slot over to the consumer. Call from the producer thread.
+        void Publish()
+        {
+            write_index = std::uint8_t(middle.exchange(std::uint8_t(write_index | fresh_bit), std::memory_order_acq_rel) & index_mask);
+        }
+
+        // If something was published since the last call, makes it the read slot and returns true. Call from the consumer thread.
+        bool Update()
+        {
+            if (!(middle.load(std::memory_order_relaxed) & fresh_bit))
+                return false;
+            read_index = std::uint8_t(middle.exchange(read_index, std::memory_order_acq_rel) & index_mask);
+            return true;
+        }
+
+        // The consumer's slot, the value from the last successful `Update()`. Stays valid and unchanged until the next one.
+        [[nodiscard]]       T &ReadSlot()       {return slots[read_index];}
+        [[nodiscard]] const T &ReadSlot() const {return slots[read_index];}
+    };
+}
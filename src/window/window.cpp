@@ -27,9 +27,16 @@ namespace em
         if (!state.window)
             throw std::runtime_error(fmt::format("Unable to create SDL window: {}", SDL_GetError()));
 
-        state.gpu_device = params.gpu_device->Handle();
-        if (params.gpu_device && !SDL_ClaimWindowForGPUDevice(params.gpu_device->Handle(), state.window))
-            throw std::runtime_error(fmt::format("Unable to attach SDL window to the GPU device: {}", SDL_GetError()));
+        if (params.gpu_device)
+        {
+            if (!SDL_ClaimWindowForGPUDevice(params.gpu_device->Handle(), state.window))
+                throw std::runtime_error(fmt::format("Unable to attach SDL window to the GPU device: {}", SDL_GetError()));
+            state.gpu_device = params.gpu_device->Handle();
+
+            SetPresentMode(SupportsPresentMode(params.present_mode) ? params.present_mode : PresentMode::vsync);
+            if (params.max_frames_in_flight != state.max_frames_in_flight)
+                SetMaxFramesInFlight(params.max_frames_in_flight);
+        }
 
         if (!SDL_SetWindowMinimumSize(state.window, params.min_size ? params.min_size->x : params.size.x, params.min_size ? params.min_size->y : params.size.y))
             throw std::runtime_error(fmt::format("Unable to set minimum window size: {}", SDL_GetError()));
@@ -57,4 +64,45 @@ namespace em
     {
         return SDL_GetGPUSwapchainTextureFormat(state.gpu_device, state.window);
     }
+
+    static SDL_GPUPresentMode PresentModeToSdl(Window::PresentMode mode)
+    {
+        switch (mode)
+        {
+          case Window::PresentMode::vsync:     return SDL_GPU_PRESENTMODE_VSYNC;
+          case Window::PresentMode::mailbox:   return SDL_GPU_PRESENTMODE_MAILBOX;
+          case Window::PresentMode::immediate: return SDL_GPU_PRESENTMODE_IMMEDIATE;
+        }
+        throw std::logic_error("Invalid present mode enum.");
+    }
+
+    bool Window::SupportsPresentMode(PresentMode mode) const
+    {
+        return SDL_WindowSupportsGPUPresentMode(state.gpu_device, state.window, PresentModeToSdl(mode));
+    }
+
+    void Window::SetPresentMode(PresentMode mode)
+    {
+        if (!SDL_SetGPUSwapchainParameters(state.gpu_device, state.window, SDL_GPU_SWAPCHAINCOMPOSITION_SDR, PresentModeToSdl(mode)))
+            throw std::runtime_error(fmt::format("Unable to set the present mode to `{}`: {}", PresentModeName(mode), SDL_GetError()));
+        state.present_mode = mode;
+    }
+
+    void Window::SetMaxFramesInFlight(std::uint32_t n)
+    {
+        if (!SDL_SetGPUAllowedFramesInFlight(state.gpu_device, n))
+            throw std::runtime_error(fmt::format("Unable to set the number of frames in flight to {}: {}", n, SDL_GetError()));
+        state.max_frames_in_flight = n;
+    }
+
+    const char *PresentModeName(Window::PresentMode mode)
+    {
+        switch (mode)
+        {
+          case Window::PresentMode::vsync:     return "vsync";
+          case Window::PresentMode::mailbox:   return "mailbox";
+          case Window::PresentMode::immediate: return "immediate";
+        }
+        return "??";
+    }
 }
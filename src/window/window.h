@@ -4,6 +4,7 @@
 
 #include <SDL3/SDL_gpu.h>
 
+#include <cstdint>
 #include <optional>
 #include <string_view>
 
@@ -17,6 +18,16 @@ namespace em
     // One window. Maybe attached to a SDL GPU device, maybe not.
     class Window
     {
+      public:
+        // How the swapchain images are presented. Only makes sense if a GPU device is attached.
+        enum class PresentMode
+        {
+            vsync, // Waits for the vertical blank. Always supported. No tearing, but the most latency.
+            mailbox, // Doesn't block, the newest finished frame replaces the queued one. No tearing. Not always supported.
+            immediate, // Presents right away. The least latency, but tears. Not always supported.
+        };
+
+      private:
         struct State
         {
             SDL_Window *window = nullptr;
@@ -25,6 +36,9 @@ namespace em
             // Only set if a GPU device is attached.
             // This is here solely for our convenience. This lets us call `SDL_GetGPUSwapchainTextureFormat()`, for example.
             SDL_GPUDevice *gpu_device = nullptr;
+
+            PresentMode present_mode = PresentMode::vsync;
+            std::uint32_t max_frames_in_flight = 2;
         };
         State state;
 
@@ -38,6 +52,13 @@ namespace em
             ivec2 size = ivec2(1920, 1080) / 3;
             std::optional<ivec2> min_size{}; // If not set, matches `size`.
             bool resizable = true;
+
+            // Those are ignored if no GPU device is attached.
+            // If this mode isn't supported, falls back to `vsync`.
+            PresentMode present_mode = PresentMode::vsync;
+            // How many frames the CPU can be ahead of the GPU, 1 to 3. `Gpu::CommandBuffer::WaitAndAcquireSwapchainTexture()` blocks when there's this many.
+            // 1 has the least latency, but the CPU and GPU then mostly wait for each other. SDL's default is 2.
+            std::uint32_t max_frames_in_flight = 2;
         };
 
         Window(const Params &params);
@@ -52,5 +73,18 @@ namespace em
         // The texture format this window uses for rendering.
         // Only makes sense if a GPU device is attached.
         SDL_GPUTextureFormat GetSwapchainTextureFormat() const;
+
+        // The present modes can be changed at any time, but not while a swapchain texture is acquired and not yet submitted.
+        // Those only make sense if a GPU device is attached.
+        [[nodiscard]] bool SupportsPresentMode(PresentMode mode) const;
+        [[nodiscard]] PresentMode GetPresentMode() const {return state.present_mode;}
+        // Throws if the mode isn't supported, check `SupportsPresentMode()` first.
+        void SetPresentMode(PresentMode mode);
+
+        // This is a property of the GPU device, so this affects all windows attached to it. This waits for the GPU to become idle.
+        [[nodiscard]] std::uint32_t GetMaxFramesInFlight() const {return state.max_frames_in_flight;}
+        void SetMaxFramesInFlight(std::uint32_t n);
     };
+
+    [[nodiscard]] const char *PresentModeName(Window::PresentMode mode);
 }
@@ -0,0 +1,54 @@
+// Converts a PNG to our pre-baked image format, see `src/game/baked_image.h`.
+// Usage: `bake_image <input.png> <output.image>`. The build system runs this for every image in `assets/images`.
+
+#include "game/baked_image.h"
+
+#include <stb_image.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        std::fprintf(stderr, "Usage: %s <input.png> <output.image>\n", argc > 0 ? argv[0] : "bake_image");
+        return 1;
+    }
+
+    int width = 0, height = 0;
+    unsigned char *pixels = stbi_load(argv[1], &width, &height, nullptr, 4);
+    if (!pixels)
+    {
+        std::fprintf(stderr, "Unable to load image `%s`: %s\n", argv[1], stbi_failure_reason());
+        return 1;
+    }
+
+    BakedImageHeader header;
+    std::memcpy(header.magic, BakedImageHeader::expected_magic, sizeof header.magic);
+    header.version = BakedImageHeader::current_version;
+    header.width = std::uint32_t(width);
+    header.height = std::uint32_t(height);
+
+    FILE *output = std::fopen(argv[2], "wb");
+    if (!output)
+    {
+        std::fprintf(stderr, "Unable to open `%s` for writing.\n", argv[2]);
+        stbi_image_free(pixels);
+        return 1;
+    }
+
+    bool ok = std::fwrite(&header, sizeof header, 1, output) == 1 && std::fwrite(pixels, std::size_t(header.PixelDataSize()), 1, output) == 1;
+    ok = std::fclose(output) == 0 && ok;
+    stbi_image_free(pixels);
+
+    if (!ok)
+    {
+        std::fprintf(stderr, "Unable to write `%s`.\n", argv[2]);
+        std::remove(argv[2]);
+        return 1;
+    }
+
+    return 0;
+}
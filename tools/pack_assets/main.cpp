@@ -0,0 +1,150 @@
+// Packs files into our asset pack format, see `src/utils/asset_pack_format.h`.
+// Usage: `pack_assets <output.pack> <root_dir> <files...>`. The names in the pack are the file paths relative to `root_dir`.
+// The build system runs this on all assets, after generating them.
+
+#include "utils/asset_pack_format.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    struct InputFile
+    {
+        std::string name;
+        std::uint64_t hash = 0;
+        std::vector<unsigned char> data;
+    };
+
+    [[nodiscard]] bool ReadFile(const char *path, std::vector<unsigned char> &out)
+    {
+        FILE *file = std::fopen(path, "rb");
+        if (!file)
+            return false;
+
+        bool ok = true;
+        unsigned char buffer[1 << 16];
+        while (true)
+        {
+            std::size_t n = std::fread(buffer, 1, sizeof buffer, file);
+            out.insert(out.end(), buffer, buffer + n);
+            if (n < sizeof buffer)
+            {
+                ok = !std::ferror(file);
+                break;
+            }
+        }
+        std::fclose(file);
+        return ok;
+    }
+
+    [[nodiscard]] std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::fprintf(stderr, "Usage: %s <output.pack> <root_dir> <files...>\n", argc > 0 ? argv[0] : "pack_assets");
+        return 1;
+    }
+
+    std::string root = argv[2];
+    if (!root.empty() && root.back() != '/')
+        root += '/';
+
+    std::vector<InputFile> files;
+    for (int i = 3; i < argc; i++)
+    {
+        InputFile &file = files.emplace_back();
+
+        std::string_view path = argv[i];
+        if (!path.starts_with(root))
+        {
+            std::fprintf(stderr, "The file `%s` is not in `%s`.\n", argv[i], root.c_str());
+            return 1;
+        }
+        file.name = path.substr(root.size());
+        std::replace(file.name.begin(), file.name.end(), '\\', '/');
+        file.hash = AssetPackHash(file.name);
+
+        if (!ReadFile(argv[i], file.data))
+        {
+            std::fprintf(stderr, "Unable to read `%s`.\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::sort(files.begin(), files.end(), [](const InputFile &a, const InputFile &b){return a.hash != b.hash ? a.hash < b.hash : a.name < b.name;});
+    for (std::size_t i = 1; i < files.size(); i++)
+    {
+        if (files[i].name == files[i - 1].name)
+        {
+            std::fprintf(stderr, "The file `%s` is listed twice.\n", files[i].name.c_str());
+            return 1;
+        }
+    }
+
+    // Lay out the file.
+    AssetPackHeader header;
+    std::memcpy(header.magic, AssetPackHeader::expected_magic, sizeof header.magic);
+    header.version = AssetPackHeader::current_version;
+    header.num_entries = std::uint32_t(files.size());
+    header.entries_offset = sizeof header;
+    header.names_offset = header.entries_offset + sizeof(AssetPackEntry) * files.size();
+
+    std::vector<AssetPackEntry> entries(files.size());
+    std::string names;
+    for (std::size_t i = 0; i < files.size(); i++)
+    {
+        entries[i].name_hash = files[i].hash;
+        entries[i].name_offset = std::uint32_t(names.size());
+        entries[i].name_size = std::uint32_t(files[i].name.size());
+        names += files[i].name;
+    }
+
+    std::uint64_t pos = header.names_offset + names.size();
+    for (std::size_t i = 0; i < files.size(); i++)
+    {
+        // `+ 1` to guarantee a null terminator even before an aligned position.
+        pos = AlignUp(pos + 1, AssetPackHeader::blob_alignment);
+        entries[i].data_offset = pos;
+        entries[i].data_size = files[i].data.size();
+        pos += files[i].data.size();
+    }
+    std::uint64_t total_size = pos + 1;
+
+    // Assemble the file in memory, zero-filled, so the padding and the null terminators are already in place.
+    std::vector<unsigned char> output(std::size_t(total_size));
+    std::memcpy(output.data(), &header, sizeof header);
+    std::memcpy(output.data() + header.entries_offset, entries.data(), sizeof(AssetPackEntry) * entries.size());
+    std::memcpy(output.data() + header.names_offset, names.data(), names.size());
+    for (std::size_t i = 0; i < files.size(); i++)
+        std::copy(files[i].data.begin(), files[i].data.end(), output.begin() + std::ptrdiff_t(entries[i].data_offset));
+
+    FILE *file = std::fopen(argv[1], "wb");
+    if (!file)
+    {
+        std::fprintf(stderr, "Unable to open `%s` for writing.\n", argv[1]);
+        return 1;
+    }
+    bool ok = std::fwrite(output.data(), output.size(), 1, file) == 1;
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok)
+    {
+        std::fprintf(stderr, "Unable to write `%s`.\n", argv[1]);
+        std::remove(argv[1]);
+        return 1;
+    }
+
+    return 0;
+}